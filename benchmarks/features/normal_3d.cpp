@@ -21,6 +21,24 @@ BM_NormalEstimation(benchmark::State& state, const std::string& file)
   }
 }
 
+static void
+BM_NormalEstimationBatched(benchmark::State& state, const std::string& file)
+{
+  // Perform setup here
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::PCDReader reader;
+  reader.read(file, *cloud);
+  pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> ne;
+  ne.setInputCloud(cloud);
+  ne.setKSearch(state.range(0));
+  ne.setBatchSize(state.range(1));
+  pcl::PointCloud<pcl::Normal>::Ptr cloud_normals(new pcl::PointCloud<pcl::Normal>);
+  for (auto _ : state) {
+    // This code gets timed
+    ne.compute(*cloud_normals);
+  }
+}
+
 #ifdef _OPENMP
 static void
 BM_NormalEstimationOMP(benchmark::State& state, const std::string& file)
@@ -32,6 +50,7 @@ BM_NormalEstimationOMP(benchmark::State& state, const std::string& file)
   pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> ne;
   ne.setInputCloud(cloud);
   ne.setKSearch(100);
+  ne.setBatchSize(state.range(0));
   pcl::PointCloud<pcl::Normal>::Ptr cloud_normals(new pcl::PointCloud<pcl::Normal>);
   for (auto _ : state) {
     // This code gets timed
@@ -59,9 +78,21 @@ main(int argc, char** argv)
       ->Arg(50)
       ->Arg(100)
       ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_NormalEstimationBatched_mug", &BM_NormalEstimationBatched, argv[1])
+      ->Args({50, 256})
+      ->Args({100, 256})
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_NormalEstimationBatched_milk", &BM_NormalEstimationBatched, argv[2])
+      ->Args({50, 256})
+      ->Args({100, 256})
+      ->Unit(benchmark::kMillisecond);
 #ifdef _OPENMP
   benchmark::RegisterBenchmark(
       "BM_NormalEstimationOMP", &BM_NormalEstimationOMP, argv[1])
+      ->Arg(0)
+      ->Arg(256)
       ->Unit(benchmark::kMillisecond);
 #endif
   benchmark::Initialize(&argc, argv);
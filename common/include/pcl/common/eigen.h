@@ -129,6 +129,22 @@ namespace pcl
   template <typename Matrix, typename Vector> void
   eigen33 (const Matrix &mat, Matrix &evecs, Vector &evals);
 
+  /** \brief determines the smallest eigenvalue and its corresponding eigenvector for a batch of symmetric positive
+    * semi definite 3x3 matrices at once.
+    *
+    * The matrices are stored in structure-of-arrays layout, one matrix per row, so that the closed form solution
+    * used by \ref eigen33 can be evaluated on whole columns with vectorized array expressions.
+    * \param[in] mats the upper triangular coefficients (00, 01, 02, 11, 12, 22) of the input matrices, one matrix per row
+    * \param[out] eigenvalues the smallest eigenvalue of each input matrix
+    * \param[out] eigenvectors the corresponding eigenvector of each input matrix, one eigenvector per row
+    * \note per matrix, the result is the same as the one of \ref eigen33 up to floating point rounding.
+    * \ingroup common
+    */
+  template <typename Scalar> void
+  eigen33Batch (const Eigen::Array<Scalar, Eigen::Dynamic, 6> &mats,
+                Eigen::Array<Scalar, Eigen::Dynamic, 1> &eigenvalues,
+                Eigen::Array<Scalar, Eigen::Dynamic, 3> &eigenvectors);
+
   /** \brief Calculate the inverse of a 2x2 matrix
     * \param[in] matrix matrix to be inverted
     * \param[out] inverse the resultant inverted matrix
@@ -401,6 +401,86 @@ eigen33 (const Matrix& mat, Matrix& evecs, Vector& evals)
 }
 
 
+template <typename Scalar> inline void
+eigen33Batch (const Eigen::Array<Scalar, Eigen::Dynamic, 6>& mats,
+              Eigen::Array<Scalar, Eigen::Dynamic, 1>& eigenvalues,
+              Eigen::Array<Scalar, Eigen::Dynamic, 3>& eigenvectors)
+{
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  using Mask = Eigen::Array<bool, Eigen::Dynamic, 1>;
+  const Eigen::Index n = mats.rows ();
+
+  // Scale each matrix so its entries are in [-1,1], see eigen33
+  Array scale = mats.abs ().rowwise ().maxCoeff ();
+  scale = (scale <= std::numeric_limits<Scalar>::min ()).select (Array::Ones (n), scale);
+
+  const Array m00 = mats.col (0) / scale;
+  const Array m01 = mats.col (1) / scale;
+  const Array m02 = mats.col (2) / scale;
+  const Array m11 = mats.col (3) / scale;
+  const Array m12 = mats.col (4) / scale;
+  const Array m22 = mats.col (5) / scale;
+
+  // Coefficients of the characteristic equation x^3 - c2*x^2 + c1*x - c0 = 0, see computeRoots
+  const Array c0 = m00 * m11 * m22 + Scalar (2) * m01 * m02 * m12
+                 - m00 * m12 * m12 - m11 * m02 * m02 - m22 * m01 * m01;
+  const Array c1 = m00 * m11 - m01 * m01 + m00 * m22 - m02 * m02 + m11 * m22 - m12 * m12;
+  const Array c2 = m00 + m11 + m22;
+
+  constexpr Scalar s_inv3 = Scalar (1.0 / 3.0);
+  const Scalar s_sqrt3 = std::sqrt (Scalar (3.0));
+  const Array c2_over_3 = c2 * s_inv3;
+  const Array a_over_3 = ((c1 - c2 * c2_over_3) * s_inv3).min (Scalar (0));
+  const Array half_b = Scalar (0.5) * (c0 + c2_over_3 * (Scalar (2) * c2_over_3 * c2_over_3 - c1));
+  const Array q = (half_b * half_b + a_over_3 * a_over_3 * a_over_3).min (Scalar (0));
+
+  const Array rho = (-a_over_3).sqrt ();
+  const Array theta = (-q).sqrt ().binaryExpr (half_b, [] (Scalar y, Scalar x) { return std::atan2 (y, x); }) * s_inv3;
+  const Array cos_theta = theta.cos ();
+  const Array sin_theta = theta.sin ();
+  const Array root0 = c2_over_3 + Scalar (2) * rho * cos_theta;
+  const Array root1 = c2_over_3 - rho * (cos_theta + s_sqrt3 * sin_theta);
+  const Array root2 = c2_over_3 - rho * (cos_theta - s_sqrt3 * sin_theta);
+
+  // If one root is 0 (quadratic equation) or the smallest root is not positive, computeRoots falls back to
+  // computeRoots2, whose smallest root is 0
+  Array smallest = root0.min (root1).min (root2);
+  const Mask quadratic = (c0.abs () < Eigen::NumTraits<Scalar>::epsilon ()) || (smallest <= Scalar (0));
+  smallest = quadratic.select (Array::Zero (n), smallest);
+
+  eigenvalues = smallest * scale;
+
+  // Rows of the scaled matrix with the smallest eigenvalue subtracted from the diagonal
+  const Array d00 = m00 - smallest;
+  const Array d11 = m11 - smallest;
+  const Array d22 = m22 - smallest;
+
+  // Pairwise cross products of the rows, see detail::getLargest3x3Eigenvector
+  const Array x01 = m01 * m12 - m02 * d11;
+  const Array y01 = m02 * m01 - d00 * m12;
+  const Array z01 = d00 * d11 - m01 * m01;
+  const Array x02 = m01 * d22 - m02 * m12;
+  const Array y02 = m02 * m02 - d00 * d22;
+  const Array z02 = d00 * m12 - m01 * m02;
+  const Array x12 = d11 * d22 - m12 * m12;
+  const Array y12 = m12 * m02 - m01 * d22;
+  const Array z12 = m01 * m12 - d11 * m02;
+
+  const Array len01 = (x01 * x01 + y01 * y01 + z01 * z01).sqrt ();
+  const Array len02 = (x02 * x02 + y02 * y02 + z02 * z02).sqrt ();
+  const Array len12 = (x12 * x12 + y12 * y12 + z12 * z12).sqrt ();
+
+  // Pick the longest cross product, preferring the first one on ties like maxCoeff does
+  const Mask use01 = (len01 >= len02) && (len01 >= len12);
+  const Mask use02 = !use01 && (len02 >= len12);
+
+  eigenvectors.resize (n, 3);
+  eigenvectors.col (0) = use01.select (x01 / len01, use02.select (x02 / len02, x12 / len12));
+  eigenvectors.col (1) = use01.select (y01 / len01, use02.select (y02 / len02, y12 / len12));
+  eigenvectors.col (2) = use01.select (z01 / len01, use02.select (z02 / len02, z12 / len12));
+}
+
+
 template <typename Matrix> inline typename Matrix::Scalar
 invert2x2 (const Matrix& matrix, Matrix& inverse)
 {
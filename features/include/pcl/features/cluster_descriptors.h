@@ -0,0 +1,62 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/features/feature.h>
+#include <pcl/PointIndices.h>
+
+namespace pcl
+{
+  /** \brief Compute a global descriptor (e.g. VFH, CVFH, OUR-CVFH, ESF) for every cluster of a segmented
+    * point cloud. The clusters are processed in parallel, each thread running its own copy of \a estimator
+    * with the indices of the cluster. The search method is bound to the search surface once before the
+    * parallel section so that the copies only read from it.
+    *
+    * \param[in] estimator a fully configured estimator (input cloud, normals, search surface, parameters)
+    * \param[in] clusters the indices of each cluster in the input cloud of \a estimator
+    * \param[out] descriptors the descriptors of each cluster, in the same order as \a clusters
+    * \param[in] nr_threads the number of hardware threads to use (0 sets the value to automatic)
+    * \ingroup features
+    */
+  template <typename FeatureT, typename PointOutT> void
+  computeClusterDescriptors (const FeatureT &estimator,
+                             const std::vector<pcl::PointIndices> &clusters,
+                             std::vector<pcl::PointCloud<PointOutT> > &descriptors,
+                             unsigned int nr_threads = 0);
+}
+
+#include <pcl/features/impl/cluster_descriptors.hpp>
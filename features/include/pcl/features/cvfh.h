@@ -86,11 +86,13 @@ namespace pcl
         cluster_tolerance_ (leaf_size_ * 3), 
         eps_angle_threshold_ (0.125f), 
         min_points_ (50),
-        radius_normals_ (leaf_size_ * 3)
+        radius_normals_ (leaf_size_ * 3),
+        threads_ (0)
       {
         search_radius_ = 0;
         k_ = 1;
         feature_name_ = "CVFHEstimation";
+        setNumberOfThreads (threads_);
       }
       ;
 
@@ -206,6 +208,13 @@ namespace pcl
         normalize_bins_ = normalize;
       }
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * The VFH signatures of the dominant regions are computed in parallel.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Overloaded computed method from pcl::Feature.
         * \param[out] output the resultant point cloud model dataset containing the estimated features
         */
@@ -243,6 +252,9 @@ namespace pcl
       /** \brief Radius for the normals computation. */
       float radius_normals_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Estimate the Clustered Viewpoint Feature Histograms (CVFH) descriptors at 
         * a set of points given by <setInputCloud (), setIndices ()> using the surface in
         * setSearchSurface ()
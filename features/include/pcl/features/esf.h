@@ -44,6 +44,8 @@
 #define GRIDSIZE 64
 #define GRIDSIZE_H GRIDSIZE/2
 #include <vector>
+#include <cstdint> // for std::uint8_t
+#include <ctime> // for time
 
 namespace pcl
 {
@@ -74,19 +76,16 @@ namespace pcl
       using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
 
       /** \brief Empty constructor. */
-      ESFEstimation () : local_cloud_ ()
+      ESFEstimation () :
+        threads_ (0),
+        lut_ (GRIDSIZE * GRIDSIZE * GRIDSIZE, 0),
+        local_cloud_ (),
+        seed_ (static_cast<unsigned int> (time (nullptr)))
       {
         feature_name_ = "ESFEstimation";
-        lut_.resize (GRIDSIZE);
-        for (int i = 0; i < GRIDSIZE; ++i)
-        {
-          lut_[i].resize (GRIDSIZE);
-          for (int j = 0; j < GRIDSIZE; ++j)
-            lut_[i][j].resize (GRIDSIZE);
-        }
-        //lut_.resize (boost::extents[GRIDSIZE][GRIDSIZE][GRIDSIZE]);
         search_radius_ = 0;
         k_ = 5;
+        setNumberOfThreads (threads_); // Reset number of threads with the member's initialization value to apply input validation.
       }
 
       /** \brief Overloaded computed method from pcl::Feature.
@@ -95,6 +94,30 @@ namespace pcl
       void
       compute (PointCloudOut &output);
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * The samples are split in fixed blocks with their own random generator, so the descriptor
+        * only depends on the seed and not on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Set the seed of the random generator used to draw the point triplets.
+        * \param[in] seed the seed (default: the current time)
+        */
+      inline void
+      setSeed (unsigned int seed)
+      {
+        seed_ = seed;
+      }
+
+      /** \brief Get the seed of the random generator used to draw the point triplets. */
+      inline unsigned int
+      getSeed () const
+      {
+        return (seed_);
+      }
+
     protected:
 
       /** \brief Estimate the Ensebmel of Shape Function (ESF) descriptors at a set of points given by
@@ -108,7 +131,7 @@ namespace pcl
       int
       lci (const int x1, const int y1, const int z1, 
            const int x2, const int y2, const int z2, 
-           float &ratio, int &incnt, int &pointcount);
+           float &ratio, int &incnt, int &pointcount) const;
      
       /** \brief ... */
       void
@@ -126,13 +149,38 @@ namespace pcl
       void
       scale_points_unit_sphere (const pcl::PointCloud<PointInT> &pc, float scalefactor, Eigen::Vector4f& centroid);
 
+      /** \brief Copy the points of \b pc given by \b indices into local_cloud_, centered on their centroid and
+        * scaled so that the point farthest from the centroid lies at distance \b scalefactor.
+        * Like the overload without indices, but without copying the selected points first.
+        * \param[in] pc the input point cloud
+        * \param[in] indices the indices of the points of \b pc to use
+        * \param[in] scalefactor the distance of the farthest point from the centroid after the scaling
+        * \param[out] centroid the centroid of the selected points, before the scaling
+        */
+      void
+      scale_points_unit_sphere (const pcl::PointCloud<PointInT> &pc, const pcl::Indices &indices,
+                                float scalefactor, Eigen::Vector4f& centroid);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
     private:
 
-      /** \brief ... */
-      std::vector<std::vector<std::vector<int> > > lut_;
+      /** \brief Index of a voxel in lut_. */
+      static inline std::size_t
+      lutIndex (int x, int y, int z)
+      {
+        return ((static_cast<std::size_t> (x) * GRIDSIZE + y) * GRIDSIZE + z);
+      }
+
+      /** \brief Occupancy of the GRIDSIZE^3 voxel grid, stored as a flat array. */
+      std::vector<std::uint8_t> lut_;
       
       /** \brief ... */
       PointCloudIn local_cloud_;
+
+      /** \brief The seed of the random generator. */
+      unsigned int seed_;
   };
 }
 
@@ -0,0 +1,99 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCL_FEATURES_IMPL_CLUSTER_DESCRIPTORS_H_
+#define PCL_FEATURES_IMPL_CLUSTER_DESCRIPTORS_H_
+
+#include <pcl/features/cluster_descriptors.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/search/organized.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename FeatureT, typename PointOutT> void
+pcl::computeClusterDescriptors (const FeatureT &estimator,
+                                const std::vector<pcl::PointIndices> &clusters,
+                                std::vector<pcl::PointCloud<PointOutT> > &descriptors,
+                                unsigned int nr_threads)
+{
+  using PointCloudIn = typename std::decay_t<decltype (estimator.getInputCloud ())>::element_type;
+  using PointInT = typename PointCloudIn::PointType;
+
+  descriptors.clear ();
+  descriptors.resize (clusters.size ());
+
+  FeatureT cluster_estimator (estimator);
+  const auto input = cluster_estimator.getInputCloud ();
+  if (!input)
+  {
+    PCL_ERROR ("[pcl::computeClusterDescriptors] No input dataset was given!\n");
+    return;
+  }
+  const auto surface = cluster_estimator.getSearchSurface () ? cluster_estimator.getSearchSurface () : input;
+
+  // Create and bind the search method up front, the same way Feature::initCompute would
+  auto tree = cluster_estimator.getSearchMethod ();
+  if (!tree)
+  {
+    if (surface->isOrganized () && input->isOrganized ())
+      tree.reset (new pcl::search::OrganizedNeighbor<PointInT> ());
+    else
+      tree.reset (new pcl::search::KdTree<PointInT> (false));
+    cluster_estimator.setSearchMethod (tree);
+  }
+  if (tree->getInputCloud () != surface)
+    tree->setInputCloud (surface);
+
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    nr_threads = omp_get_num_procs ();
+#else
+    nr_threads = 1;
+#endif
+
+#pragma omp parallel for \
+  default(none) \
+  shared(clusters, descriptors) \
+  firstprivate(cluster_estimator) \
+  schedule(dynamic, 1) \
+  num_threads(nr_threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (clusters.size ()); ++i)
+  {
+    cluster_estimator.setIndices (pcl::IndicesPtr (new pcl::Indices (clusters[i].indices)));
+    cluster_estimator.compute (descriptors[i]);
+  }
+}
+
+#endif    // PCL_FEATURES_IMPL_CLUSTER_DESCRIPTORS_H_
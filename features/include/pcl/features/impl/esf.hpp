@@ -44,28 +44,183 @@
 #include <pcl/features/esf.h>
 #include <pcl/common/distances.h>
 #include <pcl/common/transforms.h>
+#include <random>
 #include <vector>
-#include <ctime> // for time
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ESFEstimation<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
     PointCloudIn &pc, std::vector<float> &hist)
 {
-  const int binsize = 64;
-  unsigned int sample_size = 20000;
-  // @TODO: Replace with c++ stdlib uniform_random_generator
-  srand (static_cast<unsigned int> (time (nullptr)));
-  const auto maxindex = pc.size ();
-
-  std::vector<float> d2v, d1v, d3v, wt_d3;
-  std::vector<int> wt_d2;
-  d1v.reserve (sample_size);
-  d2v.reserve (sample_size * 3);
-  d3v.reserve (sample_size);
-  wt_d2.reserve (sample_size * 3);
-  wt_d3.reserve (sample_size);
+  constexpr int binsize = 64;
+  constexpr std::size_t sample_size = 20000;
+  // The samples are drawn in fixed blocks, each one with its own generator seeded from seed_ and
+  // the block number, so that the result does not depend on the number of threads
+  constexpr std::size_t block_size = 500;
+  constexpr std::size_t nr_blocks = sample_size / block_size;
+  const std::size_t maxindex = pc.size ();
+  const unsigned int seed = seed_;
+
+  // Each sample writes at its own position, three D2 values and one D3 value
+  std::vector<float> d2v (sample_size * 3), d3v (sample_size), wt_d3 (sample_size);
+  std::vector<int> wt_d2 (sample_size * 3);
+
+  // The histograms filled while sampling (h_mix_ratio, h_a3_in, h_a3_out, h_a3_mix), one set per block
+  std::vector<float> block_hists (nr_blocks * 4 * binsize, 0.0f);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(pc, d2v, d3v, wt_d2, wt_d3, block_hists) \
+  firstprivate(maxindex, seed) \
+  schedule(dynamic, 1) \
+  num_threads(threads_)
+  for (std::ptrdiff_t block = 0; block < static_cast<std::ptrdiff_t> (nr_blocks); ++block)
+  {
+    std::seed_seq seq {seed, static_cast<unsigned int> (block)};
+    std::mt19937 rng (seq);
+    std::uniform_int_distribution<std::size_t> random_index (0, maxindex - 1);
+
+    float* h_mix_ratio = &block_hists[block * 4 * binsize];
+    float* h_a3_in = h_mix_ratio + binsize;
+    float* h_a3_out = h_a3_in + binsize;
+    float* h_a3_mix = h_a3_out + binsize;
+
+    const float pih = static_cast<float>(M_PI) / 2.0f;
+    float ratio=0.0;
+    float a,b,c,s;
+    int th1,th2,th3;
+    int vxlcnt = 0;
+    int pcnt1,pcnt2,pcnt3;
+    for (std::size_t nn_idx = block * block_size; nn_idx < (block + 1) * block_size;)
+    {
+      // get a new random point
+      const std::size_t index1 = random_index (rng);
+      const std::size_t index2 = random_index (rng);
+      const std::size_t index3 = random_index (rng);
+
+      if (index1==index2 || index1 == index3 || index2 == index3)
+        continue;
+
+      Eigen::Vector4f p1 = pc[index1].getVector4fMap ();
+      Eigen::Vector4f p2 = pc[index2].getVector4fMap ();
+      Eigen::Vector4f p3 = pc[index3].getVector4fMap ();
+
+      // A3
+      Eigen::Vector4f v21 (p2 - p1);
+      Eigen::Vector4f v31 (p3 - p1);
+      Eigen::Vector4f v23 (p2 - p3);
+      a = v21.norm (); b = v31.norm (); c = v23.norm (); s = (a+b+c) * 0.5f;
+      if (s * (s-a) * (s-b) * (s-c) <= 0.001f)
+        continue;
+
+      v21.normalize ();
+      v31.normalize ();
+      v23.normalize ();
+
+      //TODO: .dot gives nan's
+      th1 = static_cast<int> (pcl_round (std::acos (std::abs (v21.dot (v31))) / pih * (binsize-1)));
+      th2 = static_cast<int> (pcl_round (std::acos (std::abs (v23.dot (v31))) / pih * (binsize-1)));
+      th3 = static_cast<int> (pcl_round (std::acos (std::abs (v23.dot (v21))) / pih * (binsize-1)));
+      if (th1 < 0 || th1 >= binsize)
+        continue;
+      if (th2 < 0 || th2 >= binsize)
+        continue;
+      if (th3 < 0 || th3 >= binsize)
+        continue;
+
+      // D2
+      d2v[nn_idx * 3 + 0] = pcl::euclideanDistance (pc[index1], pc[index2]);
+      d2v[nn_idx * 3 + 1] = pcl::euclideanDistance (pc[index1], pc[index3]);
+      d2v[nn_idx * 3 + 2] = pcl::euclideanDistance (pc[index2], pc[index3]);
+
+      int vxlcnt_sum = 0;
+      int p_cnt = 0;
+      // IN, OUT, MIXED, Ratio line tracing, index1->index2
+      {
+        const int xs = p1[0] < 0.0? static_cast<int>(std::floor(p1[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[0])+GRIDSIZE_H-1);
+        const int ys = p1[1] < 0.0? static_cast<int>(std::floor(p1[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[1])+GRIDSIZE_H-1);
+        const int zs = p1[2] < 0.0? static_cast<int>(std::floor(p1[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[2])+GRIDSIZE_H-1);
+        const int xt = p2[0] < 0.0? static_cast<int>(std::floor(p2[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[0])+GRIDSIZE_H-1);
+        const int yt = p2[1] < 0.0? static_cast<int>(std::floor(p2[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[1])+GRIDSIZE_H-1);
+        const int zt = p2[2] < 0.0? static_cast<int>(std::floor(p2[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[2])+GRIDSIZE_H-1);
+        wt_d2[nn_idx * 3 + 0] = this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt1);
+        if (wt_d2[nn_idx * 3 + 0] == 2)
+          h_mix_ratio[static_cast<int> (pcl_round (ratio * (binsize-1)))]++;
+        vxlcnt_sum += vxlcnt;
+        p_cnt += pcnt1;
+      }
+      // IN, OUT, MIXED, Ratio line tracing, index1->index3
+      {
+        const int xs = p1[0] < 0.0? static_cast<int>(std::floor(p1[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[0])+GRIDSIZE_H-1);
+        const int ys = p1[1] < 0.0? static_cast<int>(std::floor(p1[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[1])+GRIDSIZE_H-1);
+        const int zs = p1[2] < 0.0? static_cast<int>(std::floor(p1[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[2])+GRIDSIZE_H-1);
+        const int xt = p3[0] < 0.0? static_cast<int>(std::floor(p3[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[0])+GRIDSIZE_H-1);
+        const int yt = p3[1] < 0.0? static_cast<int>(std::floor(p3[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[1])+GRIDSIZE_H-1);
+        const int zt = p3[2] < 0.0? static_cast<int>(std::floor(p3[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[2])+GRIDSIZE_H-1);
+        wt_d2[nn_idx * 3 + 1] = this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt2);
+        if (wt_d2[nn_idx * 3 + 1] == 2)
+          h_mix_ratio[static_cast<int>(pcl_round (ratio * (binsize-1)))]++;
+        vxlcnt_sum += vxlcnt;
+        p_cnt += pcnt2;
+      }
+      // IN, OUT, MIXED, Ratio line tracing, index2->index3
+      {
+        const int xs = p2[0] < 0.0? static_cast<int>(std::floor(p2[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[0])+GRIDSIZE_H-1);
+        const int ys = p2[1] < 0.0? static_cast<int>(std::floor(p2[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[1])+GRIDSIZE_H-1);
+        const int zs = p2[2] < 0.0? static_cast<int>(std::floor(p2[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[2])+GRIDSIZE_H-1);
+        const int xt = p3[0] < 0.0? static_cast<int>(std::floor(p3[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[0])+GRIDSIZE_H-1);
+        const int yt = p3[1] < 0.0? static_cast<int>(std::floor(p3[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[1])+GRIDSIZE_H-1);
+        const int zt = p3[2] < 0.0? static_cast<int>(std::floor(p3[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[2])+GRIDSIZE_H-1);
+        wt_d2[nn_idx * 3 + 2] = this->lci (xs,ys,zs,xt,yt,zt,ratio,vxlcnt,pcnt3);
+        if (wt_d2[nn_idx * 3 + 2] == 2)
+          h_mix_ratio[static_cast<int>(pcl_round(ratio * (binsize-1)))]++;
+        vxlcnt_sum += vxlcnt;
+        p_cnt += pcnt3;
+      }
+
+      // D3 ( herons formula )
+      d3v[nn_idx] = std::sqrt (std::sqrt (s * (s-a) * (s-b) * (s-c)));
+      if (vxlcnt_sum <= 21)
+      {
+        wt_d3[nn_idx] = 0;
+        h_a3_out[th1] += static_cast<float> (pcnt3) / 32.0f;
+        h_a3_out[th2] += static_cast<float> (pcnt1) / 32.0f;
+        h_a3_out[th3] += static_cast<float> (pcnt2) / 32.0f;
+      }
+      else
+        if (p_cnt - vxlcnt_sum < 4)
+        {
+          h_a3_in[th1] += static_cast<float> (pcnt3) / 32.0f;
+          h_a3_in[th2] += static_cast<float> (pcnt1) / 32.0f;
+          h_a3_in[th3] += static_cast<float> (pcnt2) / 32.0f;
+          wt_d3[nn_idx] = 1;
+        }
+        else
+        {
+          h_a3_mix[th1] += static_cast<float> (pcnt3) / 32.0f;
+          h_a3_mix[th2] += static_cast<float> (pcnt1) / 32.0f;
+          h_a3_mix[th3] += static_cast<float> (pcnt2) / 32.0f;
+          wt_d3[nn_idx] = static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt);
+        }
+      ++nn_idx;
+    }
+  }
 
+  // Merge the histograms of the blocks, always in the same order
   float h_in[binsize] = {0};
   float h_out[binsize] = {0};
   float h_mix[binsize] = {0};
@@ -79,154 +234,32 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
   float h_d3_out[binsize] = {0};
   float h_d3_mix[binsize] = {0};
 
-  float ratio=0.0;
-  float pih = static_cast<float>(M_PI) / 2.0f;
-  float a,b,c,s;
-  int th1,th2,th3;
-  int vxlcnt = 0;
-  int pcnt1,pcnt2,pcnt3;
-  for (std::size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  for (std::size_t block = 0; block < nr_blocks; ++block)
   {
-    // get a new random point
-    int index1 = rand()%maxindex;
-    int index2 = rand()%maxindex;
-    int index3 = rand()%maxindex;
-
-    if (index1==index2 || index1 == index3 || index2 == index3)
-    {
-      nn_idx--;
-      continue;
-    }
-
-    Eigen::Vector4f p1 = pc[index1].getVector4fMap ();
-    Eigen::Vector4f p2 = pc[index2].getVector4fMap ();
-    Eigen::Vector4f p3 = pc[index3].getVector4fMap ();
-
-    // A3
-    Eigen::Vector4f v21 (p2 - p1);
-    Eigen::Vector4f v31 (p3 - p1);
-    Eigen::Vector4f v23 (p2 - p3);
-    a = v21.norm (); b = v31.norm (); c = v23.norm (); s = (a+b+c) * 0.5f;
-    if (s * (s-a) * (s-b) * (s-c) <= 0.001f)
+    const float* block_hist = &block_hists[block * 4 * binsize];
+    for (int i = 0; i < binsize; ++i)
     {
-        nn_idx--;
-        continue;
-    }
-
-    v21.normalize ();
-    v31.normalize ();
-    v23.normalize ();
-
-    //TODO: .dot gives nan's
-    th1 = static_cast<int> (pcl_round (std::acos (std::abs (v21.dot (v31))) / pih * (binsize-1)));
-    th2 = static_cast<int> (pcl_round (std::acos (std::abs (v23.dot (v31))) / pih * (binsize-1)));
-    th3 = static_cast<int> (pcl_round (std::acos (std::abs (v23.dot (v21))) / pih * (binsize-1)));
-    if (th1 < 0 || th1 >= binsize)
-    {
-      nn_idx--;
-      continue;
+      h_mix_ratio[i] += block_hist[i];
+      h_a3_in[i] += block_hist[binsize + i];
+      h_a3_out[i] += block_hist[2 * binsize + i];
+      h_a3_mix[i] += block_hist[3 * binsize + i];
     }
-    if (th2 < 0 || th2 >= binsize)
-    {
-      nn_idx--;
-      continue;
-    }
-    if (th3 < 0 || th3 >= binsize)
-    {
-      nn_idx--;
-      continue;
-    }
-
-    // D2
-    d2v.push_back (pcl::euclideanDistance (pc[index1], pc[index2]));
-    d2v.push_back (pcl::euclideanDistance (pc[index1], pc[index3]));
-    d2v.push_back (pcl::euclideanDistance (pc[index2], pc[index3]));
-
-    int vxlcnt_sum = 0;
-    int p_cnt = 0;
-    // IN, OUT, MIXED, Ratio line tracing, index1->index2
-    {
-      const int xs = p1[0] < 0.0? static_cast<int>(std::floor(p1[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[0])+GRIDSIZE_H-1);
-      const int ys = p1[1] < 0.0? static_cast<int>(std::floor(p1[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[1])+GRIDSIZE_H-1);
-      const int zs = p1[2] < 0.0? static_cast<int>(std::floor(p1[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[2])+GRIDSIZE_H-1);
-      const int xt = p2[0] < 0.0? static_cast<int>(std::floor(p2[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[0])+GRIDSIZE_H-1);
-      const int yt = p2[1] < 0.0? static_cast<int>(std::floor(p2[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[1])+GRIDSIZE_H-1);
-      const int zt = p2[2] < 0.0? static_cast<int>(std::floor(p2[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt1));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int> (pcl_round (ratio * (binsize-1)))]++;
-      vxlcnt_sum += vxlcnt;
-      p_cnt += pcnt1;
-    }
-    // IN, OUT, MIXED, Ratio line tracing, index1->index3
-    {
-      const int xs = p1[0] < 0.0? static_cast<int>(std::floor(p1[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[0])+GRIDSIZE_H-1);
-      const int ys = p1[1] < 0.0? static_cast<int>(std::floor(p1[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[1])+GRIDSIZE_H-1);
-      const int zs = p1[2] < 0.0? static_cast<int>(std::floor(p1[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p1[2])+GRIDSIZE_H-1);
-      const int xt = p3[0] < 0.0? static_cast<int>(std::floor(p3[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[0])+GRIDSIZE_H-1);
-      const int yt = p3[1] < 0.0? static_cast<int>(std::floor(p3[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[1])+GRIDSIZE_H-1);
-      const int zt = p3[2] < 0.0? static_cast<int>(std::floor(p3[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt2));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int>(pcl_round (ratio * (binsize-1)))]++;
-      vxlcnt_sum += vxlcnt;
-      p_cnt += pcnt2;
-    }
-    // IN, OUT, MIXED, Ratio line tracing, index2->index3
-    {
-      const int xs = p2[0] < 0.0? static_cast<int>(std::floor(p2[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[0])+GRIDSIZE_H-1);
-      const int ys = p2[1] < 0.0? static_cast<int>(std::floor(p2[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[1])+GRIDSIZE_H-1);
-      const int zs = p2[2] < 0.0? static_cast<int>(std::floor(p2[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[2])+GRIDSIZE_H-1);
-      const int xt = p3[0] < 0.0? static_cast<int>(std::floor(p3[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[0])+GRIDSIZE_H-1);
-      const int yt = p3[1] < 0.0? static_cast<int>(std::floor(p3[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[1])+GRIDSIZE_H-1);
-      const int zt = p3[2] < 0.0? static_cast<int>(std::floor(p3[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs,ys,zs,xt,yt,zt,ratio,vxlcnt,pcnt3));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int>(pcl_round(ratio * (binsize-1)))]++;
-      vxlcnt_sum += vxlcnt;
-      p_cnt += pcnt3;
-    }
-
-    // D3 ( herons formula )
-    d3v.push_back (std::sqrt (std::sqrt (s * (s-a) * (s-b) * (s-c))));
-    if (vxlcnt_sum <= 21)
-    {
-      wt_d3.push_back (0);
-      h_a3_out[th1] += static_cast<float> (pcnt3) / 32.0f;
-      h_a3_out[th2] += static_cast<float> (pcnt1) / 32.0f;
-      h_a3_out[th3] += static_cast<float> (pcnt2) / 32.0f;
-    }
-    else
-      if (p_cnt - vxlcnt_sum < 4)
-      {
-        h_a3_in[th1] += static_cast<float> (pcnt3) / 32.0f;
-        h_a3_in[th2] += static_cast<float> (pcnt1) / 32.0f;
-        h_a3_in[th3] += static_cast<float> (pcnt2) / 32.0f;
-        wt_d3.push_back (1);
-      }
-      else
-      {
-        h_a3_mix[th1] += static_cast<float> (pcnt3) / 32.0f;
-        h_a3_mix[th2] += static_cast<float> (pcnt1) / 32.0f;
-        h_a3_mix[th3] += static_cast<float> (pcnt2) / 32.0f;
-        wt_d3.push_back (static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt));
-      }
   }
+
   // Normalizing, get max
   float maxd2 = 0;
   float maxd3 = 0;
 
-  for (std::size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  for (const float &d2 : d2v)
   {
     // get max of Dx
-    if (d2v[nn_idx] > maxd2)
-      maxd2 = d2v[nn_idx];
-    if (d2v[sample_size + nn_idx] > maxd2)
-      maxd2 = d2v[sample_size + nn_idx];
-    if (d2v[sample_size*2 +nn_idx] > maxd2)
-      maxd2 = d2v[sample_size*2 +nn_idx];
-    if (d3v[nn_idx] > maxd3)
-      maxd3 = d3v[nn_idx];
+    if (d2 > maxd2)
+      maxd2 = d2;
+  }
+  for (const float &d3 : d3v)
+  {
+    if (d3 > maxd3)
+      maxd3 = d3;
   }
 
   // Normalize and create histogram
@@ -306,7 +339,7 @@ template <typename PointInT, typename PointOutT> int
 pcl::ESFEstimation<PointInT, PointOutT>::lci (
     const int x1, const int y1, const int z1, 
     const int x2, const int y2, const int z2, 
-    float &ratio, int &incnt, int &pointcount)
+    float &ratio, int &incnt, int &pointcount) const
 {
   int voxelcount = 0;
   int voxel_in = 0;
@@ -343,7 +376,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i = 1; i<l; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(lut_[lutIndex (act_voxel[0], act_voxel[1], act_voxel[2])] == 1);
       if (err_1 > 0)
       {
         act_voxel[1] += y_inc;
@@ -366,7 +399,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i=1; i<m; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(lut_[lutIndex (act_voxel[0], act_voxel[1], act_voxel[2])] == 1);
       if (err_1 > 0)
       {
         act_voxel[0] +=  x_inc;
@@ -389,7 +422,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i=1; i<n; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(lut_[lutIndex (act_voxel[0], act_voxel[1], act_voxel[2])] == 1);
       if (err_1 > 0)
       {
         act_voxel[1] += y_inc;
@@ -406,7 +439,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     }
   }
   voxelcount++;
-  voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+  voxel_in +=  static_cast<int>(lut_[lutIndex (act_voxel[0], act_voxel[1], act_voxel[2])] == 1);
   incnt = voxel_in;
   pointcount = voxelcount;
 
@@ -443,7 +476,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::voxelize9 (PointCloudIn &cluster)
             ;
           }
           else
-            this->lut_[xi][yi][zi] = 1;
+            this->lut_[lutIndex (xi, yi, zi)] = 1;
         }
   }
 }
@@ -471,7 +504,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::cleanup9 (PointCloudIn &cluster)
             ;
           }
           else
-            this->lut_[xi][yi][zi] = 0;
+            this->lut_[lutIndex (xi, yi, zi)] = 0;
         }
   }
 }
@@ -501,6 +534,31 @@ pcl::ESFEstimation<PointInT, PointOutT>::scale_points_unit_sphere (
   pcl::transformPointCloud (local_cloud_, local_cloud_, matrix);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ESFEstimation<PointInT, PointOutT>::scale_points_unit_sphere (
+    const pcl::PointCloud<PointInT> &pc, const pcl::Indices &indices, float scalefactor, Eigen::Vector4f& centroid)
+{
+  pcl::compute3DCentroid (pc, indices, centroid);
+  pcl::demeanPointCloud (pc, indices, centroid, local_cloud_);
+
+  float max_distance = 0;
+  pcl::PointXYZ cog (0, 0, 0);
+
+  for (const auto& point: local_cloud_)
+  {
+    float d = pcl::euclideanDistance(cog,point);
+    if (d > max_distance)
+      max_distance = d;
+  }
+
+  float scale_factor = 1.0f / max_distance * scalefactor;
+
+  Eigen::Affine3f matrix = Eigen::Affine3f::Identity();
+  matrix.scale (scale_factor);
+  pcl::transformPointCloud (local_cloud_, local_cloud_, matrix);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointOutT> void
 pcl::ESFEstimation<PointInT, PointOutT>::compute (PointCloudOut &output)
@@ -535,7 +593,11 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
   Eigen::Vector4f xyz_centroid;
   std::vector<float> hist;
-  scale_points_unit_sphere (*surface_, static_cast<float>(GRIDSIZE_H), xyz_centroid);
+  // Without a search surface, describe the points of the input given by the indices
+  if (this->fake_surface_)
+    scale_points_unit_sphere (*input_, *indices_, static_cast<float>(GRIDSIZE_H), xyz_centroid);
+  else
+    scale_points_unit_sphere (*surface_, static_cast<float>(GRIDSIZE_H), xyz_centroid);
   this->voxelize9 (local_cloud_);
   this->computeESF (local_cloud_, hist);
   this->cleanup9 (local_cloud_);
@@ -41,10 +41,72 @@
 #ifndef PCL_INTEGRAL_IMAGE2D_IMPL_H_
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
+#include <algorithm>
+#include <cstddef>
+
 
 namespace pcl
 {
 
+namespace detail
+{
+
+/** \brief Turn per-row prefix sums into an integral image by accumulating the rows top-down.
+  * The rows are split into column blocks which are processed independently, each of them
+  * being a plain array addition that Eigen vectorizes.
+  * \param[in,out] data the row-major image data, each row holding \a row_size scalars
+  * \param[in] row_size the number of scalars per row
+  * \param[in] rows the number of rows
+  * \param[in] threads the number of threads to use
+  */
+template <typename T> void
+accumulateIntegralImageRows (T *data, std::size_t row_size, std::size_t rows, unsigned int threads)
+{
+  std::ptrdiff_t block_size = 1024;
+  std::ptrdiff_t nr_blocks = (static_cast<std::ptrdiff_t> (row_size) + block_size - 1) / block_size;
+
+#pragma omp parallel for \
+  default(none) \
+  shared(block_size, data, nr_blocks, row_size, rows) \
+  num_threads(threads)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    const std::size_t begin = block * block_size;
+    const std::size_t length = std::min<std::size_t> (block_size, row_size - begin);
+    for (std::size_t row = 1; row < rows; ++row)
+    {
+      Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1> > current (data + row * row_size + begin, length);
+      Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1> > previous (data + (row - 1) * row_size + begin, length);
+      current += previous;
+    }
+  }
+}
+
+} // namespace detail
+
+template <typename DataType, unsigned Dimension> void
+IntegralImage2D<DataType, Dimension>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+template <typename DataType, unsigned Dimension> void
+IntegralImage2D<DataType, Dimension>::reserve (unsigned width, unsigned height)
+{
+  const std::size_t size = static_cast<std::size_t> (width + 1) * (height + 1);
+  first_order_integral_image_.reserve (size);
+  finite_values_integral_image_.reserve (size);
+  if (compute_second_order_integral_images_)
+    second_order_integral_image_.reserve (size);
+}
+
 template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compute_second_order_integral_images)
 {
@@ -55,15 +117,13 @@ IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compute_se
 template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
-  {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-  }
+  // resizing within the capacity of the buffers does not reallocate, see reserve ()
+  width_  = width;
+  height_ = height;
+  first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  if (compute_second_order_integral_images_)
+    second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   computeIntegralImages (data, row_stride, element_stride);
 }
 
@@ -156,62 +216,60 @@ template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  for (unsigned int i = 0; i < (width_ + 1); ++i)
-    previous_row[i].setZero();
+  using IntegralType = typename IntegralImageTypeTraits<DataType>::IntegralType;
+  static_assert (sizeof (ElementType) == Dimension * sizeof (IntegralType), "ElementType must be densely packed");
+  static_assert (sizeof (SecondOrderType) == second_order_size * sizeof (IntegralType), "SecondOrderType must be densely packed");
 
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  std::fill_n(count_previous_row, width_ + 1, 0);
+  for (unsigned int i = 0; i < (width_ + 1); ++i)
+    first_order_integral_image_[i].setZero();
+  std::fill_n(&finite_values_integral_image_[0], width_ + 1, 0);
+  if (compute_second_order_integral_images_)
+  {
+    for (unsigned int i = 0; i < (width_ + 1); ++i)
+      second_order_integral_image_[i].setZero();
+  }
 
-  if (!compute_second_order_integral_images_)
+  // first pass: the rows are independent, so compute the prefix sums along each row in parallel
+#pragma omp parallel for \
+  default(none) \
+  shared(data, element_stride, row_stride) \
+  num_threads(threads_)
+  for (std::ptrdiff_t rowIdx = 0; rowIdx < static_cast<std::ptrdiff_t> (height_); ++rowIdx)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const DataType* row_data = data + rowIdx * row_stride;
+    ElementType* current_row = &first_order_integral_image_[(rowIdx + 1) * (width_ + 1)];
+    unsigned* count_current_row = &finite_values_integral_image_[(rowIdx + 1) * (width_ + 1)];
+    current_row [0].setZero ();
+    count_current_row [0] = 0;
+
+    if (!compute_second_order_integral_images_)
     {
-      current_row [0].setZero ();
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const auto* element = reinterpret_cast <const InputType*> (&data [valIdx]);
+        current_row [colIdx + 1] = current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        const auto* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
         if (std::isfinite (element->sum ()))
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+          current_row [colIdx + 1] += element->template cast<IntegralType>();
           ++(count_current_row [colIdx + 1]);
         }
       }
     }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    for (unsigned int i = 0; i < (width_ + 1); ++i)
-      so_previous_row[i].setZero();
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    else
     {
-      current_row [0].setZero ();
+      SecondOrderType* so_current_row = &second_order_integral_image_[(rowIdx + 1) * (width_ + 1)];
       so_current_row [0].setZero ();
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+        current_row [colIdx + 1] = current_row [colIdx];
+        so_current_row [colIdx + 1] = so_current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
 
-        const auto* element = reinterpret_cast <const InputType*> (&data [valIdx]);
+        const auto* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
         if (std::isfinite (element->sum ()))
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+          current_row [colIdx + 1] += element->template cast<IntegralType>();
           ++(count_current_row [colIdx + 1]);
           for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
             for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
@@ -220,21 +278,50 @@ IntegralImage2D<DataType, Dimension>::computeIntegralImages (
       }
     }
   }
+
+  // second pass: accumulate the row sums top-down
+  detail::accumulateIntegralImageRows (first_order_integral_image_[0].data (), (width_ + 1) * Dimension, height_ + 1, threads_);
+  detail::accumulateIntegralImageRows (&finite_values_integral_image_[0], width_ + 1, height_ + 1, threads_);
+  if (compute_second_order_integral_images_)
+    detail::accumulateIntegralImageRows (second_order_integral_image_[0].data (), (width_ + 1) * second_order_size, height_ + 1, threads_);
+}
+
+
+template <typename DataType> void
+IntegralImage2D<DataType, 1>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+
+template <typename DataType> void
+IntegralImage2D<DataType, 1>::reserve (unsigned width, unsigned height)
+{
+  const std::size_t size = static_cast<std::size_t> (width + 1) * (height + 1);
+  first_order_integral_image_.reserve (size);
+  finite_values_integral_image_.reserve (size);
+  if (compute_second_order_integral_images_)
+    second_order_integral_image_.reserve (size);
 }
 
 
 template <typename DataType> void
 IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
-  {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-  }
+  // resizing within the capacity of the buffers does not reallocate, see reserve ()
+  width_  = width;
+  height_ = height;
+  first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  if (compute_second_order_integral_images_)
+    second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   computeIntegralImages (data, row_stride, element_stride);
 }
 
@@ -327,62 +414,61 @@ template <typename DataType> void
 IntegralImage2D<DataType, 1>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  std::fill_n(previous_row, width_ + 1, 0);
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  std::fill_n(count_previous_row, width_ + 1, 0);
-
-  if (!compute_second_order_integral_images_)
+  std::fill_n(&first_order_integral_image_[0], width_ + 1, 0);
+  std::fill_n(&finite_values_integral_image_[0], width_ + 1, 0);
+  if (compute_second_order_integral_images_)
+    std::fill_n(&second_order_integral_image_[0], width_ + 1, 0);
+
+  // first pass: the rows are independent, so compute the prefix sums along each row in parallel
+#pragma omp parallel for \
+  default(none) \
+  shared(data, element_stride, row_stride) \
+  num_threads(threads_)
+  for (std::ptrdiff_t rowIdx = 0; rowIdx < static_cast<std::ptrdiff_t> (height_); ++rowIdx)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const DataType* row_data = data + rowIdx * row_stride;
+    ElementType* current_row = &first_order_integral_image_[(rowIdx + 1) * (width_ + 1)];
+    unsigned* count_current_row = &finite_values_integral_image_[(rowIdx + 1) * (width_ + 1)];
+    current_row [0] = 0.0;
+    count_current_row [0] = 0;
+
+    if (!compute_second_order_integral_images_)
     {
-      current_row [0] = 0.0;
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data [valIdx]))
+        current_row [colIdx + 1] = current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        if (std::isfinite (row_data [valIdx]))
         {
-          current_row [colIdx + 1] += data [valIdx];
+          current_row [colIdx + 1] += row_data [valIdx];
           ++(count_current_row [colIdx + 1]);
         }
       }
     }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    std::fill_n(so_previous_row, width_ + 1, 0);
-
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    else
     {
-      current_row [0] = 0.0;
+      SecondOrderType* so_current_row = &second_order_integral_image_[(rowIdx + 1) * (width_ + 1)];
       so_current_row [0] = 0.0;
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data[valIdx]))
+        current_row [colIdx + 1] = current_row [colIdx];
+        so_current_row [colIdx + 1] = so_current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        if (std::isfinite (row_data[valIdx]))
         {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
+          current_row [colIdx + 1] += row_data[valIdx];
+          so_current_row [colIdx + 1] += row_data[valIdx] * row_data[valIdx];
           ++(count_current_row [colIdx + 1]);
         }
       }
     }
   }
+
+  // second pass: accumulate the row sums top-down
+  detail::accumulateIntegralImageRows (&first_order_integral_image_[0], width_ + 1, height_ + 1, threads_);
+  detail::accumulateIntegralImageRows (&finite_values_integral_image_[0], width_ + 1, height_ + 1, threads_);
+  if (compute_second_order_integral_images_)
+    detail::accumulateIntegralImageRows (&second_order_integral_image_[0], width_ + 1, height_ + 1, threads_);
 }
 
 } // namespace pcl
@@ -40,16 +40,6 @@
 
 #include <algorithm>
 
-//////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointInT, typename PointOutT>
-pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::~IntegralImageNormalEstimation ()
-{
-  delete[] diff_x_;
-  delete[] diff_y_;
-  delete[] depth_data_;
-  delete[] distance_map_;
-}
-
 //////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData ()
@@ -66,16 +56,6 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData ()
     PCL_THROW_EXCEPTION (InitFailedException,
                          "[pcl::IntegralImageNormalEstimation::initData] unknown normal estimation method.");
 
-  // compute derivatives
-  delete[] diff_x_;
-  delete[] diff_y_;
-  delete[] depth_data_;
-  delete[] distance_map_;
-  diff_x_ = nullptr;
-  diff_y_ = nullptr;
-  depth_data_ = nullptr;
-  distance_map_ = nullptr;
-
   if (normal_estimation_method_ == COVARIANCE_MATRIX)
     initCovarianceMatrixMethod ();
   else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT)
@@ -87,6 +67,51 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData ()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+
+  integral_image_DX_.setNumberOfThreads (threads_);
+  integral_image_DY_.setNumberOfThreads (threads_);
+  integral_image_depth_.setNumberOfThreads (threads_);
+  integral_image_XYZ_.setNumberOfThreads (threads_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::reserve (unsigned width, unsigned height)
+{
+  const std::size_t size = static_cast<std::size_t> (width) * height;
+  depth_change_map_.reserve (size);
+  distance_map_.reserve (size);
+
+  if (normal_estimation_method_ == COVARIANCE_MATRIX)
+  {
+    integral_image_XYZ_.setSecondOrderComputation (true);
+    integral_image_XYZ_.reserve (width, height);
+  }
+  else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT)
+  {
+    diff_x_.reserve (size << 2);
+    diff_y_.reserve (size << 2);
+    integral_image_DX_.reserve (width, height);
+    integral_image_DY_.reserve (width, height);
+  }
+  else if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE)
+    integral_image_depth_.reserve (width, height);
+  else if (normal_estimation_method_ == SIMPLE_3D_GRADIENT)
+    integral_image_XYZ_.reserve (width, height);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::setRectSize (const int width, const int height)
@@ -139,46 +164,58 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initCovarianceMatrixMet
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMethod ()
 {
-  delete[] diff_x_;
-  delete[] diff_y_;
-  std::size_t data_size = (input_->size () << 2);
-  diff_x_ = new float[data_size]{};
-  diff_y_ = new float[data_size]{};
+  std::size_t width = input_->width;
+  std::size_t height = input_->height;
+  // the buffers are kept across frames, resizing them within their capacity does not reallocate
+  diff_x_.resize (input_->size () << 2);
+  diff_y_.resize (input_->size () << 2);
 
   // x u x
   // l x r
   // x d x
-  const PointInT* point_up = &(input_->points [1]);
-  const PointInT* point_dn = point_up + (input_->width << 1);//&(input_->points [1 + (input_->width << 1)]);
-  const PointInT* point_lf = &(input_->points [input_->width]);
-  const PointInT* point_rg = point_lf + 2; //&(input_->points [input_->width + 2]);
-  float* diff_x_ptr = diff_x_ + ((input_->width + 1) << 2);
-  float* diff_y_ptr = diff_y_ + ((input_->width + 1) << 2);
-  unsigned diff_skip = 8; // skip last element in row and the first in the next row
-
-  for (std::size_t ri = 1; ri < input_->height - 1; ++ri
-                                             , point_up += input_->width
-                                             , point_dn += input_->width
-                                             , point_lf += input_->width
-                                             , point_rg += input_->width
-                                             , diff_x_ptr += diff_skip
-                                             , diff_y_ptr += diff_skip)
+  // The first and last row and column have no neighbors on both sides and are set to zero.
+  std::fill_n (diff_x_.begin (), width << 2, 0.0f);
+  std::fill_n (diff_y_.begin (), width << 2, 0.0f);
+  std::fill_n (diff_x_.end () - (width << 2), width << 2, 0.0f);
+  std::fill_n (diff_y_.end () - (width << 2), width << 2, 0.0f);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(height, width) \
+  num_threads(threads_)
+  for (std::ptrdiff_t ri = 1; ri < static_cast<std::ptrdiff_t> (height) - 1; ++ri)
   {
-    for (std::size_t ci = 0; ci < input_->width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
+    const PointInT* point_up = &(*input_)[(ri - 1) * width + 1];
+    const PointInT* point_dn = &(*input_)[(ri + 1) * width + 1];
+    const PointInT* point_lf = &(*input_)[ri * width];
+    const PointInT* point_rg = point_lf + 2;
+    float* diff_x_ptr = &diff_x_[(ri * width) << 2];
+    float* diff_y_ptr = &diff_y_[(ri * width) << 2];
+
+    std::fill_n (diff_x_ptr, 4, 0.0f);
+    std::fill_n (diff_y_ptr, 4, 0.0f);
+    std::fill_n (diff_x_ptr + ((width - 1) << 2), 4, 0.0f);
+    std::fill_n (diff_y_ptr + ((width - 1) << 2), 4, 0.0f);
+    diff_x_ptr += 4;
+    diff_y_ptr += 4;
+
+    for (std::size_t ci = 0; ci < width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
     {
       diff_x_ptr[0] = point_rg[ci].x - point_lf[ci].x;
       diff_x_ptr[1] = point_rg[ci].y - point_lf[ci].y;
       diff_x_ptr[2] = point_rg[ci].z - point_lf[ci].z;
+      diff_x_ptr[3] = 0.0f;
 
       diff_y_ptr[0] = point_dn[ci].x - point_up[ci].x;
       diff_y_ptr[1] = point_dn[ci].y - point_up[ci].y;
       diff_y_ptr[2] = point_dn[ci].z - point_up[ci].z;
+      diff_y_ptr[3] = 0.0f;
     }
   }
 
   // Compute integral images
-  integral_image_DX_.setInput (diff_x_, input_->width, input_->height, 4, input_->width << 2);
-  integral_image_DY_.setInput (diff_y_, input_->width, input_->height, 4, input_->width << 2);
+  integral_image_DX_.setInput (diff_x_.data (), input_->width, input_->height, 4, input_->width << 2);
+  integral_image_DY_.setInput (diff_y_.data (), input_->width, input_->height, 4, input_->width << 2);
   init_covariance_matrix_ = init_depth_change_ = init_simple_3d_gradient_ = false;
   init_average_3d_gradient_ = true;
 }
@@ -205,14 +242,28 @@ template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal)
 {
+  if (!isMethodInitialized ())
+    initData ();
+
+  computePointNormalInRect (pos_x, pos_y, point_index, rect_width_, rect_height_, normal);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalInRect (
+    const int pos_x, const int pos_y, const unsigned point_index,
+    const int rect_width, const int rect_height, PointOutT &normal) const
+{
+  const int rect_width_2 = rect_width / 2;
+  const int rect_width_4 = rect_width / 4;
+  const int rect_height_2 = rect_height / 2;
+  const int rect_height_4 = rect_height / 4;
+
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
   if (normal_estimation_method_ == COVARIANCE_MATRIX)
   {
-    if (!init_covariance_matrix_)
-      initCovarianceMatrixMethod ();
-
-    unsigned count = integral_image_XYZ_.getFiniteElementsCount (pos_x - (rect_width_2_), pos_y - (rect_height_2_), rect_width_, rect_height_);
+    unsigned count = integral_image_XYZ_.getFiniteElementsCount (pos_x - (rect_width_2), pos_y - (rect_height_2), rect_width, rect_height);
 
     // no valid points within the rectangular region?
     if (count == 0)
@@ -224,8 +275,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
     Eigen::Vector3f center;
     typename IntegralImage2D<float, 3>::SecondOrderType so_elements;
-    center = integral_image_XYZ_.getFirstOrderSum(pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_).template cast<float> ();
-    so_elements = integral_image_XYZ_.getSecondOrderSum(pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    center = integral_image_XYZ_.getFirstOrderSum(pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height).template cast<float> ();
+    so_elements = integral_image_XYZ_.getSecondOrderSum(pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
 
     covariance_matrix.coeffRef (0) = static_cast<float> (so_elements [0]);
     covariance_matrix.coeffRef (1) = covariance_matrix.coeffRef (3) = static_cast<float> (so_elements [1]);
@@ -250,18 +301,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
   }
   if (normal_estimation_method_ == AVERAGE_3D_GRADIENT)
   {
-    if (!init_average_3d_gradient_)
-      initAverage3DGradientMethod ();
-
-    unsigned count_x = integral_image_DX_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-    unsigned count_y = integral_image_DY_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    unsigned count_x = integral_image_DX_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    unsigned count_y = integral_image_DY_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
     if (count_x == 0 || count_y == 0)
     {
       normal.normal_x = normal.normal_y = normal.normal_z = normal.curvature = bad_point;
       return;
     }
-    Eigen::Vector3d gradient_x = integral_image_DX_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-    Eigen::Vector3d gradient_y = integral_image_DY_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    Eigen::Vector3d gradient_x = integral_image_DX_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    Eigen::Vector3d gradient_y = integral_image_DY_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
 
     Eigen::Vector3d normal_vector = gradient_y.cross (gradient_x);
     double normal_length = normal_vector.squaredNorm ();
@@ -288,14 +336,11 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
   }
   if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE)
   {
-    if (!init_depth_change_)
-      initAverageDepthChangeMethod ();
-
     // width and height are at least 3 x 3
-    unsigned count_L_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_4_, rect_width_2_, rect_height_2_);
-    unsigned count_R_z = integral_image_depth_.getFiniteElementsCount (pos_x + 1            , pos_y - rect_height_4_, rect_width_2_, rect_height_2_);
-    unsigned count_U_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4_, pos_y - rect_height_2_, rect_width_2_, rect_height_2_);
-    unsigned count_D_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4_, pos_y + 1             , rect_width_2_, rect_height_2_);
+    unsigned count_L_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_4, rect_width_2, rect_height_2);
+    unsigned count_R_z = integral_image_depth_.getFiniteElementsCount (pos_x + 1            , pos_y - rect_height_4, rect_width_2, rect_height_2);
+    unsigned count_U_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4, pos_y - rect_height_2, rect_width_2, rect_height_2);
+    unsigned count_D_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4, pos_y + 1             , rect_width_2, rect_height_2);
 
     if (count_L_z == 0 || count_R_z == 0 || count_U_z == 0 || count_D_z == 0)
     {
@@ -303,15 +348,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
       return;
     }
 
-    float mean_L_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_4_, rect_width_2_, rect_height_2_) / count_L_z);
-    float mean_R_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x + 1            , pos_y - rect_height_4_, rect_width_2_, rect_height_2_) / count_R_z);
-    float mean_U_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4_, pos_y - rect_height_2_, rect_width_2_, rect_height_2_) / count_U_z);
-    float mean_D_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4_, pos_y + 1             , rect_width_2_, rect_height_2_) / count_D_z);
+    float mean_L_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_4, rect_width_2, rect_height_2) / count_L_z);
+    float mean_R_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x + 1            , pos_y - rect_height_4, rect_width_2, rect_height_2) / count_R_z);
+    float mean_U_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4, pos_y - rect_height_2, rect_width_2, rect_height_2) / count_U_z);
+    float mean_D_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4, pos_y + 1             , rect_width_2, rect_height_2) / count_D_z);
 
-    PointInT pointL = (*input_)[point_index - rect_width_4_ - 1];
-    PointInT pointR = (*input_)[point_index + rect_width_4_ + 1];
-    PointInT pointU = (*input_)[point_index - rect_height_4_ * input_->width - 1];
-    PointInT pointD = (*input_)[point_index + rect_height_4_ * input_->width + 1];
+    PointInT pointL = (*input_)[point_index - rect_width_4 - 1];
+    PointInT pointR = (*input_)[point_index + rect_width_4 + 1];
+    PointInT pointU = (*input_)[point_index - rect_height_4 * input_->width - 1];
+    PointInT pointD = (*input_)[point_index + rect_height_4 * input_->width + 1];
 
     const float mean_x_z = mean_R_z - mean_L_z;
     const float mean_y_z = mean_D_z - mean_U_z;
@@ -347,15 +392,12 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
   }
   if (normal_estimation_method_ == SIMPLE_3D_GRADIENT)
   {
-    if (!init_simple_3d_gradient_)
-      initSimple3DGradientMethod ();
-
     // this method does not work if lots of NaNs are in the neighborhood of the point
-    Eigen::Vector3d gradient_x = integral_image_XYZ_.getFirstOrderSum (pos_x + rect_width_2_, pos_y - rect_height_2_, 1, rect_height_) -
-                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, 1, rect_height_);
+    Eigen::Vector3d gradient_x = integral_image_XYZ_.getFirstOrderSum (pos_x + rect_width_2, pos_y - rect_height_2, 1, rect_height) -
+                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, 1, rect_height);
 
-    Eigen::Vector3d gradient_y = integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y + rect_height_2_, rect_width_, 1) -
-                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, 1);
+    Eigen::Vector3d gradient_y = integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y + rect_height_2, rect_width, 1) -
+                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, 1);
     Eigen::Vector3d normal_vector = gradient_y.cross (gradient_x);
     double normal_length = normal_vector.squaredNorm ();
     if (normal_length == 0.0f)
@@ -460,6 +502,23 @@ template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirror (
     const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal)
 {
+  if (!isMethodInitialized ())
+    initData ();
+
+  computePointNormalMirrorInRect (pos_x, pos_y, point_index, rect_width_, rect_height_, normal);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirrorInRect (
+    const int pos_x, const int pos_y, const unsigned point_index,
+    const int rect_width, const int rect_height, PointOutT &normal) const
+{
+  const int rect_width_2 = rect_width / 2;
+  const int rect_width_4 = rect_width / 4;
+  const int rect_height_2 = rect_height / 2;
+  const int rect_height_4 = rect_height / 4;
+
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
   const int width = input_->width;
@@ -468,13 +527,10 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
   // ==============================================================
   if (normal_estimation_method_ == COVARIANCE_MATRIX) 
   {
-    if (!init_covariance_matrix_)
-      initCovarianceMatrixMethod ();
-
-    const int start_x = pos_x - rect_width_2_;
-    const int start_y = pos_y - rect_height_2_;
-    const int end_x = start_x + rect_width_;
-    const int end_y = start_y + rect_height_;
+    const int start_x = pos_x - rect_width_2;
+    const int start_y = pos_y - rect_height_2;
+    const int end_x = start_x + rect_width;
+    const int end_y = start_y + rect_height;
 
     unsigned count = 0;
     auto cb_xyz_fecse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) { return integral_image_XYZ_.getFiniteElementsCountSE (p1, p2, p3, p4); };
@@ -539,13 +595,10 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
   // =======================================================
   if (normal_estimation_method_ == AVERAGE_3D_GRADIENT) 
   {
-    if (!init_average_3d_gradient_)
-      initAverage3DGradientMethod ();
-
-    const int start_x = pos_x - rect_width_2_;
-    const int start_y = pos_y - rect_height_2_;
-    const int end_x = start_x + rect_width_;
-    const int end_y = start_y + rect_height_;
+    const int start_x = pos_x - rect_width_2;
+    const int start_y = pos_y - rect_height_2;
+    const int end_x = start_x + rect_width;
+    const int end_y = start_y + rect_height;
 
     unsigned count_x = 0;
     unsigned count_y = 0;
@@ -596,17 +649,14 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
   // ======================================================
   if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE) 
   {
-    if (!init_depth_change_)
-      initAverageDepthChangeMethod ();
-
-    int point_index_L_x = pos_x - rect_width_4_ - 1;
+    int point_index_L_x = pos_x - rect_width_4 - 1;
     int point_index_L_y = pos_y;
-    int point_index_R_x = pos_x + rect_width_4_ + 1;
+    int point_index_R_x = pos_x + rect_width_4 + 1;
     int point_index_R_y = pos_y;
     int point_index_U_x = pos_x - 1;
-    int point_index_U_y = pos_y - rect_height_4_;
+    int point_index_U_y = pos_y - rect_height_4;
     int point_index_D_x = pos_x + 1;
-    int point_index_D_y = pos_y + rect_height_4_;
+    int point_index_D_y = pos_y + rect_height_4;
 
     if (point_index_L_x < 0)
       point_index_L_x = -point_index_L_x;
@@ -622,25 +672,25 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     if (point_index_D_y >= height)
       point_index_D_y = height-(point_index_D_y-(height-1));
 
-    const int start_x_L = pos_x - rect_width_2_;
-    const int start_y_L = pos_y - rect_height_4_;
-    const int end_x_L = start_x_L + rect_width_2_;
-    const int end_y_L = start_y_L + rect_height_2_;
+    const int start_x_L = pos_x - rect_width_2;
+    const int start_y_L = pos_y - rect_height_4;
+    const int end_x_L = start_x_L + rect_width_2;
+    const int end_y_L = start_y_L + rect_height_2;
 
     const int start_x_R = pos_x + 1;
-    const int start_y_R = pos_y - rect_height_4_;
-    const int end_x_R = start_x_R + rect_width_2_;
-    const int end_y_R = start_y_R + rect_height_2_;
+    const int start_y_R = pos_y - rect_height_4;
+    const int end_x_R = start_x_R + rect_width_2;
+    const int end_y_R = start_y_R + rect_height_2;
 
-    const int start_x_U = pos_x - rect_width_4_;
-    const int start_y_U = pos_y - rect_height_2_;
-    const int end_x_U = start_x_U + rect_width_2_;
-    const int end_y_U = start_y_U + rect_height_2_;
+    const int start_x_U = pos_x - rect_width_4;
+    const int start_y_U = pos_y - rect_height_2;
+    const int end_x_U = start_x_U + rect_width_2;
+    const int end_y_U = start_y_U + rect_height_2;
 
-    const int start_x_D = pos_x - rect_width_4_;
+    const int start_x_D = pos_x - rect_width_4;
     const int start_y_D = pos_y + 1;
-    const int end_x_D = start_x_D + rect_width_2_;
-    const int end_y_D = start_y_D + rect_height_2_;
+    const int end_x_D = start_x_D + rect_width_2;
+    const int end_y_D = start_y_D + rect_height_2;
 
     unsigned count_L_z = 0;
     unsigned count_R_z = 0;
@@ -724,6 +774,24 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
   return;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::isMethodInitialized () const
+{
+  switch (normal_estimation_method_)
+  {
+    case COVARIANCE_MATRIX:
+      return (init_covariance_matrix_);
+    case AVERAGE_3D_GRADIENT:
+      return (init_average_3d_gradient_);
+    case AVERAGE_DEPTH_CHANGE:
+      return (init_depth_change_);
+    case SIMPLE_3D_GRADIENT:
+      return (init_simple_3d_gradient_);
+  }
+  return (false);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -733,50 +801,66 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
   
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
-  // compute depth-change map
-  auto depthChangeMap = new unsigned char[input_->size ()];
-  std::fill_n(depthChangeMap, input_->size(), 255);
-
-  unsigned index = 0;
-  for (unsigned int ri = 0; ri < input_->height-1; ++ri)
-  {
-    for (unsigned int ci = 0; ci < input_->width-1; ++ci, ++index)
-    {
-      index = ri * input_->width + ci;
+  if (border_policy_ == BORDER_POLICY_MIRROR && normal_estimation_method_ == SIMPLE_3D_GRADIENT)
+    PCL_THROW_EXCEPTION (PCLException, "BORDER_POLICY_MIRROR not supported for normal estimation method SIMPLE_3D_GRADIENT");
 
-      const float depth  = input_->points [index].z;
-      const float depthR = input_->points [index + 1].z;
-      const float depthD = input_->points [index + input_->width].z;
+  // the per point computations below run concurrently, so the integral images have to be ready beforehand
+  if (!isMethodInitialized ())
+    initData ();
 
-      //const float depthDependendDepthChange = (max_depth_change_factor_ * (std::abs(depth)+1.0f))/(500.0f*0.001f);
-      const float depthDependendDepthChange = (max_depth_change_factor_ * (std::abs (depth) + 1.0f) * 2.0f);
+  std::ptrdiff_t width = input_->width;
+  std::ptrdiff_t height = input_->height;
 
-      if (std::fabs (depth - depthR) > depthDependendDepthChange
-        || !std::isfinite (depth) || !std::isfinite (depthR))
-      {
-        depthChangeMap[index] = 0;
-        depthChangeMap[index+1] = 0;
-      }
-      if (std::fabs (depth - depthD) > depthDependendDepthChange
-        || !std::isfinite (depth) || !std::isfinite (depthD))
-      {
-        depthChangeMap[index] = 0;
-        depthChangeMap[index + input_->width] = 0;
-      }
+  // compute depth-change map; every pixel only looks at its own neighbors, so the rows are independent
+  depth_change_map_.resize (input_->size ());
+  unsigned char *depthChangeMap = depth_change_map_.data ();
+  auto isDepthChange = [this] (const float depth, const float other_depth)
+  {
+    const float depthDependendDepthChange = (max_depth_change_factor_ * (std::abs (depth) + 1.0f) * 2.0f);
+    return (std::fabs (depth - other_depth) > depthDependendDepthChange
+            || !std::isfinite (depth) || !std::isfinite (other_depth));
+  };
+
+#pragma omp parallel for \
+  default(none) \
+  shared(depthChangeMap, height, isDepthChange, width) \
+  num_threads(threads_)
+  for (std::ptrdiff_t ri = 0; ri < height; ++ri)
+  {
+    for (std::ptrdiff_t ci = 0; ci < width; ++ci)
+    {
+      const std::ptrdiff_t index = ri * width + ci;
+      const float depth = (*input_)[index].z;
+      bool change = false;
+
+      // comparisons with the right and the lower neighbor (only done for pixels which have both)
+      if (ri < height - 1 && ci < width - 1)
+        change = isDepthChange (depth, (*input_)[index + 1].z) || isDepthChange (depth, (*input_)[index + width].z);
+      // comparison done by the left neighbor
+      if (!change && ci > 0 && ri < height - 1)
+        change = isDepthChange ((*input_)[index - 1].z, depth);
+      // comparison done by the upper neighbor
+      if (!change && ri > 0 && ci < width - 1)
+        change = isDepthChange ((*input_)[index - width].z, depth);
+
+      depthChangeMap[index] = change ? 0 : 255;
     }
   }
 
   // compute distance map
-  //float *distanceMap = new float[input_->size ()];
-  delete[] distance_map_;
-  distance_map_ = new float[input_->size ()];
-  float *distanceMap = distance_map_;
-  for (std::size_t index = 0; index < input_->size (); ++index)
+  distance_map_.resize (input_->size ());
+  float *distanceMap = distance_map_.data ();
+  float max_distance = static_cast<float> (input_->width + input_->height);
+#pragma omp parallel for \
+  default(none) \
+  shared(depthChangeMap, distanceMap, max_distance) \
+  num_threads(threads_)
+  for (std::ptrdiff_t index = 0; index < static_cast<std::ptrdiff_t> (input_->size ()); ++index)
   {
     if (depthChangeMap[index] == 0)
       distanceMap[index] = 0.0f;
     else
-      distanceMap[index] = static_cast<float> (input_->width + input_->height);
+      distanceMap[index] = max_distance;
   }
 
   // first pass
@@ -827,8 +911,40 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
     computeFeaturePart (distanceMap, bad_point, output);
   else
     computeFeatureFull (distanceMap, bad_point, output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeNormalFromDistanceMap (
+    const float *distance_map, const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal) const
+{
+  const float depth = (*input_)[point_index].z;
+  if (!std::isfinite (depth))
+  {
+    normal.getNormalVector3fMap ().setConstant (std::numeric_limits<float>::quiet_NaN ());
+    normal.curvature = std::numeric_limits<float>::quiet_NaN ();
+    return;
+  }
 
-  delete[] depthChangeMap;
+  float smoothing;
+  if (use_depth_dependent_smoothing_)
+    smoothing = (std::min)(distance_map[point_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+  else
+    smoothing = (std::min)(distance_map[point_index], normal_smoothing_size_);
+
+  if (smoothing > 2.0f)
+  {
+    const int rect_size = static_cast<int> (smoothing);
+    if (border_policy_ == BORDER_POLICY_MIRROR)
+      computePointNormalMirrorInRect (pos_x, pos_y, point_index, rect_size, rect_size, normal);
+    else
+      computePointNormalInRect (pos_x, pos_y, point_index, rect_size, rect_size, normal);
+  }
+  else
+  {
+    normal.getNormalVector3fMap ().setConstant (std::numeric_limits<float>::quiet_NaN ());
+    normal.curvature = std::numeric_limits<float>::quiet_NaN ();
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -837,15 +953,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
                                                                              const float &bad_point,
                                                                              PointCloudOut &output)
 {
-  unsigned index = 0;
+  output.is_dense = false;
 
+  // With BORDER_POLICY_IGNORE all normals that we do not touch are set to NaN, with
+  // BORDER_POLICY_MIRROR every pixel of the image is processed.
+  unsigned border = 0;
   if (border_policy_ == BORDER_POLICY_IGNORE)
   {
-    // Set all normals that we do not touch to NaN
+    border = static_cast<unsigned>(normal_smoothing_size_);
     // top and bottom borders
-    // That sets the output density to false!
-    output.is_dense = false;
-    auto border = static_cast<unsigned>(normal_smoothing_size_);
     PointOutT* vec1 = &output [0];
     PointOutT* vec2 = vec1 + input_->width * (input_->height - border);
 
@@ -871,149 +987,24 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
         vec2 [ci].curvature = bad_point;
       }
     }
-
-    if (use_depth_dependent_smoothing_)
-    {
-      index = border + input_->width * border;
-      unsigned skip = (border << 1);
-      for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
-      {
-        for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
-        {
-          index = ri * input_->width + ci;
-
-          const float depth = (*input_)[index].z;
-          if (!std::isfinite (depth))
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormal (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-          }
-        }
-      }
-    }
-    else
-    {
-      float smoothing_constant = normal_smoothing_size_;
-
-      index = border + input_->width * border;
-      unsigned skip = (border << 1);
-      for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
-      {
-        for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
-        {
-          index = ri * input_->width + ci;
-
-          if (!std::isfinite ((*input_)[index].z))
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], smoothing_constant);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormal (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-          }
-        }
-      }
-    }
   }
-  else if (border_policy_ == BORDER_POLICY_MIRROR)
-  {
-    output.is_dense = false;
 
-    if (use_depth_dependent_smoothing_)
+  // the rows are processed in bands by the available threads
+  std::ptrdiff_t row_begin = border;
+  std::ptrdiff_t row_end = static_cast<std::ptrdiff_t> (input_->height) - border;
+  int col_begin = border;
+  int col_end = static_cast<int> (input_->width) - border;
+#pragma omp parallel for \
+  default(none) \
+  shared(col_begin, col_end, distanceMap, output, row_begin, row_end) \
+  schedule(static) \
+  num_threads(threads_)
+  for (std::ptrdiff_t ri = row_begin; ri < row_end; ++ri)
+  {
+    for (int ci = col_begin; ci < col_end; ++ci)
     {
-      //index = 0;
-      //unsigned skip = 0;
-      //for (unsigned ri = 0; ri < input_->height; ++ri, index += skip)
-      for (unsigned ri = 0; ri < input_->height; ++ri)
-      {
-        //for (unsigned ci = 0; ci < input_->width; ++ci, ++index)
-        for (unsigned ci = 0; ci < input_->width; ++ci)
-        {
-          index = ri * input_->width + ci;
-
-          const float depth = (*input_)[index].z;
-          if (!std::isfinite (depth))
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormalMirror (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-          }
-        }
-      }
-    }
-    else
-    {
-      float smoothing_constant = normal_smoothing_size_;
-
-      //index = border + input_->width * border;
-      //unsigned skip = (border << 1);
-      //for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
-      for (unsigned ri = 0; ri < input_->height; ++ri)
-      {
-        //for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
-        for (unsigned ci = 0; ci < input_->width; ++ci)
-        {
-          index = ri * input_->width + ci;
-
-          if (!std::isfinite ((*input_)[index].z))
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], smoothing_constant);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormalMirror (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-          }
-        }
-      }
+      const unsigned index = static_cast<unsigned> (ri * input_->width + ci);
+      computeNormalFromDistanceMap (distanceMap, ci, static_cast<int> (ri), index, output [index]);
     }
   }
 }
@@ -1021,168 +1012,34 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeaturePart (const float *distanceMap,
-                                                                             const float &bad_point,
+                                                                             const float &,
                                                                              PointCloudOut &output)
 {
-  if (border_policy_ == BORDER_POLICY_IGNORE)
+  output.is_dense = false;
+  auto border = static_cast<unsigned>(normal_smoothing_size_);
+  unsigned bottom = input_->height > border ? input_->height - border : 0;
+  unsigned right = input_->width > border ? input_->width - border : 0;
+
+  // Iterating over the entire index vector
+#pragma omp parallel for \
+  default(none) \
+  shared(border, bottom, distanceMap, output, right) \
+  num_threads(threads_)
+  for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
-    output.is_dense = false;
-    auto border = static_cast<unsigned>(normal_smoothing_size_);
-    unsigned bottom = input_->height > border ? input_->height - border : 0;
-    unsigned right = input_->width > border ? input_->width - border : 0;
-    if (use_depth_dependent_smoothing_)
-    {
-      // Iterating over the entire index vector
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-      {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-        if (v < border || v > bottom)
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
-
-        if (u < border || u > right)
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
-
-        const float depth = (*input_)[pt_index].z;
-        if (!std::isfinite (depth))
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
-
-        float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormal (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-        }
-      }
-    }
-    else
+    unsigned pt_index = (*indices_)[idx];
+    unsigned u = pt_index % input_->width;
+    unsigned v = pt_index / input_->width;
+    if (border_policy_ == BORDER_POLICY_IGNORE &&
+        (v < border || v > bottom || u < border || u > right))
     {
-      float smoothing_constant = normal_smoothing_size_;
-      // Iterating over the entire index vector
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-      {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-        if (v < border || v > bottom)
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
-
-        if (u < border || u > right)
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
-
-        if (!std::isfinite ((*input_)[pt_index].z))
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-          continue;
-        }
-
-        float smoothing = (std::min)(distanceMap[pt_index], smoothing_constant);
-
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormal (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-        }
-      }
+      output[idx].getNormalVector3fMap ().setConstant (std::numeric_limits<float>::quiet_NaN ());
+      output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+      continue;
     }
-  }// border_policy_ == BORDER_POLICY_IGNORE
-  else if (border_policy_ == BORDER_POLICY_MIRROR)
-  {
-    output.is_dense = false;
 
-    if (use_depth_dependent_smoothing_)
-    {
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-      {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-
-        const float depth = (*input_)[pt_index].z;
-        if (!std::isfinite (depth))
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
-
-        float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormalMirror (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-        }
-      }
-    }
-    else
-    {
-      float smoothing_constant = normal_smoothing_size_;
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-      {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-
-        if (!std::isfinite ((*input_)[pt_index].z))
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-          continue;
-        }
-
-        float smoothing = (std::min)(distanceMap[pt_index], smoothing_constant);
-
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormalMirror (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-        }
-      }
-    }
-  } // border_policy_ == BORDER_POLICY_MIRROR
+    computeNormalFromDistanceMap (distanceMap, u, v, pt_index, output [idx]);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
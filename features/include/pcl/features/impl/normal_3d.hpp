@@ -42,6 +42,9 @@
 #define PCL_FEATURES_IMPL_NORMAL_3D_H_
 
 #include <pcl/features/normal_3d.h>
+#include <pcl/common/eigen.h>
+
+#include <algorithm>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
@@ -53,6 +56,17 @@ pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &outpu
   std::vector<float> nn_dists (k_);
 
   output.is_dense = true;
+  if (batch_size_ > 0)
+  {
+    BatchBuffers buffers;
+    for (std::size_t begin = 0; begin < indices_->size (); begin += batch_size_)
+    {
+      if (!computeFeatureBatch (begin, std::min (begin + batch_size_, indices_->size ()), buffers, output))
+        output.is_dense = false;
+    }
+    return;
+  }
+
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
   if (input_->is_dense)
   {
@@ -95,6 +109,94 @@ pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &outpu
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::NormalEstimation<PointInT, PointOutT>::computeFeatureBatch (std::size_t begin, std::size_t end,
+                                                                 BatchBuffers &buffers, PointCloudOut &output) const
+{
+  const Eigen::Index batch_size = static_cast<Eigen::Index> (end - begin);
+  buffers.covariances.resize (batch_size, 6);
+  buffers.valid.resize (batch_size);
+
+  // Gather the neighborhood of every point of the block and accumulate its covariance matrix
+  for (Eigen::Index i = 0; i < batch_size; ++i)
+  {
+    const auto index = (*indices_)[begin + i];
+    buffers.covariances.row (i).setZero ();
+    buffers.valid (i) = false;
+    if ((!input_->is_dense && !isFinite ((*input_)[index])) ||
+        this->searchForNeighbors (index, search_parameter_, buffers.nn_indices, buffers.nn_dists) == 0 ||
+        buffers.nn_indices.size () < 3)
+      continue;
+
+    if (buffers.x.size () < static_cast<Eigen::Index> (buffers.nn_indices.size ()))
+    {
+      buffers.x.resize (buffers.nn_indices.size ());
+      buffers.y.resize (buffers.nn_indices.size ());
+      buffers.z.resize (buffers.nn_indices.size ());
+    }
+    Eigen::Index count = 0;
+    for (const auto &nn_index : buffers.nn_indices)
+    {
+      const PointInT &point = (*surface_)[nn_index];
+      if (!surface_->is_dense && !isFinite (point))
+        continue;
+      buffers.x (count) = point.x;
+      buffers.y (count) = point.y;
+      buffers.z (count) = point.z;
+      ++count;
+    }
+    if (count == 0)
+      continue;
+
+    // Shift by the first point for accuracy, as computeMeanAndCovarianceMatrix does
+    auto x = buffers.x.head (count);
+    auto y = buffers.y.head (count);
+    auto z = buffers.z.head (count);
+    const float shift_x = x (0), shift_y = y (0), shift_z = z (0);
+    x -= shift_x;
+    y -= shift_y;
+    z -= shift_z;
+    const float mean_x = x.sum () / static_cast<float> (count);
+    const float mean_y = y.sum () / static_cast<float> (count);
+    const float mean_z = z.sum () / static_cast<float> (count);
+    buffers.covariances.row (i) << (x * x).sum () / static_cast<float> (count) - mean_x * mean_x,
+                                   (x * y).sum () / static_cast<float> (count) - mean_x * mean_y,
+                                   (x * z).sum () / static_cast<float> (count) - mean_x * mean_z,
+                                   (y * y).sum () / static_cast<float> (count) - mean_y * mean_y,
+                                   (y * z).sum () / static_cast<float> (count) - mean_y * mean_z,
+                                   (z * z).sum () / static_cast<float> (count) - mean_z * mean_z;
+    buffers.valid (i) = true;
+  }
+
+  // Solve all eigenproblems of the block at once
+  pcl::eigen33Batch (buffers.covariances, buffers.eigenvalues, buffers.eigenvectors);
+
+  // Compute the curvature as in solvePlaneParameters
+  const Eigen::ArrayXf eig_sum = buffers.covariances.col (0) + buffers.covariances.col (3) + buffers.covariances.col (5);
+  buffers.eigenvalues = (eig_sum != 0.0f).select ((buffers.eigenvalues / eig_sum).abs (), 0.0f);
+
+  bool dense = true;
+  for (Eigen::Index i = 0; i < batch_size; ++i)
+  {
+    PointOutT &normal = output[begin + i];
+    if (!buffers.valid (i))
+    {
+      normal.normal[0] = normal.normal[1] = normal.normal[2] = normal.curvature = std::numeric_limits<float>::quiet_NaN ();
+      dense = false;
+      continue;
+    }
+
+    normal.normal[0] = buffers.eigenvectors (i, 0);
+    normal.normal[1] = buffers.eigenvectors (i, 1);
+    normal.normal[2] = buffers.eigenvectors (i, 2);
+    normal.curvature = buffers.eigenvalues (i);
+    flipNormalTowardsViewpoint ((*input_)[(*indices_)[begin + i]], vpx_, vpy_, vpz_,
+                                normal.normal[0], normal.normal[1], normal.normal[2]);
+  }
+  return (dense);
+}
+
 #define PCL_INSTANTIATE_NormalEstimation(T,NT) template class PCL_EXPORTS pcl::NormalEstimation<T,NT>;
 
 #endif    // PCL_FEATURES_IMPL_NORMAL_3D_H_ 
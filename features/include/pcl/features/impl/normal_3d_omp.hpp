@@ -43,6 +43,8 @@
 
 #include <pcl/features/normal_3d_omp.h>
 
+#include <algorithm>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimationOMP<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
@@ -67,6 +69,24 @@ pcl::NormalEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &ou
   std::vector<float> nn_dists (k_);
 
   output.is_dense = true;
+  if (batch_size_ > 0)
+  {
+    // Every thread works on whole blocks, with its own scratch space
+    typename NormalEstimation<PointInT, PointOutT>::BatchBuffers buffers;
+#pragma omp parallel for \
+  default(none) \
+  shared(output) \
+  firstprivate(buffers) \
+  num_threads(threads_)
+    for (std::ptrdiff_t block = 0; block < static_cast<std::ptrdiff_t> ((indices_->size () + batch_size_ - 1) / batch_size_); ++block)
+    {
+      const std::size_t begin = static_cast<std::size_t> (block) * batch_size_;
+      if (!this->computeFeatureBatch (begin, std::min (begin + batch_size_, indices_->size ()), buffers, output))
+        output.is_dense = false;
+    }
+    return;
+  }
+
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
   if (input_->is_dense)
   {
@@ -48,6 +48,20 @@
 #include <pcl/common/common.h> // for getMaxDistance
 #include <pcl/common/transforms.h>
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT> void
+pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointNT, typename PointOutT> void
 pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::compute (PointCloudOut &output)
@@ -386,10 +400,18 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeRFAndShapeDistribut
   cluster_axes_.clear ();
   cluster_axes_.resize (centroids_dominant_orientations_.size ());
 
-  for (std::size_t i = 0; i < centroids_dominant_orientations_.size (); i++)
+  // The SGURFs and signatures of every cluster are gathered separately and concatenated in cluster order
+  std::vector<std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > > cluster_transforms (centroids_dominant_orientations_.size ());
+  std::vector<PointCloudOut> cluster_signatures (centroids_dominant_orientations_.size ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cluster_indices, cluster_signatures, cluster_transforms, output, processed) \
+  num_threads(threads_)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (centroids_dominant_orientations_.size ()); i++)
   {
 
-    std::vector < Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > transformations;
+    auto &transformations = cluster_transforms[i];
     PointInTPtr grid (new pcl::PointCloud<PointInT>);
     sgurf (centroids_dominant_orientations_[i], dominant_normals_[i], processed, transformations, grid, cluster_indices[i]);
 
@@ -400,8 +422,6 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeRFAndShapeDistribut
     {
 
       pcl::transformPointCloud (*processed, *grid, transformation);
-      transforms_.push_back (transformation);
-      valid_transforms_.push_back (true);
 
       std::vector < Eigen::VectorXf > quadrants (8);
       int size_hists = 13;
@@ -531,12 +551,19 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeRFAndShapeDistribut
         }
       }
 
-      ourcvfh_output.push_back (vfh_signature[0]);
-      ourcvfh_output.width = ourcvfh_output.size ();
+      cluster_signatures[i].push_back (vfh_signature[0]);
       delete[] weights;
     }
   }
 
+  for (std::size_t i = 0; i < cluster_signatures.size (); i++)
+  {
+    transforms_.insert (transforms_.end (), cluster_transforms[i].begin (), cluster_transforms[i].end ());
+    valid_transforms_.insert (valid_transforms_.end (), cluster_transforms[i].size (), true);
+    ourcvfh_output.points.insert (ourcvfh_output.end (), cluster_signatures[i].begin (), cluster_signatures[i].end ());
+  }
+  ourcvfh_output.width = ourcvfh_output.size ();
+
   if (!ourcvfh_output.empty ())
   {
     ourcvfh_output.height = 1;
@@ -570,6 +597,7 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
   centroids_dominant_orientations_.clear ();
   clusters_.clear ();
   transforms_.clear ();
+  valid_transforms_.clear ();
   dominant_normals_.clear ();
 
   // ---[ Step 0: remove normals with high curvature
@@ -705,7 +733,13 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
     output.resize (dominant_normals_.size ());
     output.width = dominant_normals_.size ();
 
-    for (std::size_t i = 0; i < dominant_normals_.size (); ++i)
+    // The search method is already bound to surface_, each thread works on its own copy of the estimator
+#pragma omp parallel for \
+  default(none) \
+  shared(output) \
+  firstprivate(vfh) \
+  num_threads(threads_)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (dominant_normals_.size ()); ++i)
     {
       //configure VFH computation for CVFH
       vfh.setNormalToUse (dominant_normals_[i]);
@@ -725,7 +759,7 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
 
     PCL_WARN("No clusters were found in the surface... using VFH...\n");
     Eigen::Vector4f avg_centroid;
-    pcl::compute3DCentroid (*surface_, avg_centroid);
+    pcl::compute3DCentroid (*surface_, *indices_, avg_centroid);
     Eigen::Vector3f cloud_centroid (avg_centroid[0], avg_centroid[1], avg_centroid[2]);
     centroids_dominant_orientations_.push_back (cloud_centroid);
 
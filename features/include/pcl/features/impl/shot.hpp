@@ -154,6 +154,10 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
     return (false);
   }
 
+  // Reuse the frames estimated by the previous call, if they were kept and are still valid
+  if (canReuseReferenceFrames ())
+    return (true);
+
   // Default LRF estimation alg: SHOTLocalReferenceFrameEstimation
   typename SHOTLocalReferenceFrameEstimation<PointInT, PointRFT>::Ptr lrf_estimator(new SHOTLocalReferenceFrameEstimation<PointInT, PointRFT>());
   lrf_estimator->setRadiusSearch ((lrf_radius_ > 0 ? lrf_radius_ : search_radius_));
@@ -167,10 +171,95 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
     PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
     return (false);
   }
+  keepReferenceFrames ();
 
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
+pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::canReuseReferenceFrames () const
+{
+  // Frames given by the user are handled by initLocalReferenceFrames
+  if (!keep_frames_ || !frames_never_defined_ || !frames_)
+    return (false);
+
+  return (frames_input_ == input_ && frames_indices_ == indices_ && frames_surface_ == surface_ &&
+          frames_radius_ == (lrf_radius_ > 0 ? lrf_radius_ : search_radius_) &&
+          frames_->size () == indices_->size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::keepReferenceFrames ()
+{
+  if (keep_frames_ && frames_never_defined_)
+  {
+    frames_input_ = input_;
+    frames_indices_ = indices_;
+    frames_surface_ = surface_;
+    frames_radius_ = (lrf_radius_ > 0 ? lrf_radius_ : search_radius_);
+  }
+  else
+  {
+    frames_input_.reset ();
+    frames_indices_.reset ();
+    frames_surface_.reset ();
+    frames_radius_ = 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::computeLocalCoordinates (
+    const pcl::Indices &indices,
+    const std::vector<float> &sqr_dists,
+    const int index,
+    LocalCoordinates &coords) const
+{
+  const auto nr_neighbors = static_cast<Eigen::Index> (indices.size ());
+  const Eigen::Vector3f central_point = (*input_)[(*indices_)[index]].getVector3fMap ();
+  const PointRFT& current_frame = (*frames_)[index];
+
+  Eigen::Matrix3f rotation;
+  rotation.row (0) = Eigen::Map<const Eigen::RowVector3f> (current_frame.x_axis);
+  rotation.row (1) = Eigen::Map<const Eigen::RowVector3f> (current_frame.y_axis);
+  rotation.row (2) = Eigen::Map<const Eigen::RowVector3f> (current_frame.z_axis);
+
+  if (coords.x.size () < nr_neighbors)
+  {
+    coords.delta.resize (3, nr_neighbors);
+    coords.x.resize (nr_neighbors);
+    coords.y.resize (nr_neighbors);
+    coords.z.resize (nr_neighbors);
+    coords.distance.resize (nr_neighbors);
+    coords.inclination.resize (nr_neighbors);
+    coords.azimuth.resize (nr_neighbors);
+  }
+
+  // Gather the neighbors relative to the feature point, then rotate all of them at once
+  auto delta = coords.delta.leftCols (nr_neighbors);
+  for (Eigen::Index i_idx = 0; i_idx < nr_neighbors; ++i_idx)
+    delta.col (i_idx) = (*surface_)[indices[i_idx]].getVector3fMap () - central_point;
+
+  // To avoid numerical problems afterwards
+  const auto zero_small = [] (double v) { return (std::abs (v) < 1E-30 ? 0.0 : v); };
+  auto x = coords.x.head (nr_neighbors);
+  auto y = coords.y.head (nr_neighbors);
+  auto z = coords.z.head (nr_neighbors);
+  x = rotation.row (0).lazyProduct (delta).transpose ().template cast<double> ().array ().unaryExpr (zero_small);
+  y = rotation.row (1).lazyProduct (delta).transpose ().template cast<double> ().array ().unaryExpr (zero_small);
+  z = rotation.row (2).lazyProduct (delta).transpose ().template cast<double> ().array ().unaryExpr (zero_small);
+
+  // Compute the Euclidean norm
+  auto distance = coords.distance.head (nr_neighbors);
+  distance = Eigen::Map<const Eigen::ArrayXf> (sqr_dists.data (), nr_neighbors).template cast<double> ().sqrt ();
+
+  // The inclination of coincident neighbors is undefined, they are skipped by the interpolation
+  coords.inclination.head (nr_neighbors) = (z / distance).max (-1.0).min (1.0).acos ();
+  coords.azimuth.head (nr_neighbors) = y.binaryExpr (x, [] (double y_v, double x_v) { return (std::atan2 (y_v, x_v)); });
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::createBinDistanceShape (
@@ -240,41 +329,24 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     const int index,
     std::vector<double> &binDistance,
     const int nr_bins,
-    Eigen::VectorXf &shot)
+    Eigen::VectorXf &shot,
+    LocalCoordinates &coords)
 {
-  const Eigen::Vector4f& central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
-  const PointRFT& current_frame = (*frames_)[index];
-
-  Eigen::Vector4f current_frame_x (current_frame.x_axis[0], current_frame.x_axis[1], current_frame.x_axis[2], 0);
-  Eigen::Vector4f current_frame_y (current_frame.y_axis[0], current_frame.y_axis[1], current_frame.y_axis[2], 0);
-  Eigen::Vector4f current_frame_z (current_frame.z_axis[0], current_frame.z_axis[1], current_frame.z_axis[2], 0);
+  computeLocalCoordinates (indices, sqr_dists, index, coords);
 
   for (std::size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
     if (!std::isfinite(binDistance[i_idx]))
       continue;
 
-    Eigen::Vector4f delta = (*surface_)[indices[i_idx]].getVector4fMap () - central_point;
-    delta[3] = 0;
-
-    // Compute the Euclidean norm
-   double distance = sqrt (sqr_dists[i_idx]);
+    const double distance = coords.distance[i_idx];
 
     if (areEquals (distance, 0.0))
       continue;
 
-    double xInFeatRef = delta.dot (current_frame_x);
-    double yInFeatRef = delta.dot (current_frame_y);
-    double zInFeatRef = delta.dot (current_frame_z);
-
-    // To avoid numerical problems afterwards
-    if (std::abs (yInFeatRef) < 1E-30)
-      yInFeatRef  = 0;
-    if (std::abs (xInFeatRef) < 1E-30)
-      xInFeatRef  = 0;
-    if (std::abs (zInFeatRef) < 1E-30)
-      zInFeatRef  = 0;
-
+    const double xInFeatRef = coords.x[i_idx];
+    const double yInFeatRef = coords.y[i_idx];
+    const double zInFeatRef = coords.z[i_idx];
 
     unsigned char bit4 = ((yInFeatRef > 0) || ((yInFeatRef == 0.0) && (xInFeatRef < 0))) ? 1 : 0;
     auto bit3 = static_cast<unsigned char> (((xInFeatRef > 0) || ((xInFeatRef == 0.0) && (yInFeatRef > 0))) ? !bit4 : bit4);
@@ -335,13 +407,7 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     }
 
     //Interpolation on the inclination (adjacent vertical volumes)
-    double inclinationCos = zInFeatRef / distance;
-    if (inclinationCos < - 1.0)
-      inclinationCos = - 1.0;
-    if (inclinationCos > 1.0)
-      inclinationCos = 1.0;
-
-    double inclination = std::acos (inclinationCos);
+    const double inclination = coords.inclination[i_idx];
 
     assert (inclination >= 0.0 && inclination <= PST_RAD_180);
 
@@ -373,7 +439,7 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     if (yInFeatRef != 0.0 || xInFeatRef != 0.0)
     {
       //Interpolation on the azimuth (adjacent horizontal volumes)
-      double azimuth = std::atan2 (yInFeatRef, xInFeatRef);
+      const double azimuth = coords.azimuth[i_idx];
 
       int sel = desc_index >> 2;
       double angularSectorSpan = PST_RAD_45;
@@ -417,42 +483,26 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::interpolateDou
   std::vector<double> &binDistanceColor,
   const int nr_bins_shape,
   const int nr_bins_color,
-  Eigen::VectorXf &shot)
+  Eigen::VectorXf &shot,
+  LocalCoordinates &coords)
 {
-  const Eigen::Vector4f &central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
-  const PointRFT& current_frame = (*frames_)[index];
-
   int shapeToColorStride = nr_grid_sector_*(nr_bins_shape+1);
 
-  Eigen::Vector4f current_frame_x (current_frame.x_axis[0], current_frame.x_axis[1], current_frame.x_axis[2], 0);
-  Eigen::Vector4f current_frame_y (current_frame.y_axis[0], current_frame.y_axis[1], current_frame.y_axis[2], 0);
-  Eigen::Vector4f current_frame_z (current_frame.z_axis[0], current_frame.z_axis[1], current_frame.z_axis[2], 0);
+  this->computeLocalCoordinates (indices, sqr_dists, index, coords);
 
   for (std::size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
     if (!std::isfinite(binDistanceShape[i_idx]))
       continue;
 
-    Eigen::Vector4f delta = (*surface_)[indices[i_idx]].getVector4fMap () - central_point;
-    delta[3] = 0;
-
-    // Compute the Euclidean norm
-    double distance = sqrt (sqr_dists[i_idx]);
+    const double distance = coords.distance[i_idx];
 
     if (areEquals (distance, 0.0))
       continue;
 
-    double xInFeatRef = delta.dot (current_frame_x);
-    double yInFeatRef = delta.dot (current_frame_y);
-    double zInFeatRef = delta.dot (current_frame_z);
-
-    // To avoid numerical problems afterwards
-    if (std::abs (yInFeatRef) < 1E-30)
-      yInFeatRef  = 0;
-    if (std::abs (xInFeatRef) < 1E-30)
-      xInFeatRef  = 0;
-    if (std::abs (zInFeatRef) < 1E-30)
-      zInFeatRef  = 0;
+    const double xInFeatRef = coords.x[i_idx];
+    const double yInFeatRef = coords.y[i_idx];
+    const double zInFeatRef = coords.z[i_idx];
 
     unsigned char bit4 = ((yInFeatRef > 0) || ((yInFeatRef == 0.0) && (xInFeatRef < 0))) ? 1 : 0;
     auto bit3 = static_cast<unsigned char> (((xInFeatRef > 0) || ((xInFeatRef == 0.0) && (yInFeatRef > 0))) ? !bit4 : bit4);
@@ -534,13 +584,7 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::interpolateDou
     }
 
     //Interpolation on the inclination (adjacent vertical volumes)
-    double inclinationCos = zInFeatRef / distance;
-    if (inclinationCos < - 1.0)
-      inclinationCos = - 1.0;
-    if (inclinationCos > 1.0)
-      inclinationCos = 1.0;
-
-    double inclination = std::acos (inclinationCos);
+    const double inclination = coords.inclination[i_idx];
 
     assert (inclination >= 0.0 && inclination <= PST_RAD_180);
 
@@ -584,7 +628,7 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::interpolateDou
     if (yInFeatRef != 0.0 || xInFeatRef != 0.0)
     {
       //Interpolation on the azimuth (adjacent horizontal volumes)
-      double azimuth = std::atan2 (yInFeatRef, xInFeatRef);
+      const double azimuth = coords.azimuth[i_idx];
 
       int sel = desc_index >> 2;
       double angularSectorSpan = PST_RAD_45;
@@ -626,7 +670,8 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::interpolateDou
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
-  const int index, const pcl::Indices &indices, const std::vector<float> &sqr_dists, Eigen::VectorXf &shot)
+  const int index, const pcl::Indices &indices, const std::vector<float> &sqr_dists, Eigen::VectorXf &shot,
+  LocalCoordinates &coords)
 {
   // Clear the resultant shot
   shot.setZero ();
@@ -698,11 +743,11 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSH
   if (b_describe_shape_ && b_describe_color_)
     interpolateDoubleChannel (indices, sqr_dists, index, binDistanceShape, binDistanceColor,
                               nr_shape_bins_, nr_color_bins_,
-                              shot);
+                              shot, coords);
   else if (b_describe_color_)
-    interpolateSingleChannel (indices, sqr_dists, index, binDistanceColor, nr_color_bins_, shot);
+    interpolateSingleChannel (indices, sqr_dists, index, binDistanceColor, nr_color_bins_, shot, coords);
   else
-    interpolateSingleChannel (indices, sqr_dists, index, binDistanceShape, nr_shape_bins_, shot);
+    interpolateSingleChannel (indices, sqr_dists, index, binDistanceShape, nr_shape_bins_, shot, coords);
 
   // Normalize the final histogram
   this->normalizeHistogram (shot, descLength_);
@@ -711,7 +756,8 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSH
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
-  const int index, const pcl::Indices &indices, const std::vector<float> &sqr_dists, Eigen::VectorXf &shot)
+  const int index, const pcl::Indices &indices, const std::vector<float> &sqr_dists, Eigen::VectorXf &shot,
+  LocalCoordinates &coords)
 {
   //Skip the current feature if the number of its neighbors is not sufficient for its description
   if (indices.size () < 5)
@@ -730,7 +776,7 @@ pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
 
   // Interpolate
   shot.setZero ();
-  interpolateSingleChannel (indices, sqr_dists, index, binDistanceShape, nr_shape_bins_, shot);
+  interpolateSingleChannel (indices, sqr_dists, index, binDistanceShape, nr_shape_bins_, shot, coords);
 
   // Normalize the final histogram
   this->normalizeHistogram (shot, descLength_);
@@ -753,6 +799,7 @@ pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (pcl
 
   Eigen::VectorXf shot;
   shot.setZero (descLength_);
+  LocalCoordinates coords;
 
   // Allocate enough space to hold the results
   // \note This resize is irrelevant for a radiusSearch ().
@@ -789,7 +836,7 @@ pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (pcl
     }
 
     // Estimate the SHOT descriptor at each patch
-    computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot);
+    computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot, coords);
 
     // Copy into the resultant cloud
     for (int d = 0; d < descLength_; ++d)
@@ -826,6 +873,7 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature
 
   Eigen::VectorXf shot;
   shot.setZero (descLength_);
+  LocalCoordinates coords;
 
   // Allocate enough space to hold the results
   // \note This resize is irrelevant for a radiusSearch ().
@@ -862,7 +910,7 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature
     }
 
     // Compute the SHOT descriptor for the current 3D feature
-    computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot);
+    computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot, coords);
 
     // Copy into the resultant cloud
     for (int d = 0; d < descLength_; ++d)
@@ -64,6 +64,10 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
     return (false);
   }
 
+  // Reuse the frames estimated by the previous call, if they were kept and are still valid
+  if (this->canReuseReferenceFrames ())
+    return (true);
+
   // Default LRF estimation alg: SHOTLocalReferenceFrameEstimationOMP
   typename SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT>::Ptr lrf_estimator(new SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT>);
   lrf_estimator->setRadiusSearch ((lrf_radius_ > 0 ? lrf_radius_ : search_radius_));
@@ -79,6 +83,7 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
     PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
     return (false);
   }
+  this->keepReferenceFrames ();
 
   return (true);
 }
@@ -102,6 +107,10 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute
     return (false);
   }
 
+  // Reuse the frames estimated by the previous call, if they were kept and are still valid
+  if (this->canReuseReferenceFrames ())
+    return (true);
+
   // Default LRF estimation alg: SHOTLocalReferenceFrameEstimationOMP
   typename SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT>::Ptr lrf_estimator(new SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT>);
   lrf_estimator->setRadiusSearch ((lrf_radius_ > 0 ? lrf_radius_ : search_radius_));
@@ -117,6 +126,7 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute
     PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
     return (false);
   }
+  this->keepReferenceFrames ();
 
   return (true);
 }
@@ -148,18 +158,24 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
 
   assert(descLength_ == 352);
 
+  // Per-thread buffers, reused across the points handled by each thread
+  Eigen::VectorXf shot;
+  shot.setZero (descLength_);
+  typename SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::LocalCoordinates coords;
+  // Allocate enough space to hold the results
+  // \note This resize is irrelevant for a radiusSearch ().
+  pcl::Indices nn_indices (k_);
+  std::vector<float> nn_dists (k_);
+
   output.is_dense = true;
   // Iterating over the entire index vector
 #pragma omp parallel for \
   default(none) \
   shared(output) \
+  firstprivate(shot, coords, nn_indices, nn_dists) \
   num_threads(threads_)
   for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
-
-    Eigen::VectorXf shot;
-    shot.setZero (descLength_);
-
     bool lrf_is_nan = false;
     const PointRFT& current_frame = (*frames_)[idx];
     if (!std::isfinite (current_frame.x_axis[0]) ||
@@ -171,11 +187,6 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
       lrf_is_nan = true;
     }
 
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
-    pcl::Indices nn_indices (k_);
-    std::vector<float> nn_dists (k_);
-
     if (!isFinite ((*input_)[(*indices_)[idx]]) || lrf_is_nan || this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices,
                                                                                            nn_dists) == 0)
     {
@@ -190,7 +201,7 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
     }
 
     // Estimate the SHOT at each patch
-    this->computePointSHOT (idx, nn_indices, nn_dists, shot);
+    this->computePointSHOT (idx, nn_indices, nn_dists, shot, coords);
 
     // Copy into the resultant cloud
     for (Eigen::Index d = 0; d < shot.size (); ++d)
@@ -235,22 +246,24 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeat
   radius1_4_ = search_radius_ / 4;
   radius1_2_ = search_radius_ / 2;
 
+  // Per-thread buffers, reused across the points handled by each thread
+  Eigen::VectorXf shot;
+  shot.setZero (descLength_);
+  typename SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::LocalCoordinates coords;
+  // Allocate enough space to hold the results
+  // \note This resize is irrelevant for a radiusSearch ().
+  pcl::Indices nn_indices (k_);
+  std::vector<float> nn_dists (k_);
+
   output.is_dense = true;
   // Iterating over the entire index vector
 #pragma omp parallel for \
   default(none) \
   shared(output) \
+  firstprivate(shot, coords, nn_indices, nn_dists) \
   num_threads(threads_)
   for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
-    Eigen::VectorXf shot;
-    shot.setZero (descLength_);
-
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
-    pcl::Indices nn_indices (k_);
-    std::vector<float> nn_dists (k_);
-
     bool lrf_is_nan = false;
     const PointRFT& current_frame = (*frames_)[idx];
     if (!std::isfinite (current_frame.x_axis[0]) ||
@@ -277,7 +290,7 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeat
     }
 
     // Estimate the SHOT at each patch
-    this->computePointSHOT (idx, nn_indices, nn_dists, shot);
+    this->computePointSHOT (idx, nn_indices, nn_dists, shot, coords);
 
     // Copy into the resultant cloud
     for (Eigen::Index d = 0; d < shot.size (); ++d)
@@ -123,7 +123,8 @@ namespace pcl
         second_order_integral_image_ (),
         width_ (1), 
         height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        threads_ (1)
       {
       }
 
@@ -148,6 +149,21 @@ namespace pcl
       setInput (const DataType * data,
                 unsigned width, unsigned height, unsigned element_stride, unsigned row_stride);
 
+      /** \brief Allocate the integral image buffers for data of the given size in advance.
+        * The buffers are kept between calls to setInput and only grow, so inputs of the same
+        * (or a smaller) size are processed without any further allocation.
+        * \param[in] width the width of the data
+        * \param[in] height the height of the data
+        */
+      void
+      reserve (unsigned width, unsigned height);
+
+      /** \brief Set the number of threads used to compute the integral images.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Compute the first order sum within a given rectangle
         * \param[in] start_x x position of rectangle
         * \param[in] start_y y position of rectangle
@@ -224,6 +240,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to compute the integral images. */
+      unsigned int threads_;
    };
 
    /**
@@ -248,7 +267,8 @@ namespace pcl
         second_order_integral_image_ (),
         
         width_ (1), height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        threads_ (1)
       {
       }
 
@@ -267,6 +287,21 @@ namespace pcl
       setInput (const DataType * data,
                 unsigned width, unsigned height, unsigned element_stride, unsigned row_stride);
 
+      /** \brief Allocate the integral image buffers for data of the given size in advance.
+        * The buffers are kept between calls to setInput and only grow, so inputs of the same
+        * (or a smaller) size are processed without any further allocation.
+        * \param[in] width the width of the data
+        * \param[in] height the height of the data
+        */
+      void
+      reserve (unsigned width, unsigned height);
+
+      /** \brief Set the number of threads used to compute the integral images.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Compute the first order sum within a given rectangle
         * \param[in] start_x x position of rectangle
         * \param[in] start_y y position of rectangle
@@ -343,6 +378,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to compute the integral images. */
+      unsigned int threads_;
    };
  }
 
@@ -44,6 +44,8 @@
 #include <pcl/features/feature.h>
 #include <pcl/features/integral_image2D.h>
 
+#include <vector>
+
 namespace pcl
 {
   /** \brief Surface normal estimation on organized data using integral images.
@@ -114,10 +116,6 @@ namespace pcl
         , integral_image_DY_ (false)
         , integral_image_depth_ (false)
         , integral_image_XYZ_ (true)
-        , diff_x_ (nullptr)
-        , diff_y_ (nullptr)
-        , depth_data_ (nullptr)
-        , distance_map_ (nullptr)
         , use_depth_dependent_smoothing_ (false)
         , max_depth_change_factor_ (20.0f*0.001f)
         , normal_smoothing_size_ (10.0f)
@@ -129,6 +127,7 @@ namespace pcl
         , vpy_ (0.0f)
         , vpz_ (0.0f)
         , use_sensor_origin_ (true)
+        , threads_ (1)
       {
         feature_name_ = "IntegralImagesNormalEstimation";
         tree_.reset ();
@@ -136,7 +135,7 @@ namespace pcl
       }
 
       /** \brief Destructor **/
-      ~IntegralImageNormalEstimation () override;
+      ~IntegralImageNormalEstimation () override = default;
 
       /** \brief Set the regions size which is considered for normal estimation.
         * \param[in] width the width of the search rectangle
@@ -154,6 +153,22 @@ namespace pcl
         border_policy_ = border_policy;
       }
 
+      /** \brief Set the number of threads used to build the integral images and to compute the normals.
+        * The image is split into bands of rows which are processed concurrently.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Allocate all internal buffers (integral images, gradient and distance maps) for organized
+        * clouds of the given size in advance. The buffers are kept between frames and only grow, so a
+        * stream of equally sized clouds is processed without any reallocation in compute ().
+        * \param[in] width the width of the organized clouds
+        * \param[in] height the height of the organized clouds
+        */
+      void
+      reserve (unsigned width, unsigned height);
+
       /** \brief Computes the normal at the specified position.
         * \param[in] pos_x x position (pixel)
         * \param[in] pos_y y position (pixel)
@@ -256,7 +271,7 @@ namespace pcl
       inline float*
       getDistanceMap ()
       {
-        return (distance_map_);
+        return (distance_map_.empty () ? nullptr : distance_map_.data ());
       }
 
       /** \brief Set the viewpoint.
@@ -341,6 +356,48 @@ namespace pcl
 
     private:
 
+      /** \brief Computes the normal at the specified position using a given rectangle size. Unlike
+        * computePointNormal, this neither modifies the rectangle size nor initializes the integral images,
+        * so it can be called concurrently once the data structures are set up.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormalInRect (const int pos_x, const int pos_y, const unsigned point_index,
+                                const int rect_width, const int rect_height, PointOutT &normal) const;
+
+      /** \brief Computes the normal at the specified position using a given rectangle size and mirroring
+        * for border handling. Safe to be called concurrently, see computePointNormalInRect.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormalMirrorInRect (const int pos_x, const int pos_y, const unsigned point_index,
+                                      const int rect_width, const int rect_height, PointOutT &normal) const;
+
+      /** \brief Computes the normal of a single point of the input cloud from the distance map, handling
+        * invalid points, depth dependent smoothing and the border policy.
+        * \param[in] distance_map distance map
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computeNormalFromDistanceMap (const float *distance_map, const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal) const;
+
+      /** \brief Returns whether the data structures needed by the chosen estimation method are initialized. */
+      bool
+      isMethodInitialized () const;
+
       /** \brief Flip (in place) the estimated normal of a point towards a given viewpoint
         * \param point a given point
         * \param vp_x the X coordinate of the viewpoint
@@ -354,7 +411,7 @@ namespace pcl
       inline void
       flipNormalTowardsViewpoint (const PointInT &point, 
                                   float vp_x, float vp_y, float vp_z,
-                                  float &nx, float &ny, float &nz)
+                                  float &nx, float &ny, float &nz) const
       {
         // See if we need to flip any plane normals
         vp_x -= point.x;
@@ -406,15 +463,15 @@ namespace pcl
       IntegralImage2D<float, 3> integral_image_XYZ_;
 
       /** derivatives in x-direction */
-      float *diff_x_;
+      std::vector<float> diff_x_;
       /** derivatives in y-direction */
-      float *diff_y_;
+      std::vector<float> diff_y_;
 
-      /** depth data */
-      float *depth_data_;
+      /** depth change map */
+      std::vector<unsigned char> depth_change_map_;
 
       /** distance map */
-      float *distance_map_;
+      std::vector<float> distance_map_;
 
       /** \brief Smooth data based on depth (true/false). */
       bool use_depth_dependent_smoothing_;
@@ -443,6 +500,9 @@ namespace pcl
 
       /** whether the sensor origin of the input cloud or a user given viewpoint should be used.*/
       bool use_sensor_origin_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
       
       /** \brief This method should get called before starting the actual computation. */
       bool
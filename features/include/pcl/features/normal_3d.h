@@ -263,6 +263,7 @@ namespace pcl
       , vpy_ (0)
       , vpz_ (0)
       , use_sensor_origin_ (true)
+      , batch_size_ (0)
       {
         feature_name_ = "NormalEstimation";
       };
@@ -391,8 +392,53 @@ namespace pcl
           vpz_ = 0;
         }
       }
+
+      /** \brief Set the number of points whose normals are estimated together by the batched code path.
+        * The batched path gathers the neighborhoods of a block of points, accumulates their covariance matrices
+        * with vectorized array operations and solves all eigenproblems of the block at once (see \ref eigen33Batch).
+        * The results match the ones of the default path up to floating point rounding.
+        * \param[in] batch_size the number of points per block (0, the default, disables the batched path)
+        */
+      inline void
+      setBatchSize (std::size_t batch_size) { batch_size_ = batch_size; }
+
+      /** \brief Get the number of points whose normals are estimated together by the batched code path. */
+      inline std::size_t
+      getBatchSize () const { return (batch_size_); }
       
     protected:
+      /** \brief Scratch space of the batched code path, reused from one block to the next. */
+      struct BatchBuffers
+      {
+        /** \brief Neighbors of the current query point. */
+        pcl::Indices nn_indices;
+        std::vector<float> nn_dists;
+
+        /** \brief Coordinates of the neighbors of the current query point, in structure-of-arrays layout. */
+        Eigen::ArrayXf x, y, z;
+
+        /** \brief Upper triangular coefficients of the covariance matrices of the block, one matrix per row. */
+        Eigen::Array<float, Eigen::Dynamic, 6> covariances;
+
+        /** \brief Smallest eigenvalue and corresponding eigenvector of every covariance matrix of the block. */
+        Eigen::ArrayXf eigenvalues;
+        Eigen::Array<float, Eigen::Dynamic, 3> eigenvectors;
+
+        /** \brief Whether a normal could be estimated for the points of the block. */
+        Eigen::Array<bool, Eigen::Dynamic, 1> valid;
+      };
+
+      /** \brief Estimate the normals of the points with positions [begin, end) in the index vector, using the
+        * batched code path. Safe to call concurrently on disjoint ranges with distinct buffers.
+        * \param[in] begin first position in the index vector
+        * \param[in] end one past the last position in the index vector
+        * \param[in,out] buffers the scratch space to use
+        * \param[out] output the resultant point cloud model dataset that contains surface normals and curvatures
+        * \return false if the normal of at least one point of the block could not be estimated
+        */
+      bool
+      computeFeatureBatch (std::size_t begin, std::size_t end, BatchBuffers &buffers, PointCloudOut &output) const;
+
       /** \brief Estimate normals for all points given in <setInputCloud (), setIndices ()> using the surface in
         * setSearchSurface () and the spatial locator in setSearchMethod ()
         * \note In situations where not enough neighbors are found, the normal and curvature values are set to NaN.
@@ -414,6 +460,9 @@ namespace pcl
       /** whether the sensor origin of the input cloud or a user given viewpoint should be used.*/
       bool use_sensor_origin_;
 
+      /** \brief The number of points per block of the batched code path, 0 if disabled. */
+      std::size_t batch_size_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -75,7 +75,7 @@ namespace pcl
       /** \brief Empty constructor. */
       OURCVFHEstimation () :
         vpx_ (0), vpy_ (0), vpz_ (0), leaf_size_ (0.005f), normalize_bins_ (false), curv_threshold_ (0.03f), cluster_tolerance_ (leaf_size_ * 3),
-            eps_angle_threshold_ (0.125f), min_points_ (50), radius_normals_ (leaf_size_ * 3)
+            eps_angle_threshold_ (0.125f), min_points_ (50), radius_normals_ (leaf_size_ * 3), threads_ (0)
       {
         search_radius_ = 0;
         k_ = 1;
@@ -83,6 +83,7 @@ namespace pcl
         refine_clusters_ = 1.f;
         min_axis_value_ = 0.925f;
         axis_ratio_ = 0.8f;
+        setNumberOfThreads (threads_);
       }
       ;
 
@@ -314,6 +315,13 @@ namespace pcl
         min_axis_value_ = f;
       }
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+       * The VFH signatures and the SGURFs of the dominant regions are computed in parallel.
+       * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+       */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Overloaded computed method from pcl::Feature.
        * \param[out] output the resultant point cloud model dataset containing the estimated features
        */
@@ -351,6 +359,9 @@ namespace pcl
       /** \brief Radius for the normals computation. */
       float radius_normals_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Factor for the cluster refinement */
       float refine_clusters_;
 
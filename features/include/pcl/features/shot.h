@@ -83,8 +83,10 @@ namespace pcl
       using Feature<PointInT, PointOutT>::fake_surface_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_never_defined_;
 
       using PointCloudIn = typename Feature<PointInT, PointOutT>::PointCloudIn;
+      using PointCloudInConstPtr = typename Feature<PointInT, PointOutT>::PointCloudInConstPtr;
 
     protected:
       /** \brief Empty constructor.
@@ -93,6 +95,8 @@ namespace pcl
       SHOTEstimationBase (int nr_shape_bins = 10) :
         nr_shape_bins_ (nr_shape_bins),
         lrf_radius_ (0),
+        keep_frames_ (false),
+        frames_radius_ (0),
         sqradius_ (0), radius3_4_ (0), radius1_4_ (0), radius1_2_ (0),
         nr_grid_sector_ (32),
         maxAngularSectors_ (32),
@@ -102,6 +106,24 @@ namespace pcl
       };
 
     public:
+      /** \brief Coordinates of the neighbors of a feature point in its local reference frame, stored as a
+        * structure of arrays so that the quantities needed by the interpolation are computed for the whole
+        * neighborhood at once. The arrays only grow, so that one instance can be reused across the feature
+        * points handled by a thread; only their first indices.size () entries are valid.
+        */
+      struct LocalCoordinates
+      {
+        /** \brief Scratch buffer holding the neighbors relative to the feature point. */
+        Eigen::Matrix3Xf delta;
+        /** \brief The coordinates along the x, y and z axes of the local reference frame. */
+        Eigen::ArrayXd x, y, z;
+        /** \brief The distances from the feature point. */
+        Eigen::ArrayXd distance;
+        /** \brief The angles between the z axis and the neighbors, in [0, pi]. */
+        Eigen::ArrayXd inclination;
+        /** \brief The angles between the x axis and the neighbors projected on the xy plane, in [-pi, pi]. */
+        Eigen::ArrayXd azimuth;
+      };
 
       /** \brief Empty destructor */
       ~SHOTEstimationBase () override = default;
@@ -111,12 +133,31 @@ namespace pcl
          * \param[in] indices the k-neighborhood point indices in surface_
          * \param[in] sqr_dists the k-neighborhood point distances in surface_
          * \param[out] shot the resultant SHOT descriptor representing the feature at the query point
+         * \param[in,out] coords buffers for the local coordinates of the neighbors, reused across points
          */
       virtual void
       computePointSHOT (const int index,
                         const pcl::Indices &indices,
                         const std::vector<float> &sqr_dists,
-                        Eigen::VectorXf &shot) = 0;
+                        Eigen::VectorXf &shot,
+                        LocalCoordinates &coords) = 0;
+
+       /** \brief Estimate the SHOT descriptor for a given point based on its spatial neighborhood of 3D points with normals,
+         * with temporary buffers for the local coordinates
+         * \param[in] index the index of the point in indices_
+         * \param[in] indices the k-neighborhood point indices in surface_
+         * \param[in] sqr_dists the k-neighborhood point distances in surface_
+         * \param[out] shot the resultant SHOT descriptor representing the feature at the query point
+         */
+      void
+      computePointSHOT (const int index,
+                        const pcl::Indices &indices,
+                        const std::vector<float> &sqr_dists,
+                        Eigen::VectorXf &shot)
+      {
+        LocalCoordinates coords;
+        computePointSHOT (index, indices, sqr_dists, shot, coords);
+      }
 
         /** \brief Set the radius used for local reference frame estimation if the frames are not set by the user */
       virtual void
@@ -126,12 +167,48 @@ namespace pcl
       virtual float
       getLRFRadius () const { return lrf_radius_; }
 
-    protected:
+      /** \brief Keep the local reference frames estimated by compute () and reuse them in the following calls,
+        * as long as the input cloud, the indices, the search surface and the LRF radius stay the same.
+        * After compute (), the estimated frames are available through getInputReferenceFrames () and can be
+        * handed to another SHOT estimator working on the same points (e.g. a SHOTColorEstimation) through
+        * setInputReferenceFrames (), so that they are estimated only once.
+        * \note The clouds are compared by pointer: disable this option before modifying them in place.
+        * \param[in] keep_frames whether to keep the estimated frames (default: false)
+        */
+      inline void
+      setKeepReferenceFrames (bool keep_frames) { keep_frames_ = keep_frames; }
+
+      /** \brief Get whether the estimated local reference frames are kept between calls to compute (). */
+      inline bool
+      getKeepReferenceFrames () const { return (keep_frames_); }
 
+    protected:
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute () override;
 
+      /** \brief Check whether the frames estimated by a previous call to compute () can be used as they are,
+        * see setKeepReferenceFrames ().
+        */
+      bool
+      canReuseReferenceFrames () const;
+
+      /** \brief Remember the data the current frames were estimated from, if they have to be kept. */
+      void
+      keepReferenceFrames ();
+
+      /** \brief Express the neighborhood of a feature point in its local reference frame.
+        * \param[in] indices the neighborhood point indices
+        * \param[in] sqr_dists the neighborhood point distances
+        * \param[in] index the index of the point in indices_
+        * \param[in,out] coords the coordinates, distances and angles of the neighbors, grown if needed
+        */
+      void
+      computeLocalCoordinates (const pcl::Indices &indices,
+                               const std::vector<float> &sqr_dists,
+                               const int index,
+                               LocalCoordinates &coords) const;
+
       /** \brief Quadrilinear interpolation used when color and shape descriptions are NOT activated simultaneously
         *
         * \param[in] indices the neighborhood point indices
@@ -140,6 +217,7 @@ namespace pcl
         * \param[out] binDistance the resultant distance shape histogram
         * \param[in] nr_bins the number of bins in the shape histogram
         * \param[out] shot the resultant SHOT histogram
+        * \param[in,out] coords buffers for the local coordinates of the neighbors
         */
       void
       interpolateSingleChannel (const pcl::Indices &indices,
@@ -147,7 +225,8 @@ namespace pcl
                                 const int index,
                                 std::vector<double> &binDistance,
                                 const int nr_bins,
-                                Eigen::VectorXf &shot);
+                                Eigen::VectorXf &shot,
+                                LocalCoordinates &coords);
 
       /** \brief Normalize the SHOT histogram.
         * \param[in,out] shot the SHOT histogram
@@ -172,6 +251,15 @@ namespace pcl
       /** \brief The radius used for the LRF computation */
       float lrf_radius_;
 
+      /** \brief Whether the estimated local reference frames are kept between calls to compute (). */
+      bool keep_frames_;
+
+      /** \brief The input cloud, indices, search surface and radius the kept frames were estimated from. */
+      PointCloudInConstPtr frames_input_;
+      IndicesConstPtr frames_indices_;
+      PointCloudInConstPtr frames_surface_;
+      double frames_radius_;
+
       /** \brief The squared search radius. */
       double sqradius_;
 
@@ -237,6 +325,7 @@ namespace pcl
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::radius1_2_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::maxAngularSectors_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSingleChannel;
+      using LocalCoordinates = typename SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::LocalCoordinates;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
 
       using PointCloudIn = typename Feature<PointInT, PointOutT>::PointCloudIn;
@@ -255,12 +344,16 @@ namespace pcl
         * \param[in] indices the k-neighborhood point indices in surface_
         * \param[in] sqr_dists the k-neighborhood point distances in surface_
         * \param[out] shot the resultant SHOT descriptor representing the feature at the query point
+        * \param[in,out] coords buffers for the local coordinates of the neighbors, reused across points
         */
       void
       computePointSHOT (const int index,
                         const pcl::Indices &indices,
                         const std::vector<float> &sqr_dists,
-                        Eigen::VectorXf &shot) override;
+                        Eigen::VectorXf &shot,
+                        LocalCoordinates &coords) override;
+
+      using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT;
     protected:
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
@@ -314,6 +407,7 @@ namespace pcl
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::radius1_2_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::maxAngularSectors_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSingleChannel;
+      using LocalCoordinates = typename SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::LocalCoordinates;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
 
       using PointCloudIn = typename Feature<PointInT, PointOutT>::PointCloudIn;
@@ -340,12 +434,16 @@ namespace pcl
         * \param[in] indices the k-neighborhood point indices in surface_
         * \param[in] sqr_dists the k-neighborhood point distances in surface_
         * \param[out] shot the resultant SHOT descriptor representing the feature at the query point
+        * \param[in,out] coords buffers for the local coordinates of the neighbors, reused across points
         */
       void
       computePointSHOT (const int index,
                         const pcl::Indices &indices,
                         const std::vector<float> &sqr_dists,
-                        Eigen::VectorXf &shot) override;
+                        Eigen::VectorXf &shot,
+                        LocalCoordinates &coords) override;
+
+      using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT;
     protected:
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
@@ -364,6 +462,7 @@ namespace pcl
         * \param[in] nr_bins_shape the number of bins in the shape histogram
         * \param[in] nr_bins_color the number of bins in the color histogram
         * \param[out] shot the resultant SHOT histogram
+        * \param[in,out] coords buffers for the local coordinates of the neighbors
         */
       void
       interpolateDoubleChannel (const pcl::Indices &indices,
@@ -373,7 +472,8 @@ namespace pcl
                                 std::vector<double> &binDistanceColor,
                                 const int nr_bins_shape,
                                 const int nr_bins_color,
-                                Eigen::VectorXf &shot);
+                                Eigen::VectorXf &shot,
+                                LocalCoordinates &coords);
 
       /** \brief Compute shape descriptor. */
       bool b_describe_shape_;
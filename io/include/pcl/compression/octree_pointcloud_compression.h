@@ -162,6 +162,17 @@ namespace pcl
           OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointIdx(pointIdx_arg);
         }
 
+        /** \brief Add point at index from input pointcloud dataset to a leaf container created by a bulk build of the octree
+         * \param[in] leaf_arg the leaf container the point falls into
+         * \param[in] pointIdx_arg the index representing the point in the dataset given by \a setInputCloud
+         */
+        void
+        addPointIdxToLeaf (LeafT& leaf_arg, const uindex_t pointIdx_arg) override
+        {
+          ++object_count_;
+          OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointIdxToLeaf (leaf_arg, pointIdx_arg);
+        }
+
         /** \brief Provide a pointer to the output data set.
           * \param cloud_arg: the boost shared pointer to a PointCloud message
           */
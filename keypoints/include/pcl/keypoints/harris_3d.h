@@ -88,9 +88,11 @@ namespace pcl
       , nonmax_ (true)
       , method_ (method)
       , threads_ (0)
+      , reuse_neighborhoods_ (false)
       {
         name_ = "HarrisKeypoint3D";
         search_radius_ = radius;
+        setNumberOfThreads (threads_);
       }
       
       /** \brief Empty destructor */
@@ -154,8 +156,17 @@ namespace pcl
       /** \brief Initialize the scheduler and set the number of threads to use.
         * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
         */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Whether the neighborhoods of the input points are searched for only once and shared by the response
+        * and the non maxima suppression stages, instead of being searched for again by each stage. This trades memory,
+        * proportional to the number of neighbors within the radius, for speed. The neighborhoods are only shared if
+        * no search surface different from the input cloud is set.
+        * \param[in] reuse_neighborhoods whether the stages share the neighborhoods (default false)
+        */
       inline void
-      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+      setReuseNeighborhoods (bool reuse_neighborhoods) { reuse_neighborhoods_ = reuse_neighborhoods; }
     protected:
       bool
       initCompute () override;
@@ -169,6 +180,10 @@ namespace pcl
       void refineCorners (PointCloudOut &corners) const;
       /** \brief calculates the upper triangular part of unnormalized covariance matrix over the normals given by the indices.*/
       void calculateNormalCovar (const pcl::Indices& neighbors, float* coefficients) const;
+      /** \brief gets the neighbors of an input point within the radius, either from the shared neighborhoods or by
+        * searching for them into the given buffers.
+        * \return a reference to the neighbors of the point*/
+      const pcl::Indices& getNeighbors (int index, pcl::Indices& nn_indices, std::vector<float>& nn_dists) const;
     private:
       float threshold_;
       bool refine_;
@@ -176,6 +191,9 @@ namespace pcl
       ResponseMethod method_;
       PointCloudNConstPtr normals_;
       unsigned int threads_;
+      bool reuse_neighborhoods_;
+      /** \brief the neighborhoods of the input points shared by the stages, empty if they are not in use*/
+      std::vector<pcl::Indices> neighborhoods_;
   };
 }
 
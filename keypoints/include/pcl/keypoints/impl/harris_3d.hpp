@@ -43,6 +43,7 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
 #include <pcl/common/centroid.h>
+#include <algorithm> // for none_of
 #ifdef __SSE__
 #include <xmmintrin.h>
 #endif
@@ -98,6 +99,31 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::setNormals (const PointClou
   normals_ = normals;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename NormalT> void
+pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename NormalT> const pcl::Indices&
+pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::getNeighbors (int index, pcl::Indices& nn_indices, std::vector<float>& nn_dists) const
+{
+  if (!neighborhoods_.empty ())
+    return (neighborhoods_[index]);
+
+  tree_->radiusSearch ((*input_)[index], search_radius_, nn_indices, nn_dists);
+  return (nn_indices);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::calculateNormalCovar (const pcl::Indices& neighbors, float* coefficients) const
@@ -241,6 +267,24 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
   response->points.reserve (input_->size());
 
+  // Search once for the neighborhoods shared by the response and the non maxima suppression
+  if (reuse_neighborhoods_ && nonmax_ && surface_ == input_ && method_ != CURVATURE)
+  {
+    neighborhoods_.resize (input_->size ());
+#pragma omp parallel for \
+  default(none) \
+  num_threads(threads_)
+    for (int idx = 0; idx < static_cast<int> (input_->size ()); ++idx)
+    {
+      neighborhoods_[idx].clear ();
+      if (isFinite ((*input_)[idx]))
+      {
+        std::vector<float> nn_dists;
+        tree_->radiusSearch (idx, search_radius_, neighborhoods_[idx], nn_dists);
+      }
+    }
+  }
+
   switch (method_)
   {
     case HARRIS:
@@ -273,9 +317,10 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.clear ();
     output.reserve (response->size());
 
+    std::vector<char> is_maxima (response->size (), false);
 #pragma omp parallel for \
   default(none) \
-  shared(output, response) \
+  shared(is_maxima, response) \
   num_threads(threads_)
     for (int idx = 0; idx < static_cast<int> (response->size ()); ++idx)
     {
@@ -286,18 +331,19 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
       pcl::Indices nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
-      bool is_maxima = true;
-      for (const auto& index : nn_indices)
+      if (neighborhoods_.empty ())
+        tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
+      const pcl::Indices& neighbors = neighborhoods_.empty () ? nn_indices : neighborhoods_[idx];
+      is_maxima[idx] = std::none_of (neighbors.cbegin (), neighbors.cend (), [&response, idx] (const pcl::index_t& index)
       {
-        if ((*response)[idx].intensity < (*response)[index].intensity)
-        {
-          is_maxima = false;
-          break;
-        }
-      }
-      if (is_maxima)
-#pragma omp critical
+        return ((*response)[idx].intensity < (*response)[index].intensity);
+      });
+    }
+
+    // Collect the keypoints in the order of the input cloud, independently of the number of threads
+    for (int idx = 0; idx < static_cast<int> (response->size ()); ++idx)
+    {
+      if (is_maxima[idx])
       {
         output.push_back ((*response)[idx]);
         keypoints_indices_->indices.push_back (idx);
@@ -311,6 +357,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.width = output.size();
     output.is_dense = true;
   }
+
+  std::vector<pcl::Indices> ().swap (neighborhoods_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -332,8 +380,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudO
     {
       pcl::Indices nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
+      calculateNormalCovar (getNeighbors (pIdx, nn_indices, nn_dists), covar);
 
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
@@ -373,8 +420,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOu
     {
       pcl::Indices nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
+      calculateNormalCovar (getNeighbors (pIdx, nn_indices, nn_dists), covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
       {
@@ -413,8 +459,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseLowe (PointCloudOut
     {
       pcl::Indices nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
+      calculateNormalCovar (getNeighbors (pIdx, nn_indices, nn_dists), covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
       {
@@ -472,8 +517,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
     {
       pcl::Indices nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
+      calculateNormalCovar (getNeighbors (pIdx, nn_indices, nn_dists), covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
       {
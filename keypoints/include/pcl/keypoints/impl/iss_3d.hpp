@@ -39,6 +39,7 @@
 #define PCL_ISS_KEYPOINT3D_IMPL_H_
 
 #include <Eigen/Eigenvalues> // for SelfAdjointEigenSolver
+#include <algorithm> // for any_of, max
 #include <pcl/features/boundary.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
@@ -117,7 +118,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::setNumberOfThreads (unsigned i
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointOutT, typename NormalT> bool*
-pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getBoundaryPoints (PointCloudIn &input, double border_radius, float angle_threshold)
+pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getBoundaryPoints (const PointCloudIn &input, double border_radius, float angle_threshold)
 {
   bool* edge_points = new bool [input.size ()];
 
@@ -143,7 +144,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getBoundaryPoints (PointCloudI
       std::vector<float> nn_distances;
       int n_neighbors;
 
-      this->searchForNeighbors (index, border_radius, nn_indices, nn_distances);
+      getNeighbors (index, border_radius, nn_indices, nn_distances);
 
       n_neighbors = static_cast<int> (nn_indices.size ());
 
@@ -163,6 +164,18 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getBoundaryPoints (PointCloudI
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointOutT, typename NormalT> void
 pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getScatterMatrix (const int& current_index, Eigen::Matrix3d &cov_m)
+{
+  pcl::Indices nn_indices;
+  std::vector<float> nn_distances;
+
+  this->searchForNeighbors (current_index, salient_radius_, nn_indices, nn_distances);
+
+  getScatterMatrix (current_index, nn_indices, cov_m);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointOutT, typename NormalT> void
+pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getScatterMatrix (const int& current_index, const pcl::Indices &nn_indices, Eigen::Matrix3d &cov_m) const
 {
   const PointInT& current_point = (*input_)[current_index];
 
@@ -174,13 +187,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getScatterMatrix (const int& c
 
   cov_m = Eigen::Matrix3d::Zero ();
 
-  pcl::Indices nn_indices;
-  std::vector<float> nn_distances;
-  int n_neighbors;
-
-  this->searchForNeighbors (current_index, salient_radius_, nn_indices, nn_distances);
-
-  n_neighbors = static_cast<int> (nn_indices.size ());
+  const int n_neighbors = static_cast<int> (nn_indices.size ());
 
   if (n_neighbors < min_neighbors_)
     return;
@@ -207,6 +214,52 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getScatterMatrix (const int& c
 	   cov[6], cov[7], cov[8];
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointOutT, typename NormalT> void
+pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::computeNeighborhoods (double radius)
+{
+  neighborhoods_.resize (input_->size ());
+  neighborhood_distances_.resize (input_->size ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(radius) \
+  num_threads(threads_)
+  for (int index = 0; index < static_cast<int> (input_->size ()); index++)
+  {
+    neighborhoods_[index].clear ();
+    neighborhood_distances_[index].clear ();
+    if (pcl::isFinite ((*input_)[index]))
+      this->searchForNeighbors (index, radius, neighborhoods_[index], neighborhood_distances_[index]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointOutT, typename NormalT> void
+pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getNeighbors (int index, double radius, pcl::Indices &nn_indices, std::vector<float> &nn_distances) const
+{
+  if (neighborhoods_.empty ())
+  {
+    this->searchForNeighbors (index, radius, nn_indices, nn_distances);
+    return;
+  }
+
+  // Keep the shared neighbors which are within the requested radius
+  const float sqr_radius = static_cast<float> (radius * radius);
+  const pcl::Indices &neighborhood = neighborhoods_[index];
+  const std::vector<float> &distances = neighborhood_distances_[index];
+  nn_indices.clear ();
+  nn_distances.clear ();
+  for (std::size_t i = 0; i < neighborhood.size (); ++i)
+  {
+    if (distances[i] <= sqr_radius)
+    {
+      nn_indices.push_back (neighborhood[i]);
+      nn_distances.push_back (distances[i]);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointOutT, typename NormalT> bool
 pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::initCompute ()
@@ -305,73 +358,54 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
   // Make sure the output cloud is empty
   output.clear ();
 
+  if (reuse_neighborhoods_)
+    computeNeighborhoods (std::max ({salient_radius_, non_max_radius_, border_radius_}));
+
   if (border_radius_ > 0.0)
-    edge_points_ = getBoundaryPoints (*(input_->makeShared ()), border_radius_, angle_threshold_);
+    edge_points_ = getBoundaryPoints (*input_, border_radius_, angle_threshold_);
 
-  bool* borders = new bool [input_->size()];
+  std::vector<char> borders (input_->size (), false);
 
+  if (border_radius_ > 0.0)
+  {
 #pragma omp parallel for \
   default(none) \
   shared(borders) \
   num_threads(threads_)
-  for (int index = 0; index < static_cast<int>(input_->size ()); index++)
-  {
-    borders[index] = false;
-    PointInT current_point = (*input_)[index];
-
-    if ((border_radius_ > 0.0) && (pcl::isFinite(current_point)))
+    for (int index = 0; index < static_cast<int>(input_->size ()); index++)
     {
-      pcl::Indices nn_indices;
-      std::vector<float> nn_distances;
+      PointInT current_point = (*input_)[index];
 
-      this->searchForNeighbors (index, border_radius_, nn_indices, nn_distances);
-
-      for (const auto &nn_index : nn_indices)
+      if (pcl::isFinite(current_point))
       {
-        if (edge_points_[nn_index])
-        {
-          borders[index] = true;
-          break;
-        }
+        pcl::Indices nn_indices;
+        std::vector<float> nn_distances;
+
+        getNeighbors (index, border_radius_, nn_indices, nn_distances);
+
+        borders[index] = std::any_of (nn_indices.cbegin (), nn_indices.cend (),
+                                      [this] (const pcl::index_t &nn_index) { return (edge_points_[nn_index]); });
       }
     }
   }
 
-#ifdef _OPENMP
-  Eigen::Vector3d *omp_mem = new Eigen::Vector3d[threads_];
-
-  for (std::size_t i = 0; i < threads_; i++)
-    omp_mem[i].setZero (3);
-#else
-  auto *omp_mem = new Eigen::Vector3d[1];
-
-  omp_mem[0].setZero (3);
-#endif
-
-  double *prg_local_mem = new double[input_->size () * 3];
-  double **prg_mem = new double * [input_->size ()];
-
-  for (std::size_t i = 0; i < input_->size (); i++)
-    prg_mem[i] = prg_local_mem + 3 * i;
-
 #pragma omp parallel for \
   default(none) \
-  shared(borders, omp_mem, prg_mem) \
+  shared(borders) \
   num_threads(threads_)
   for (int index = 0; index < static_cast<int> (input_->size ()); index++)
   {
-#ifdef _OPENMP
-    int tid = omp_get_thread_num ();
-#else
-    int tid = 0;
-#endif
     PointInT current_point = (*input_)[index];
 
     if ((!borders[index]) && pcl::isFinite(current_point))
     {
       //if the considered point is not a border point and the point is "finite", then compute the scatter matrix
+      pcl::Indices nn_indices;
+      std::vector<float> nn_distances;
+      getNeighbors (index, salient_radius_, nn_indices, nn_distances);
+
       Eigen::Matrix3d cov_m = Eigen::Matrix3d::Zero ();
-      getScatterMatrix (static_cast<int> (index), cov_m);
+      getScatterMatrix (index, nn_indices, cov_m);
 
       Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (cov_m);
 
@@ -389,25 +423,12 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
 	continue;
       }
 
-      omp_mem[tid][0] = e2c / e1c;
-      omp_mem[tid][1] = e3c / e2c;
-      omp_mem[tid][2] = e3c;
+      if ((e2c / e1c < gamma_21_) && (e3c / e2c < gamma_32_))
+        third_eigen_value_[index] = e3c;
     }
-
-    for (Eigen::Index d = 0; d < omp_mem[tid].size (); d++)
-        prg_mem[index][d] = omp_mem[tid][d];
   }
 
-  for (int index = 0; index < static_cast<int>(input_->size ()); index++)
-  {
-   if (!borders[index])
-    {
-      if ((prg_mem[index][0] < gamma_21_) && (prg_mem[index][1] < gamma_32_))
-        third_eigen_value_[index] = prg_mem[index][2];
-    }
-  }
-
-  bool* feat_max = new bool [input_->size()];
+  std::vector<char> feat_max (input_->size (), false);
 
 #pragma omp parallel for \
   default(none) \
@@ -415,7 +436,6 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
   num_threads(threads_)
   for (int index = 0; index < static_cast<int>(input_->size ()); index++)
   {
-    feat_max [index] = false;
     PointInT current_point = (*input_)[index];
 
     if ((third_eigen_value_[index] > 0.0) && (pcl::isFinite(current_point)))
@@ -424,7 +444,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
       std::vector<float> nn_distances;
       int n_neighbors;
 
-      this->searchForNeighbors (index, non_max_radius_, nn_indices, nn_distances);
+      getNeighbors (index, non_max_radius_, nn_indices, nn_distances);
 
       n_neighbors = static_cast<int> (nn_indices.size ());
 
@@ -441,14 +461,10 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
     }
   }
 
-#pragma omp parallel for \
-  default(none) \
-  shared(feat_max, output) \
-  num_threads(threads_)
+  // Collect the keypoints in the order of the input cloud, independently of the number of threads
   for (int index = 0; index < static_cast<int>(input_->size ()); index++)
   {
     if (feat_max[index])
-#pragma omp critical
     {
       PointOutT p;
       p.getVector3fMap () = (*input_)[index].getVector3fMap ();
@@ -465,11 +481,8 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
   if (border_radius_ > 0.0)
     normals_.reset (new pcl::PointCloud<NormalT>);
 
-  delete[] borders;
-  delete[] prg_mem;
-  delete[] prg_local_mem;
-  delete[] feat_max;
-  delete[] omp_mem;
+  std::vector<pcl::Indices> ().swap (neighborhoods_);
+  std::vector<std::vector<float> > ().swap (neighborhood_distances_);
 }
 
 #define PCL_INSTANTIATE_ISSKeypoint3D(T,U,N) template class PCL_EXPORTS pcl::ISSKeypoint3D<T,U,N>;
@@ -59,6 +59,20 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::setMinimumContrast (float min_contrast)
   min_contrast_ = min_contrast;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::SIFTKeypoint<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> bool
 pcl::SIFTKeypoint<PointInT, PointOutT>::initCompute ()
@@ -216,10 +230,33 @@ void pcl::SIFTKeypoint<PointInT, PointOutT>::computeScaleSpace (
   // For efficiency, we will only filter over points within 3 standard deviations 
   const float max_radius = 3.0f * scales.back ();
 
+  // The field values and the scale variances are shared by all the points
+  std::vector<float> values (input.size ());
+  for (std::size_t i_point = 0; i_point < input.size (); ++i_point)
+    values[i_point] = getFieldValue_ (input[i_point]);
+
+  std::vector<float> sigma_sqrs (scales.size ());
+  for (std::size_t i_scale = 0; i_scale < scales.size (); ++i_scale)
+    sigma_sqrs[i_scale] = powf (scales[i_scale], 2.0f);
+
+  pcl::Indices nn_indices;
+  std::vector<float> nn_dist;
+
+#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
+#pragma omp parallel for \
+  default(none) \
+  shared(diff_of_gauss, input, sigma_sqrs, tree, values) \
+  firstprivate(nn_indices, nn_dist) \
+  num_threads(threads_)
+#else
+#pragma omp parallel for \
+  default(none) \
+  shared(diff_of_gauss, input, max_radius, sigma_sqrs, tree, values) \
+  firstprivate(nn_indices, nn_dist) \
+  num_threads(threads_)
+#endif
   for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
   {
-    pcl::Indices nn_indices;
-    std::vector<float> nn_dist;
     tree.radiusSearch (i_point, max_radius, nn_indices, nn_dist); // *
     // * note: at this stage of the algorithm, we must find all points within a radius defined by the maximum scale, 
     //   regardless of the configurable search method specified by the user, so we directly employ tree.radiusSearch 
@@ -227,15 +264,15 @@ void pcl::SIFTKeypoint<PointInT, PointOutT>::computeScaleSpace (
 
     // For each scale, compute the Gaussian "filter response" at the current point
     float filter_response = 0.0f;
-    for (std::size_t i_scale = 0; i_scale < scales.size (); ++i_scale)
+    for (std::size_t i_scale = 0; i_scale < sigma_sqrs.size (); ++i_scale)
     {
-      float sigma_sqr = powf (scales[i_scale], 2.0f);
+      const float sigma_sqr = sigma_sqrs[i_scale];
 
       float numerator = 0.0f;
       float denominator = 0.0f;
       for (std::size_t i_neighbor = 0; i_neighbor < nn_indices.size (); ++i_neighbor)
       {
-        const float &value = getFieldValue_ (input[nn_indices[i_neighbor]]);
+        const float &value = values[nn_indices[i_neighbor]];
         const float &dist_sqr = nn_dist[i_neighbor];
         if (dist_sqr <= 9*sigma_sqr)
         {
@@ -268,6 +305,23 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::findScaleSpaceExtrema (
   const int nr_scales = static_cast<int> (diff_of_gauss.cols ());
   std::vector<float> min_val (nr_scales), max_val (nr_scales);
 
+  // Whether a point is an extremum at a scale, stored per point and scale so that the extrema can be collected
+  // in order afterwards
+  std::vector<char> is_extremum (input.size () * nr_scales, false);
+
+#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
+#pragma omp parallel for \
+  default(none) \
+  shared(diff_of_gauss, input, is_extremum, tree) \
+  firstprivate(nn_indices, nn_dist, min_val, max_val) \
+  num_threads(threads_)
+#else
+#pragma omp parallel for \
+  default(none) \
+  shared(diff_of_gauss, input, is_extremum, nr_scales, tree) \
+  firstprivate(nn_indices, nn_dist, min_val, max_val) \
+  num_threads(threads_)
+#endif
   for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
   {
     // Define the local neighborhood around the current point
@@ -291,7 +345,7 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::findScaleSpaceExtrema (
       }
     }
 
-    // If the current point is an extreme value with high enough contrast, add it as a keypoint 
+    // If the current point is an extreme value with high enough contrast, mark it as a keypoint 
     for (int i_scale = 1; i_scale < nr_scales - 1; ++i_scale)
     {
       const float &val = diff_of_gauss (i_point, i_scale);
@@ -304,20 +358,31 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::findScaleSpaceExtrema (
             (val <  min_val[i_scale - 1]) && 
             (val <  min_val[i_scale + 1]))
         {
-          extrema_indices.push_back (i_point);
-          extrema_scales.push_back (i_scale);
+          is_extremum[i_point * nr_scales + i_scale] = true;
         }
         // Is it a local maximum?
         else if ((val == max_val[i_scale]) && 
                  (val >  max_val[i_scale - 1]) && 
                  (val >  max_val[i_scale + 1]))
         {
-          extrema_indices.push_back (i_point);
-          extrema_scales.push_back (i_scale);
+          is_extremum[i_point * nr_scales + i_scale] = true;
         }
       }
     }
   }
+
+  // Collect the extrema in the order of the points and scales
+  for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
+  {
+    for (int i_scale = 1; i_scale < nr_scales - 1; ++i_scale)
+    {
+      if (is_extremum[i_point * nr_scales + i_scale])
+      {
+        extrema_indices.push_back (i_point);
+        extrema_scales.push_back (i_scale);
+      }
+    }
+  }
 }
 
 #define PCL_INSTANTIATE_SIFTKeypoint(T,U) template class PCL_EXPORTS pcl::SIFTKeypoint<T,U>;
@@ -122,6 +122,7 @@ namespace pcl
       , normals_ (new pcl::PointCloud<NormalT>)
       , angle_threshold_ (static_cast<float> (M_PI) / 2.0f)
       , threads_ (0)
+      , reuse_neighborhoods_ (false)
       {
         name_ = "ISSKeypoint3D";
         search_radius_ = salient_radius_;
@@ -201,6 +202,18 @@ namespace pcl
       void
       setNumberOfThreads (unsigned int nr_threads = 0);
 
+      /** \brief Set whether the neighborhoods of the input points are searched for only once, within the largest of
+        * the border, salient and non maxima radii, and then shared by all the stages of the detector, instead of being
+        * searched for again at every stage. This trades memory, proportional to the number of neighbors within the
+        * largest radius, for speed.
+        * \param[in] reuse_neighborhoods whether the stages share the neighborhoods (default false)
+        */
+      inline void
+      setReuseNeighborhoods (bool reuse_neighborhoods)
+      {
+        reuse_neighborhoods_ = reuse_neighborhoods;
+      }
+
     protected:
 
       /** \brief Compute the boundary points for the given input cloud.
@@ -210,7 +223,7 @@ namespace pcl
         * \return the vector of boolean values in which the information about the boundary points is stored
         */
       bool*
-      getBoundaryPoints (PointCloudIn &input, double border_radius, float angle_threshold);
+      getBoundaryPoints (const PointCloudIn &input, double border_radius, float angle_threshold);
 
       /** \brief Compute the scatter matrix for a point index.
         * \param[in] current_index the index of the point
@@ -219,6 +232,31 @@ namespace pcl
       void
       getScatterMatrix (const int &current_index, Eigen::Matrix3d &cov_m);
 
+      /** \brief Compute the scatter matrix for a point index from its already known neighbors.
+        * \param[in] current_index the index of the point
+        * \param[in] nn_indices the neighbors of the point within the salient radius
+        * \param[out] cov_m the point scatter matrix
+        */
+      void
+      getScatterMatrix (const int &current_index, const pcl::Indices &nn_indices, Eigen::Matrix3d &cov_m) const;
+
+      /** \brief Search once for the neighbors of every input point within the given radius, to be shared by all
+        * the stages of the detector afterwards.
+        * \param[in] radius the largest radius used by the stages
+        */
+      void
+      computeNeighborhoods (double radius);
+
+      /** \brief Get the neighbors of a point within a radius, taken from the shared neighborhoods if they were
+        * computed, or searched for otherwise.
+        * \param[in] index the index of the point
+        * \param[in] radius the search radius, not larger than the radius of the shared neighborhoods
+        * \param[out] nn_indices the indices of the neighbors
+        * \param[out] nn_distances the squared distances to the neighbors
+        */
+      void
+      getNeighbors (int index, double radius, pcl::Indices &nn_indices, std::vector<float> &nn_distances) const;
+
       /** \brief Perform the initial checks before computing the keypoints.
        *  \return true if all the checks are passed, false otherwise
         */
@@ -268,6 +306,15 @@ namespace pcl
       /** \brief The number of threads that has to be used by the scheduler. */
       unsigned int threads_;
 
+      /** \brief Whether the stages of the detector share the neighborhoods of the input points. */
+      bool reuse_neighborhoods_;
+
+      /** \brief The shared neighborhoods of the input points, empty if they are not in use. */
+      std::vector<pcl::Indices> neighborhoods_;
+
+      /** \brief The squared distances to the points of the shared neighborhoods. */
+      std::vector<std::vector<float> > neighborhood_distances_;
+
   };
 
 }
@@ -110,7 +110,7 @@ namespace pcl
       /** \brief Empty constructor. */
       SIFTKeypoint () : min_scale_ (0.0), nr_octaves_ (0), nr_scales_per_octave_ (0), 
         min_contrast_ (-std::numeric_limits<float>::max ()), scale_idx_ (-1), 
-        getFieldValue_ ()
+        getFieldValue_ (), threads_ (1)
       {
         name_ = "SIFTKeypoint";
       }
@@ -129,6 +129,14 @@ namespace pcl
       void 
       setMinimumContrast (float min_contrast);
 
+      /** \brief Initialize the scheduler and set the number of threads to use for the computation of the scale
+        * space and the search for its extrema. By default, a single thread is used. The result does not depend
+        * on the number of threads.
+        * \param nr_threads the number of hardware threads to use (0 sets the value to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
     protected:
       bool
       initCompute () override;
@@ -197,6 +205,9 @@ namespace pcl
       std::vector<pcl::PCLPointField> out_fields_;
 
       SIFTKeypointFieldSelector<PointInT> getFieldValue_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
@@ -171,6 +171,22 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::deleteTree()
     depth_mask_ = 0;
     octree_depth_ = 0;
   }
+
+  freeNodePools();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT, typename BranchContainerT>
+void
+Octree2BufBase<LeafContainerT, BranchContainerT>::freeNodePools()
+{
+  for (BranchNode* branch : branch_pool_)
+    delete (branch);
+  branch_pool_.clear();
+
+  for (LeafNode* leaf : leaf_pool_)
+    delete (leaf);
+  leaf_pool_.clear();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -351,6 +367,39 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::serializeNewLeafs(
   tree_dirty_flag_ = false;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT, typename BranchContainerT>
+void
+Octree2BufBase<LeafContainerT, BranchContainerT>::getNewLeafs(
+    std::vector<LeafContainerT*>& leaf_container_vector_arg,
+    unsigned int nr_threads_arg) const
+{
+  leaf_container_vector_arg.clear();
+
+  // split the octree into the subtrees below a fixed depth, all of them being branches
+  const uindex_t sub_tree_depth =
+      octree_depth_ > 1 ? std::min<uindex_t>(3, octree_depth_ - 1) : 0;
+  std::vector<const BranchNode*> sub_trees;
+  getSubTreesRecursive(root_node_, 0, sub_tree_depth, sub_trees);
+
+  // the subtrees are disjoint, the buffers are only read
+  std::vector<std::vector<LeafContainerT*>> sub_tree_leafs(sub_trees.size());
+#pragma omp parallel for default(none) shared(sub_trees, sub_tree_leafs)               \
+    schedule(dynamic) num_threads(nr_threads_arg)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(sub_trees.size()); ++i)
+    getNewLeafsRecursive(sub_trees[i], sub_tree_leafs[i]);
+
+  // concatenate the results in depth-first order
+  std::size_t nr_leafs = 0;
+  for (const auto& leafs : sub_tree_leafs)
+    nr_leafs += leafs.size();
+
+  leaf_container_vector_arg.reserve(nr_leafs);
+  for (const auto& leafs : sub_tree_leafs)
+    leaf_container_vector_arg.insert(
+        leaf_container_vector_arg.end(), leafs.begin(), leafs.end());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename LeafContainerT, typename BranchContainerT>
 uindex_t
@@ -783,6 +832,56 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::deserializeTreeRecursive(
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT, typename BranchContainerT>
+void
+Octree2BufBase<LeafContainerT, BranchContainerT>::getSubTreesRecursive(
+    const BranchNode* branch_arg,
+    uindex_t depth_arg,
+    uindex_t sub_tree_depth_arg,
+    std::vector<const BranchNode*>& sub_trees_arg) const
+{
+  if (depth_arg == sub_tree_depth_arg) {
+    sub_trees_arg.push_back(branch_arg);
+    return;
+  }
+
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++) {
+    const OctreeNode* child_node = branch_arg->getChildPtr(buffer_selector_, child_idx);
+
+    if (child_node && child_node->getNodeType() == BRANCH_NODE)
+      getSubTreesRecursive(static_cast<const BranchNode*>(child_node),
+                           depth_arg + 1,
+                           sub_tree_depth_arg,
+                           sub_trees_arg);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT, typename BranchContainerT>
+void
+Octree2BufBase<LeafContainerT, BranchContainerT>::getNewLeafsRecursive(
+    const BranchNode* branch_arg,
+    std::vector<LeafContainerT*>& leaf_container_vector_arg) const
+{
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++) {
+    OctreeNode* child_node = branch_arg->getChildPtr(buffer_selector_, child_idx);
+
+    if (!child_node)
+      continue;
+
+    if (child_node->getNodeType() == BRANCH_NODE) {
+      getNewLeafsRecursive(static_cast<const BranchNode*>(child_node),
+                           leaf_container_vector_arg);
+    }
+    else if (!branch_arg->hasChild(!buffer_selector_, child_idx)) {
+      // leaf did not exist in previous buffer
+      leaf_container_vector_arg.push_back(
+          static_cast<LeafNode*>(child_node)->getContainerPtr());
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename LeafContainerT, typename BranchContainerT>
 void
@@ -44,29 +44,35 @@
 namespace pcl {
 namespace octree {
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
-OctreeBase<LeafContainerT, BranchContainerT>::OctreeBase()
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::OctreeBase()
 : leaf_count_(0)
 , branch_count_(1)
-, root_node_(new BranchNode())
+, root_node_(branch_allocator_.allocate())
 , depth_mask_(0)
 , octree_depth_(0)
 , dynamic_depth_enabled_(false)
 {}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
-OctreeBase<LeafContainerT, BranchContainerT>::~OctreeBase()
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::~OctreeBase()
 {
   // deallocate tree structure
   deleteTree();
-  delete (root_node_);
+  branch_allocator_.deallocate(root_node_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::setMaxVoxelIndex(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::setMaxVoxelIndex(
     uindex_t max_voxel_index_arg)
 {
   uindex_t tree_depth;
@@ -82,9 +88,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::setMaxVoxelIndex(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::setTreeDepth(uindex_t depth_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::setTreeDepth(
+    uindex_t depth_arg)
 {
   assert(depth_arg > 0);
   assert(depth_arg <= OctreeKey::maxDepth);
@@ -100,11 +109,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::setTreeDepth(uindex_t depth_arg)
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 LeafContainerT*
-OctreeBase<LeafContainerT, BranchContainerT>::findLeaf(uindex_t idx_x_arg,
-                                                       uindex_t idx_y_arg,
-                                                       uindex_t idx_z_arg) const
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::findLeaf(
+    uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg) const
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -114,11 +124,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::findLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 LeafContainerT*
-OctreeBase<LeafContainerT, BranchContainerT>::createLeaf(uindex_t idx_x_arg,
-                                                         uindex_t idx_y_arg,
-                                                         uindex_t idx_z_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::createLeaf(
+    uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg)
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -128,11 +139,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::createLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 bool
-OctreeBase<LeafContainerT, BranchContainerT>::existLeaf(uindex_t idx_x_arg,
-                                                        uindex_t idx_y_arg,
-                                                        uindex_t idx_z_arg) const
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::existLeaf(
+    uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg) const
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -142,11 +154,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::existLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::removeLeaf(uindex_t idx_x_arg,
-                                                         uindex_t idx_y_arg,
-                                                         uindex_t idx_z_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::removeLeaf(
+    uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg)
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -156,9 +169,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::removeLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::deleteTree()
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deleteTree()
 {
 
   if (root_node_) {
@@ -170,9 +185,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::deleteTree()
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::serializeTree(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::serializeTree(
     std::vector<char>& binary_tree_out_arg) const
 {
 
@@ -186,9 +203,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::serializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::serializeTree(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::serializeTree(
     std::vector<char>& binary_tree_out_arg,
     std::vector<LeafContainerT*>& leaf_container_vector_arg) const
 {
@@ -207,9 +226,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::serializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::serializeLeafs(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::serializeLeafs(
     std::vector<LeafContainerT*>& leaf_container_vector_arg)
 {
   OctreeKey new_key;
@@ -223,9 +244,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::serializeLeafs(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::deserializeTree(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deserializeTree(
     std::vector<char>& binary_tree_out_arg)
 {
   OctreeKey new_key;
@@ -247,9 +270,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::deserializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::deserializeTree(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deserializeTree(
     std::vector<char>& binary_tree_in_arg,
     std::vector<LeafContainerT*>& leaf_container_vector_arg)
 {
@@ -280,9 +305,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::deserializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 uindex_t
-OctreeBase<LeafContainerT, BranchContainerT>::createLeafRecursive(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::createLeafRecursive(
     const OctreeKey& key_arg,
     uindex_t depth_mask_arg,
     BranchNode* branch_arg,
@@ -340,9 +367,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::createLeafRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::findLeafRecursive(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::findLeafRecursive(
     const OctreeKey& key_arg,
     uindex_t depth_mask_arg,
     BranchNode* branch_arg,
@@ -378,9 +407,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::findLeafRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 bool
-OctreeBase<LeafContainerT, BranchContainerT>::deleteLeafRecursive(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deleteLeafRecursive(
     const OctreeKey& key_arg, uindex_t depth_mask_arg, BranchNode* branch_arg)
 {
   // index to branch child
@@ -430,9 +461,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::deleteLeafRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::serializeTreeRecursive(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::serializeTreeRecursive(
     const BranchNode* branch_arg,
     OctreeKey& key_arg,
     std::vector<char>* binary_tree_out_arg,
@@ -487,9 +520,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::serializeTreeRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename> class NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::deserializeTreeRecursive(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deserializeTreeRecursive(
     BranchNode* branch_arg,
     uindex_t depth_mask_arg,
     OctreeKey& key_arg,
@@ -43,7 +43,89 @@
 #include <pcl/octree/impl/octree_base.hpp>
 #include <pcl/types.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace pcl {
+namespace octree {
+namespace detail {
+/** \brief Interleave the bits of an octree key into a Morton code. The x, y and z bits
+ * of each tree level form the child index of that level.
+ * \param[in] key_arg octree key with at most 21 bits per coordinate
+ * \return Morton code of the key
+ */
+inline std::uint64_t
+encodeMortonCode(const OctreeKey& key_arg)
+{
+  const auto spread_bits = [](std::uint64_t value) {
+    value &= 0x1fffff;
+    value = (value | (value << 32)) & 0x1f00000000ffff;
+    value = (value | (value << 16)) & 0x1f0000ff0000ff;
+    value = (value | (value << 8)) & 0x100f00f00f00f00f;
+    value = (value | (value << 4)) & 0x10c30c30c30c30c3;
+    value = (value | (value << 2)) & 0x1249249249249249;
+    return value;
+  };
+  return (spread_bits(key_arg.x) << 2) | (spread_bits(key_arg.y) << 1) |
+         spread_bits(key_arg.z);
+}
+
+/** \brief Sort a vector in parallel: chunks are sorted by separate threads and merged
+ * pairwise afterwards. The result does not depend on the number of threads.
+ * \param[in,out] values the values to sort
+ * \param[in] nr_threads the number of threads to use
+ */
+template <typename T>
+void
+parallelSort(std::vector<T>& values, unsigned int nr_threads)
+{
+  const auto nr_values = static_cast<std::ptrdiff_t>(values.size());
+  // chunks smaller than this are not worth a thread
+  constexpr std::ptrdiff_t min_chunk_size = 1 << 14;
+  const auto nr_chunks = std::max<std::ptrdiff_t>(
+      1,
+      std::min<std::ptrdiff_t>(nr_threads, nr_values / min_chunk_size));
+
+  std::vector<std::ptrdiff_t> bounds(nr_chunks + 1);
+  for (std::ptrdiff_t chunk = 0; chunk <= nr_chunks; ++chunk)
+    bounds[chunk] = chunk * nr_values / nr_chunks;
+
+#pragma omp parallel for default(none) shared(values, bounds)                          \
+    firstprivate(nr_chunks) num_threads(nr_threads)
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
+    std::sort(values.begin() + bounds[chunk], values.begin() + bounds[chunk + 1]);
+
+  std::vector<T> buffer(values.size());
+  while (bounds.size() > 2) {
+    const auto nr_pairs = static_cast<std::ptrdiff_t>(bounds.size() / 2);
+#pragma omp parallel for default(none) shared(values, buffer, bounds)                  \
+    firstprivate(nr_pairs) num_threads(nr_threads)
+    for (std::ptrdiff_t pair = 0; pair < nr_pairs; ++pair) {
+      const auto begin = bounds[2 * pair];
+      const auto middle = bounds[2 * pair + 1];
+      // an odd chunk at the end is merged in the next round
+      const auto end = bounds[std::min<std::size_t>(2 * pair + 2, bounds.size() - 1)];
+      std::merge(values.begin() + begin,
+                 values.begin() + middle,
+                 values.begin() + middle,
+                 values.begin() + end,
+                 buffer.begin() + begin);
+    }
+    values.swap(buffer);
+
+    std::vector<std::ptrdiff_t> merged_bounds;
+    for (std::size_t bound = 0; bound < bounds.size(); bound += 2)
+      merged_bounds.push_back(bounds[bound]);
+    if (merged_bounds.back() != nr_values)
+      merged_bounds.push_back(nr_values);
+    bounds.swap(merged_bounds);
+  }
+}
+} // namespace detail
+} // namespace octree
+} // namespace pcl
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,
@@ -65,10 +147,30 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
 , max_z_(resolution)
 , bounding_box_defined_(false)
 , max_objs_per_leaf_(0)
+, threads_(1)
 {
   assert(resolution > 0.0f);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeT>
+void
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
+    setNumberOfThreads(unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,
           typename LeafContainerT,
@@ -78,6 +180,38 @@ void
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
     addPointsFromInputCloud()
 {
+  if (this->leaf_count_ == 0 && !this->dynamic_depth_enabled_ &&
+      detail::supports_bulk_build<OctreeT>::value) {
+    Indices point_indices;
+    if (indices_) {
+      point_indices.reserve(indices_->size());
+      for (const auto& index : *indices_) {
+        assert((index >= 0) && (static_cast<std::size_t>(index) < input_->size()));
+
+        if (isFinite((*input_)[index]))
+          point_indices.push_back(index);
+      }
+    }
+    else {
+      point_indices.reserve(input_->size());
+      for (index_t i = 0; i < static_cast<index_t>(input_->size()); i++) {
+        if (isFinite((*input_)[i]))
+          point_indices.push_back(i);
+      }
+    }
+
+    // grow the bounding box in insertion order, so that the octree ends up exactly like
+    // the one built by adding the points one by one
+    for (const auto& index : point_indices)
+      adoptBoundingBoxToPoint((*input_)[index]);
+
+    if (!addPointsBulk(point_indices)) {
+      for (const auto& index : point_indices)
+        this->addPointIdx(index);
+    }
+    return;
+  }
+
   if (indices_) {
     for (const auto& index : *indices_) {
       assert((index >= 0) && (static_cast<std::size_t>(index) < input_->size()));
@@ -505,7 +639,7 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
 
         BranchNode* newRootBranch;
 
-        newRootBranch = new BranchNode();
+        newRootBranch = this->createBranch();
         this->branch_count_++;
 
         this->setBranchChildPtr(*newRootBranch, child_idx, this->root_node_);
@@ -656,6 +790,84 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
   (*leaf_node)->addPointIndex(point_idx_arg);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeT>
+bool
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
+    addPointsBulk(const Indices& point_indices_arg)
+{
+  // 3 bits per tree level have to fit into a 64 bit Morton code
+  constexpr uindex_t max_bulk_depth = 21;
+
+  if (!detail::supports_bulk_build<OctreeT>::value || this->leaf_count_ != 0 ||
+      this->dynamic_depth_enabled_ || this->octree_depth_ > max_bulk_depth)
+    return (false);
+
+  // Morton code of every point together with its position in point_indices_arg, which
+  // keeps the insertion order of points falling into the same voxel
+  const auto nr_points = static_cast<std::ptrdiff_t>(point_indices_arg.size());
+  std::vector<std::pair<std::uint64_t, std::ptrdiff_t>> codes(nr_points);
+
+#pragma omp parallel for default(none) shared(codes, point_indices_arg)                \
+    firstprivate(nr_points) num_threads(threads_)
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i) {
+    assert(static_cast<std::size_t>(point_indices_arg[i]) < input_->size());
+
+    OctreeKey key;
+    this->genOctreeKeyforPoint((*input_)[point_indices_arg[i]], key);
+    codes[i] = std::make_pair(detail::encodeMortonCode(key), i);
+  }
+
+  detail::parallelSort(codes, threads_);
+
+  // branch_path[level] is the branch at that level on the path to the current leaf
+  const uindex_t depth = this->octree_depth_;
+  std::vector<BranchNode*> branch_path(depth);
+  branch_path[0] = this->root_node_;
+  LeafNode* leaf_node = nullptr;
+
+  for (std::size_t i = 0; i < codes.size(); ++i) {
+    const std::uint64_t code = codes[i].first;
+
+    if (!leaf_node || code != codes[i - 1].first) {
+      // the path to the new leaf leaves the previous one at the first differing level
+      uindex_t level = 0;
+      if (leaf_node) {
+        const std::uint64_t code_diff = code ^ codes[i - 1].first;
+        while ((code_diff >> (3 * (depth - 1 - level))) == 0)
+          ++level;
+      }
+
+      for (; level < depth; ++level) {
+        BranchNode* branch = branch_path[level];
+        const auto child_idx =
+            static_cast<unsigned char>((code >> (3 * (depth - 1 - level))) & 7);
+        OctreeNode* child_node = this->getBranchChildPtr(*branch, child_idx);
+
+        if (level + 1 < depth) {
+          // existing branches stem from growing the bounding box
+          if (!child_node) {
+            child_node = this->createBranchChild(*branch, child_idx);
+            this->branch_count_++;
+          }
+          branch_path[level + 1] = static_cast<BranchNode*>(child_node);
+        }
+        else {
+          leaf_node = this->createLeafChild(*branch, child_idx);
+          this->leaf_count_++;
+        }
+      }
+    }
+
+    addPointIdxToLeaf(**leaf_node, point_indices_arg[codes[i].second]);
+  }
+
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,
           typename LeafContainerT,
@@ -49,6 +49,28 @@
  */
 #include <pcl/octree/impl/octree_pointcloud.hpp>
 
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+namespace pcl {
+namespace octree {
+namespace detail {
+/** \brief Hash function for octree keys. */
+struct OctreeKeyHash {
+  std::size_t
+  operator()(const OctreeKey& key_arg) const
+  {
+    std::uint64_t hash = key_arg.x;
+    hash = hash * 0x9E3779B97F4A7C15ULL + key_arg.y;
+    hash = hash * 0x9E3779B97F4A7C15ULL + key_arg.z;
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+  }
+};
+} // namespace detail
+} // namespace octree
+} // namespace pcl
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename LeafContainerT, typename BranchContainerT>
 pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::
@@ -95,23 +117,115 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   }
   this->defineBoundingBox(minX, minY, minZ, maxX, maxY, maxZ);
 
-  OctreePointCloud<PointT, LeafContainerT, BranchContainerT>::addPointsFromInputCloud();
+  Indices point_indices;
+  if (this->indices_) {
+    point_indices.reserve(this->indices_->size());
+    for (const auto& index : *this->indices_)
+      if (pcl::isFinite((*input_)[index]))
+        point_indices.push_back(index);
+  }
+  else {
+    point_indices.reserve(input_->size());
+    for (index_t i = 0; i < static_cast<index_t>(input_->size()); ++i)
+      if (pcl::isFinite((*input_)[i]))
+        point_indices.push_back(i);
+  }
 
+  // The bounding box already holds all (transformed) points, so they can be added in a
+  // single pass. Otherwise fall back to adding them one by one.
+  if (!this->addPointsBulk(point_indices)) {
+    for (const auto& index : point_indices)
+      addPointIdx(index);
+  }
+
+  leaf_vector_.clear();
   leaf_vector_.reserve(this->getLeafCount());
+  std::vector<OctreeKey> leaf_keys;
+  leaf_keys.reserve(this->getLeafCount());
   for (auto leaf_itr = this->leaf_depth_begin(); leaf_itr != this->leaf_depth_end();
        ++leaf_itr) {
-    OctreeKey leaf_key = leaf_itr.getCurrentOctreeKey();
-    LeafContainerT* leaf_container = &(leaf_itr.getLeafContainer());
+    leaf_keys.push_back(leaf_itr.getCurrentOctreeKey());
+    leaf_vector_.push_back(&(leaf_itr.getLeafContainer()));
+  }
+  // Make sure our leaf vector is correctly sized
+  assert(leaf_vector_.size() == this->getLeafCount());
 
-    // Run the leaf's compute function
-    leaf_container->computeData();
+  computeAdjacency(leaf_keys);
+}
 
-    computeNeighbors(leaf_key, leaf_container);
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+void
+pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::
+    computeAdjacency(const std::vector<OctreeKey>& leaf_keys)
+{
+  const auto nr_leaves = static_cast<std::ptrdiff_t>(leaf_vector_.size());
+
+  std::unordered_map<OctreeKey, uindex_t, detail::OctreeKeyHash> leaf_indices;
+  leaf_indices.reserve(nr_leaves);
+  for (std::ptrdiff_t i = 0; i < nr_leaves; ++i)
+    leaf_indices.emplace(leaf_keys[i], static_cast<uindex_t>(i));
+
+  // Looks up the indices of the neighbors of a leaf, in the same order as
+  // computeNeighbors(), and returns their number
+  const OctreeKey max_key = this->max_key_;
+  const auto find_neighbors = [&leaf_indices, &max_key](
+                                  const OctreeKey& key,
+                                  std::array<uindex_t, 27>& neighbors) {
+    std::size_t nr_neighbors = 0;
+    const int dx_min = (key.x > 0) ? -1 : 0;
+    const int dy_min = (key.y > 0) ? -1 : 0;
+    const int dz_min = (key.z > 0) ? -1 : 0;
+    const int dx_max = (key.x == max_key.x) ? 0 : 1;
+    const int dy_max = (key.y == max_key.y) ? 0 : 1;
+    const int dz_max = (key.z == max_key.z) ? 0 : 1;
+
+    OctreeKey neighbor_key;
+    for (int dx = dx_min; dx <= dx_max; ++dx) {
+      for (int dy = dy_min; dy <= dy_max; ++dy) {
+        for (int dz = dz_min; dz <= dz_max; ++dz) {
+          neighbor_key.x = static_cast<uindex_t>(key.x + dx);
+          neighbor_key.y = static_cast<uindex_t>(key.y + dy);
+          neighbor_key.z = static_cast<uindex_t>(key.z + dz);
+          const auto neighbor = leaf_indices.find(neighbor_key);
+          if (neighbor != leaf_indices.end())
+            neighbors[nr_neighbors++] = neighbor->second;
+        }
+      }
+    }
+    return nr_neighbors;
+  };
+
+  // The neighbors are counted first, so that the compressed rows can be filled in
+  // parallel afterwards without storing up to 27 neighbors for every leaf
+  neighbor_offsets_.assign(nr_leaves + 1, 0);
+#pragma omp parallel for default(none)                                                 \
+    shared(leaf_keys, find_neighbors) firstprivate(nr_leaves) num_threads(threads_)
+  for (std::ptrdiff_t i = 0; i < nr_leaves; ++i) {
+    // Run the leaf's compute function
+    leaf_vector_[i]->computeData();
 
-    leaf_vector_.push_back(leaf_container);
+    std::array<uindex_t, 27> neighbors;
+    neighbor_offsets_[i + 1] =
+        static_cast<uindex_t>(find_neighbors(leaf_keys[i], neighbors));
+  }
+  for (std::ptrdiff_t i = 0; i < nr_leaves; ++i)
+    neighbor_offsets_[i + 1] += neighbor_offsets_[i];
+
+  neighbor_indices_.resize(neighbor_offsets_.back());
+#pragma omp parallel for default(none)                                                 \
+    shared(leaf_keys, find_neighbors) firstprivate(nr_leaves) num_threads(threads_)
+  for (std::ptrdiff_t i = 0; i < nr_leaves; ++i) {
+    std::array<uindex_t, 27> neighbors;
+    const std::size_t nr_neighbors = find_neighbors(leaf_keys[i], neighbors);
+
+    LeafContainerT* leaf_container = leaf_vector_[i];
+    leaf_container->reserveNeighbors(nr_neighbors);
+    for (std::size_t j = 0; j < nr_neighbors; ++j) {
+      neighbor_indices_[neighbor_offsets_[i] + j] = neighbors[j];
+      leaf_container->addNeighbor(leaf_vector_[neighbors[j]]);
+    }
   }
-  // Make sure our leaf vector is correctly sized
-  assert(leaf_vector_.size() == this->getLeafCount());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -164,6 +278,15 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   container->addPoint(point);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+void
+pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::
+    addPointIdxToLeaf(LeafContainerT& leaf_arg, const uindex_t point_idx_arg)
+{
+  leaf_arg.addPoint((*this->input_)[point_idx_arg]);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename LeafContainerT, typename BranchContainerT>
 void
@@ -226,8 +349,9 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   // TODO Change this to use leaf centers, not centroids!
 
   voxel_adjacency_graph.clear();
-  // Add a vertex for each voxel, store ids in map
-  std::map<LeafContainerT*, VoxelID> leaf_vertex_id_map;
+  // Add a vertex for each voxel, the leaves are iterated in the order of leaf_vector_
+  std::vector<VoxelID> leaf_vertex_ids;
+  leaf_vertex_ids.reserve(leaf_vector_.size());
   for (typename OctreeAdjacencyT::LeafNodeDepthFirstIterator leaf_itr =
            this->leaf_depth_begin();
        leaf_itr != this->leaf_depth_end();
@@ -238,22 +362,19 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
     VoxelID node_id = add_vertex(voxel_adjacency_graph);
 
     voxel_adjacency_graph[node_id] = centroid_point;
-    LeafContainerT* leaf_container = &(leaf_itr.getLeafContainer());
-    leaf_vertex_id_map[leaf_container] = node_id;
+    leaf_vertex_ids.push_back(node_id);
   }
 
-  // Iterate through and add edges to adjacency graph
-  for (auto leaf_itr = leaf_vector_.begin(); leaf_itr != leaf_vector_.end();
-       ++leaf_itr) {
-    VoxelID u = (leaf_vertex_id_map.find(*leaf_itr))->second;
+  // Iterate through the compressed rows and add edges to adjacency graph
+  for (std::size_t leaf_idx = 0; leaf_idx + 1 < neighbor_offsets_.size(); ++leaf_idx) {
+    VoxelID u = leaf_vertex_ids[leaf_idx];
     PointT p_u = voxel_adjacency_graph[u];
-    for (auto neighbor_itr = (*leaf_itr)->cbegin(), neighbor_end = (*leaf_itr)->cend();
-         neighbor_itr != neighbor_end;
-         ++neighbor_itr) {
-      LeafContainerT* neighbor_container = *neighbor_itr;
+    for (uindex_t neighbor_idx = neighbor_offsets_[leaf_idx];
+         neighbor_idx < neighbor_offsets_[leaf_idx + 1];
+         ++neighbor_idx) {
       EdgeID edge;
       bool edge_added;
-      VoxelID v = (leaf_vertex_id_map.find(neighbor_container))->second;
+      VoxelID v = leaf_vertex_ids[neighbor_indices_[neighbor_idx]];
       boost::tie(edge, edge_added) = add_edge(u, v, voxel_adjacency_graph);
 
       PointT p_v = voxel_adjacency_graph[v];
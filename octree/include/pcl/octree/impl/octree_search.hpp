@@ -39,16 +39,22 @@
 #ifndef PCL_OCTREE_SEARCH_IMPL_H_
 #define PCL_OCTREE_SEARCH_IMPL_H_
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
 
 namespace pcl {
 
 namespace octree {
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 bool
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::voxelSearch(
-    const PointT& point, Indices& point_idx_data)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    voxelSearch(const PointT& point, Indices& point_idx_data)
 {
   assert(isFinite(point) &&
          "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
@@ -68,35 +74,60 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::voxelSearch(
   return (b_success);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 bool
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::voxelSearch(
-    const uindex_t index, Indices& point_idx_data)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    voxelSearch(const uindex_t index, Indices& point_idx_data)
 {
   const PointT search_point = this->getPointByIndex(index);
   return (this->voxelSearch(search_point, point_idx_data));
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::nearestKSearch(
-    const PointT& p_q,
-    uindex_t k,
-    Indices& k_indices,
-    std::vector<float>& k_sqr_distances)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    nearestKSearch(const PointT& p_q,
+                   uindex_t k,
+                   Indices& k_indices,
+                   std::vector<float>& k_sqr_distances)
 {
   assert(this->leaf_count_ > 0);
   assert(isFinite(p_q) &&
          "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
 
+  std::vector<prioPointQueueEntry> point_candidates;
+  Indices leaf_indices;
+
+  return (getKNearestNeighbors(
+      p_q, k, k_indices, k_sqr_distances, point_candidates, leaf_indices));
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
+uindex_t
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    getKNearestNeighbors(const PointT& p_q,
+                         uindex_t k,
+                         Indices& k_indices,
+                         std::vector<float>& k_sqr_distances,
+                         std::vector<prioPointQueueEntry>& point_candidates,
+                         Indices& leaf_indices) const
+{
   k_indices.clear();
   k_sqr_distances.clear();
 
   if (k < 1)
     return 0;
 
-  prioPointQueueEntry point_entry;
-  std::vector<prioPointQueueEntry> point_candidates;
+  point_candidates.clear();
 
   OctreeKey key;
   key.x = key.y = key.z = 0;
@@ -104,8 +135,17 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::nearestKSearch
   // initialize smallest point distance in search with high value
   double smallest_dist = std::numeric_limits<double>::max();
 
-  getKNearestNeighborRecursive(
-      p_q, k, this->root_node_, key, 1, smallest_dist, point_candidates);
+  getKNearestNeighborRecursive(p_q,
+                               k,
+                               this->root_node_,
+                               key,
+                               1,
+                               smallest_dist,
+                               point_candidates,
+                               leaf_indices);
+
+  // turn the max-heap of candidates into a list sorted by distance
+  std::sort_heap(point_candidates.begin(), point_candidates.end());
 
   const auto result_count = static_cast<uindex_t>(point_candidates.size());
 
@@ -120,19 +160,28 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::nearestKSearch
   return k_indices.size();
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::nearestKSearch(
-    uindex_t index, uindex_t k, Indices& k_indices, std::vector<float>& k_sqr_distances)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    nearestKSearch(uindex_t index,
+                   uindex_t k,
+                   Indices& k_indices,
+                   std::vector<float>& k_sqr_distances)
 {
   const PointT search_point = this->getPointByIndex(index);
   return (nearestKSearch(search_point, k, k_indices, k_sqr_distances));
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::approxNearestSearch(
-    const PointT& p_q, index_t& result_index, float& sqr_distance)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    approxNearestSearch(const PointT& p_q, index_t& result_index, float& sqr_distance)
 {
   assert(this->leaf_count_ > 0);
   assert(isFinite(p_q) &&
@@ -147,24 +196,32 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::approxNearestS
   return;
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::approxNearestSearch(
-    uindex_t query_index, index_t& result_index, float& sqr_distance)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    approxNearestSearch(uindex_t query_index,
+                        index_t& result_index,
+                        float& sqr_distance)
 {
   const PointT search_point = this->getPointByIndex(query_index);
 
   return (approxNearestSearch(search_point, result_index, sqr_distance));
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch(
-    const PointT& p_q,
-    const double radius,
-    Indices& k_indices,
-    std::vector<float>& k_sqr_distances,
-    uindex_t max_nn) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    radiusSearch(const PointT& p_q,
+                 const double radius,
+                 Indices& k_indices,
+                 std::vector<float>& k_sqr_distances,
+                 uindex_t max_nn) const
 {
   assert(isFinite(p_q) &&
          "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
@@ -186,26 +243,32 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch(
   return k_indices.size();
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch(
-    uindex_t index,
-    const double radius,
-    Indices& k_indices,
-    std::vector<float>& k_sqr_distances,
-    uindex_t max_nn) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    radiusSearch(uindex_t index,
+                 const double radius,
+                 Indices& k_indices,
+                 std::vector<float>& k_sqr_distances,
+                 uindex_t max_nn) const
 {
   const PointT search_point = this->getPointByIndex(index);
 
   return (radiusSearch(search_point, radius, k_indices, k_sqr_distances, max_nn));
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearch(
-    const Eigen::Vector3f& min_pt,
-    const Eigen::Vector3f& max_pt,
-    Indices& k_indices) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    boxSearch(const Eigen::Vector3f& min_pt,
+              const Eigen::Vector3f& max_pt,
+              Indices& k_indices) const
 {
 
   OctreeKey key;
@@ -218,9 +281,107 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearch(
   return k_indices.size();
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
+void
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    nearestKSearch(const PointCloud& cloud,
+                   const Indices& indices,
+                   uindex_t k,
+                   std::vector<Indices>& k_indices,
+                   std::vector<std::vector<float>>& k_sqr_distances) const
+{
+  const auto nr_queries =
+      static_cast<std::ptrdiff_t>(indices.empty() ? cloud.size() : indices.size());
+  k_indices.resize(nr_queries);
+  k_sqr_distances.resize(nr_queries);
+
+  // every thread works on its own copy of the buffers, reused for all of its queries
+  std::vector<prioPointQueueEntry> point_candidates;
+  Indices leaf_indices;
+
+#pragma omp parallel for default(none)                                                 \
+    shared(cloud, indices, k_indices, k_sqr_distances)                                 \
+    firstprivate(k, nr_queries, point_candidates, leaf_indices) schedule(dynamic, 64)  \
+    num_threads(this->threads_)
+  for (std::ptrdiff_t i = 0; i < nr_queries; ++i) {
+    const PointT& query_point = cloud[indices.empty() ? i : indices[i]];
+    if (!isFinite(query_point)) {
+      k_indices[i].clear();
+      k_sqr_distances[i].clear();
+      continue;
+    }
+    getKNearestNeighbors(query_point,
+                         k,
+                         k_indices[i],
+                         k_sqr_distances[i],
+                         point_candidates,
+                         leaf_indices);
+  }
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
+void
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    radiusSearch(const PointCloud& cloud,
+                 const Indices& indices,
+                 double radius,
+                 std::vector<Indices>& k_indices,
+                 std::vector<std::vector<float>>& k_sqr_distances,
+                 uindex_t max_nn) const
+{
+  const auto nr_queries =
+      static_cast<std::ptrdiff_t>(indices.empty() ? cloud.size() : indices.size());
+  k_indices.resize(nr_queries);
+  k_sqr_distances.resize(nr_queries);
+
+#pragma omp parallel for default(none)                                                 \
+    shared(cloud, indices, k_indices, k_sqr_distances)                                 \
+    firstprivate(radius, max_nn, nr_queries) schedule(dynamic, 64)                     \
+    num_threads(this->threads_)
+  for (std::ptrdiff_t i = 0; i < nr_queries; ++i) {
+    const PointT& query_point = cloud[indices.empty() ? i : indices[i]];
+    if (!isFinite(query_point)) {
+      k_indices[i].clear();
+      k_sqr_distances[i].clear();
+      continue;
+    }
+    radiusSearch(query_point, radius, k_indices[i], k_sqr_distances[i], max_nn);
+  }
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
+void
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    boxSearch(const std::vector<Eigen::Vector3f>& min_pts,
+              const std::vector<Eigen::Vector3f>& max_pts,
+              std::vector<Indices>& k_indices) const
+{
+  assert(min_pts.size() == max_pts.size());
+
+  const auto nr_queries = static_cast<std::ptrdiff_t>(min_pts.size());
+  k_indices.resize(nr_queries);
+
+#pragma omp parallel for default(none) shared(min_pts, max_pts, k_indices)             \
+    firstprivate(nr_queries) schedule(dynamic, 64) num_threads(this->threads_)
+  for (std::ptrdiff_t i = 0; i < nr_queries; ++i)
+    boxSearch(min_pts[i], max_pts[i], k_indices[i]);
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 double
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
     getKNearestNeighborRecursive(
         const PointT& point,
         uindex_t K,
@@ -228,10 +389,10 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
         const OctreeKey& key,
         uindex_t tree_depth,
         const double squared_search_radius,
-        std::vector<prioPointQueueEntry>& point_candidates) const
+        std::vector<prioPointQueueEntry>& point_candidates,
+        Indices& leaf_indices) const
 {
-  std::vector<prioBranchQueueEntry> search_heap;
-  search_heap.resize(8);
+  std::array<prioBranchQueueEntry, 8> search_heap;
 
   OctreeKey new_key;
 
@@ -264,18 +425,19 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
 
   std::sort(search_heap.begin(), search_heap.end());
 
-  // iterate over all children in priority queue
+  // iterate over all children in priority queue, the closest one is at the back
   // check if the distance to search candidate is smaller than the best point distance
   // (smallest_squared_dist)
-  while ((!search_heap.empty()) &&
-         (search_heap.back().point_distance <
+  std::size_t search_heap_size = search_heap.size();
+  while ((search_heap_size > 0) &&
+         (search_heap[search_heap_size - 1].point_distance <
           smallest_squared_dist + voxelSquaredDiameter / 4.0 +
               sqrt(smallest_squared_dist * voxelSquaredDiameter) - this->epsilon_)) {
     const OctreeNode* child_node;
 
     // read from priority queue element
-    child_node = search_heap.back().node;
-    new_key = search_heap.back().key;
+    child_node = search_heap[search_heap_size - 1].node;
+    new_key = search_heap[search_heap_size - 1].key;
 
     if (child_node->getNodeType() == BRANCH_NODE) {
       // we have not reached maximum tree depth
@@ -286,19 +448,19 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
                                        new_key,
                                        tree_depth + 1,
                                        smallest_squared_dist,
-                                       point_candidates);
+                                       point_candidates,
+                                       leaf_indices);
     }
     else {
       // we reached leaf node level
-      Indices decoded_point_vector;
-
       const auto* child_leaf = static_cast<const LeafNode*>(child_node);
 
-      // decode leaf node into decoded_point_vector
-      (*child_leaf)->getPointIndices(decoded_point_vector);
+      // decode leaf node into leaf_indices
+      leaf_indices.clear();
+      (*child_leaf)->getPointIndices(leaf_indices);
 
       // Linearly iterate over all decoded (unsorted) points
-      for (const auto& point_index : decoded_point_vector) {
+      for (const auto& point_index : leaf_indices) {
 
         const PointT& candidate_point = this->getPointByIndex(point_index);
 
@@ -307,32 +469,32 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
 
         // check if a closer match is found
         if (squared_dist < smallest_squared_dist) {
-          prioPointQueueEntry point_entry;
-
-          point_entry.point_distance_ = squared_dist;
-          point_entry.point_idx_ = point_index;
-          point_candidates.push_back(point_entry);
+          // replace the farthest of K candidates, which is at the top of the max-heap
+          if (point_candidates.size() == K) {
+            std::pop_heap(point_candidates.begin(), point_candidates.end());
+            point_candidates.pop_back();
+          }
+          point_candidates.emplace_back(point_index, squared_dist);
+          std::push_heap(point_candidates.begin(), point_candidates.end());
+
+          if (point_candidates.size() == K)
+            smallest_squared_dist = point_candidates.front().point_distance_;
         }
       }
-
-      std::sort(point_candidates.begin(), point_candidates.end());
-
-      if (point_candidates.size() > K)
-        point_candidates.resize(K);
-
-      if (point_candidates.size() == K)
-        smallest_squared_dist = point_candidates.back().point_distance_;
     }
     // pop element from priority queue
-    search_heap.pop_back();
+    --search_heap_size;
   }
 
   return (smallest_squared_dist);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
     getNeighborsWithinRadiusRecursive(const PointT& point,
                                       const double radiusSquared,
                                       const BranchNode* node,
@@ -389,13 +551,14 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
       else {
         // we reached leaf node level
         const auto* child_leaf = static_cast<const LeafNode*>(child_node);
-        Indices decoded_point_vector;
 
-        // decode leaf node into decoded_point_vector
-        (*child_leaf)->getPointIndices(decoded_point_vector);
+        // decode leaf node straight into the result vector and keep the matches
+        const std::size_t first_decoded = k_indices.size();
+        (*child_leaf)->getPointIndices(k_indices);
 
-        // Linearly iterate over all decoded (unsorted) points
-        for (const auto& index : decoded_point_vector) {
+        std::size_t result_count = first_decoded;
+        for (std::size_t i = first_decoded; i < k_indices.size(); ++i) {
+          const index_t index = k_indices[i];
           const PointT& candidate_point = this->getPointByIndex(index);
 
           // calculate point distance to search point
@@ -406,20 +569,27 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
             continue;
 
           // add point to result vector
-          k_indices.push_back(index);
+          k_indices[result_count++] = index;
           k_sqr_distances.push_back(squared_dist);
 
-          if (max_nn != 0 && k_indices.size() == max_nn)
-            return;
+          if (max_nn != 0 && result_count == max_nn)
+            break;
         }
+        k_indices.resize(result_count);
+
+        if (max_nn != 0 && k_indices.size() == max_nn)
+          return;
       }
     }
   }
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
     approxNearestSearchRecursive(const PointT& point,
                                  const BranchNode* node,
                                  const OctreeKey& key,
@@ -506,23 +676,29 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   }
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 float
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::pointSquaredDist(
-    const PointT& point_a, const PointT& point_b) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    pointSquaredDist(const PointT& point_a, const PointT& point_b) const
 {
   return (point_a.getVector3fMap() - point_b.getVector3fMap()).squaredNorm();
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearchRecursive(
-    const Eigen::Vector3f& min_pt,
-    const Eigen::Vector3f& max_pt,
-    const BranchNode* node,
-    const OctreeKey& key,
-    uindex_t tree_depth,
-    Indices& k_indices) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    boxSearchRecursive(const Eigen::Vector3f& min_pt,
+                       const Eigen::Vector3f& max_pt,
+                       const BranchNode* node,
+                       const OctreeKey& key,
+                       uindex_t tree_depth,
+                       Indices& k_indices) const
 {
   // iterate over all children
   for (unsigned char child_idx = 0; child_idx < 8; child_idx++) {
@@ -563,15 +739,15 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearchRecur
       }
       else {
         // we reached leaf node level
-        Indices decoded_point_vector;
-
         const auto* child_leaf = static_cast<const LeafNode*>(child_node);
 
-        // decode leaf node into decoded_point_vector
-        (**child_leaf).getPointIndices(decoded_point_vector);
+        // decode leaf node straight into the result vector and keep the matches
+        const std::size_t first_decoded = k_indices.size();
+        (**child_leaf).getPointIndices(k_indices);
 
-        // Linearly iterate over all decoded (unsorted) points
-        for (const auto& index : decoded_point_vector) {
+        std::size_t result_count = first_decoded;
+        for (std::size_t i = first_decoded; i < k_indices.size(); ++i) {
+          const index_t index = k_indices[i];
           const PointT& candidate_point = this->getPointByIndex(index);
 
           // check if point falls within search box
@@ -582,16 +758,20 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearchRecur
 
           if (bInBox)
             // add to result vector
-            k_indices.push_back(index);
+            k_indices[result_count++] = index;
         }
+        k_indices.resize(result_count);
       }
     }
   }
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
     getIntersectedVoxelCenters(Eigen::Vector3f origin,
                                Eigen::Vector3f direction,
                                AlignedPointTVector& voxel_center_list,
@@ -625,9 +805,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (0);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
     getIntersectedVoxelIndices(Eigen::Vector3f origin,
                                Eigen::Vector3f direction,
                                Indices& k_indices,
@@ -659,9 +842,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (0);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
     getIntersectedVoxelCentersRecursive(double min_x,
                                         double min_y,
                                         double min_z,
@@ -855,9 +1041,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (voxel_count);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
     getIntersectedVoxelIndicesRecursive(double min_x,
                                         double min_y,
                                         double min_z,
@@ -1048,6 +1237,239 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (voxel_count);
 }
 
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
+void
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    getIntersectedVoxelCenters(const std::vector<Eigen::Vector3f>& origins,
+                               const std::vector<Eigen::Vector3f>& directions,
+                               std::vector<AlignedPointTVector>& voxel_center_lists,
+                               uindex_t max_voxel_count) const
+{
+  voxel_center_lists.resize(origins.size());
+  for (auto& voxel_center_list : voxel_center_lists)
+    voxel_center_list.clear();
+
+  castRayPackets(
+      origins,
+      directions,
+      max_voxel_count,
+      [this, &voxel_center_lists](
+          std::size_t ray_idx, const LeafNode&, const OctreeKey& key) {
+        PointT voxel_center;
+        this->genLeafNodeCenterFromOctreeKey(key, voxel_center);
+        voxel_center_lists[ray_idx].push_back(voxel_center);
+      });
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
+void
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    getIntersectedVoxelIndices(const std::vector<Eigen::Vector3f>& origins,
+                               const std::vector<Eigen::Vector3f>& directions,
+                               std::vector<Indices>& k_indices,
+                               uindex_t max_voxel_count) const
+{
+  k_indices.resize(origins.size());
+  for (auto& ray_indices : k_indices)
+    ray_indices.clear();
+
+  castRayPackets(
+      origins,
+      directions,
+      max_voxel_count,
+      [&k_indices](std::size_t ray_idx, const LeafNode& leaf, const OctreeKey&) {
+        leaf->getPointIndices(k_indices[ray_idx]);
+      });
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeBaseT>
+template <typename LeafVisitorT>
+void
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>::
+    castRayPackets(const std::vector<Eigen::Vector3f>& origins,
+                   const std::vector<Eigen::Vector3f>& directions,
+                   uindex_t max_voxel_count,
+                   const LeafVisitorT& visit_leaf) const
+{
+  assert(origins.size() == directions.size());
+  static_assert(ray_packet_size <= 32, "ray mask has 32 bits");
+
+  const auto nr_rays = static_cast<std::ptrdiff_t>(origins.size());
+
+  // Ray parameters at the bounding box of the octree and child index remapping of
+  // every ray, as for a single ray
+  std::vector<std::array<double, 6>> ray_params(nr_rays);
+  std::vector<unsigned char> ray_octants(nr_rays);
+
+#pragma omp parallel for default(none)                                                 \
+    shared(origins, directions, ray_params, ray_octants) firstprivate(nr_rays)         \
+    num_threads(this->threads_)
+  for (std::ptrdiff_t i = 0; i < nr_rays; ++i) {
+    Eigen::Vector3f origin = origins[i];
+    Eigen::Vector3f direction = directions[i];
+    std::array<double, 6>& params = ray_params[i];
+    initIntersectedVoxel(origin,
+                         direction,
+                         params[0],
+                         params[1],
+                         params[2],
+                         params[3],
+                         params[4],
+                         params[5],
+                         ray_octants[i]);
+  }
+
+  // Rays of the same octant visit the children of a node in the same order, so the
+  // packets are formed from the rays of each octant
+  std::array<std::size_t, 9> octant_begin{};
+  for (const auto octant : ray_octants)
+    ++octant_begin[octant + 1];
+  for (std::size_t octant = 0; octant < 8; ++octant)
+    octant_begin[octant + 1] += octant_begin[octant];
+
+  std::vector<std::size_t> ray_order(nr_rays);
+  {
+    std::array<std::size_t, 9> octant_pos = octant_begin;
+    for (std::ptrdiff_t i = 0; i < nr_rays; ++i)
+      ray_order[octant_pos[ray_octants[i]]++] = i;
+  }
+
+  std::vector<std::size_t> packet_begin;
+  for (std::size_t octant = 0; octant < 8; ++octant)
+    for (std::size_t begin = octant_begin[octant]; begin < octant_begin[octant + 1];
+         begin += ray_packet_size)
+      packet_begin.push_back(begin);
+  packet_begin.push_back(nr_rays);
+
+  const auto nr_packets = static_cast<std::ptrdiff_t>(packet_begin.size()) - 1;
+  // every thread works on its own copy of the stack, reused for all of its packets
+  RayPacketStack stack;
+
+#pragma omp parallel for default(none)                                                 \
+    shared(ray_params, ray_octants, ray_order, packet_begin, visit_leaf)                \
+    firstprivate(max_voxel_count, nr_packets, stack) schedule(dynamic)                 \
+    num_threads(this->threads_)
+  for (std::ptrdiff_t packet = 0; packet < nr_packets; ++packet) {
+    const std::size_t begin = packet_begin[packet];
+    const std::size_t nr_packet_rays =
+        std::min(packet_begin[packet + 1] - begin, ray_packet_size);
+    const unsigned char a = ray_octants[ray_order[begin]];
+
+    // Lanes without a ray stay inactive
+    RayPacketNode root;
+    root.node = this->root_node_;
+    root.key.x = root.key.y = root.key.z = 0;
+    root.ray_mask = 0;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      root.min_t[axis].setZero();
+      root.max_t[axis].setZero();
+    }
+    for (std::size_t lane = 0; lane < nr_packet_rays; ++lane) {
+      const std::array<double, 6>& params = ray_params[ray_order[begin + lane]];
+      for (std::size_t axis = 0; axis < 3; ++axis) {
+        root.min_t[axis](lane) = params[axis];
+        root.max_t[axis](lane) = params[axis + 3];
+      }
+      if (std::max(std::max(params[0], params[1]), params[2]) <
+          std::min(std::min(params[3], params[4]), params[5]))
+        root.ray_mask |= std::uint32_t(1) << lane;
+    }
+
+    std::array<uindex_t, ray_packet_size> voxel_counts{};
+    // rays which have not yet intersected max_voxel_count voxels
+    std::uint32_t active_rays = root.ray_mask;
+
+    stack.clear();
+    if (root.ray_mask)
+      stack.push_back(root);
+
+    while (!stack.empty()) {
+      const RayPacketNode entry = stack.back();
+      stack.pop_back();
+
+      const std::uint32_t ray_mask = entry.ray_mask & active_rays;
+      if (!ray_mask)
+        continue;
+
+      if (entry.node->getNodeType() == LEAF_NODE) {
+        const auto& leaf = static_cast<const LeafNode&>(*entry.node);
+        for (std::size_t lane = 0; lane < nr_packet_rays; ++lane) {
+          if (!(ray_mask & (std::uint32_t(1) << lane)))
+            continue;
+          visit_leaf(ray_order[begin + lane], leaf, entry.key);
+          if (max_voxel_count > 0 && ++voxel_counts[lane] >= max_voxel_count)
+            active_rays &= ~(std::uint32_t(1) << lane);
+        }
+        continue;
+      }
+
+      // Voxel mid lines
+      RayPacketArray mid_t[3];
+      for (std::size_t axis = 0; axis < 3; ++axis)
+        mid_t[axis] = 0.5 * (entry.min_t[axis] + entry.max_t[axis]);
+
+      // All directions of the packet are positive in the remapped space, where a ray
+      // can only enter a child after the children with a subset of its index bits.
+      // Pushing the children in descending order thus makes every ray visit them in
+      // the order in which it intersects them.
+      const auto& branch = static_cast<const BranchNode&>(*entry.node);
+      for (int child = 7; child >= 0; --child) {
+        const auto child_idx = static_cast<unsigned char>(child ^ a);
+        const OctreeNode* child_node = this->getBranchChildPtr(branch, child_idx);
+        if (!child_node)
+          continue;
+
+        stack.emplace_back();
+        RayPacketNode& child_entry = stack.back();
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+          if (child & (4 >> axis)) {
+            child_entry.min_t[axis] = mid_t[axis];
+            child_entry.max_t[axis] = entry.max_t[axis];
+          }
+          else {
+            child_entry.min_t[axis] = entry.min_t[axis];
+            child_entry.max_t[axis] = mid_t[axis];
+          }
+        }
+
+        // Slab test of all rays of the packet against the child
+        const RayPacketArray enter_t = child_entry.min_t[0]
+                                           .max(child_entry.min_t[1])
+                                           .max(child_entry.min_t[2]);
+        const RayPacketArray exit_t = child_entry.max_t[0]
+                                          .min(child_entry.max_t[1])
+                                          .min(child_entry.max_t[2]);
+        const auto hits = (enter_t < exit_t) && (exit_t >= 0.0);
+
+        std::uint32_t child_mask = 0;
+        for (std::size_t lane = 0; lane < nr_packet_rays; ++lane)
+          if (hits(lane))
+            child_mask |= std::uint32_t(1) << lane;
+        child_mask &= ray_mask;
+
+        if (!child_mask) {
+          stack.pop_back();
+          continue;
+        }
+        child_entry.node = child_node;
+        child_entry.ray_mask = child_mask;
+        child_entry.key.x = (entry.key.x << 1) | (!!(child_idx & (1 << 2)));
+        child_entry.key.y = (entry.key.y << 1) | (!!(child_idx & (1 << 1)));
+        child_entry.key.z = (entry.key.z << 1) | (!!(child_idx & (1 << 0)));
+      }
+    }
+  }
+}
+
 } // namespace octree
 } // namespace pcl
 
@@ -436,6 +436,14 @@ public:
   void
   deleteTree();
 
+  /** \brief Free the nodes that were removed from the octree and kept for reuse.
+   * \note Nodes removed from the octree, e.g. the voxels of the previous buffer that
+   * are released by switchBuffers(), are kept in a pool and reused for the nodes
+   * created in the following frames. They are freed by deleteTree() or this method.
+   */
+  void
+  freeNodePools();
+
   /** \brief Delete octree structure of previous buffer. */
   inline void
   deletePreviousBuffer()
@@ -499,6 +507,19 @@ public:
   void
   serializeNewLeafs(std::vector<LeafContainerT*>& leaf_container_vector_arg);
 
+  /** \brief Get the leaf containers of all leaf nodes that did not exist in the
+   * previous buffer, in the same order as serializeNewLeafs(). The octree is not
+   * modified, so the subtrees below the third octree level are searched by separate
+   * threads. Unlike serializeNewLeafs(), serializeTreeCallback() is not called and the
+   * unused nodes of the previous buffer are only released by the next switchBuffers().
+   * \param leaf_container_vector_arg: pointers to the new leaf containers are written
+   * to this vector
+   * \param nr_threads_arg: number of threads to use
+   */
+  void
+  getNewLeafs(std::vector<LeafContainerT*>& leaf_container_vector_arg,
+              unsigned int nr_threads_arg = 1) const;
+
   /** \brief Deserialize a binary octree description vector and create a corresponding
    * octree structure. Leaf nodes are initialized with getDataTByKey(..).
    * \param binary_tree_in_arg: reference to input vector for reading binary tree
@@ -729,14 +750,14 @@ protected:
         // free child branch recursively
         deleteBranch(*static_cast<BranchNode*>(branchChild));
 
-        // delete unused branch
-        delete (branchChild);
+        // push unused branch to branch pool
+        branch_pool_.push_back(static_cast<BranchNode*>(branchChild));
         break;
       }
 
       case LEAF_NODE: {
-        // push unused leaf to branch pool
-        delete (branchChild);
+        // push unused leaf to leaf pool
+        leaf_pool_.push_back(static_cast<LeafNode*>(branchChild));
         break;
       }
       default:
@@ -790,7 +811,16 @@ protected:
   inline BranchNode*
   createBranchChild(BranchNode& branch_arg, unsigned char child_idx_arg)
   {
-    auto* new_branch_child = new BranchNode();
+    BranchNode* new_branch_child;
+    if (branch_pool_.empty())
+      new_branch_child = new BranchNode();
+    else {
+      // reuse a branch that was removed from the octree
+      new_branch_child = branch_pool_.back();
+      branch_pool_.pop_back();
+      new_branch_child->reset();
+      new_branch_child->getContainer() = BranchContainerT();
+    }
 
     branch_arg.setChildPtr(
         buffer_selector_, child_idx_arg, static_cast<OctreeNode*>(new_branch_child));
@@ -798,6 +828,15 @@ protected:
     return new_branch_child;
   }
 
+  /** \brief Create a new branch that is not attached to the tree yet, e.g. a new root
+   *  \return pointer to the new branch
+   */
+  inline BranchNode*
+  createBranch()
+  {
+    return new BranchNode();
+  }
+
   /** \brief Fetch and add a new leaf child to a branch class
    *  \param branch_arg: reference to octree branch class
    *  \param child_idx_arg: index to child node
@@ -806,7 +845,15 @@ protected:
   inline LeafNode*
   createLeafChild(BranchNode& branch_arg, unsigned char child_idx_arg)
   {
-    auto* new_leaf_child = new LeafNode();
+    LeafNode* new_leaf_child;
+    if (leaf_pool_.empty())
+      new_leaf_child = new LeafNode();
+    else {
+      // reuse a leaf that was removed from the octree
+      new_leaf_child = leaf_pool_.back();
+      leaf_pool_.pop_back();
+      new_leaf_child->getContainer() = LeafContainerT();
+    }
 
     branch_arg.setChildPtr(buffer_selector_, child_idx_arg, new_leaf_child);
 
@@ -935,6 +982,27 @@ protected:
   // Helpers
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+  /** \brief Recursively collect the branches at a given depth of the current buffer
+   *  \param branch_arg: current branch node
+   *  \param depth_arg: depth of the current branch node
+   *  \param sub_tree_depth_arg: depth of the branches to collect
+   *  \param sub_trees_arg: the branches are appended to this vector in depth-first order
+   **/
+  void
+  getSubTreesRecursive(const BranchNode* branch_arg,
+                       uindex_t depth_arg,
+                       uindex_t sub_tree_depth_arg,
+                       std::vector<const BranchNode*>& sub_trees_arg) const;
+
+  /** \brief Recursively collect the leafs of the current buffer that did not exist in
+   * the previous buffer
+   *  \param branch_arg: current branch node
+   *  \param leaf_container_vector_arg: the leaf containers are appended to this vector
+   **/
+  void
+  getNewLeafsRecursive(const BranchNode* branch_arg,
+                       std::vector<LeafContainerT*>& leaf_container_vector_arg) const;
+
   /** \brief Recursively explore the octree and remove unused branch and leaf nodes
    *  \param branch_arg: current branch node
    **/
@@ -999,6 +1067,12 @@ protected:
   /** \brief Enable dynamic_depth
    *  \note Note that this parameter is ignored in octree2buf! */
   bool dynamic_depth_enabled_;
+
+  /** \brief Branch nodes removed from the octree, kept for reuse */
+  std::vector<BranchNode*> branch_pool_;
+
+  /** \brief Leaf nodes removed from the octree, kept for reuse */
+  std::vector<LeafNode*> leaf_pool_;
 };
 } // namespace octree
 } // namespace pcl
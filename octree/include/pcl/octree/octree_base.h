@@ -41,6 +41,7 @@
 #include <pcl/octree/octree_container.h>
 #include <pcl/octree/octree_iterator.h>
 #include <pcl/octree/octree_key.h>
+#include <pcl/octree/octree_node_pool.h>
 #include <pcl/octree/octree_nodes.h>
 #include <pcl/pcl_macros.h>
 
@@ -54,14 +55,17 @@ namespace octree {
  * be initially defined).
  * \note All leaf nodes are addressed by integer indices.
  * \note The tree depth equates to the bit length of the voxel indices.
+ * \note Branch and leaf nodes are created and destroyed by NodeAllocatorT, see
+ * OctreeNodeHeapAllocator (default) and OctreeNodeArena.
  * \ingroup octree
  * \author Julius Kammerl (julius@kammerl.de)
  */
 template <typename LeafContainerT = index_t,
-          typename BranchContainerT = OctreeContainerEmpty>
+          typename BranchContainerT = OctreeContainerEmpty,
+          template <typename> class NodeAllocatorT = OctreeNodeHeapAllocator>
 class OctreeBase {
 public:
-  using OctreeT = OctreeBase<LeafContainerT, BranchContainerT>;
+  using OctreeT = OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>;
 
   using BranchNode = OctreeBranchNode<BranchContainerT>;
   using LeafNode = OctreeLeafNode<LeafContainerT>;
@@ -74,6 +78,12 @@ protected:
   // Members
   ///////////////////////////////////////////////////////////////////////
 
+  /** \brief Allocator of the branch nodes   **/
+  NodeAllocatorT<BranchNode> branch_allocator_;
+
+  /** \brief Allocator of the leaf nodes   **/
+  NodeAllocatorT<LeafNode> leaf_allocator_;
+
   /** \brief Amount of leaf nodes   **/
   std::size_t leaf_count_;
 
@@ -317,7 +327,7 @@ public:
   OctreeBase(const OctreeBase& source)
   : leaf_count_(source.leaf_count_)
   , branch_count_(source.branch_count_)
-  , root_node_(new (BranchNode)(*(source.root_node_)))
+  , root_node_(copyBranch(*(source.root_node_)))
   , depth_mask_(source.depth_mask_)
   , octree_depth_(source.octree_depth_)
   , dynamic_depth_enabled_(source.dynamic_depth_enabled_)
@@ -328,11 +338,15 @@ public:
   OctreeBase&
   operator=(const OctreeBase& source)
   {
+    if (this == &source)
+      return (*this);
+
+    deleteTree();
+    branch_allocator_.deallocate(root_node_);
+
     leaf_count_ = source.leaf_count_;
     branch_count_ = source.branch_count_;
-    delete root_node_;
-
-    root_node_ = new (BranchNode)(*(source.root_node_));
+    root_node_ = copyBranch(*(source.root_node_));
     depth_mask_ = source.depth_mask_;
     max_key_ = source.max_key_;
     octree_depth_ = source.octree_depth_;
@@ -603,12 +617,12 @@ protected:
         // free child branch recursively
         deleteBranch(*static_cast<BranchNode*>(branch_child));
         // delete branch node
-        delete branch_child;
+        branch_allocator_.deallocate(static_cast<BranchNode*>(branch_child));
       } break;
 
       case LEAF_NODE: {
         // delete leaf node
-        delete branch_child;
+        leaf_allocator_.deallocate(static_cast<LeafNode*>(branch_child));
         break;
       }
       default:
@@ -639,12 +653,46 @@ protected:
   BranchNode*
   createBranchChild(BranchNode& branch_arg, unsigned char child_idx_arg)
   {
-    auto* new_branch_child = new BranchNode();
+    auto* new_branch_child = branch_allocator_.allocate();
     branch_arg[child_idx_arg] = static_cast<OctreeNode*>(new_branch_child);
 
     return new_branch_child;
   }
 
+  /** \brief Create a new branch that is not attached to the tree yet, e.g. a new root
+   *  \return pointer to the new branch
+   */
+  BranchNode*
+  createBranch()
+  {
+    return branch_allocator_.allocate();
+  }
+
+  /** \brief Recursively copy a branch and all its subchilds
+   *  \param source_arg: branch to copy, possibly of another octree
+   *  \return pointer to the copy, owned by this octree
+   */
+  BranchNode*
+  copyBranch(const BranchNode& source_arg)
+  {
+    BranchNode* new_branch = branch_allocator_.allocate();
+    new_branch->getContainer() = source_arg.getContainer();
+
+    for (unsigned char i = 0; i < 8; i++) {
+      const OctreeNode* child = source_arg.getChildPtr(i);
+      if (!child)
+        continue;
+
+      if (child->getNodeType() == BRANCH_NODE)
+        (*new_branch)[i] = copyBranch(*static_cast<const BranchNode*>(child));
+      else
+        (*new_branch)[i] =
+            leaf_allocator_.allocate(*static_cast<const LeafNode*>(child));
+    }
+
+    return new_branch;
+  }
+
   /** \brief Create and add a new leaf child to a branch class
    *  \param branch_arg: reference to octree branch class
    *  \param child_idx_arg: index to child node
@@ -653,7 +701,7 @@ protected:
   LeafNode*
   createLeafChild(BranchNode& branch_arg, unsigned char child_idx_arg)
   {
-    auto* new_leaf_child = new LeafNode();
+    auto* new_leaf_child = leaf_allocator_.allocate();
     branch_arg[child_idx_arg] = static_cast<OctreeNode*>(new_leaf_child);
 
     return new_leaf_child;
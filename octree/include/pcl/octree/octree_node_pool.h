@@ -37,8 +37,13 @@
 
 #pragma once
 
+#include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace pcl {
@@ -108,5 +113,141 @@ protected:
   std::vector<NodeT*> nodePool_;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief @b Octree node allocator creating every node with new and delete
+ * \note This is the default node allocator of OctreeBase
+ */
+template <typename NodeT>
+class OctreeNodeHeapAllocator {
+public:
+  /** \brief Create a node
+   *  \param args: arguments forwarded to the node constructor
+   *  \return pointer to the new node
+   *  */
+  template <typename... Args>
+  inline NodeT*
+  allocate(Args&&... args)
+  {
+    return new NodeT(std::forward<Args>(args)...);
+  }
+
+  /** \brief Destroy a node created by allocate()
+   *  \param node_arg: node to destroy
+   *  */
+  inline void
+  deallocate(NodeT* node_arg)
+  {
+    delete node_arg;
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief @b Octree node arena
+ * \note Nodes are constructed in place inside large contiguous blocks instead of being
+ * allocated one by one. Destroyed nodes are recycled by subsequent allocations and all
+ * blocks are released together with the arena. Use it as the node allocator of
+ * OctreeBase to avoid millions of small heap allocations when building large octrees:
+ * \code
+ * using OctreeT = pcl::octree::OctreeBase<pcl::octree::OctreeContainerPointIndices,
+ *                                         pcl::octree::OctreeContainerEmpty,
+ *                                         pcl::octree::OctreeNodeArena>;
+ * pcl::octree::OctreePointCloudSearch<pcl::PointXYZ,
+ *                                     pcl::octree::OctreeContainerPointIndices,
+ *                                     pcl::octree::OctreeContainerEmpty,
+ *                                     OctreeT> octree (resolution);
+ * \endcode
+ */
+template <typename NodeT>
+class OctreeNodeArena {
+public:
+  /** \brief Constructor.
+   *  \param block_size_arg: number of nodes per memory block
+   *  */
+  explicit OctreeNodeArena(std::size_t block_size_arg = 4096)
+  : block_size_(block_size_arg > 0 ? block_size_arg : 1), used_in_last_block_(0)
+  {}
+
+  /** \brief Nodes are owned by the arena, it can not be copied. */
+  OctreeNodeArena(const OctreeNodeArena&) = delete;
+
+  /** \brief Release all memory blocks, the nodes must have been deallocated before. */
+  ~OctreeNodeArena()
+  {
+    for (Slot* block : blocks_)
+      block_allocator_.deallocate(block, block_size_);
+  }
+
+  OctreeNodeArena&
+  operator=(const OctreeNodeArena&) = delete;
+
+  /** \brief Construct a node in the arena
+   *  \param args: arguments forwarded to the node constructor
+   *  \return pointer to the new node
+   *  */
+  template <typename... Args>
+  inline NodeT*
+  allocate(Args&&... args)
+  {
+    void* slot;
+    if (!free_slots_.empty()) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    }
+    else {
+      if (blocks_.empty() || used_in_last_block_ == block_size_) {
+        blocks_.push_back(block_allocator_.allocate(block_size_));
+        used_in_last_block_ = 0;
+      }
+      slot = blocks_.back() + used_in_last_block_++;
+    }
+    return new (slot) NodeT(std::forward<Args>(args)...);
+  }
+
+  /** \brief Destroy a node created by allocate() and keep its memory for reuse
+   *  \param node_arg: node to destroy
+   *  */
+  inline void
+  deallocate(NodeT* node_arg)
+  {
+    node_arg->~NodeT();
+    free_slots_.push_back(node_arg);
+  }
+
+  /** \brief Get the number of nodes currently alive in the arena */
+  std::size_t
+  getNodeCount() const
+  {
+    if (blocks_.empty())
+      return 0;
+    return (blocks_.size() - 1) * block_size_ + used_in_last_block_ -
+           free_slots_.size();
+  }
+
+  /** \brief Get the number of memory blocks allocated by the arena */
+  std::size_t
+  getBlockCount() const
+  {
+    return blocks_.size();
+  }
+
+protected:
+  using Slot = typename std::aligned_storage<sizeof(NodeT), alignof(NodeT)>::type;
+
+  /** \brief Number of nodes per block */
+  std::size_t block_size_;
+
+  /** \brief Number of slots handed out from the last block */
+  std::size_t used_in_last_block_;
+
+  /** \brief Allocator of the memory blocks, aligned for nodes holding Eigen members */
+  Eigen::aligned_allocator<Slot> block_allocator_;
+
+  /** \brief Memory blocks of block_size_ uninitialized slots each */
+  std::vector<Slot*> blocks_;
+
+  /** \brief Slots of destroyed nodes */
+  std::vector<void*> free_slots_;
+};
+
 } // namespace octree
 } // namespace pcl
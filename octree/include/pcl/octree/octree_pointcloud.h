@@ -42,11 +42,28 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
+#include <type_traits>
 #include <vector>
 
 namespace pcl {
 namespace octree {
 
+namespace detail {
+/** \brief Tells whether an octree implementation can be filled by a single pass over
+ * the Morton ordered point keys. Double buffered octrees recycle the nodes of their
+ * previous buffer and are therefore always filled point by point.
+ */
+template <typename OctreeT>
+struct supports_bulk_build : std::false_type {};
+
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          template <typename>
+          class NodeAllocatorT>
+struct supports_bulk_build<OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>>
+: std::true_type {};
+} // namespace detail
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /** \brief @b Octree pointcloud class
  *  \note Octree implementation for pointclouds. Only indices are stored by the octree
@@ -189,7 +206,23 @@ public:
     return this->octree_depth_;
   }
 
-  /** \brief Add points from input point cloud to octree. */
+  /** \brief Set the number of threads used to build the octree. By default, a single
+   * thread is used.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value to
+   * automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Add points from input point cloud to octree.
+   * \note If the octree is empty and has a fixed depth, the octree keys of all points
+   * are computed in parallel, sorted in Morton order and the tree is built in a single
+   * pass over the sorted keys. The resulting octree is the same as when adding the
+   * points one by one.
+   * \note The single pass build does not call \a addPointIdx, each point is handed to
+   * \a addPointIdxToLeaf instead. Subclasses which hook point insertion by overriding
+   * \a addPointIdx have to override \a addPointIdxToLeaf as well.
+   */
   void
   addPointsFromInputCloud();
 
@@ -424,12 +457,38 @@ public:
 
 protected:
   /** \brief Add point at index from input pointcloud dataset to octree
+   * \note addPointsFromInputCloud() bypasses this method when it builds an empty octree
+   * in a single pass, see \a addPointIdxToLeaf.
    * \param[in] point_idx_arg the index representing the point in the dataset given by
    * \a setInputCloud to be added
    */
   virtual void
   addPointIdx(uindex_t point_idx_arg);
 
+  /** \brief Add the given points to an empty octree in a single pass over their Morton
+   * ordered octree keys. The bounding box has to contain all points already.
+   * \param[in] point_indices_arg indices of the points in the dataset given by \a
+   * setInputCloud, in insertion order
+   * \return "false" if the octree cannot be built this way (it is not empty, has a
+   * dynamic depth, is double buffered or too deep for 64 bit Morton codes); nothing is
+   * added in that case
+   */
+  bool
+  addPointsBulk(const Indices& point_indices_arg);
+
+  /** \brief Add a point to a leaf container created by \a addPointsBulk.
+   * \note Octrees whose leaves store point data instead of indices, or which hook point
+   * insertion, override this together with \a addPointIdx.
+   * \param[in] leaf_arg the leaf container the point falls into
+   * \param[in] point_idx_arg index of the point in the dataset given by \a
+   * setInputCloud
+   */
+  virtual void
+  addPointIdxToLeaf(LeafContainerT& leaf_arg, uindex_t point_idx_arg)
+  {
+    leaf_arg.addPointIndex(point_idx_arg);
+  }
+
   /** \brief Add point at index from input pointcloud dataset to octree
    * \param[in] leaf_node to be expanded
    * \param[in] parent_branch parent of leaf node to be expanded
@@ -496,7 +555,7 @@ protected:
    * \param[in] point_arg the point addressing a voxel
    * \param[out] key_arg write octree key to this reference
    */
-  void
+  virtual void
   genOctreeKeyforPoint(const PointT& point_arg, OctreeKey& key_arg) const;
 
   /** \brief Generate octree key for voxel at a given point
@@ -597,6 +656,9 @@ protected:
    *  \note zero indicates a fixed/maximum depth octree structure
    * **/
   std::size_t max_objs_per_leaf_;
+
+  /** \brief The number of threads used to build the octree. */
+  unsigned int threads_;
 };
 
 } // namespace octree
@@ -137,6 +137,10 @@ public:
   OctreePointCloudAdjacency(const double resolution_arg);
 
   /** \brief Adds points from cloud to the octree.
+   *
+   * The neighbors of all voxels are searched in parallel with the number of threads
+   * set with setNumberOfThreads(), looking up the keys of the 26 adjacent voxels in a
+   * hash table of the leaf keys instead of descending the tree for each of them.
    *
    * \note This overrides addPointsFromInputCloud() from the OctreePointCloud class. */
   void
@@ -161,6 +165,30 @@ public:
   void
   computeVoxelAdjacencyGraph(VoxelAdjacencyList& voxel_adjacency_graph);
 
+  /** \brief Gets the offsets of the voxel adjacency in compressed sparse row form.
+   *
+   * The neighbors of the voxel at(i) are the voxels at(getNeighborIndices()[j]) for
+   * getNeighborOffsets()[i] <= j < getNeighborOffsets()[i + 1]. As in the neighbor
+   * lists of the leaf containers, every voxel is a neighbor of itself.
+   *
+   * \returns size() + 1 offsets into getNeighborIndices(), filled by
+   * addPointsFromInputCloud() */
+  inline const std::vector<uindex_t>&
+  getNeighborOffsets() const
+  {
+    return neighbor_offsets_;
+  }
+
+  /** \brief Gets the neighbor indices of the voxel adjacency in compressed sparse row
+   * form, see getNeighborOffsets().
+   *
+   * \returns the indices into the leaf vector of the neighbors of all voxels */
+  inline const std::vector<uindex_t>&
+  getNeighborIndices() const
+  {
+    return neighbor_indices_;
+  }
+
   /** \brief Sets a point transform (and inverse) used to transform the space of the
    * input cloud.
    *
@@ -168,7 +196,9 @@ public:
    * adjacency criterion for points further from the camera.
    *
    * \param[in] transform_func A boost:function pointer to the transform to be used. The
-   * transform must have one parameter (a point) which it modifies in place. */
+   * transform must have one parameter (a point) which it modifies in place.
+   * \note When more than one thread is set with setNumberOfThreads(), the transform is
+   * called from several threads at once and has to be thread safe. */
   void
   setTransformFunction(std::function<void(PointT& p)> transform_func)
   {
@@ -197,6 +227,14 @@ protected:
   void
   addPointIdx(uindex_t point_idx_arg) override;
 
+  /** \brief Add a point to a leaf container created by a bulk build of the octree.
+   *
+   * \param[in] leaf_arg The leaf container the point falls into
+   * \param[in] point_idx_arg The index of the point in the dataset given by
+   * setInputCloud() */
+  void
+  addPointIdxToLeaf(LeafContainerT& leaf_arg, uindex_t point_idx_arg) override;
+
   /** \brief Fills in the neighbors fields for new voxels.
    *
    * \param[in] key_arg Key of the voxel to check neighbors for
@@ -205,12 +243,19 @@ protected:
   void
   computeNeighbors(OctreeKey& key_arg, LeafContainerT* leaf_container);
 
+  /** \brief Fills in the neighbors of all voxels of the leaf vector and the
+   * compressed sparse row adjacency.
+   *
+   * \param[in] leaf_keys Keys of the voxels, in the order of the leaf vector */
+  void
+  computeAdjacency(const std::vector<OctreeKey>& leaf_keys);
+
   /** \brief Generates octree key for specified point (uses transform if provided).
    *
    * \param[in] point_arg Point to generate key for
    * \param[out] key_arg Resulting octree key */
   void
-  genOctreeKeyforPoint(const PointT& point_arg, OctreeKey& key_arg) const;
+  genOctreeKeyforPoint(const PointT& point_arg, OctreeKey& key_arg) const override;
 
 private:
   /** \brief Add point at given index from input point cloud to octree.
@@ -232,10 +277,17 @@ private:
   using OctreePointCloudT::min_y_;
   using OctreePointCloudT::min_z_;
   using OctreePointCloudT::resolution_;
+  using OctreePointCloudT::threads_;
 
   /// Local leaf pointer vector used to make iterating through leaves fast.
   LeafVectorT leaf_vector_;
 
+  /// Offsets of the neighbors of each leaf in neighbor_indices_.
+  std::vector<uindex_t> neighbor_offsets_;
+
+  /// Leaf vector indices of the neighbors of all leaves.
+  std::vector<uindex_t> neighbor_indices_;
+
   std::function<void(PointT& p)> transform_func_;
 };
 
@@ -39,7 +39,7 @@
 
 #pragma once
 
-#include <list> // for std::list
+#include <vector> // for std::vector
 
 namespace pcl {
 
@@ -58,7 +58,8 @@ class OctreePointCloudAdjacencyContainer : public OctreeContainerBase {
   friend class OctreePointCloudAdjacency;
 
 public:
-  using NeighborListT = std::list<OctreePointCloudAdjacencyContainer<PointInT, DataT>*>;
+  using NeighborListT =
+      std::vector<OctreePointCloudAdjacencyContainer<PointInT, DataT>*>;
   using const_iterator = typename NeighborListT::const_iterator;
   // const iterators to neighbors
   inline const_iterator
@@ -183,6 +184,15 @@ protected:
     data_ = DataT();
   }
 
+  /** \brief Reserve memory for the neighbors of the voxel.
+   * \param[in] nr_neighbors the number of neighbors that will be added
+   */
+  void
+  reserveNeighbors(std::size_t nr_neighbors)
+  {
+    neighbors_.reserve(nr_neighbors);
+  }
+
   /** \brief Add new neighbor to voxel.
    * \param[in] neighbor the new neighbor to add
    */
@@ -42,6 +42,8 @@
 #include <pcl/octree/octree_pointcloud.h>
 #include <pcl/memory.h>
 
+#include <algorithm>
+
 namespace pcl {
 namespace octree {
 
@@ -85,6 +87,9 @@ public:
   {}
 
   /** \brief Get a indices from all leaf nodes that did not exist in previous buffer.
+   * \note The octree is searched and the indices are copied using the number of
+   * threads set with setNumberOfThreads(). The order of the indices does not depend on
+   * the number of threads.
    * \param indicesVector_arg: results are written to this vector of int indices
    * \param minPointsPerLeaf_arg: minimum amount of points required within leaf node to
    * become serialized.
@@ -96,11 +101,27 @@ public:
   {
 
     std::vector<OctreeContainerPointIndices*> leaf_containers;
-    this->serializeNewLeafs(leaf_containers);
+    this->getNewLeafs(leaf_containers, this->threads_);
+
+    // position of the indices of every leaf in the output vector
+    std::vector<std::size_t> offsets(leaf_containers.size() + 1,
+                                     indicesVector_arg.size());
+    for (std::size_t i = 0; i < leaf_containers.size(); ++i) {
+      const uindex_t leaf_size = leaf_containers[i]->getSize();
+      offsets[i + 1] = offsets[i] + (leaf_size >= minPointsPerLeaf_arg ? leaf_size : 0);
+    }
+    indicesVector_arg.resize(offsets.back());
 
-    for (const auto& leaf_container : leaf_containers) {
-      if (static_cast<uindex_t>(leaf_container->getSize()) >= minPointsPerLeaf_arg)
-        leaf_container->getPointIndices(indicesVector_arg);
+#pragma omp parallel for default(none)                                                 \
+    shared(leaf_containers, offsets, indicesVector_arg) num_threads(this->threads_)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(leaf_containers.size());
+         ++i) {
+      if (offsets[i + 1] > offsets[i]) {
+        const Indices& leaf_indices = leaf_containers[i]->getPointIndicesVector();
+        std::copy(leaf_indices.cbegin(),
+                  leaf_indices.cend(),
+                  indicesVector_arg.begin() + offsets[i]);
+      }
     }
 
     return (indicesVector_arg.size());
@@ -175,6 +175,16 @@ public:
     container->addPoint(point);
   }
 
+  /** \brief Add a point to a leaf container created by a bulk build of the octree.
+   * \param[in] leaf_arg leaf container the point falls into
+   * \param[in] point_idx_arg index of the point in the input cloud
+   */
+  void
+  addPointIdxToLeaf(LeafContainerT& leaf_arg, const uindex_t point_idx_arg) override
+  {
+    leaf_arg.addPoint((*this->input_)[point_idx_arg]);
+  }
+
   /** \brief Get centroid for a single voxel addressed by a PointT point.
    * \param[in] point_arg point addressing a voxel in octree
    * \param[out] voxel_centroid_arg centroid is written to this PointT reference
@@ -48,14 +48,17 @@ namespace octree {
  * \note This class provides several methods for spatial neighbor search based on octree
  * structure
  * \tparam PointT type of point used in pointcloud
+ * \tparam OctreeBaseT underlying octree, e.g. an OctreeBase allocating its nodes from
+ * an OctreeNodeArena
  * \ingroup octree
  * \author Julius Kammerl (julius@kammerl.de)
  */
 template <typename PointT,
           typename LeafContainerT = OctreeContainerPointIndices,
-          typename BranchContainerT = OctreeContainerEmpty>
+          typename BranchContainerT = OctreeContainerEmpty,
+          typename OctreeBaseT = OctreeBase<LeafContainerT, BranchContainerT>>
 class OctreePointCloudSearch
-: public OctreePointCloud<PointT, LeafContainerT, BranchContainerT> {
+: public OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeBaseT> {
 public:
   // public typedefs
   using IndicesPtr = shared_ptr<Indices>;
@@ -66,15 +69,18 @@ public:
   using PointCloudConstPtr = typename PointCloud::ConstPtr;
 
   // Boost shared pointers
-  using Ptr =
-      shared_ptr<OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>>;
-  using ConstPtr = shared_ptr<
-      const OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>>;
+  using Ptr = shared_ptr<
+      OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>>;
+  using ConstPtr = shared_ptr<const OctreePointCloudSearch<PointT,
+                                                           LeafContainerT,
+                                                           BranchContainerT,
+                                                           OctreeBaseT>>;
 
   // Eigen aligned allocator
   using AlignedPointTVector = std::vector<PointT, Eigen::aligned_allocator<PointT>>;
 
-  using OctreeT = OctreePointCloud<PointT, LeafContainerT, BranchContainerT>;
+  using OctreeT =
+      OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>;
   using LeafNode = typename OctreeT::LeafNode;
   using BranchNode = typename OctreeT::BranchNode;
 
@@ -82,7 +88,7 @@ public:
    * \param[in] resolution octree resolution at lowest octree level
    */
   OctreePointCloudSearch(const double resolution)
-  : OctreePointCloud<PointT, LeafContainerT, BranchContainerT>(resolution)
+  : OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeBaseT>(resolution)
   {}
 
   /** \brief Search for neighbors within a voxel at given point
@@ -286,6 +292,95 @@ public:
             const Eigen::Vector3f& max_pt,
             Indices& k_indices) const;
 
+  /** \brief Search for the k-nearest neighbors of several query points in parallel.
+   * \note Every thread reuses its candidate queue for all of its queries. Invalid
+   * (NaN, Inf) query points get no neighbors.
+   * \param[in] cloud the point cloud data holding the query points
+   * \param[in] indices the indices in \a cloud of the query points. If empty, all
+   * points of \a cloud are queried.
+   * \param[in] k the number of neighbors to search for
+   * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i]
+   * corresponds to the neighbors of the query point i
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points, k_sqr_distances[i] corresponds to the neighbors of the query point i
+   */
+  void
+  nearestKSearch(const PointCloud& cloud,
+                 const Indices& indices,
+                 uindex_t k,
+                 std::vector<Indices>& k_indices,
+                 std::vector<std::vector<float>>& k_sqr_distances) const;
+
+  /** \brief Search for all neighbors of several query points within a given radius in
+   * parallel.
+   * \note Invalid (NaN, Inf) query points get no neighbors.
+   * \param[in] cloud the point cloud data holding the query points
+   * \param[in] indices the indices in \a cloud of the query points. If empty, all
+   * points of \a cloud are queried.
+   * \param[in] radius the radius of the spheres bounding the neighbors
+   * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i]
+   * corresponds to the neighbors of the query point i
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points, k_sqr_distances[i] corresponds to the neighbors of the query point i
+   * \param[in] max_nn if given, bounds the maximum returned neighbors per query point
+   */
+  void
+  radiusSearch(const PointCloud& cloud,
+               const Indices& indices,
+               double radius,
+               std::vector<Indices>& k_indices,
+               std::vector<std::vector<float>>& k_sqr_distances,
+               uindex_t max_nn = 0) const;
+
+  /** \brief Search for the points within several rectangular search areas in parallel.
+   * Points exactly on the edges of a search rectangle are included.
+   * \param[in] min_pts lower corners of the search areas
+   * \param[in] max_pts upper corners of the search areas
+   * \param[out] k_indices the resultant point indices, k_indices[i] corresponds to the
+   * search area i
+   */
+  void
+  boxSearch(const std::vector<Eigen::Vector3f>& min_pts,
+            const std::vector<Eigen::Vector3f>& max_pts,
+            std::vector<Indices>& k_indices) const;
+
+  /** \brief Get the centers of the voxels intersected by several rays in parallel.
+   * \note The rays are traversed in packets of \ref ray_packet_size rays with the same
+   * direction octant, whose intersections with the children of a node are computed
+   * together. The voxels of every ray are in the order in which it intersects them,
+   * as for a single ray.
+   * \param[in] origins ray origins
+   * \param[in] directions ray direction vectors
+   * \param[out] voxel_center_lists the resultant voxel centers, voxel_center_lists[i]
+   * corresponds to the ray i
+   * \param[in] max_voxel_count stop raycasting when this many voxels are intersected by
+   * a ray, e.g. 1 gives the first voxel hit by every ray (0: disable)
+   */
+  void
+  getIntersectedVoxelCenters(const std::vector<Eigen::Vector3f>& origins,
+                             const std::vector<Eigen::Vector3f>& directions,
+                             std::vector<AlignedPointTVector>& voxel_center_lists,
+                             uindex_t max_voxel_count = 0) const;
+
+  /** \brief Get the indices of the points in the voxels intersected by several rays in
+   * parallel.
+   * \note The rays are traversed in packets, see getIntersectedVoxelCenters().
+   * \param[in] origins ray origins
+   * \param[in] directions ray direction vectors
+   * \param[out] k_indices resulting point indices from intersected voxels, k_indices[i]
+   * corresponds to the ray i
+   * \param[in] max_voxel_count stop raycasting when this many voxels are intersected by
+   * a ray, e.g. 1 gives the first voxel hit by every ray (0: disable)
+   */
+  void
+  getIntersectedVoxelIndices(const std::vector<Eigen::Vector3f>& origins,
+                             const std::vector<Eigen::Vector3f>& directions,
+                             std::vector<Indices>& k_indices,
+                             uindex_t max_voxel_count = 0) const;
+
+  /** \brief Number of rays traversed together by the batched ray casting methods. */
+  static constexpr std::size_t ray_packet_size = 8;
+
 protected:
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Octree-based search routines & helpers
@@ -362,6 +457,51 @@ protected:
     float point_distance_;
   };
 
+  /** \brief Ray parameters of a packet of rays along the axes, one element per ray */
+  using RayPacketArray = Eigen::Array<double, ray_packet_size, 1>;
+
+  /** \brief @b Stack entry of the ray packet traversal
+   *  \note The ray parameters at the lower and upper bounding box corner of the node
+   * are given in the space in which all ray directions of the packet are positive.
+   */
+  struct RayPacketNode {
+    /** \brief Pointer to octree node. */
+    const OctreeNode* node;
+
+    /** \brief Octree key. */
+    OctreeKey key;
+
+    /** \brief Bit mask of the rays intersecting the node. */
+    std::uint32_t ray_mask;
+
+    /** \brief Ray parameters at the lower bounding box corner, per axis. */
+    RayPacketArray min_t[3];
+
+    /** \brief Ray parameters at the upper bounding box corner, per axis. */
+    RayPacketArray max_t[3];
+
+    PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  using RayPacketStack =
+      std::vector<RayPacketNode, Eigen::aligned_allocator<RayPacketNode>>;
+
+  /** \brief Cast several rays through the octree in parallel packets and call a
+   * function for every leaf node intersected by a ray, in the order in which the ray
+   * intersects them.
+   * \param[in] origins ray origins
+   * \param[in] directions ray direction vectors
+   * \param[in] max_voxel_count stop raycasting when this many voxels are intersected by
+   * a ray (0: disable)
+   * \param[in] visit_leaf function called with the ray index, the leaf node and its key
+   */
+  template <typename LeafVisitorT>
+  void
+  castRayPackets(const std::vector<Eigen::Vector3f>& origins,
+                 const std::vector<Eigen::Vector3f>& directions,
+                 uindex_t max_voxel_count,
+                 const LeafVisitorT& visit_leaf) const;
+
   /** \brief Helper function to calculate the squared distance between two points
    * \param[in] point_a point A
    * \param[in] point_b point B
@@ -403,7 +543,9 @@ protected:
    * \param[in] key octree key addressing a leaf node.
    * \param[in] tree_depth current depth/level in the octree
    * \param[in] squared_search_radius squared search radius distance
-   * \param[out] point_candidates priority queue of nearest neighbor point candidates
+   * \param[out] point_candidates priority queue of nearest neighbor point candidates,
+   * kept as a max-heap of at most K entries
+   * \param[in,out] leaf_indices buffer for the point indices decoded from a leaf node
    * \return squared search radius based on current point candidate set found
    */
   double
@@ -414,7 +556,27 @@ protected:
       const OctreeKey& key,
       uindex_t tree_depth,
       const double squared_search_radius,
-      std::vector<prioPointQueueEntry>& point_candidates) const;
+      std::vector<prioPointQueueEntry>& point_candidates,
+      Indices& leaf_indices) const;
+
+  /** \brief Search for k-nearest neighbors at given query point, using the given
+   * buffers instead of allocating new ones
+   * \param[in] p_q the given query point
+   * \param[in] k the number of neighbors to search for
+   * \param[out] k_indices the resultant indices of the neighboring points
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points
+   * \param[in,out] point_candidates buffer for the queue of nearest neighbor candidates
+   * \param[in,out] leaf_indices buffer for the point indices decoded from a leaf node
+   * \return number of neighbors found
+   */
+  uindex_t
+  getKNearestNeighbors(const PointT& p_q,
+                       uindex_t k,
+                       Indices& k_indices,
+                       std::vector<float>& k_sqr_distances,
+                       std::vector<prioPointQueueEntry>& point_candidates,
+                       Indices& leaf_indices) const;
 
   /** \brief Recursive search method that explores the octree and finds the approximate
    * nearest neighbor
@@ -2,11 +2,18 @@
 #ifndef __PCL_OUTOFCORE_LRU_CACHE__
 #define __PCL_OUTOFCORE_LRU_CACHE__
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 template<typename T>
 class LRUCacheItem
@@ -178,4 +185,226 @@ public:
   Cache cache_;
 };
 
+/** \brief Thread-safe least recently used cache with a budget in bytes.
+  *
+  * The keys are distributed over shards by their hash. Every shard has its own lock and an
+  * equal part of the budget, so that threads accessing different keys rarely wait for each
+  * other. A value larger than the part of a shard is stored as long as it fits into the whole
+  * budget; the other shards then evict their least recently used values until the cache fits
+  * into the budget again. The values are shared with the callers; an evicted value stays valid
+  * as long as a caller holds it.
+  */
+template<typename KeyT, typename ValueT, typename HashT = std::hash<KeyT> >
+class ShardedLRUCache
+{
+public:
+
+  using ValuePtr = std::shared_ptr<const ValueT>;
+
+  /** \param[in] capacity budget of the cache in bytes
+    * \param[in] nr_shards number of independently locked parts of the cache
+    */
+  ShardedLRUCache (std::size_t capacity, std::size_t nr_shards = 16) :
+      capacity_ (capacity), size_ (0)
+  {
+    assert (nr_shards != 0);
+    shards_.reserve (nr_shards);
+    for (std::size_t i = 0; i < nr_shards; i++)
+    {
+      shards_.emplace_back (new Shard ());
+      shards_.back ()->capacity = capacity / nr_shards;
+    }
+  }
+
+  /** \brief Returns the value of the key and marks it as most recently used, nullptr if the key is not cached */
+  ValuePtr
+  get (const KeyT& key)
+  {
+    Shard& shard = getShard (key);
+    std::lock_guard<std::mutex> lock (shard.mutex);
+
+    const auto it = shard.index.find (key);
+    if (it == shard.index.end ())
+      return (ValuePtr ());
+
+    shard.entries.splice (shard.entries.end (), shard.entries, it->second);
+    return (it->second->value);
+  }
+
+  bool
+  hasKey (const KeyT& key)
+  {
+    Shard& shard = getShard (key);
+    std::lock_guard<std::mutex> lock (shard.mutex);
+    return (shard.index.find (key) != shard.index.end ());
+  }
+
+  /** \brief Stores the value of the key, replacing a cached one, and evicts the least recently
+    * used values until it fits into the budget.
+    * \param[in] key key of the value
+    * \param[in] value value to store
+    * \param[in] size size of the value in bytes
+    * \return false if the value is larger than the budget of the cache and was not stored
+    */
+  bool
+  insert (const KeyT& key, const ValuePtr& value, std::size_t size)
+  {
+    Shard& shard = getShard (key);
+    {
+      std::lock_guard<std::mutex> lock (shard.mutex);
+
+      const auto it = shard.index.find (key);
+      if (it != shard.index.end ())
+      {
+        size_ -= it->second->size;
+        shard.size -= it->second->size;
+        shard.entries.erase (it->second);
+        shard.index.erase (it);
+      }
+
+      if (size > capacity_)
+        return (false);
+
+      // a value larger than the part of the shard replaces all values of the shard
+      size_ -= shard.evict (shard.capacity > size ? shard.capacity - size : 0);
+      shard.entries.push_back (Entry {key, value, size});
+      shard.index[key] = std::prev (shard.entries.end ());
+      shard.size += size;
+      size_ += size;
+    }
+
+    // only values larger than the part of a shard exceed the budget of the cache
+    evictExcess (&shard);
+    return (true);
+  }
+
+  /** \brief Removes the value of the key */
+  bool
+  erase (const KeyT& key)
+  {
+    Shard& shard = getShard (key);
+    std::lock_guard<std::mutex> lock (shard.mutex);
+
+    const auto it = shard.index.find (key);
+    if (it == shard.index.end ())
+      return (false);
+
+    size_ -= it->second->size;
+    shard.size -= it->second->size;
+    shard.entries.erase (it->second);
+    shard.index.erase (it);
+    return (true);
+  }
+
+  /** \brief Removes all values */
+  void
+  clear ()
+  {
+    for (auto& shard : shards_)
+    {
+      std::lock_guard<std::mutex> lock (shard->mutex);
+      size_ -= shard->evict (0);
+    }
+  }
+
+  /** \brief Returns the size of the cached values in bytes */
+  std::size_t
+  size () const
+  {
+    return (size_);
+  }
+
+  std::size_t
+  getCapacity () const
+  {
+    return (capacity_);
+  }
+
+  /** \brief Sets the budget of the cache in bytes, evicting values if it shrinks */
+  void
+  setCapacity (std::size_t capacity)
+  {
+    capacity_ = capacity;
+    for (auto& shard : shards_)
+    {
+      std::lock_guard<std::mutex> lock (shard->mutex);
+      shard->capacity = capacity / shards_.size ();
+      // keep a single value larger than the part of the shard, if it fits into the budget
+      const bool keep_single = (shard->entries.size () == 1) && (shard->size <= capacity);
+      size_ -= shard->evict (keep_single ? shard->size : shard->capacity);
+    }
+    evictExcess (nullptr);
+  }
+
+private:
+
+  struct Entry
+  {
+    KeyT key;
+    ValuePtr value;
+    std::size_t size;
+  };
+
+  struct Shard
+  {
+    /** \brief Evict the least recently used values until the size is at most max_size, returns the evicted bytes */
+    std::size_t
+    evict (std::size_t max_size)
+    {
+      const std::size_t old_size = size;
+      while (size > max_size && !entries.empty ())
+      {
+        size -= entries.front ().size;
+        index.erase (entries.front ().key);
+        entries.pop_front ();
+      }
+      return (old_size - size);
+    }
+
+    mutable std::mutex mutex;
+
+    // LRU entries[0] ... MRU entries[N]
+    std::list<Entry> entries;
+
+    std::unordered_map<KeyT, typename std::list<Entry>::iterator, HashT> index;
+
+    std::size_t size = 0;
+
+    std::size_t capacity = 0;
+  };
+
+  /** \brief Evicts the least recently used values of the shards other than \b skip until the cache fits into its budget */
+  void
+  evictExcess (const Shard* skip)
+  {
+    for (auto& shard : shards_)
+    {
+      if (shard.get () == skip)
+        continue;
+
+      std::lock_guard<std::mutex> lock (shard->mutex);
+      const std::size_t size = size_;
+      if (size <= capacity_)
+        return;
+      const std::size_t excess = size - capacity_;
+      size_ -= shard->evict (shard->size - std::min (shard->size, excess));
+    }
+  }
+
+  Shard&
+  getShard (const KeyT& key)
+  {
+    // mix the hash, e.g. the hash of aligned pointers has empty low bits
+    const auto hash = static_cast<std::uint64_t> (HashT () (key)) * 0x9E3779B97F4A7C15ULL;
+    return (*shards_[static_cast<std::size_t> (hash >> 32) % shards_.size ()]);
+  }
+
+  std::atomic<std::size_t> capacity_;
+
+  /** \brief Size of the values of all shards in bytes */
+  std::atomic<std::size_t> size_;
+
+  std::vector<std::unique_ptr<Shard> > shards_;
+};
+
 #endif //__PCL_OUTOFCORE_LRU_CACHE__
@@ -7,6 +7,8 @@
 #include <mutex>
 #include <queue>
 
+#include <boost/noncopyable.hpp>
+
 template<typename DataT>
 class MonitorQueue : boost::noncopyable
 {
@@ -24,7 +26,8 @@ public:
   {
     std::unique_lock<std::mutex> lock (monitor_mutex_);
 
-    if (queue_.empty ())
+    // wait in a loop to ignore spurious wakeups
+    while (queue_.empty ())
     {
       item_available_.wait (lock);
     }
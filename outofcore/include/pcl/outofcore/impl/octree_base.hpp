@@ -50,6 +50,8 @@
 #include <pcl/filters/extract_indices.h>
 
 // C++
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -80,6 +82,15 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<pcl::PCLPointCloud2> ())
+      , threads_ (1)
+      , write_buffer_size_ (0)
+      , write_buffers_ ()
+      , buffered_points_ (0)
+      , container_initializer_ ()
+      , node_cache_ (std::size_t (1) << 28)
+      , tasks_ ()
+      , workers_ ()
+      , workers_mutex_ ()
     {
       //validate the root filename
       if (!this->checkExtension (root_name))
@@ -108,6 +119,15 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<pcl::PCLPointCloud2> ())
+      , threads_ (1)
+      , write_buffer_size_ (0)
+      , write_buffers_ ()
+      , buffered_points_ (0)
+      , container_initializer_ ()
+      , node_cache_ (std::size_t (1) << 28)
+      , tasks_ ()
+      , workers_ ()
+      , workers_mutex_ ()
     {
       //Enlarge the bounding box to a cube so our voxels will be cubes
       Eigen::Vector3d tmp_min = min;
@@ -130,6 +150,15 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<pcl::PCLPointCloud2> ())
+      , threads_ (1)
+      , write_buffer_size_ (0)
+      , write_buffers_ ()
+      , buffered_points_ (0)
+      , container_initializer_ ()
+      , node_cache_ (std::size_t (1) << 28)
+      , tasks_ ()
+      , workers_ ()
+      , workers_mutex_ ()
     {
       //Create a new outofcore tree
       this->init (max_depth, min, max, root_node_name, coord_sys);
@@ -188,6 +217,13 @@ namespace pcl
     template<typename ContainerT, typename PointT>
     OutofcoreOctreeBase<ContainerT, PointT>::~OutofcoreOctreeBase ()
     {
+      // finish the pending asynchronous queries
+      for (std::size_t i = 0; i < workers_.size (); i++)
+        tasks_.push (std::function<void ()> ());
+      for (auto &worker : workers_)
+        worker.join ();
+
+      writeBuffersToNodes ();
       root_node_->flushToDiskRecursive ();
 
       saveToFile ();
@@ -211,7 +247,8 @@ namespace pcl
 
       constexpr bool _FORCE_BB_CHECK = true;
       
-      std::uint64_t pt_added = root_node_->addDataToLeaf (p, _FORCE_BB_CHECK);
+      std::uint64_t pt_added = partitionToWriteBuffers (p, false, _FORCE_BB_CHECK);
+      flushWriteBuffersIfFull ();
 
       assert (p.size () == pt_added);
 
@@ -231,7 +268,11 @@ namespace pcl
     template<typename ContainerT, typename PointT> std::uint64_t
     OutofcoreOctreeBase<ContainerT, PointT>::addPointCloud (pcl::PCLPointCloud2::Ptr &input_cloud, const bool skip_bb_check)
     {
+      // Keep the order of the points in the nodes
+      flushWriteBuffers ();
+
       std::uint64_t pt_added = this->root_node_->addPointCloud (input_cloud, skip_bb_check) ;
+      node_cache_.clear ();
 //      assert (input_cloud->width*input_cloud->height == pt_added);
       return (pt_added);
     }
@@ -244,7 +285,8 @@ namespace pcl
     {
       // Lock the tree while writing
       std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
-      std::uint64_t pt_added = root_node_->addDataToLeaf_and_genLOD (point_cloud->points, false);
+      std::uint64_t pt_added = partitionToWriteBuffers (point_cloud->points, true, false);
+      flushWriteBuffersIfFull ();
       return (pt_added);
     }
 
@@ -255,7 +297,9 @@ namespace pcl
     {
       // Lock the tree while writing
       std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+      writeBuffersToNodes ();
       std::uint64_t pt_added = root_node_->addPointCloud_and_genLOD (input_cloud);
+      node_cache_.clear ();
       
       PCL_DEBUG ("[pcl::outofcore::OutofcoreOctreeBase::%s] Points added %lu, points in input cloud, %lu\n",__FUNCTION__, pt_added, input_cloud->width*input_cloud->height );
  
@@ -271,12 +315,444 @@ namespace pcl
     {
       // Lock the tree while writing
       std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
-      std::uint64_t pt_added = root_node_->addDataToLeaf_and_genLOD (src, false);
+      std::uint64_t pt_added = partitionToWriteBuffers (src, true, false);
+      flushWriteBuffersIfFull ();
       return (pt_added);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::setNumberOfThreads (unsigned int nr_threads)
+    {
+      if (nr_threads == 0)
+#ifdef _OPENMP
+        threads_ = omp_get_num_procs ();
+#else
+        threads_ = 1;
+#endif
+      else
+        threads_ = nr_threads;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::setContainerInitializer (const std::function<void (ContainerT&)> &initializer)
+    {
+      std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+      container_initializer_ = initializer;
+      if (!container_initializer_)
+        return;
+
+      // the nodes created or loaded later configure their containers themselves
+      std::vector<OutofcoreNodeType*> nodes (1, root_node_);
+      while (!nodes.empty ())
+      {
+        OutofcoreNodeType* node = nodes.back ();
+        nodes.pop_back ();
+        container_initializer_ (*node->payload_);
+        for (OutofcoreNodeType* child : node->children_)
+          if (child != nullptr)
+            nodes.push_back (child);
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::flushWriteBuffers ()
+    {
+      std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+      writeBuffersToNodes ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::uint64_t
+    OutofcoreOctreeBase<ContainerT, PointT>::partitionToWriteBuffers (const AlignedPointTVector& p, const bool gen_lod, const bool skip_bb_check)
+    {
+      // Node of the tree and its points, which are the positions [begin, end) of order
+      struct NodeRange
+      {
+        OutofcoreNodeType* node;
+        std::size_t begin;
+        std::size_t end;
+      };
+
+      std::vector<std::size_t> order;
+      order.reserve (p.size ());
+      for (std::size_t i = 0; i < p.size (); ++i)
+      {
+        if (skip_bb_check || root_node_->pointInBoundingBox (p[i]))
+          order.push_back (i);
+      }
+
+      if (order.empty ())
+        return (0);
+
+      std::vector<NodeRange> nodes (1, NodeRange {root_node_, 0, order.size ()});
+      std::vector<std::size_t> node_of_position (order.size (), 0);
+      std::vector<std::uint8_t> octants (order.size ());
+      std::vector<std::size_t> sorted (order.size ());
+      std::vector<std::array<std::size_t, 8> > octant_sizes;
+      std::vector<Eigen::Vector3d> centers;
+
+      const std::uint64_t max_depth = this->getDepth ();
+      for (std::uint64_t depth = root_node_->getDepth (); depth < max_depth; ++depth)
+      {
+        if (gen_lod)
+        {
+          // Store a random sample of the points of every node of this level at the node
+          std::uint64_t points_in_lod = 0;
+          for (const NodeRange& range : nodes)
+          {
+            AlignedPointTVector node_points (range.end - range.begin);
+            for (std::size_t i = range.begin; i < range.end; ++i)
+              node_points[i - range.begin] = p[order[i]];
+
+            AlignedPointTVector sample;
+            range.node->randomSample (node_points, sample, true);
+
+            AlignedPointTVector& buffer = write_buffers_[range.node];
+            buffer.insert (buffer.end (), sample.begin (), sample.end ());
+            points_in_lod += sample.size ();
+          }
+          incrementPointsInLOD (depth, points_in_lod);
+          buffered_points_ += points_in_lod;
+        }
+
+        centers.resize (nodes.size ());
+        for (std::size_t n = 0; n < nodes.size (); ++n)
+        {
+          if (nodes[n].node->hasUnloadedChildren ())
+            nodes[n].node->loadChildren (false);
+          centers[n] = nodes[n].node->node_metadata_->getVoxelCenter ();
+        }
+
+        // Assign every point to the octant of its node
+        const auto nr_positions = static_cast<std::ptrdiff_t> (order.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(p, order, node_of_position, octants, centers) \
+  firstprivate(nr_positions) \
+  num_threads(threads_)
+        for (std::ptrdiff_t i = 0; i < nr_positions; ++i)
+        {
+          const PointT& pt = p[order[i]];
+          const Eigen::Vector3d& mid_xyz = centers[node_of_position[i]];
+          octants[i] = static_cast<std::uint8_t> (((pt.z >= mid_xyz[2]) << 2) | ((pt.y >= mid_xyz[1]) << 1) | ((pt.x >= mid_xyz[0]) << 0));
+        }
+
+        // Sort the points of every node by octant, keeping their order within an octant
+        octant_sizes.assign (nodes.size (), std::array<std::size_t, 8> ());
+        const auto nr_nodes = static_cast<std::ptrdiff_t> (nodes.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(nodes, order, octants, sorted, octant_sizes) \
+  firstprivate(nr_nodes) \
+  schedule(dynamic, 1) \
+  num_threads(threads_)
+        for (std::ptrdiff_t n = 0; n < nr_nodes; ++n)
+        {
+          const NodeRange& range = nodes[n];
+          std::array<std::size_t, 8>& sizes = octant_sizes[n];
+          sizes.fill (0);
+          for (std::size_t i = range.begin; i < range.end; ++i)
+            ++sizes[octants[i]];
+
+          std::array<std::size_t, 8> next;
+          next[0] = range.begin;
+          for (std::size_t c = 1; c < 8; ++c)
+            next[c] = next[c - 1] + sizes[c - 1];
+
+          for (std::size_t i = range.begin; i < range.end; ++i)
+            sorted[next[octants[i]]++] = order[i];
+        }
+        order.swap (sorted);
+
+        // Descend into the children, which are created on demand
+        std::vector<NodeRange> children;
+        children.reserve (nodes.size ());
+        for (std::size_t n = 0; n < nodes.size (); ++n)
+        {
+          std::size_t begin = nodes[n].begin;
+          for (std::size_t c = 0; c < 8; ++c)
+          {
+            const std::size_t size = octant_sizes[n][c];
+            if (size == 0)
+              continue;
+            if (!nodes[n].node->children_[c])
+              nodes[n].node->createChild (c);
+            children.push_back (NodeRange {nodes[n].node->children_[c], begin, begin + size});
+            begin += size;
+          }
+        }
+        nodes.swap (children);
+
+        for (std::size_t n = 0; n < nodes.size (); ++n)
+          std::fill (node_of_position.begin () + nodes[n].begin, node_of_position.begin () + nodes[n].end, n);
+      }
+
+      // Copy the points to the write buffers of the nodes at the max depth
+      std::vector<AlignedPointTVector*> buffers (nodes.size ());
+      for (std::size_t n = 0; n < nodes.size (); ++n)
+        buffers[n] = &write_buffers_[nodes[n].node];
+
+      std::uint64_t points_added = 0;
+      const auto nr_nodes = static_cast<std::ptrdiff_t> (nodes.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(p, order, nodes, buffers) \
+  firstprivate(gen_lod, nr_nodes) \
+  reduction(+: points_added) \
+  schedule(dynamic, 1) \
+  num_threads(threads_)
+      for (std::ptrdiff_t n = 0; n < nr_nodes; ++n)
+      {
+        const NodeRange& range = nodes[n];
+        AlignedPointTVector& buffer = *buffers[n];
+        const std::size_t buffered = buffer.size ();
+        buffer.reserve (buffered + range.end - range.begin);
+        for (std::size_t i = range.begin; i < range.end; ++i)
+        {
+          // Only the points inside of the nodes are kept when generating the LOD
+          const PointT& pt = p[order[i]];
+          if (!gen_lod || range.node->pointInBoundingBox (pt))
+            buffer.push_back (pt);
+        }
+        points_added += buffer.size () - buffered;
+      }
+
+      incrementPointsInLOD (max_depth, points_added);
+      buffered_points_ += points_added;
+
+      return (points_added);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::flushWriteBuffersIfFull ()
+    {
+      if (buffered_points_ * sizeof (PointT) > write_buffer_size_)
+        writeBuffersToNodes ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::writeBuffersToNodes ()
+    {
+      std::vector<std::pair<OutofcoreNodeType*, AlignedPointTVector*> > buffers;
+      buffers.reserve (write_buffers_.size ());
+      for (auto& buffer : write_buffers_)
+      {
+        if (!buffer.second.empty ())
+          buffers.emplace_back (buffer.first, &buffer.second);
+      }
+
+      // Every node writes to its own file
+      const auto nr_buffers = static_cast<std::ptrdiff_t> (buffers.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(buffers) \
+  firstprivate(nr_buffers) \
+  schedule(dynamic, 1) \
+  num_threads(threads_)
+      for (std::ptrdiff_t i = 0; i < nr_buffers; ++i)
+      {
+        const AlignedPointTVector& points = *buffers[i].second;
+        buffers[i].first->payload_->insertRange (points.data (), points.size ());
+      }
+
+      write_buffers_.clear ();
+      buffered_points_ = 0;
+      node_cache_.clear ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::submitTask (std::function<void ()> task) const
+    {
+      {
+        std::lock_guard<std::mutex> lock (workers_mutex_);
+        if (workers_.empty ())
+        {
+          for (unsigned int i = 0; i < std::max (threads_, 1u); i++)
+          {
+            workers_.emplace_back ([this]
+            {
+              for (std::function<void ()> next = tasks_.pop (); next; next = tasks_.pop ())
+                next ();
+            });
+          }
+        }
+      }
+      tasks_.push (std::move (task));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::collectNodes (OutofcoreNodeType* node, const Eigen::Vector3d& min, const Eigen::Vector3d& max,
+                                                           const std::uint64_t query_depth, std::vector<OutofcoreNodeType*>& nodes) const
+    {
+      if (!node->intersectsWithBoundingBox (min, max))
+        return;
+
+      // like OutofcoreOctreeBaseNode::queryBBIncludes, nodes above query_depth do not contribute points
+      if (node->depth_ < query_depth)
+      {
+        if (node->hasUnloadedChildren ())
+          node->loadChildren (false);
+
+        for (std::size_t i = 0; i < 8; i++)
+        {
+          if (node->children_[i])
+            collectNodes (node->children_[i], min, max, query_depth, nodes);
+        }
+        return;
+      }
+      nodes.push_back (node);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> typename OutofcoreOctreeBase<ContainerT, PointT>::NodePointsPtr
+    OutofcoreOctreeBase<ContainerT, PointT>::getNodePoints (const OutofcoreNodeType* node) const
+    {
+      NodePointsPtr cached = node_cache_.get (node);
+      if (cached)
+        return (cached);
+
+      std::shared_ptr<AlignedPointTVector> points (new AlignedPointTVector ());
+      node->payload_->readRange (0, node->payload_->size (), *points);
+      node_cache_.insert (node, points, points->size () * sizeof (PointT));
+      return (points);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::queryBBIncludesCached (const Eigen::Vector3d& min, const Eigen::Vector3d& max, const std::uint64_t query_depth,
+                                                                    AlignedPointTVector& dst) const
+    {
+      std::vector<OutofcoreNodeType*> nodes;
+      {
+        // loading the children of the nodes changes the tree
+        std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+        collectNodes (root_node_, min, max, query_depth, nodes);
+      }
+
+      std::shared_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+      for (const OutofcoreNodeType* node : nodes)
+      {
+        const NodePointsPtr points = getNodePoints (node);
+        if (node->inBoundingBox (min, max))
+        {
+          dst.insert (dst.end (), points->begin (), points->end ());
+          continue;
+        }
+
+        for (const PointT& p : *points)
+        {
+          if (OutofcoreNodeType::pointInBoundingBox (min, max, p))
+            dst.push_back (p);
+        }
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::future<typename OutofcoreOctreeBase<ContainerT, PointT>::AlignedPointTVector>
+    OutofcoreOctreeBase<ContainerT, PointT>::queryBBIncludesAsync (const Eigen::Vector3d& min, const Eigen::Vector3d& max, const std::uint64_t query_depth) const
+    {
+      auto task = std::make_shared<std::packaged_task<AlignedPointTVector ()> > ([this, min, max, query_depth]
+      {
+        AlignedPointTVector dst;
+        queryBBIncludesCached (min, max, query_depth, dst);
+        return (dst);
+      });
+
+      std::future<AlignedPointTVector> result = task->get_future ();
+      submitTask ([task] { (*task) (); });
+      return (result);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::future<void>
+    OutofcoreOctreeBase<ContainerT, PointT>::queryBBIncludesAsync (const Eigen::Vector3d& min, const Eigen::Vector3d& max, const std::uint64_t query_depth,
+                                                                   const std::function<void (const AlignedPointTVector&)>& callback) const
+    {
+      // the task stores an exception of the query or of the callback in the future, it does not leave the worker
+      auto task = std::make_shared<std::packaged_task<void ()> > ([this, min, max, query_depth, callback]
+      {
+        AlignedPointTVector dst;
+        queryBBIncludesCached (min, max, query_depth, dst);
+        callback (dst);
+      });
+
+      std::future<void> result = task->get_future ();
+      submitTask ([task] { (*task) (); });
+      return (result);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::future<std::list<std::string> >
+    OutofcoreOctreeBase<ContainerT, PointT>::queryFrustumAsync (const double planes[24], const std::uint32_t query_depth) const
+    {
+      std::array<double, 24> frustum;
+      std::copy (planes, planes + 24, frustum.begin ());
+
+      auto task = std::make_shared<std::packaged_task<std::list<std::string> ()> > ([this, frustum, query_depth]
+      {
+        std::list<std::string> file_names;
+        // loading the children of the nodes changes the tree
+        std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+        root_node_->queryFrustum (frustum.data (), file_names, query_depth);
+        return (file_names);
+      });
+
+      std::future<std::list<std::string> > result = task->get_future ();
+      submitTask ([task] { (*task) (); });
+      return (result);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::future<void>
+    OutofcoreOctreeBase<ContainerT, PointT>::prefetch (const Eigen::Vector3d& eye, const Eigen::Vector3d& motion, const double radius, const std::uint64_t query_depth) const
+    {
+      const Eigen::Vector3d target = eye + motion;
+      const Eigen::Vector3d min = eye.cwiseMin (target) - Eigen::Vector3d::Constant (radius);
+      const Eigen::Vector3d max = eye.cwiseMax (target) + Eigen::Vector3d::Constant (radius);
+
+      auto task = std::make_shared<std::packaged_task<void ()> > ([this, min, max, query_depth]
+      {
+        std::vector<OutofcoreNodeType*> nodes;
+        {
+          std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+          collectNodes (root_node_, min, max, std::min (query_depth + 1, this->getDepth ()), nodes);
+          if (query_depth < this->getDepth ())
+            collectNodes (root_node_, min, max, query_depth, nodes);
+        }
+
+        std::shared_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+        for (const OutofcoreNodeType* node : nodes)
+          getNodePoints (node);
+      });
+
+      std::future<void> result = task->get_future ();
+      submitTask ([task] { (*task) (); });
+      return (result);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename Container, typename PointT> void
     OutofcoreOctreeBase<Container, PointT>::queryFrustum (const double planes[24], std::list<std::string>& file_names) const
     {
@@ -444,6 +920,7 @@ namespace pcl
     template<typename ContainerT, typename PointT> void
     OutofcoreOctreeBase<ContainerT, PointT>::flushToDisk ()
     {
+      writeBuffersToNodes ();
       root_node_->flushToDisk ();
     }
 
@@ -568,6 +1045,8 @@ namespace pcl
       }
 
       std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+      writeBuffersToNodes ();
+      node_cache_.clear ();
 
       constexpr int number_of_nodes = 1;
 
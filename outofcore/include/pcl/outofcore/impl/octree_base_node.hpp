@@ -249,7 +249,7 @@ namespace pcl
       node_metadata_->serializeMetadataToDisk ();
 
       // Create data container, ie octree_disk_container, octree_ram_container
-      payload_.reset (new ContainerT (node_metadata_->getPCDFilename ()));
+      createPayload (node_metadata_->getPCDFilename ());
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -1737,7 +1737,7 @@ namespace pcl
 
       boost::filesystem::create_directory (node_metadata_->getDirectoryPathname ());
 
-      payload_.reset (new ContainerT (node_metadata_->getPCDFilename ()));
+      createPayload (node_metadata_->getPCDFilename ());
       this->saveIdx (false);
     }
 
@@ -1929,7 +1929,19 @@ namespace pcl
         recFreeChildren ();      
 
       this->num_children_ = 0;
-      this->payload_.reset (new ContainerT (node_metadata_->getPCDFilename ()));
+      this->createPayload (node_metadata_->getPCDFilename ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBaseNode<ContainerT, PointT>::createPayload (const boost::filesystem::path &path)
+    {
+      payload_.reset (new ContainerT (path));
+
+      // the root is created before the tree is known, setContainerInitializer configures it
+      if (root_node_ != nullptr && root_node_->m_tree_ != nullptr)
+        root_node_->m_tree_->initializeContainer (*payload_);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
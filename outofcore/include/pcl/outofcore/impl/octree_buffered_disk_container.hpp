@@ -0,0 +1,702 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCL_OUTOFCORE_OCTREE_BUFFERED_DISK_CONTAINER_IMPL_H_
+#define PCL_OUTOFCORE_OCTREE_BUFFERED_DISK_CONTAINER_IMPL_H_
+
+// C++
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+// PCL
+#include <pcl/common/concatenate.h>
+#include <pcl/common/io.h>
+#include <pcl/conversions.h>
+#include <pcl/exceptions.h>
+#include <pcl/io/low_level_io.h>
+#include <pcl/io/pcd_io.h>
+
+#include <pcl/outofcore/octree_buffered_disk_container.h>
+#include <pcl/outofcore/octree_disk_container.h>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    namespace detail
+    {
+      /** \brief Open a file for positional reads and writes */
+      inline int
+      openPointFile (const std::string &file_name, int flags)
+      {
+#ifdef _WIN32
+        flags |= O_BINARY;
+#endif
+        return (pcl::io::raw_open (file_name.c_str (), flags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+      }
+
+#ifdef _WIN32
+      using FileOffset = __int64;
+#else
+      using FileOffset = off_t;
+#endif
+
+      /** \brief Check that the bytes [\b offset, \b offset + \b size) of a file can be addressed on this platform */
+      inline bool
+      isAddressable (std::uint64_t offset, std::uint64_t size)
+      {
+        const auto max_offset = static_cast<std::uint64_t> (std::numeric_limits<FileOffset>::max ());
+        return (offset <= max_offset && size <= max_offset - offset);
+      }
+
+#ifdef _WIN32
+      /** \brief Move the file position to \b offset, with a 64 bit offset (raw_lseek takes a 32 bit long on Windows) */
+      inline bool
+      seekBlock (int fd, std::uint64_t offset)
+      {
+        return (::_lseeki64 (fd, static_cast<FileOffset> (offset), SEEK_SET) >= 0);
+      }
+#endif
+
+      /** \brief Read \b size bytes at \b offset of a file, without changing the file position on POSIX systems */
+      inline bool
+      readBlock (int fd, std::uint64_t offset, char* buffer, std::uint64_t size)
+      {
+        if (!isAddressable (offset, size))
+          return (false);
+        while (size > 0)
+        {
+#ifdef _WIN32
+          // _read and _write transfer at most INT_MAX bytes per call
+          if (!seekBlock (fd, offset))
+            return (false);
+          const auto res = pcl::io::raw_read (fd, buffer, static_cast<std::size_t> (std::min<std::uint64_t> (size, std::numeric_limits<int>::max ())));
+#else
+          const auto res = ::pread (fd, buffer, static_cast<std::size_t> (size), static_cast<off_t> (offset));
+#endif
+          if (res <= 0)
+            return (false);
+          offset += res;
+          buffer += res;
+          size -= res;
+        }
+        return (true);
+      }
+
+      /** \brief Write \b size bytes at \b offset of a file */
+      inline bool
+      writeBlock (int fd, std::uint64_t offset, const char* buffer, std::uint64_t size)
+      {
+        if (!isAddressable (offset, size))
+          return (false);
+        while (size > 0)
+        {
+#ifdef _WIN32
+          if (!seekBlock (fd, offset))
+            return (false);
+          const auto res = pcl::io::raw_write (fd, buffer, static_cast<std::size_t> (std::min<std::uint64_t> (size, std::numeric_limits<int>::max ())));
+#else
+          const auto res = ::pwrite (fd, buffer, static_cast<std::size_t> (size), static_cast<off_t> (offset));
+#endif
+          if (res <= 0)
+            return (false);
+          offset += res;
+          buffer += res;
+          size -= res;
+        }
+        return (true);
+      }
+    }
+
+    template<typename PointT>
+    std::mutex OutofcoreOctreeBufferedDiskContainer<PointT>::rng_mutex_;
+
+    template<typename PointT>
+    std::mt19937 OutofcoreOctreeBufferedDiskContainer<PointT>::rng_ (static_cast<unsigned int> (std::time (nullptr)));
+
+    template<typename PointT>
+    const std::uint64_t OutofcoreOctreeBufferedDiskContainer<PointT>::WRITE_BUFF_MAX_ = 1 << 16;
+
+    template<typename PointT>
+    const std::uint64_t OutofcoreOctreeBufferedDiskContainer<PointT>::READ_BLOCK_SIZE_ = 1 << 26;
+
+    template<typename PointT>
+    const std::uint64_t OutofcoreOctreeBufferedDiskContainer<PointT>::MAX_GAP_BYTES_ = 1 << 16;
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreeBufferedDiskContainer<PointT>::OutofcoreOctreeBufferedDiskContainer ()
+      : filelen_ (0)
+      , data_index_ (0)
+      , record_size_ (0)
+    {
+      initRecordLayout ();
+      OutofcoreOctreeDiskContainer<PointT>::getRandomUUIDString (disk_storage_filename_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreeBufferedDiskContainer<PointT>::OutofcoreOctreeBufferedDiskContainer (const boost::filesystem::path& path)
+      : filelen_ (0)
+      , data_index_ (0)
+      , record_size_ (0)
+    {
+      initRecordLayout ();
+
+      if (boost::filesystem::exists (path) && boost::filesystem::is_directory (path))
+      {
+        std::string uuid;
+        OutofcoreOctreeDiskContainer<PointT>::getRandomUUIDString (uuid);
+        disk_storage_filename_ = (path / boost::filesystem::path (uuid)).string ();
+      }
+      else
+      {
+        disk_storage_filename_ = path.string ();
+        if (boost::filesystem::exists (path))
+          openFile ();
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreeBufferedDiskContainer<PointT>::~OutofcoreOctreeBufferedDiskContainer ()
+    {
+      flushWritebuff (true);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::initRecordLayout ()
+    {
+      // the fields are stored in the order of PointT, without padding
+      record_layout_.clear ();
+      record_size_ = 0;
+      for (const auto &field : pcl::getFields<PointT> ())
+      {
+        if (field.name == "_")
+          continue;
+
+        const std::size_t size = std::max<std::size_t> (field.count, 1) * pcl::getFieldSize (field.datatype);
+
+        // merge fields which are contiguous in both layouts, e.g. x, y and z
+        if (!record_layout_.empty () &&
+            record_layout_.back ().point_offset + record_layout_.back ().size == field.offset &&
+            record_layout_.back ().record_offset + record_layout_.back ().size == record_size_)
+          record_layout_.back ().size += size;
+        else
+          record_layout_.push_back ({field.offset, record_size_, size});
+
+        record_size_ += size;
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::openFile ()
+    {
+      pcl::PCLPointCloud2 cloud_info;
+      Eigen::Vector4f origin;
+      Eigen::Quaternionf orientation;
+      int pcd_version;
+      int data_type;
+      unsigned int data_index;
+
+      pcl::PCDReader reader;
+      if (reader.readHeader (disk_storage_filename_, cloud_info, origin, orientation, pcd_version, data_type, data_index, 0) < 0)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer::%s] Could not read the header of %s\n", __FUNCTION__, disk_storage_filename_.c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not read the header of the node file");
+      }
+
+      // the file can be accessed directly if it is binary and has the layout of PointT
+      bool same_layout = (data_type == 1) && (cloud_info.point_step == record_size_);
+      if (same_layout)
+      {
+        std::size_t field_idx = 0;
+        for (const auto &field : pcl::getFields<PointT> ())
+        {
+          if (field.name == "_")
+            continue;
+          if (field_idx >= cloud_info.fields.size () ||
+              cloud_info.fields[field_idx].name != field.name ||
+              cloud_info.fields[field_idx].datatype != field.datatype ||
+              std::max<std::uint32_t> (cloud_info.fields[field_idx].count, 1) != std::max<std::uint32_t> (field.count, 1))
+          {
+            same_layout = false;
+            break;
+          }
+          ++field_idx;
+        }
+        same_layout = same_layout && (field_idx == cloud_info.fields.size ());
+      }
+
+      if (same_layout)
+      {
+        filelen_ = static_cast<std::uint64_t> (cloud_info.width) * cloud_info.height;
+        data_index_ = data_index;
+        return;
+      }
+
+      // convert the file, e.g. written compressed by OutofcoreOctreeDiskContainer
+      PCL_DEBUG ("[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer::%s] Converting %s to binary\n", __FUNCTION__, disk_storage_filename_.c_str ());
+      pcl::PointCloud<PointT> cloud;
+      if (reader.read (disk_storage_filename_, cloud) < 0)
+      {
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not read the node file");
+      }
+      boost::filesystem::remove (disk_storage_filename_);
+      filelen_ = 0;
+      data_index_ = 0;
+      appendToFile (cloud.data (), cloud.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> std::string
+    OutofcoreOctreeBufferedDiskContainer<PointT>::generateHeader (std::uint64_t nr_points) const
+    {
+      assert (nr_points <= static_cast<std::uint64_t> (std::numeric_limits<int>::max ()));
+      return (pcl::PCDWriter::generateHeader (pcl::PointCloud<PointT> (), static_cast<int> (nr_points)) + "DATA binary\n");
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::decodeRecord (const char* record, PointT &p) const
+    {
+      char* dst = reinterpret_cast<char*> (&p);
+      for (const auto &field : record_layout_)
+        std::memcpy (dst + field.point_offset, record + field.record_offset, field.size);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::encodeRecord (const PointT &p, char* record) const
+    {
+      const char* src = reinterpret_cast<const char*> (&p);
+      for (const auto &field : record_layout_)
+        std::memcpy (record + field.record_offset, src + field.point_offset, field.size);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::appendToFile (const PointT* start, std::uint64_t count)
+    {
+      if (count == 0)
+        return;
+
+      std::vector<char> records (count * record_size_);
+      for (std::uint64_t i = 0; i < count; i++)
+        encodeRecord (start[i], &records[i * record_size_]);
+
+      const std::string header = generateHeader (filelen_ + count);
+
+      if (filelen_ > 0 && header.size () == data_index_)
+      {
+        // the header keeps its length, update it and write the new points behind the old ones
+        int fd = detail::openPointFile (disk_storage_filename_, O_RDWR);
+        if (fd < 0 ||
+            !detail::writeBlock (fd, 0, header.data (), header.size ()) ||
+            !detail::writeBlock (fd, data_index_ + filelen_ * record_size_, records.data (), records.size ()))
+        {
+          if (fd >= 0)
+            pcl::io::raw_close (fd);
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not append to the node file");
+        }
+        pcl::io::raw_close (fd);
+      }
+      else
+      {
+        // the header grows, rewrite the file. This only happens when the number of points gains a digit,
+        // so the points are copied about 1.1 times on average over the lifetime of the file
+        std::vector<char> old_records (filelen_ * record_size_);
+        if (filelen_ > 0)
+        {
+          int fd = detail::openPointFile (disk_storage_filename_, O_RDONLY);
+          const bool read_ok = (fd >= 0) && detail::readBlock (fd, data_index_, old_records.data (), old_records.size ());
+          if (fd >= 0)
+            pcl::io::raw_close (fd);
+          if (!read_ok)
+            PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not read the node file");
+        }
+
+        int fd = detail::openPointFile (disk_storage_filename_, O_RDWR | O_CREAT | O_TRUNC);
+        if (fd < 0 ||
+            !detail::writeBlock (fd, 0, header.data (), header.size ()) ||
+            !detail::writeBlock (fd, header.size (), old_records.data (), old_records.size ()) ||
+            !detail::writeBlock (fd, header.size () + old_records.size (), records.data (), records.size ()))
+        {
+          if (fd >= 0)
+            pcl::io::raw_close (fd);
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not write the node file");
+        }
+        pcl::io::raw_close (fd);
+        data_index_ = header.size ();
+      }
+
+      filelen_ += count;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::readFromFile (std::uint64_t start, std::uint64_t count, AlignedPointTVector &dst) const
+    {
+      if (count == 0)
+        return;
+
+      int fd = detail::openPointFile (disk_storage_filename_, O_RDONLY);
+      if (fd < 0)
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not open the node file");
+
+      // read in large blocks, to bound the size of the temporary buffer
+      const std::uint64_t block_points = std::max<std::uint64_t> (READ_BLOCK_SIZE_ / record_size_, 1);
+      std::vector<char> buffer (std::min (count, block_points) * record_size_);
+      dst.reserve (dst.size () + count);
+
+      PointT p;
+      for (std::uint64_t block_start = start; block_start < start + count; block_start += block_points)
+      {
+        const std::uint64_t block_count = std::min (block_points, start + count - block_start);
+        if (!detail::readBlock (fd, data_index_ + block_start * record_size_, buffer.data (), block_count * record_size_))
+        {
+          pcl::io::raw_close (fd);
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not read the node file");
+        }
+
+        for (std::uint64_t i = 0; i < block_count; i++)
+        {
+          decodeRecord (&buffer[i * record_size_], p);
+          dst.push_back (p);
+        }
+      }
+      pcl::io::raw_close (fd);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::flushWritebuff (const bool force_cache_dealloc)
+    {
+      if (!writebuff_.empty ())
+      {
+        appendToFile (writebuff_.data (), writebuff_.size ());
+        writebuff_.clear ();
+      }
+      if (force_cache_dealloc)
+        writebuff_.shrink_to_fit ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> PointT
+    OutofcoreOctreeBufferedDiskContainer<PointT>::operator[] (std::uint64_t idx) const
+    {
+      if (idx < filelen_)
+      {
+        AlignedPointTVector p;
+        readFromFile (idx, 1, p);
+        return (p.front ());
+      }
+      if (idx < filelen_ + writebuff_.size ())
+        return (writebuff_[idx - filelen_]);
+
+      PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Index is out of range");
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::push_back (const PointT& p)
+    {
+      writebuff_.push_back (p);
+      if (writebuff_.size () >= WRITE_BUFF_MAX_)
+        flushWritebuff (false);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::insertRange (const PointT* start, const std::uint64_t count)
+    {
+      // keep the order of the points, the buffered ones were added first
+      flushWritebuff (false);
+      appendToFile (start, count);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::insertRange (const PointT* const * start, const std::uint64_t count)
+    {
+      AlignedPointTVector points (count);
+      for (std::uint64_t i = 0; i < count; i++)
+        points[i] = *(start[i]);
+
+      insertRange (points.data (), count);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::insertRange (const AlignedPointTVector& src)
+    {
+      insertRange (src.data (), src.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::insertRange (const pcl::PCLPointCloud2::Ptr& input_cloud)
+    {
+      pcl::PointCloud<PointT> cloud;
+      pcl::fromPCLPointCloud2 (*input_cloud, cloud);
+      insertRange (cloud.data (), cloud.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::readRange (const std::uint64_t start, const std::uint64_t count, AlignedPointTVector& dst)
+    {
+      if (count == 0)
+        return;
+
+      if ((start + count) > size ())
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer::%s] Indices out of range; start + count exceeds the size of the stored points\n", __FUNCTION__);
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Outofcore Octree Exception: Read indices exceed range");
+      }
+
+      if (start < filelen_)
+        readFromFile (start, std::min (start + count, filelen_) - start, dst);
+
+      for (std::uint64_t i = std::max (start, filelen_); i < start + count; i++)
+        dst.push_back (writebuff_[i - filelen_]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::readRange (const std::uint64_t, const std::uint64_t, pcl::PCLPointCloud2::Ptr& dst)
+    {
+      flushWritebuff (false);
+
+      if (boost::filesystem::exists (disk_storage_filename_))
+      {
+        pcl::PCDReader reader;
+        int res = reader.read (disk_storage_filename_, *dst);
+        pcl::utils::ignore (res);
+        assert (res != -1);
+      }
+      else
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer::%s] File %s does not exist in node.\n", __FUNCTION__, disk_storage_filename_.c_str ());
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeBufferedDiskContainer<PointT>::read (pcl::PCLPointCloud2::Ptr& output_cloud)
+    {
+      flushWritebuff (false);
+
+      if (!boost::filesystem::exists (disk_storage_filename_))
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer::%s] File %s does not exist in node.\n", __FUNCTION__, disk_storage_filename_.c_str ());
+        return (-1);
+      }
+
+      pcl::PCLPointCloud2::Ptr temp_output_cloud (new pcl::PCLPointCloud2 ());
+      if (pcl::io::loadPCDFile (disk_storage_filename_, *temp_output_cloud) == -1)
+        return (-1);
+
+      if (output_cloud)
+        pcl::concatenate (*output_cloud, *temp_output_cloud, *output_cloud);
+      else
+        output_cloud = temp_output_cloud;
+      return (0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::readIndices (const std::vector<std::uint64_t> &indices, AlignedPointTVector &dst) const
+    {
+      assert (std::is_sorted (indices.begin (), indices.end ()));
+      dst.reserve (dst.size () + indices.size ());
+
+      // indices of points on disk come first
+      const auto file_end = std::lower_bound (indices.begin (), indices.end (), filelen_);
+      if (file_end != indices.begin ())
+      {
+        int fd = detail::openPointFile (disk_storage_filename_, O_RDONLY);
+        if (fd < 0)
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not open the node file");
+
+        std::vector<char> buffer;
+        PointT p;
+        for (auto run_begin = indices.begin (); run_begin != file_end;)
+        {
+          // coalesce the following points while the gaps and the block stay small
+          auto run_end = run_begin + 1;
+          while (run_end != file_end &&
+                 (*run_end - *(run_end - 1)) * record_size_ <= MAX_GAP_BYTES_ &&
+                 (*run_end - *run_begin + 1) * record_size_ <= READ_BLOCK_SIZE_)
+            ++run_end;
+
+          const std::uint64_t first = *run_begin;
+          buffer.resize ((*(run_end - 1) - first + 1) * record_size_);
+          if (!detail::readBlock (fd, data_index_ + first * record_size_, buffer.data (), buffer.size ()))
+          {
+            pcl::io::raw_close (fd);
+            PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Could not read the node file");
+          }
+
+          for (auto it = run_begin; it != run_end; ++it)
+          {
+            decodeRecord (&buffer[(*it - first) * record_size_], p);
+            dst.push_back (p);
+          }
+          run_begin = run_end;
+        }
+        pcl::io::raw_close (fd);
+      }
+
+      for (auto it = file_end; it != indices.end (); ++it)
+        dst.push_back (writebuff_[*it - filelen_]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::readRangeSubSample (const std::uint64_t start, const std::uint64_t count, const double percent, AlignedPointTVector& dst)
+    {
+      if (count == 0)
+        return;
+
+      dst.clear ();
+
+      const auto nr_samples = static_cast<std::uint64_t> (percent * static_cast<double> (count));
+      if (nr_samples == 0)
+      {
+        readRangeSubSample_bernoulli (start, count, percent, dst);
+        return;
+      }
+
+      //pregen and then sort the offsets to read the file front to back
+      std::vector<std::uint64_t> offsets (nr_samples);
+      {
+        std::lock_guard<std::mutex> lock (rng_mutex_);
+        std::uniform_int_distribution<std::uint64_t> dist (start, start + count - 1);
+        for (auto &offset : offsets)
+          offset = dist (rng_);
+      }
+      std::sort (offsets.begin (), offsets.end ());
+
+      readIndices (offsets, dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::readRangeSubSample_bernoulli (const std::uint64_t start, const std::uint64_t count, const double percent, AlignedPointTVector& dst)
+    {
+      if (count == 0)
+        return;
+
+      dst.clear ();
+
+      std::vector<std::uint64_t> offsets;
+      {
+        std::lock_guard<std::mutex> lock (rng_mutex_);
+        std::bernoulli_distribution coin (percent);
+        for (std::uint64_t i = start; i < start + count; i++)
+          if (coin (rng_))
+            offsets.push_back (i);
+      }
+
+      readIndices (offsets, dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::clear ()
+    {
+      //clear elements that have not yet been written to disk
+      writebuff_.clear ();
+      PCL_DEBUG ("[pcl::outofcore::OutofcoreOctreeBufferedDiskContainer] Removing the point data from disk, in file %s\n", disk_storage_filename_.c_str ());
+      boost::filesystem::remove (static_cast<boost::filesystem::path> (disk_storage_filename_.c_str ()));
+      filelen_ = 0;
+      data_index_ = 0;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeBufferedDiskContainer<PointT>::convertToXYZ (const boost::filesystem::path &path)
+    {
+      std::ofstream fxyz (path.string ().c_str ());
+      fxyz << std::fixed;
+      fxyz.precision (16);
+
+      const std::uint64_t block_points = std::max<std::uint64_t> (READ_BLOCK_SIZE_ / record_size_, 1);
+      AlignedPointTVector points;
+      for (std::uint64_t block_start = 0; block_start < size (); block_start += block_points)
+      {
+        points.clear ();
+        readRange (block_start, std::min (block_points, size () - block_start), points);
+        for (const auto &p : points)
+          fxyz << p.x << "\t" << p.y << "\t" << p.z << "\n";
+      }
+    }
+  }//namespace outofcore
+}//namespace pcl
+
+#endif //PCL_OUTOFCORE_OCTREE_BUFFERED_DISK_CONTAINER_IMPL_H_
@@ -0,0 +1,803 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCL_OUTOFCORE_OCTREE_COMPRESSED_DISK_CONTAINER_IMPL_H_
+#define PCL_OUTOFCORE_OCTREE_COMPRESSED_DISK_CONTAINER_IMPL_H_
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <limits>
+
+// PCL
+#include <pcl/common/concatenate.h>
+#include <pcl/common/io.h>
+#include <pcl/conversions.h>
+#include <pcl/exceptions.h>
+#include <pcl/io/lzf.h>
+#include <pcl/io/pcd_io.h>
+
+#include <pcl/outofcore/octree_compressed_disk_container.h>
+#include <pcl/outofcore/octree_disk_container.h>
+#include <pcl/outofcore/impl/octree_buffered_disk_container.hpp>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    namespace detail
+    {
+      /** \brief Append \b value as variable length integer of 7 bit groups */
+      inline void
+      writeVarint (std::uint64_t value, std::vector<char> &dst)
+      {
+        while (value >= 0x80)
+        {
+          dst.push_back (static_cast<char> ((value & 0x7F) | 0x80));
+          value >>= 7;
+        }
+        dst.push_back (static_cast<char> (value));
+      }
+
+      /** \brief Read a variable length integer written by writeVarint and advance \b src */
+      inline bool
+      readVarint (const char* &src, const char* end, std::uint64_t &value)
+      {
+        value = 0;
+        for (unsigned int shift = 0; shift < 64 && src < end; shift += 7)
+        {
+          const auto byte = static_cast<std::uint8_t> (*src++);
+          value |= static_cast<std::uint64_t> (byte & 0x7F) << shift;
+          if (!(byte & 0x80))
+            return (true);
+        }
+        return (false);
+      }
+
+      /** \brief Map signed integers to unsigned ones, small magnitudes to small values */
+      inline std::uint64_t
+      zigzagEncode (std::int64_t value)
+      {
+        return ((static_cast<std::uint64_t> (value) << 1) ^ static_cast<std::uint64_t> (value >> 63));
+      }
+
+      inline std::int64_t
+      zigzagDecode (std::uint64_t value)
+      {
+        return (static_cast<std::int64_t> (value >> 1) ^ -static_cast<std::int64_t> (value & 1));
+      }
+
+      /** \brief Write the \b size lower bytes of \b value to \b dst in little endian byte order and advance \b dst */
+      inline void
+      writeLittleEndian (std::uint64_t value, std::size_t size, char* &dst)
+      {
+        for (std::size_t i = 0; i < size; i++, value >>= 8)
+          *dst++ = static_cast<char> (value & 0xFF);
+      }
+
+      /** \brief Read \b size bytes written by writeLittleEndian and advance \b src */
+      inline std::uint64_t
+      readLittleEndian (std::size_t size, const char* &src)
+      {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < size; i++)
+          value |= static_cast<std::uint64_t> (static_cast<std::uint8_t> (*src++)) << (8 * i);
+        return (value);
+      }
+
+      inline void
+      writeLittleEndian (double value, char* &dst)
+      {
+        std::uint64_t bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+        writeLittleEndian (bits, sizeof (bits), dst);
+      }
+
+      inline double
+      readLittleEndianDouble (const char* &src)
+      {
+        const std::uint64_t bits = readLittleEndian (sizeof (bits), src);
+        double value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return (value);
+      }
+    }
+
+    template<typename PointT>
+    std::mutex OutofcoreOctreeCompressedDiskContainer<PointT>::rng_mutex_;
+
+    template<typename PointT>
+    std::mt19937 OutofcoreOctreeCompressedDiskContainer<PointT>::rng_ (static_cast<unsigned int> (std::time (nullptr)));
+
+    template<typename PointT>
+    const std::uint64_t OutofcoreOctreeCompressedDiskContainer<PointT>::BLOCK_SIZE_ = 1 << 14;
+
+    template<typename PointT>
+    const char OutofcoreOctreeCompressedDiskContainer<PointT>::FILE_MAGIC_[8] = {'P', 'C', 'L', 'O', 'C', 'Z', '0', '1'};
+
+    template<typename PointT>
+    const std::size_t OutofcoreOctreeCompressedDiskContainer<PointT>::HEADER_SIZE_ = 4 * sizeof (std::uint32_t) + 4 * sizeof (double);
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreeCompressedDiskContainer<PointT>::OutofcoreOctreeCompressedDiskContainer ()
+      : filelen_ (0)
+      , file_size_ (0)
+      , record_size_ (0)
+      , quantization_step_ (0.001)
+    {
+      initRecordLayout ();
+      OutofcoreOctreeDiskContainer<PointT>::getRandomUUIDString (disk_storage_filename_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreeCompressedDiskContainer<PointT>::OutofcoreOctreeCompressedDiskContainer (const boost::filesystem::path& path)
+      : filelen_ (0)
+      , file_size_ (0)
+      , record_size_ (0)
+      , quantization_step_ (0.001)
+    {
+      initRecordLayout ();
+
+      if (boost::filesystem::exists (path) && boost::filesystem::is_directory (path))
+      {
+        std::string uuid;
+        OutofcoreOctreeDiskContainer<PointT>::getRandomUUIDString (uuid);
+        disk_storage_filename_ = (path / boost::filesystem::path (uuid)).string ();
+      }
+      else
+      {
+        disk_storage_filename_ = path.string ();
+        if (boost::filesystem::exists (path))
+          openFile ();
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreeCompressedDiskContainer<PointT>::~OutofcoreOctreeCompressedDiskContainer ()
+    {
+      flushWritebuff (true);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::initRecordLayout ()
+    {
+      // the fields are stored in the order of PointT, without padding
+      record_layout_.clear ();
+      record_size_ = 0;
+      for (const auto &field : pcl::getFields<PointT> ())
+      {
+        if (field.name == "_" || field.name == "x" || field.name == "y" || field.name == "z")
+          continue;
+
+        const std::size_t size = std::max<std::size_t> (field.count, 1) * pcl::getFieldSize (field.datatype);
+
+        // merge fields which are contiguous in both layouts
+        if (!record_layout_.empty () &&
+            record_layout_.back ().point_offset + record_layout_.back ().size == field.offset &&
+            record_layout_.back ().record_offset + record_layout_.back ().size == record_size_)
+          record_layout_.back ().size += size;
+        else
+          record_layout_.push_back ({field.offset, record_size_, size});
+
+        record_size_ += size;
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::openFile ()
+    {
+      char magic[sizeof (FILE_MAGIC_)];
+      int fd = detail::openPointFile (disk_storage_filename_, O_RDONLY);
+      const std::uint64_t file_size = boost::filesystem::file_size (disk_storage_filename_);
+      const bool compressed = (fd >= 0) && (file_size >= sizeof (magic)) &&
+                              detail::readBlock (fd, 0, magic, sizeof (magic)) &&
+                              (std::memcmp (magic, FILE_MAGIC_, sizeof (magic)) == 0);
+
+      if (compressed)
+      {
+        // index the blocks
+        std::uint64_t offset = sizeof (FILE_MAGIC_);
+        std::vector<char> header_bytes (HEADER_SIZE_);
+        while (offset < file_size)
+        {
+          BlockHeader header {};
+          const bool header_ok = (offset + HEADER_SIZE_ <= file_size) &&
+                                 detail::readBlock (fd, offset, header_bytes.data (), HEADER_SIZE_);
+          if (header_ok)
+            header = readHeader (header_bytes.data ());
+          if (!header_ok || offset + HEADER_SIZE_ + header.stored_size > file_size)
+          {
+            pcl::io::raw_close (fd);
+            PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer::%s] Truncated block in %s\n", __FUNCTION__, disk_storage_filename_.c_str ());
+            PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Could not read the node file");
+          }
+
+          const std::uint64_t block_size = HEADER_SIZE_ + header.stored_size;
+          blocks_.push_back ({offset, block_size, filelen_, header.nr_points});
+          filelen_ += header.nr_points;
+          offset += block_size;
+        }
+        file_size_ = offset;
+        pcl::io::raw_close (fd);
+        return;
+      }
+
+      if (fd >= 0)
+        pcl::io::raw_close (fd);
+
+      // convert the file, e.g. written by OutofcoreOctreeDiskContainer
+      PCL_DEBUG ("[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer::%s] Compressing %s\n", __FUNCTION__, disk_storage_filename_.c_str ());
+      pcl::PointCloud<PointT> cloud;
+      pcl::PCDReader reader;
+      if (reader.read (disk_storage_filename_, cloud) < 0)
+      {
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Could not read the node file");
+      }
+      boost::filesystem::remove (disk_storage_filename_);
+      appendToFile (cloud.data (), cloud.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::writeHeader (const BlockHeader &header, char* dst)
+    {
+      // nr_points, flags, stored_size, raw_size, origin[3], step
+      detail::writeLittleEndian (header.nr_points, sizeof (header.nr_points), dst);
+      detail::writeLittleEndian (header.flags, sizeof (header.flags), dst);
+      detail::writeLittleEndian (header.stored_size, sizeof (header.stored_size), dst);
+      detail::writeLittleEndian (header.raw_size, sizeof (header.raw_size), dst);
+      for (const double origin : header.origin)
+        detail::writeLittleEndian (origin, dst);
+      detail::writeLittleEndian (header.step, dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> typename OutofcoreOctreeCompressedDiskContainer<PointT>::BlockHeader
+    OutofcoreOctreeCompressedDiskContainer<PointT>::readHeader (const char* src)
+    {
+      BlockHeader header;
+      header.nr_points = static_cast<std::uint32_t> (detail::readLittleEndian (sizeof (header.nr_points), src));
+      header.flags = static_cast<std::uint32_t> (detail::readLittleEndian (sizeof (header.flags), src));
+      header.stored_size = static_cast<std::uint32_t> (detail::readLittleEndian (sizeof (header.stored_size), src));
+      header.raw_size = static_cast<std::uint32_t> (detail::readLittleEndian (sizeof (header.raw_size), src));
+      for (double &origin : header.origin)
+        origin = detail::readLittleEndianDouble (src);
+      header.step = detail::readLittleEndianDouble (src);
+      return (header);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> typename OutofcoreOctreeCompressedDiskContainer<PointT>::BlockHeader
+    OutofcoreOctreeCompressedDiskContainer<PointT>::encodeBlock (const PointT* start, std::uint32_t count, std::vector<char> &data) const
+    {
+      BlockHeader header;
+      header.nr_points = count;
+      header.flags = 0;
+      header.step = quantization_step_;
+
+      // the coordinates are quantized relative to the minimum of the block, unless they do not fit
+      double min_xyz[3] = {std::numeric_limits<double>::max (), std::numeric_limits<double>::max (), std::numeric_limits<double>::max ()};
+      double max_xyz[3] = {std::numeric_limits<double>::lowest (), std::numeric_limits<double>::lowest (), std::numeric_limits<double>::lowest ()};
+      bool quantize = (header.step > 0.0);
+      for (std::uint32_t i = 0; i < count && quantize; i++)
+      {
+        const double xyz[3] = {start[i].x, start[i].y, start[i].z};
+        for (int d = 0; d < 3; d++)
+        {
+          quantize = quantize && std::isfinite (xyz[d]);
+          min_xyz[d] = std::min (min_xyz[d], xyz[d]);
+          max_xyz[d] = std::max (max_xyz[d], xyz[d]);
+        }
+      }
+      for (int d = 0; d < 3 && quantize; d++)
+        quantize = (max_xyz[d] - min_xyz[d]) / header.step < static_cast<double> (std::int64_t (1) << 52);
+
+      std::vector<char> raw;
+      raw.reserve (count * (3 * sizeof (float) + record_size_));
+      if (quantize)
+      {
+        header.flags |= QUANTIZED_XYZ;
+        std::int64_t previous[3] = {0, 0, 0};
+        for (int d = 0; d < 3; d++)
+          header.origin[d] = min_xyz[d];
+
+        for (std::uint32_t i = 0; i < count; i++)
+        {
+          const double xyz[3] = {start[i].x, start[i].y, start[i].z};
+          for (int d = 0; d < 3; d++)
+          {
+            const std::int64_t q = std::llround ((xyz[d] - header.origin[d]) / header.step);
+            detail::writeVarint (detail::zigzagEncode (q - previous[d]), raw);
+            previous[d] = q;
+          }
+        }
+      }
+      else
+      {
+        header.origin[0] = header.origin[1] = header.origin[2] = 0.0;
+        for (std::uint32_t i = 0; i < count; i++)
+        {
+          const float xyz[3] = {start[i].x, start[i].y, start[i].z};
+          raw.insert (raw.end (), reinterpret_cast<const char*> (xyz), reinterpret_cast<const char*> (xyz) + sizeof (xyz));
+        }
+      }
+
+      const std::size_t xyz_size = raw.size ();
+      raw.resize (xyz_size + count * record_size_);
+      for (std::uint32_t i = 0; i < count; i++)
+      {
+        const char* src = reinterpret_cast<const char*> (&start[i]);
+        char* record = &raw[xyz_size + i * record_size_];
+        for (const auto &field : record_layout_)
+          std::memcpy (record + field.record_offset, src + field.point_offset, field.size);
+      }
+
+      header.raw_size = static_cast<std::uint32_t> (raw.size ());
+
+      // keep the LZF result only if it is smaller; the buffer fits the worst case of LZF
+      data.resize (raw.size () + raw.size () / 16 + 64);
+      const unsigned int compressed_size = pcl::lzfCompress (raw.data (), header.raw_size, data.data (), static_cast<unsigned int> (data.size ()));
+      if (compressed_size > 0 && compressed_size < header.raw_size)
+      {
+        header.flags |= LZF_COMPRESSED;
+        data.resize (compressed_size);
+      }
+      else
+      {
+        data.swap (raw);
+      }
+      header.stored_size = static_cast<std::uint32_t> (data.size ());
+
+      return (header);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::decodeBlock (int fd, std::size_t block_idx, AlignedPointTVector &dst) const
+    {
+      const BlockInfo &block = blocks_[block_idx];
+      std::vector<char> buffer (block.size);
+      if (!detail::readBlock (fd, block.offset, buffer.data (), buffer.size ()))
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Could not read the node file");
+
+      const BlockHeader header = readHeader (buffer.data ());
+      const char* data = buffer.data () + HEADER_SIZE_;
+
+      std::vector<char> raw;
+      if (header.flags & LZF_COMPRESSED)
+      {
+        raw.resize (header.raw_size);
+        if (pcl::lzfDecompress (data, header.stored_size, raw.data (), header.raw_size) != header.raw_size)
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Could not decompress a block of the node file");
+        data = raw.data ();
+      }
+      const char* end = data + header.raw_size;
+
+      const std::size_t first = dst.size ();
+      dst.resize (first + header.nr_points);
+
+      bool valid = true;
+      if (header.flags & QUANTIZED_XYZ)
+      {
+        std::int64_t q[3] = {0, 0, 0};
+        std::uint64_t delta;
+        for (std::size_t i = first; i < dst.size () && valid; i++)
+        {
+          float* xyz[3] = {&dst[i].x, &dst[i].y, &dst[i].z};
+          for (int d = 0; d < 3 && valid; d++)
+          {
+            valid = detail::readVarint (data, end, delta);
+            q[d] += detail::zigzagDecode (delta);
+            *xyz[d] = static_cast<float> (header.origin[d] + static_cast<double> (q[d]) * header.step);
+          }
+        }
+      }
+      else
+      {
+        valid = (static_cast<std::size_t> (end - data) >= header.nr_points * 3 * sizeof (float));
+        for (std::size_t i = first; i < dst.size () && valid; i++, data += 3 * sizeof (float))
+        {
+          std::memcpy (&dst[i].x, data, sizeof (float));
+          std::memcpy (&dst[i].y, data + sizeof (float), sizeof (float));
+          std::memcpy (&dst[i].z, data + 2 * sizeof (float), sizeof (float));
+        }
+      }
+
+      if (!valid || static_cast<std::size_t> (end - data) != header.nr_points * record_size_)
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Corrupt block in the node file");
+
+      for (std::size_t i = first; i < dst.size (); i++, data += record_size_)
+      {
+        char* p = reinterpret_cast<char*> (&dst[i]);
+        for (const auto &field : record_layout_)
+          std::memcpy (p + field.point_offset, data + field.record_offset, field.size);
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> std::size_t
+    OutofcoreOctreeCompressedDiskContainer<PointT>::findBlock (std::uint64_t idx) const
+    {
+      assert (idx < filelen_);
+      const auto it = std::upper_bound (blocks_.begin (), blocks_.end (), idx,
+                                        [] (std::uint64_t i, const BlockInfo &block) { return (i < block.first); });
+      return (static_cast<std::size_t> (it - blocks_.begin ()) - 1);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::appendToFile (const PointT* start, std::uint64_t count)
+    {
+      if (count == 0)
+        return;
+
+      int fd = detail::openPointFile (disk_storage_filename_, O_RDWR | O_CREAT);
+      if (fd < 0)
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Could not open the node file");
+
+      bool write_ok = true;
+      if (file_size_ == 0)
+      {
+        write_ok = detail::writeBlock (fd, 0, FILE_MAGIC_, sizeof (FILE_MAGIC_));
+        file_size_ = sizeof (FILE_MAGIC_);
+      }
+
+      std::vector<char> data;
+      std::vector<char> block;
+      for (std::uint64_t block_start = 0; block_start < count && write_ok; block_start += BLOCK_SIZE_)
+      {
+        const auto nr_points = static_cast<std::uint32_t> (std::min (BLOCK_SIZE_, count - block_start));
+        const BlockHeader header = encodeBlock (start + block_start, nr_points, data);
+
+        block.resize (HEADER_SIZE_ + data.size ());
+        writeHeader (header, block.data ());
+        std::memcpy (block.data () + HEADER_SIZE_, data.data (), data.size ());
+
+        write_ok = detail::writeBlock (fd, file_size_, block.data (), block.size ());
+        blocks_.push_back ({file_size_, block.size (), filelen_, nr_points});
+        file_size_ += block.size ();
+        filelen_ += nr_points;
+      }
+      pcl::io::raw_close (fd);
+
+      if (!write_ok)
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Could not write the node file");
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::flushWritebuff (const bool force_cache_dealloc)
+    {
+      if (!writebuff_.empty ())
+      {
+        appendToFile (writebuff_.data (), writebuff_.size ());
+        writebuff_.clear ();
+      }
+      if (force_cache_dealloc)
+        writebuff_.shrink_to_fit ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> PointT
+    OutofcoreOctreeCompressedDiskContainer<PointT>::operator[] (std::uint64_t idx) const
+    {
+      if (idx < filelen_)
+      {
+        AlignedPointTVector p;
+        readIndices (std::vector<std::uint64_t> (1, idx), p);
+        return (p.front ());
+      }
+      if (idx < filelen_ + writebuff_.size ())
+        return (writebuff_[idx - filelen_]);
+
+      PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Index is out of range");
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::push_back (const PointT& p)
+    {
+      insertRange (&p, 1);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::insertRange (const PointT* start, const std::uint64_t count)
+    {
+      writebuff_.insert (writebuff_.end (), start, start + count);
+
+      // write the full blocks, the rest waits for more points
+      const std::uint64_t nr_full = (writebuff_.size () / BLOCK_SIZE_) * BLOCK_SIZE_;
+      if (nr_full > 0)
+      {
+        appendToFile (writebuff_.data (), nr_full);
+        writebuff_.erase (writebuff_.begin (), writebuff_.begin () + nr_full);
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::insertRange (const PointT* const * start, const std::uint64_t count)
+    {
+      AlignedPointTVector points (count);
+      for (std::uint64_t i = 0; i < count; i++)
+        points[i] = *(start[i]);
+
+      insertRange (points.data (), count);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::insertRange (const AlignedPointTVector& src)
+    {
+      insertRange (src.data (), src.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::insertRange (const pcl::PCLPointCloud2::Ptr& input_cloud)
+    {
+      pcl::PointCloud<PointT> cloud;
+      pcl::fromPCLPointCloud2 (*input_cloud, cloud);
+      insertRange (cloud.data (), cloud.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::readRange (const std::uint64_t start, const std::uint64_t count, AlignedPointTVector& dst)
+    {
+      if (count == 0)
+        return;
+
+      if ((start + count) > size ())
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer::%s] Indices out of range; start + count exceeds the size of the stored points\n", __FUNCTION__);
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Outofcore Octree Exception: Read indices exceed range");
+      }
+
+      dst.reserve (dst.size () + count);
+      const std::uint64_t end = start + count;
+      if (start < filelen_)
+      {
+        int fd = detail::openPointFile (disk_storage_filename_, O_RDONLY);
+        if (fd < 0)
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Could not open the node file");
+
+        // decode one block at a time and keep the requested part of it
+        AlignedPointTVector block_points;
+        for (std::size_t b = findBlock (start); b < blocks_.size () && blocks_[b].first < end; b++)
+        {
+          block_points.clear ();
+          decodeBlock (fd, b, block_points);
+
+          const std::uint64_t first = blocks_[b].first;
+          const std::uint64_t begin = std::max (start, first) - first;
+          const std::uint64_t stop = std::min (end, first + blocks_[b].nr_points) - first;
+          dst.insert (dst.end (), block_points.begin () + begin, block_points.begin () + stop);
+        }
+        pcl::io::raw_close (fd);
+      }
+
+      for (std::uint64_t i = std::max (start, filelen_); i < end; i++)
+        dst.push_back (writebuff_[i - filelen_]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::readRange (const std::uint64_t, const std::uint64_t, pcl::PCLPointCloud2::Ptr& dst)
+    {
+      pcl::PointCloud<PointT> cloud;
+      readRange (0, size (), cloud.points);
+      cloud.width = static_cast<std::uint32_t> (cloud.size ());
+      cloud.height = 1;
+      pcl::toPCLPointCloud2 (cloud, *dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeCompressedDiskContainer<PointT>::read (pcl::PCLPointCloud2::Ptr& output_cloud)
+    {
+      if (empty ())
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer::%s] File %s does not exist in node.\n", __FUNCTION__, disk_storage_filename_.c_str ());
+        return (-1);
+      }
+
+      pcl::PCLPointCloud2::Ptr temp_output_cloud (new pcl::PCLPointCloud2 ());
+      readRange (0, size (), temp_output_cloud);
+
+      if (output_cloud)
+        pcl::concatenate (*output_cloud, *temp_output_cloud, *output_cloud);
+      else
+        output_cloud = temp_output_cloud;
+      return (0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::readIndices (const std::vector<std::uint64_t> &indices, AlignedPointTVector &dst) const
+    {
+      assert (std::is_sorted (indices.begin (), indices.end ()));
+      dst.reserve (dst.size () + indices.size ());
+
+      // indices of points on disk come first
+      const auto file_end = std::lower_bound (indices.begin (), indices.end (), filelen_);
+      if (file_end != indices.begin ())
+      {
+        int fd = detail::openPointFile (disk_storage_filename_, O_RDONLY);
+        if (fd < 0)
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Could not open the node file");
+
+        // decode every block with a requested point once
+        AlignedPointTVector block_points;
+        std::size_t b = findBlock (*indices.begin ());
+        decodeBlock (fd, b, block_points);
+        for (auto it = indices.begin (); it != file_end; ++it)
+        {
+          if (*it >= blocks_[b].first + blocks_[b].nr_points)
+          {
+            b = findBlock (*it);
+            block_points.clear ();
+            decodeBlock (fd, b, block_points);
+          }
+          dst.push_back (block_points[*it - blocks_[b].first]);
+        }
+        pcl::io::raw_close (fd);
+      }
+
+      for (auto it = file_end; it != indices.end (); ++it)
+        dst.push_back (writebuff_[*it - filelen_]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::readRangeSubSample (const std::uint64_t start, const std::uint64_t count, const double percent, AlignedPointTVector& dst)
+    {
+      if (count == 0)
+        return;
+
+      dst.clear ();
+
+      const auto nr_samples = static_cast<std::uint64_t> (percent * static_cast<double> (count));
+      if (nr_samples == 0)
+      {
+        readRangeSubSample_bernoulli (start, count, percent, dst);
+        return;
+      }
+
+      //pregen and then sort the offsets to decode the blocks front to back
+      std::vector<std::uint64_t> offsets (nr_samples);
+      {
+        std::lock_guard<std::mutex> lock (rng_mutex_);
+        std::uniform_int_distribution<std::uint64_t> dist (start, start + count - 1);
+        for (auto &offset : offsets)
+          offset = dist (rng_);
+      }
+      std::sort (offsets.begin (), offsets.end ());
+
+      readIndices (offsets, dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::readRangeSubSample_bernoulli (const std::uint64_t start, const std::uint64_t count, const double percent, AlignedPointTVector& dst)
+    {
+      if (count == 0)
+        return;
+
+      dst.clear ();
+
+      std::vector<std::uint64_t> offsets;
+      {
+        std::lock_guard<std::mutex> lock (rng_mutex_);
+        std::bernoulli_distribution coin (percent);
+        for (std::uint64_t i = start; i < start + count; i++)
+          if (coin (rng_))
+            offsets.push_back (i);
+      }
+
+      readIndices (offsets, dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::clear ()
+    {
+      //clear elements that have not yet been written to disk
+      writebuff_.clear ();
+      PCL_DEBUG ("[pcl::outofcore::OutofcoreOctreeCompressedDiskContainer] Removing the point data from disk, in file %s\n", disk_storage_filename_.c_str ());
+      boost::filesystem::remove (static_cast<boost::filesystem::path> (disk_storage_filename_.c_str ()));
+      filelen_ = 0;
+      file_size_ = 0;
+      blocks_.clear ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedDiskContainer<PointT>::convertToXYZ (const boost::filesystem::path &path)
+    {
+      std::ofstream fxyz (path.string ().c_str ());
+      fxyz << std::fixed;
+      fxyz.precision (16);
+
+      AlignedPointTVector points;
+      for (std::uint64_t block_start = 0; block_start < size (); block_start += BLOCK_SIZE_)
+      {
+        points.clear ();
+        readRange (block_start, std::min (BLOCK_SIZE_, size () - block_start), points);
+        for (const auto &p : points)
+          fxyz << p.x << "\t" << p.y << "\t" << p.z << "\n";
+      }
+    }
+  }//namespace outofcore
+}//namespace pcl
+
+#endif //PCL_OUTOFCORE_OCTREE_COMPRESSED_DISK_CONTAINER_IMPL_H_
@@ -62,7 +62,17 @@
 
 #include <pcl/PCLPointCloud2.h>
 
+#include <pcl/outofcore/impl/lru_cache.hpp>
+#include <pcl/outofcore/impl/monitor_queue.hpp>
+
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
+#include <thread>
 
 namespace pcl
 {
@@ -565,6 +575,115 @@ namespace pcl
         {
           this->sample_percent_ = std::fabs (sample_percent_arg) > 1.0 ? 1.0 : std::fabs (sample_percent_arg);
         }
+
+        /** \brief Set the number of threads used to partition the inserted points into the nodes of the
+         * tree and to write the buffered points to the nodes. The same number of worker threads runs the
+         * asynchronous queries; they are started by the first asynchronous query.
+         * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+         */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
+        /** \brief Sets the memory budget of the write buffers in bytes.
+         *
+         * The points inserted with addDataToLeaf, addPointCloud or addDataToLeaf_and_genLOD are collected
+         * in a buffer per node and written with a single insertion per node once the buffered points
+         * exceed the budget. This replaces many small appends, which rewrite the whole file of a node for
+         * the default disk container, with few large ones. The default of 0 writes the points at the end
+         * of every insertion.
+         *
+         * \note Buffered points are not returned by queries until they are written, see flushWriteBuffers.
+         * \param[in] max_bytes size of the write buffers of all nodes in bytes
+         */
+        inline void
+        setWriteBufferSize (const std::uint64_t max_bytes)
+        {
+          write_buffer_size_ = max_bytes;
+        }
+
+        /** \brief Returns the memory budget of the write buffers in bytes. */
+        inline std::uint64_t
+        getWriteBufferSize () const
+        {
+          return (write_buffer_size_);
+        }
+
+        /** \brief Writes the points in the write buffers to their nodes
+         *  \note unique read_write_mutex lock occurs
+         */
+        void
+        flushWriteBuffers ();
+
+        /** \brief Sets a function which configures the container of every node of this tree, e.g. the
+         * quantization step of \ref OutofcoreOctreeCompressedDiskContainer. It is called for the nodes
+         * which are loaded now and for every node which is created or loaded afterwards.
+         *
+         * \note Node files which a container converts when it opens them are written before it is configured.
+         * \param[in] initializer function called with the container of a node
+         */
+        void
+        setContainerInitializer (const std::function<void (ContainerT&)> &initializer);
+
+        // Asynchronous queries
+        // -----------------------------------------------------------------------
+
+        /** \brief Sets the budget in bytes of the cache of node points used by the asynchronous queries
+         * and the prefetching, 256 MiB by default; 0 disables the cache. A node is cached if its points fit
+         * into the budget. The cache is cleared when points are written.
+         */
+        void
+        setNodeCacheSize (const std::size_t max_bytes)
+        {
+          node_cache_.setCapacity (max_bytes);
+        }
+
+        /** \brief Returns the budget of the node cache in bytes */
+        std::size_t
+        getNodeCacheSize () const
+        {
+          return (node_cache_.getCapacity ());
+        }
+
+        /** \brief Asynchronous version of queryBBIncludes, which runs on the worker threads of the tree
+         * and reads the points of the nodes through the node cache.
+         *
+         * \param[in] min The minimum corner of the bounding box
+         * \param[in] max The maximum corner of the bounding box
+         * \param[in] query_depth Query for a specific depth (specify max depth for the leaf points)
+         * \return future of the points within the bounding box
+         */
+        std::future<AlignedPointTVector>
+        queryBBIncludesAsync (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const std::uint64_t query_depth) const;
+
+        /** \brief Asynchronous version of queryBBIncludes, calls \b callback with the result on a worker thread
+         * \return future which is ready when the callback returned; it rethrows an exception thrown by the query or by the callback
+         */
+        std::future<void>
+        queryBBIncludesAsync (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const std::uint64_t query_depth,
+                              const std::function<void (const AlignedPointTVector&)> &callback) const;
+
+        /** \brief Asynchronous version of queryFrustum, which runs on the worker threads of the tree
+         * \param[in] planes the frustum planes, 4 coefficients per plane
+         * \param[in] query_depth the depth of the nodes to return
+         * \return future of the file names of the nodes within the frustum
+         */
+        std::future<std::list<std::string> >
+        queryFrustumAsync (const double planes[24], const std::uint32_t query_depth) const;
+
+        /** \brief Loads the points of the nodes ahead of a moving viewpoint into the node cache on the worker threads.
+         *
+         * The nodes at \b query_depth and their children are loaded, which intersect the box around the
+         * current position \b eye and the predicted position \b eye + \b motion, enlarged by \b radius.
+         * Following queries of this region read the points from memory, including queries at the next depth.
+         *
+         * \param[in] eye current position of the viewpoint
+         * \param[in] motion expected motion of the viewpoint until the next queries
+         * \param[in] radius distance around the viewpoint which is queried
+         * \param[in] query_depth depth of the queries
+         * \return future which is ready when the nodes are loaded
+         */
+        std::future<void>
+        prefetch (const Eigen::Vector3d &eye, const Eigen::Vector3d &motion, const double radius, const std::uint64_t query_depth) const;
 	
       protected:
         void
@@ -610,6 +729,56 @@ namespace pcl
         bool
         checkExtension (const boost::filesystem::path& path_name);
 
+        /** \brief Partitions the points into the nodes at the max depth of the tree and appends them to the
+         * write buffers of these nodes. The points of a level are assigned to the octants of their nodes in
+         * parallel, which yields the same nodes and order of points as the recursive insertion of the nodes.
+         *
+         * \param[in] p the points to insert
+         * \param[in] gen_lod whether to store a random sample of the points at every inner node on the way
+         * \param[in] skip_bb_check whether to insert the points outside of the bounding box of the tree
+         * \return number of points added to the nodes at the max depth
+         */
+        std::uint64_t
+        partitionToWriteBuffers (const AlignedPointTVector &p, const bool gen_lod, const bool skip_bb_check);
+
+        /** \brief Writes the write buffers to the nodes if they exceed the budget; the caller holds the lock */
+        void
+        flushWriteBuffersIfFull ();
+
+        /** \brief Writes the write buffers to the nodes; the caller holds the lock */
+        void
+        writeBuffersToNodes ();
+
+        using NodePointsPtr = std::shared_ptr<const AlignedPointTVector>;
+
+        /** \brief Configures \b container with the function of setContainerInitializer, if there is one */
+        void
+        initializeContainer (ContainerT &container) const
+        {
+          if (container_initializer_)
+            container_initializer_ (container);
+        }
+
+        /** \brief Runs \b task on the worker threads, starting them if necessary */
+        void
+        submitTask (std::function<void ()> task) const;
+
+        /** \brief Collects the nodes at \b query_depth that intersect the box, loading their parents' children;
+         * the caller holds the unique lock */
+        void
+        collectNodes (OutofcoreNodeType* node, const Eigen::Vector3d &min, const Eigen::Vector3d &max,
+                      const std::uint64_t query_depth, std::vector<OutofcoreNodeType*> &nodes) const;
+
+        /** \brief Returns the points of a node from the node cache, reading and caching them on a miss;
+         * the caller holds the shared lock */
+        NodePointsPtr
+        getNodePoints (const OutofcoreNodeType* node) const;
+
+        /** \brief queryBBIncludes through the node cache, used by the asynchronous queries */
+        void
+        queryBBIncludesCached (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const std::uint64_t query_depth,
+                               AlignedPointTVector &dst) const;
+
         /** \brief Flush all nodes' cache */
         void
         flushToDisk ();
@@ -651,6 +820,33 @@ namespace pcl
         double sample_percent_;
 
         pcl::RandomSample<pcl::PCLPointCloud2>::Ptr lod_filter_ptr_;
+
+        /** \brief Number of threads used for the insertion of points */
+        unsigned int threads_;
+
+        /** \brief Memory budget of the write buffers in bytes */
+        std::uint64_t write_buffer_size_;
+
+        /** \brief Points which are not yet written to their nodes */
+        std::map<OutofcoreNodeType*, AlignedPointTVector> write_buffers_;
+
+        /** \brief Number of points in write_buffers_ */
+        std::uint64_t buffered_points_;
+
+        /** \brief Configures the containers of the nodes, see setContainerInitializer */
+        std::function<void (ContainerT&)> container_initializer_;
+
+        /** \brief Points of recently queried or prefetched nodes */
+        mutable ShardedLRUCache<const OutofcoreNodeType*, AlignedPointTVector> node_cache_;
+
+        /** \brief Tasks of the worker threads, an empty task stops a worker */
+        mutable MonitorQueue<std::function<void ()> > tasks_;
+
+        /** \brief Worker threads running the asynchronous queries */
+        mutable std::vector<std::thread> workers_;
+
+        /** \brief Protects the start of workers_ */
+        mutable std::mutex workers_mutex_;
         
     };
   }
@@ -527,6 +527,12 @@ namespace pcl
         void
         enlargeToCube (Eigen::Vector3d &bb_min, Eigen::Vector3d &bb_max);
 
+        /** \brief Creates the container of this node for the file \b path and configures it
+         *  with the container initializer of the tree
+         */
+        void
+        createPayload (const boost::filesystem::path &path);
+
         /** \brief The tree we belong to */
         OutofcoreOctreeBase<ContainerT, PointT>* m_tree_;//
         /** \brief The root node of the tree we belong to */
@@ -0,0 +1,293 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+// C++
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <pcl/point_types.h>
+#include <pcl/outofcore/octree_abstract_node_container.h>
+#include <pcl/PCLPointCloud2.h>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    /** \class OutofcoreOctreeBufferedDiskContainer
+     *  \brief Disk container which keeps the points of a node in an uncompressed binary PCD file
+     *  and accesses them with positional block reads and writes.
+     *
+     *  Unlike \ref OutofcoreOctreeDiskContainer, which rewrites and decompresses the whole
+     *  node file for every access, this container appends new points at the end of the
+     *  file and reads only the bytes of the requested points: a range is read with one
+     *  call, and the random offsets of the subsampling methods are sorted and coalesced
+     *  into blocks, so that neighboring points share a single read. The node files are
+     *  regular PCD files. Files in another PCD format, e.g. written by \ref
+     *  OutofcoreOctreeDiskContainer, are converted when they are opened.
+     *
+     *  It can be used in place of \ref OutofcoreOctreeDiskContainer as the container type
+     *  of \ref OutofcoreOctreeBase.
+     *
+     *  \note Points inserted as pcl::PCLPointCloud2 are converted to \b PointT, fields
+     *  that \b PointT does not have are not stored.
+     *  \ingroup outofcore
+     */
+    template<typename PointT = pcl::PointXYZ>
+    class OutofcoreOctreeBufferedDiskContainer : public OutofcoreAbstractNodeContainer<PointT>
+    {
+      public:
+        using AlignedPointTVector = typename OutofcoreAbstractNodeContainer<PointT>::AlignedPointTVector;
+
+        /** \brief Empty constructor creates disk container and sets filename from random uuid string*/
+        OutofcoreOctreeBufferedDiskContainer ();
+
+        /** \brief Creates uuid named file or loads existing file
+         *
+         * \param[in] dir Path to the tree. If it is a directory, a new uuid named file
+         * is used. If it is an existing file, its points are made accessible.
+         */
+        OutofcoreOctreeBufferedDiskContainer (const boost::filesystem::path &dir);
+
+        /** \brief Flushes the write buffer */
+        ~OutofcoreOctreeBufferedDiskContainer () override;
+
+        /** \brief Provides random access to points based on a linear index */
+        PointT
+        operator[] (std::uint64_t idx) const override;
+
+        /** \brief Adds a single point to the buffer, which is written to disk when it
+         * grows sufficiently large, the object is destroyed or the buffer is flushed */
+        void
+        push_back (const PointT& p);
+
+        /** \brief Appends a vector of points to the file */
+        void
+        insertRange (const AlignedPointTVector& src);
+
+        /** \brief Appends the points of a PCLPointCloud2 object to the file */
+        void
+        insertRange (const pcl::PCLPointCloud2::Ptr &input_cloud);
+
+        void
+        insertRange (const PointT* const * start, const std::uint64_t count) override;
+
+        /** \brief Appends \b count points to the file with a single write
+         * \param[in] start address of the first point to insert
+         * \param[in] count number of points to insert
+         */
+        void
+        insertRange (const PointT* start, const std::uint64_t count) override;
+
+        /** \brief Reads the points [start, start + count) with a single read and appends them to \b dst
+         * \param[in] start index of first point to read
+         * \param[in] count number of points to read
+         * \param[out] dst destination for the points
+         */
+        void
+        readRange (const std::uint64_t start, const std::uint64_t count, AlignedPointTVector &dst) override;
+
+        /** \brief Reads the whole file into \b dst */
+        void
+        readRange (const std::uint64_t, const std::uint64_t, pcl::PCLPointCloud2::Ptr &dst);
+
+        /** \brief Reads the entire point contents from disk into \b output_cloud
+         *  \param[out] output_cloud
+         */
+        int
+        read (pcl::PCLPointCloud2::Ptr &output_cloud);
+
+        /** \brief Grab percent*count random points. Points are \b not guaranteed to be
+         * unique. The sampled offsets are read in sorted, coalesced blocks.
+         *
+         * \param[in] start The starting index of points to select
+         * \param[in] count The length of the range of points from which to randomly sample
+         * \param[in] percent The percentage of count that is enough points to make up this random sample
+         * \param[out] dst destination for the sampled points; size will be percentage*count
+         */
+        void
+        readRangeSubSample (const std::uint64_t start, const std::uint64_t count, const double percent,
+                            AlignedPointTVector &dst) override;
+
+        /** \brief Use bernoulli trials to select points. All points selected will be unique.
+         *
+         * \param[in] start The starting index of points to select
+         * \param[in] count The length of the range of points from which to randomly sample
+         * \param[in] percent The probability of every point to be selected
+         * \param[out] dst destination for the sampled points
+         */
+        void
+        readRangeSubSample_bernoulli (const std::uint64_t start, const std::uint64_t count,
+                                      const double percent, AlignedPointTVector& dst);
+
+        /** \brief Reads the points at the given indices, which have to be sorted in
+         * ascending order, and appends them to \b dst in that order. Points that are
+         * close to each other in the file are read with a single call.
+         * \param[in] indices sorted indices of the points to read
+         * \param[out] dst destination for the points
+         */
+        void
+        readIndices (const std::vector<std::uint64_t> &indices, AlignedPointTVector &dst) const;
+
+        /** \brief Returns the number of points on disk and in the write buffer */
+        std::uint64_t
+        size () const override
+        {
+          return (filelen_ + writebuff_.size ());
+        }
+
+        /** \brief STL-like empty test */
+        bool
+        empty () const override
+        {
+          return ((filelen_ == 0) && writebuff_.empty ());
+        }
+
+        /** \brief Writes the points of the write buffer to disk */
+        void
+        flush (const bool force_cache_dealloc)
+        {
+          flushWritebuff (force_cache_dealloc);
+        }
+
+        /** \brief Returns this objects path name */
+        inline std::string&
+        path ()
+        {
+          return (disk_storage_filename_);
+        }
+
+        /** \brief Removes the points from the write buffer and from disk */
+        void
+        clear () override;
+
+        /** \brief Write points to disk as ascii
+         * \param[in] path
+         */
+        void
+        convertToXYZ (const boost::filesystem::path &path) override;
+
+        /** \brief Returns the number of points on disk and in the write buffer */
+        std::uint64_t
+        getDataSize () const
+        {
+          return (size ());
+        }
+
+      private:
+        /** \brief Byte range of a point that is stored contiguously in \b PointT and in the file */
+        struct RecordField
+        {
+          std::size_t point_offset;
+          std::size_t record_offset;
+          std::size_t size;
+        };
+
+        OutofcoreOctreeBufferedDiskContainer (const OutofcoreOctreeBufferedDiskContainer&) = delete;
+
+        OutofcoreOctreeBufferedDiskContainer&
+        operator= (const OutofcoreOctreeBufferedDiskContainer&) = delete;
+
+        /** \brief Computes the layout of a point in the file from the fields of \b PointT */
+        void
+        initRecordLayout ();
+
+        /** \brief Reads the header of an existing file, converting it to binary if necessary */
+        void
+        openFile ();
+
+        /** \brief Generates the header of the file for \b nr_points points */
+        std::string
+        generateHeader (std::uint64_t nr_points) const;
+
+        /** \brief Reads \b count points starting at index \b start from the file */
+        void
+        readFromFile (std::uint64_t start, std::uint64_t count, AlignedPointTVector &dst) const;
+
+        /** \brief Appends \b count points to the file, the header is rewritten in place
+         * unless its length changes. The length changes when the number of points gains a
+         * digit, the whole file is rewritten then, which is amortized over the points
+         * appended since the previous rewrite. Offsets which cannot be addressed on the
+         * platform raise a PCLException. */
+        void
+        appendToFile (const PointT* start, std::uint64_t count);
+
+        /** \brief Copies a point from its file record */
+        void
+        decodeRecord (const char* record, PointT &p) const;
+
+        /** \brief Copies a point to its file record */
+        void
+        encodeRecord (const PointT &p, char* record) const;
+
+        void
+        flushWritebuff (const bool force_cache_dealloc);
+
+        /** \brief Name of the storage file on disk (i.e., the PCD file) */
+        std::string disk_storage_filename_;
+
+        /** \brief Number of points in the file */
+        std::uint64_t filelen_;
+
+        /** \brief Byte offset of the point data in the file */
+        std::uint64_t data_index_;
+
+        /** \brief Size of one point in the file */
+        std::size_t record_size_;
+
+        /** \brief Contiguous byte ranges of a point in \b PointT and in the file */
+        std::vector<RecordField> record_layout_;
+
+        /** \brief elements [0,...,size()-1] map to [filelen, ..., filelen + size()-1] */
+        AlignedPointTVector writebuff_;
+
+        /** \brief Maximum number of points in the write buffer */
+        static const std::uint64_t WRITE_BUFF_MAX_;
+
+        /** \brief Maximum number of bytes read with a single call */
+        static const std::uint64_t READ_BLOCK_SIZE_;
+
+        /** \brief Maximum gap in bytes between two points that are read with a single call */
+        static const std::uint64_t MAX_GAP_BYTES_;
+
+        static std::mutex rng_mutex_;
+        static std::mt19937 rng_;
+    };
+  } //namespace outofcore
+} //namespace pcl
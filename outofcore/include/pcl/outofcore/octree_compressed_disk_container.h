@@ -0,0 +1,366 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+// C++
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <pcl/point_types.h>
+#include <pcl/outofcore/octree_abstract_node_container.h>
+#include <pcl/PCLPointCloud2.h>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    /** \class OutofcoreOctreeCompressedDiskContainer
+     *  \brief Disk container which stores the points of a node compressed in blocks.
+     *
+     *  Every block of up to BLOCK_SIZE_ points stores its coordinates quantized relative to the
+     *  minimum of the block, delta coded between consecutive points and written as variable
+     *  length integers. The remaining fields of \b PointT are stored as they are, and the whole
+     *  block is compressed with LZF if that makes it smaller. The points keep their order.
+     *
+     *  Blocks are appended to the end of the file and decoded one at a time, so reading a range
+     *  only needs memory for a single decoded block, and the subsampling methods decode only
+     *  the blocks that contain the sampled points. Points which are added with insertRange are
+     *  collected until a block is full; they can be read like the points on disk.
+     *
+     *  The coordinates are lossy: a coordinate differs from the inserted one by at most half of
+     *  the quantization step, see setQuantizationStep. A step of 0 stores the coordinates
+     *  losslessly. Node files in the PCD format, e.g. written by \ref OutofcoreOctreeDiskContainer,
+     *  are converted with the default step when they are opened.
+     *
+     *  It can be used in place of \ref OutofcoreOctreeDiskContainer as the container type
+     *  of \ref OutofcoreOctreeBase; the step of the nodes of a tree is set with
+     *  OutofcoreOctreeBase::setContainerInitializer.
+     *
+     *  \note The block headers are stored in little endian byte order, the fields of the points
+     *  in the byte order of the machine which wrote them.
+     *  \ingroup outofcore
+     */
+    template<typename PointT = pcl::PointXYZ>
+    class OutofcoreOctreeCompressedDiskContainer : public OutofcoreAbstractNodeContainer<PointT>
+    {
+      public:
+        using AlignedPointTVector = typename OutofcoreAbstractNodeContainer<PointT>::AlignedPointTVector;
+
+        /** \brief Empty constructor creates disk container and sets filename from random uuid string*/
+        OutofcoreOctreeCompressedDiskContainer ();
+
+        /** \brief Creates uuid named file or loads existing file
+         *
+         * \param[in] dir Path to the tree. If it is a directory, a new uuid named file
+         * is used. If it is an existing file, its points are made accessible.
+         */
+        OutofcoreOctreeCompressedDiskContainer (const boost::filesystem::path &dir);
+
+        /** \brief Writes the points which are not yet on disk */
+        ~OutofcoreOctreeCompressedDiskContainer () override;
+
+        /** \brief Provides random access to points based on a linear index; decodes the block of the point */
+        PointT
+        operator[] (std::uint64_t idx) const override;
+
+        /** \brief Adds a single point to the container */
+        void
+        push_back (const PointT& p);
+
+        /** \brief Appends a vector of points to the container */
+        void
+        insertRange (const AlignedPointTVector& src);
+
+        /** \brief Appends the points of a PCLPointCloud2 object to the container */
+        void
+        insertRange (const pcl::PCLPointCloud2::Ptr &input_cloud);
+
+        void
+        insertRange (const PointT* const * start, const std::uint64_t count) override;
+
+        /** \brief Appends \b count points to the container; the full blocks are written to disk
+         * \param[in] start address of the first point to insert
+         * \param[in] count number of points to insert
+         */
+        void
+        insertRange (const PointT* start, const std::uint64_t count) override;
+
+        /** \brief Decodes the points [start, start + count) block by block and appends them to \b dst
+         * \param[in] start index of first point to read
+         * \param[in] count number of points to read
+         * \param[out] dst destination for the points
+         */
+        void
+        readRange (const std::uint64_t start, const std::uint64_t count, AlignedPointTVector &dst) override;
+
+        /** \brief Reads all points into \b dst */
+        void
+        readRange (const std::uint64_t, const std::uint64_t, pcl::PCLPointCloud2::Ptr &dst);
+
+        /** \brief Reads all points and concatenates them to \b output_cloud
+         *  \param[out] output_cloud
+         */
+        int
+        read (pcl::PCLPointCloud2::Ptr &output_cloud);
+
+        /** \brief Grab percent*count random points. Points are \b not guaranteed to be
+         * unique. Only the blocks containing sampled points are decoded.
+         *
+         * \param[in] start The starting index of points to select
+         * \param[in] count The length of the range of points from which to randomly sample
+         * \param[in] percent The percentage of count that is enough points to make up this random sample
+         * \param[out] dst destination for the sampled points; size will be percentage*count
+         */
+        void
+        readRangeSubSample (const std::uint64_t start, const std::uint64_t count, const double percent,
+                            AlignedPointTVector &dst) override;
+
+        /** \brief Use bernoulli trials to select points. All points selected will be unique.
+         *
+         * \param[in] start The starting index of points to select
+         * \param[in] count The length of the range of points from which to randomly sample
+         * \param[in] percent The probability of every point to be selected
+         * \param[out] dst destination for the sampled points
+         */
+        void
+        readRangeSubSample_bernoulli (const std::uint64_t start, const std::uint64_t count,
+                                      const double percent, AlignedPointTVector& dst);
+
+        /** \brief Reads the points at the given indices, which have to be sorted in
+         * ascending order, and appends them to \b dst in that order. Every block is
+         * decoded at most once.
+         * \param[in] indices sorted indices of the points to read
+         * \param[out] dst destination for the points
+         */
+        void
+        readIndices (const std::vector<std::uint64_t> &indices, AlignedPointTVector &dst) const;
+
+        /** \brief Returns the number of points on disk and in the write buffer */
+        std::uint64_t
+        size () const override
+        {
+          return (filelen_ + writebuff_.size ());
+        }
+
+        /** \brief STL-like empty test */
+        bool
+        empty () const override
+        {
+          return ((filelen_ == 0) && writebuff_.empty ());
+        }
+
+        /** \brief Writes the points of the write buffer to disk, the last block may be partially filled */
+        void
+        flush (const bool force_cache_dealloc)
+        {
+          flushWritebuff (force_cache_dealloc);
+        }
+
+        /** \brief Returns this objects path name */
+        inline std::string&
+        path ()
+        {
+          return (disk_storage_filename_);
+        }
+
+        /** \brief Removes the points from the write buffer and from disk */
+        void
+        clear () override;
+
+        /** \brief Write points to disk as ascii
+         * \param[in] path
+         */
+        void
+        convertToXYZ (const boost::filesystem::path &path) override;
+
+        /** \brief Returns the number of points on disk and in the write buffer */
+        std::uint64_t
+        getDataSize () const
+        {
+          return (size ());
+        }
+
+        /** \brief Returns the size of the file in bytes */
+        std::uint64_t
+        getFileSize () const
+        {
+          return (file_size_);
+        }
+
+        /** \brief Sets the quantization step of the coordinates of the blocks which this container
+         * writes afterwards, 0.001 by default. The step is stored with every block.
+         * \param[in] step quantization step in the units of the coordinates, 0 stores them losslessly
+         */
+        void
+        setQuantizationStep (const double step)
+        {
+          quantization_step_ = std::max (step, 0.0);
+        }
+
+        /** \brief Returns the quantization step of the coordinates */
+        double
+        getQuantizationStep () const
+        {
+          return (quantization_step_);
+        }
+
+      private:
+        /** \brief Header in front of every block of the file, see writeHeader for its layout on disk */
+        struct BlockHeader
+        {
+          /** \brief number of points in the block */
+          std::uint32_t nr_points;
+          /** \brief combination of the BlockFlags */
+          std::uint32_t flags;
+          /** \brief size of the data of the block in the file */
+          std::uint32_t stored_size;
+          /** \brief size of the data of the block after the LZF decompression */
+          std::uint32_t raw_size;
+          /** \brief coordinates which the quantized coordinates are relative to */
+          double origin[3];
+          /** \brief quantization step of the coordinates */
+          double step;
+        };
+
+        enum BlockFlags
+        {
+          QUANTIZED_XYZ = 1,
+          LZF_COMPRESSED = 2
+        };
+
+        /** \brief Location of a block in the file */
+        struct BlockInfo
+        {
+          /** \brief byte offset of the header of the block */
+          std::uint64_t offset;
+          /** \brief size of the header and the data of the block */
+          std::uint64_t size;
+          /** \brief index of the first point of the block */
+          std::uint64_t first;
+          /** \brief number of points in the block */
+          std::uint64_t nr_points;
+        };
+
+        /** \brief Byte range of a field other than the coordinates in \b PointT and in the file */
+        struct RecordField
+        {
+          std::size_t point_offset;
+          std::size_t record_offset;
+          std::size_t size;
+        };
+
+        OutofcoreOctreeCompressedDiskContainer (const OutofcoreOctreeCompressedDiskContainer&) = delete;
+
+        OutofcoreOctreeCompressedDiskContainer&
+        operator= (const OutofcoreOctreeCompressedDiskContainer&) = delete;
+
+        /** \brief Computes the layout of the fields other than x, y and z from the fields of \b PointT */
+        void
+        initRecordLayout ();
+
+        /** \brief Reads the block headers of an existing file, converting it if it is not compressed */
+        void
+        openFile ();
+
+        /** \brief Compresses the points into blocks and appends them to the file */
+        void
+        appendToFile (const PointT* start, std::uint64_t count);
+
+        /** \brief Writes \b header to the HEADER_SIZE_ bytes at \b dst, field by field in little endian byte order */
+        static void
+        writeHeader (const BlockHeader &header, char* dst);
+
+        /** \brief Reads a header written by writeHeader from the HEADER_SIZE_ bytes at \b src */
+        static BlockHeader
+        readHeader (const char* src);
+
+        /** \brief Encodes a block of points into \b data, returns its header */
+        BlockHeader
+        encodeBlock (const PointT* start, std::uint32_t count, std::vector<char> &data) const;
+
+        /** \brief Reads and decodes the block with index \b block_idx */
+        void
+        decodeBlock (int fd, std::size_t block_idx, AlignedPointTVector &dst) const;
+
+        /** \brief Returns the index of the block containing the point with index \b idx */
+        std::size_t
+        findBlock (std::uint64_t idx) const;
+
+        void
+        flushWritebuff (const bool force_cache_dealloc);
+
+        /** \brief Name of the storage file on disk */
+        std::string disk_storage_filename_;
+
+        /** \brief Number of points in the file */
+        std::uint64_t filelen_;
+
+        /** \brief Size of the file in bytes */
+        std::uint64_t file_size_;
+
+        /** \brief Blocks of the file, ordered by their first point */
+        std::vector<BlockInfo> blocks_;
+
+        /** \brief Size of the fields other than x, y and z of a point in the file */
+        std::size_t record_size_;
+
+        /** \brief Contiguous byte ranges of the fields other than x, y and z in \b PointT and in the file */
+        std::vector<RecordField> record_layout_;
+
+        /** \brief elements [0,...,size()-1] map to [filelen, ..., filelen + size()-1] */
+        AlignedPointTVector writebuff_;
+
+        /** \brief Quantization step of the coordinates of the blocks which are written */
+        double quantization_step_;
+
+        /** \brief Maximum number of points in a block */
+        static const std::uint64_t BLOCK_SIZE_;
+
+        /** \brief Size of a block header in the file */
+        static const std::size_t HEADER_SIZE_;
+
+        /** \brief Identifies the files of this container */
+        static const char FILE_MAGIC_[8];
+
+        static std::mutex rng_mutex_;
+        static std::mt19937 rng_;
+    };
+  } //namespace outofcore
+} //namespace pcl
@@ -48,6 +48,8 @@
 #include <pcl/outofcore/octree_abstract_node_container.h>
 
 #include <pcl/outofcore/octree_disk_container.h>
+#include <pcl/outofcore/octree_buffered_disk_container.h>
+#include <pcl/outofcore/octree_compressed_disk_container.h>
 #include <pcl/outofcore/octree_ram_container.h>
 
 #include <pcl/outofcore/outofcore_iterator_base.h>
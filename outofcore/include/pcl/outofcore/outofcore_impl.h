@@ -47,4 +47,6 @@
 #include <pcl/outofcore/impl/octree_base_node.hpp>
 
 #include <pcl/outofcore/impl/octree_disk_container.hpp>
+#include <pcl/outofcore/impl/octree_buffered_disk_container.hpp>
+#include <pcl/outofcore/impl/octree_compressed_disk_container.hpp>
 #include <pcl/outofcore/impl/octree_ram_container.hpp>
@@ -235,6 +235,43 @@ namespace pcl
           return (static_cast<int> (k_indices.size ()));
         }
 
+        /** \brief Search for the k-nearest neighbors of several query points. The queries run in
+         * parallel, with the number of threads set on \a tree_.
+         * \param[in] cloud the point cloud data
+         * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+         * \param[in] k the number of neighbors to search for
+         * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to the neighbors of the query point i
+         * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, k_sqr_distances[i] corresponds to the neighbors of the query point i
+         */
+        inline void
+        nearestKSearch (const PointCloud& cloud, const Indices& indices, int k,
+                        std::vector<Indices>& k_indices,
+                        std::vector< std::vector<float> >& k_sqr_distances) const override
+        {
+          tree_->nearestKSearch (cloud, indices, k, k_indices, k_sqr_distances);
+        }
+
+        /** \brief Search for all neighbors of several query points within a given radius. The queries
+         * run in parallel, with the number of threads set on \a tree_.
+         * \param[in] cloud the point cloud data
+         * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+         * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+         * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to the neighbors of the query point i
+         * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, k_sqr_distances[i] corresponds to the neighbors of the query point i
+         * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+         */
+        inline void
+        radiusSearch (const PointCloud& cloud, const Indices& indices, double radius,
+                      std::vector<Indices>& k_indices,
+                      std::vector< std::vector<float> >& k_sqr_distances,
+                      unsigned int max_nn = 0) const override
+        {
+          tree_->radiusSearch (cloud, indices, radius, k_indices, k_sqr_distances, max_nn);
+          if (sorted_results_)
+            for (std::size_t i = 0; i < k_indices.size (); ++i)
+              this->sortResults (k_indices[i], k_sqr_distances[i]);
+        }
+
 
         /** \brief Search for approximate nearest neighbor at the query point.
           * \param[in] cloud the point cloud data
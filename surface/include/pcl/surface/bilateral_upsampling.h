@@ -81,6 +81,7 @@ namespace pcl
         : window_size_ (5)
         , sigma_color_ (15.0f)
         , sigma_depth_ (0.5f)
+        , threads_ (1)
       {
         KinectVGAProjectionMatrix << 525.0f, 0.0f, 320.0f,
                                      0.0f, 525.0f, 240.0f,
@@ -132,6 +133,12 @@ namespace pcl
       inline Eigen::Matrix3f
       getProjectionMatrix () const { return (projection_matrix_); }
 
+      /** \brief Set the number of threads used to filter the rows of the cloud in parallel.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Method that does the actual processing on the input cloud.
         * \param[out] output the container of the resulting upsampled cloud */
       void
@@ -152,6 +159,9 @@ namespace pcl
       float sigma_color_, sigma_depth_;
       Eigen::Matrix3f projection_matrix_, unprojection_matrix_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -90,7 +90,8 @@ namespace pcl
       /** \brief Empty constructor. */
       ConvexHull () : compute_area_ (false), total_area_ (0), total_volume_ (0), dimension_ (0),
                       projection_angle_thresh_ (std::cos (0.174532925) ), qhull_flags ("qhull "),
-                      x_axis_ (1.0, 0.0, 0.0), y_axis_ (0.0, 1.0, 0.0), z_axis_ (0.0, 0.0, 1.0)
+                      x_axis_ (1.0, 0.0, 0.0), y_axis_ (0.0, 1.0, 0.0), z_axis_ (0.0, 0.0, 1.0),
+                      incremental_ (false)
       {
       }
       
@@ -174,6 +175,38 @@ namespace pcl
       void
       getHullPointIndices (pcl::PointIndices &hull_point_indices) const;
 
+      /** \brief If set to true, each reconstruction updates the hull of the previous inputs with the current input
+        * (e.g. a new batch of points), instead of computing the hull of the current input only.
+        *
+        * \note Only the vertices of the previous hull and the points of the current input that lie outside of it are
+        * passed to qhull. If no point lies outside, the previous hull is returned without calling qhull. After an
+        * update, getHullPointIndices only contains the hull points that belong to the current input.
+        * \param[in] value whether to update the hull incrementally, default is false. Changing it discards the
+        * previous hull.
+        */
+      void
+      setIncremental (bool value)
+      {
+        incremental_ = value;
+        clearIncrementalHull ();
+      }
+
+      /** \brief Returns whether each reconstruction updates the hull of the previous inputs. */
+      bool
+      getIncremental () const
+      {
+        return (incremental_);
+      }
+
+      /** \brief Discards the hull of the previous inputs, the next reconstruction starts a new hull. */
+      void
+      clearIncrementalHull ()
+      {
+        incremental_hull_.clear ();
+        incremental_polygons_.clear ();
+        hull_planes_.clear ();
+      }
+
     protected:
       /** \brief The actual reconstruction method. 
         * 
@@ -225,6 +258,16 @@ namespace pcl
       void
       performReconstruction (std::vector<pcl::Vertices> &polygons) override;
 
+      /** \brief Updates the hull of the previous inputs with the points of the current input that lie outside of it.
+        *
+        * \param[out] points the resultant points lying on the convex hull
+        * \param[out] polygons the resultant convex hull polygons, as a set of
+        * vertices. The Vertices structure contains an array of point indices.
+        */
+      void
+      performIncrementalReconstruction (PointCloud &points,
+                                        std::vector<pcl::Vertices> &polygons);
+
       /** \brief Automatically determines the dimension of input data - 2D or 3D. */
       void 
       calculateInputDimension ();
@@ -266,6 +309,18 @@ namespace pcl
       /* \brief vector containing the point cloud indices of the convex hull points. */
       pcl::PointIndices hull_indices_;
 
+      /** \brief True if each reconstruction updates the hull of the previous inputs. */
+      bool incremental_;
+
+      /** \brief The points of the hull of the previous inputs, in incremental mode. */
+      PointCloud incremental_hull_;
+
+      /** \brief The polygons of the hull of the previous inputs, in incremental mode. */
+      std::vector<pcl::Vertices> incremental_polygons_;
+
+      /** \brief The planes bounding the hull of the previous inputs, with normals pointing outwards. */
+      std::vector<Eigen::Vector4d, Eigen::aligned_allocator<Eigen::Vector4d> > hull_planes_;
+
       public:
         PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
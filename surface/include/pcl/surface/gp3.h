@@ -163,6 +163,9 @@ namespace pcl
         eps_angle_(M_PI/4), //45 degrees,
         consistent_(false), 
         consistent_ordering_ (false),
+        tile_size_ (0),
+        tile_overlap_ (0),
+        threads_ (1),
         angles_ (),
         R_ (),
         is_current_free_ (false),
@@ -174,7 +177,8 @@ namespace pcl
         changed_1st_fn_ (false),
         changed_2nd_fn_ (false),
         new2boundary_ (),
-        already_connected_ (false)
+        already_connected_ (false),
+        nr_halo_points_ (0)
       {};
 
       /** \brief Set the multiplier of the nearest neighbor distance to obtain the final search radius for each point
@@ -277,6 +281,37 @@ namespace pcl
       getPartIDs () const { return (part_); }
 
 
+      /** \brief Set the edge length of the cubic tiles in which the cloud is triangulated independently.
+        * \details The tiles are processed concurrently, each tile including the points of its neighbors
+        * that are closer than the tile overlap. A triangle is kept by the tile that contains its vertex with
+        * the lowest index, so that the result does not depend on the number of threads.
+        * \param[in] tile_size the edge length of the tiles (0 disables the partitioning, which is the default)
+        * \note Since the tiles are triangulated independently, the mesh may have small holes or overlapping
+        * triangles along the tile borders.
+        */
+      inline void
+      setTileSize (double tile_size) { tile_size_ = tile_size; }
+
+      /** \brief Get the edge length of the tiles in which the cloud is triangulated independently. */
+      inline double
+      getTileSize () const { return (tile_size_); }
+
+      /** \brief Set the width of the border of the neighboring tiles that is triangulated with each tile.
+        * \param[in] tile_overlap the width of the border (0 uses twice the search radius). It is limited to the tile size.
+        */
+      inline void
+      setTileOverlap (double tile_overlap) { tile_overlap_ = tile_overlap; }
+
+      /** \brief Get the width of the border of the neighboring tiles that is triangulated with each tile. */
+      inline double
+      getTileOverlap () const { return (tile_overlap_); }
+
+      /** \brief Set the number of threads used to triangulate the tiles (see setTileSize).
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Get the sfn list. */
       inline pcl::Indices
       getSFN () const { return (sfn_); }
@@ -310,6 +345,15 @@ namespace pcl
       /** \brief Set this to true if the output triangle vertices should be consistently oriented. */
       bool consistent_ordering_;
 
+      /** \brief The edge length of the tiles that are triangulated independently (0 to disable). */
+      double tile_size_;
+
+      /** \brief The width of the border of the neighboring tiles that is triangulated with each tile. */
+      double tile_overlap_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
      private:
       /** \brief Struct for storing the angles to nearest neighbors **/
       struct nnAngle
@@ -395,6 +439,13 @@ namespace pcl
       /** \brief Temporary variable to store 3 coordinates **/
       Eigen::Vector3f tmp_;
 
+      /** \brief Precomputed nearest neighbors (as positions in indices_), nnn_ entries per point **/
+      pcl::Indices nn_cache_indices_;
+      /** \brief Squared distances of the precomputed nearest neighbors **/
+      std::vector<float> nn_cache_sqr_dists_;
+      /** \brief Number of points at the end of indices_ that are only used as neighbors **/
+      std::size_t nr_halo_points_;
+
       /** \brief The actual surface reconstruction method.
         * \param[out] output the resultant polygonal mesh
         */
@@ -413,6 +464,22 @@ namespace pcl
       bool
       reconstructPolygons (std::vector<pcl::Vertices> &polygons);
 
+      /** \brief Triangulate the tiles of the cloud concurrently and stitch the results.
+        * \param[out] polygons the resultant polygons, as a set of vertices. The Vertices structure contains an array of point indices.
+        */
+      bool
+      reconstructTiles (std::vector<pcl::Vertices> &polygons);
+
+      /** \brief Get the nnn_ nearest neighbors of a point, either from the precomputed lists or from the search tree.
+        * \param[in] index the position of the query point in indices_
+        * \param[in] point2index the mapping from cloud indices to positions in indices_
+        * \param[out] nnIdx the positions of the neighbors in indices_
+        * \param[out] sqrDists the squared distances to the neighbors
+        */
+      void
+      searchForNeighbors (int index, const std::vector<int> &point2index,
+                          pcl::Indices &nnIdx, std::vector<float> &sqrDists) const;
+
       /** \brief Class get name method. */
       std::string 
       getClassName () const override { return ("GreedyProjectionTriangulation"); }
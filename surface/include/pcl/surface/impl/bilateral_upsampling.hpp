@@ -41,6 +41,7 @@
 
 #include <pcl/surface/bilateral_upsampling.h>
 #include <algorithm>
+#include <vector>
 #include <pcl/console/print.h>
 
 #include <Eigen/LU> // for inverse
@@ -83,81 +84,123 @@ pcl::BilateralUpsampling<PointInT, PointOutT>::process (pcl::PointCloud<PointOut
   deinitCompute ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::BilateralUpsampling<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::BilateralUpsampling<PointInT, PointOutT>::performProcessing (PointCloudOut &output)
 {
     output.resize (input_->size ());
     float nan = std::numeric_limits<float>::quiet_NaN ();
+    int width = static_cast<int> (input_->width),
+        height = static_cast<int> (input_->height);
 
     Eigen::MatrixXf val_exp_depth_matrix;
     Eigen::VectorXf val_exp_rgb_vector;
     computeDistances (val_exp_depth_matrix, val_exp_rgb_vector);
 
-    for (int x = 0; x < static_cast<int> (input_->width); ++x)
-      for (int y = 0; y < static_cast<int> (input_->height); ++y)
+    // Split the points into depth and color, invalid depths get a zero weight so that the window sums need no branch
+    std::vector<float> depth (input_->size ()), depth_weight (input_->size ());
+    std::vector<std::uint8_t> color (3 * input_->size ());
+    for (std::size_t i = 0; i < input_->size (); ++i)
+    {
+      const bool valid = std::isfinite ((*input_)[i].z);
+      depth[i] = valid ? (*input_)[i].z : 0.0f;
+      depth_weight[i] = valid ? 1.0f : 0.0f;
+      color[3 * i] = (*input_)[i].r;
+      color[3 * i + 1] = (*input_)[i].g;
+      color[3 * i + 2] = (*input_)[i].b;
+    }
+
+#pragma omp parallel for \
+  default(none) \
+  shared(color, depth, depth_weight, height, nan, output, val_exp_depth_matrix, val_exp_rgb_vector, width) \
+  schedule(dynamic) \
+  num_threads(threads_)
+    for (int y = 0; y < height; ++y)
+    {
+      const int window_size = window_size_;
+      const float *val_exp_rgb = val_exp_rgb_vector.data ();
+      for (int x = 0; x < width; ++x)
       {
-        int start_window_x = std::max (x - window_size_, 0),
-            start_window_y = std::max (y - window_size_, 0),
-            end_window_x = std::min (x + window_size_, static_cast<int> (input_->width)),
-            end_window_y = std::min (y + window_size_, static_cast<int> (input_->height));
+        const int idx = y * width + x;
+        int start_window_x = std::max (x - window_size, 0),
+            start_window_y = std::max (y - window_size, 0),
+            end_window_x = std::min (x + window_size, width),
+            end_window_y = std::min (y + window_size, height);
 
-        float sum = 0.0f,
-            norm_sum = 0.0f;
+        const int r = color[3 * idx], g = color[3 * idx + 1], b = color[3 * idx + 2];
+        double sum = 0.0,
+            norm_sum = 0.0;
 
-        for (int x_w = start_window_x; x_w < end_window_x; ++ x_w)
-          for (int y_w = start_window_y; y_w < end_window_y; ++ y_w)
+        for (int y_w = start_window_y; y_w < end_window_y; ++ y_w)
+        {
+          // Spatial weights of the row of the window, the table is symmetric in x and y
+          const float *val_exp_depth = &val_exp_depth_matrix (0, static_cast<Eigen::MatrixXf::Index> (y - y_w + window_size));
+          const std::uint8_t *color_w = &color[3 * (y_w * width)];
+          const float *depth_w = &depth[y_w * width];
+          const float *depth_weight_w = &depth_weight[y_w * width];
+          for (int x_w = start_window_x; x_w < end_window_x; ++ x_w)
           {
-            float val_exp_depth = val_exp_depth_matrix (static_cast<Eigen::MatrixXf::Index> (x - x_w + window_size_),
-                                                        static_cast<Eigen::MatrixXf::Index> (y - y_w + window_size_));
-
-            auto d_color = static_cast<Eigen::VectorXf::Index> (
-                std::abs ((*input_)[y_w * input_->width + x_w].r - (*input_)[y * input_->width + x].r) +
-                std::abs ((*input_)[y_w * input_->width + x_w].g - (*input_)[y * input_->width + x].g) +
-                std::abs ((*input_)[y_w * input_->width + x_w].b - (*input_)[y * input_->width + x].b));
-
-            float val_exp_rgb = val_exp_rgb_vector (d_color);
+            const int d_color = std::abs (color_w[3 * x_w] - r) +
+                                std::abs (color_w[3 * x_w + 1] - g) +
+                                std::abs (color_w[3 * x_w + 2] - b);
 
-            if (std::isfinite ((*input_)[y_w*input_->width + x_w].z))
-            {
-              sum += val_exp_depth * val_exp_rgb * (*input_)[y_w*input_->width + x_w].z;
-              norm_sum += val_exp_depth * val_exp_rgb;
-            }
+            const double weight = static_cast<double> (val_exp_depth[x - x_w + window_size]) * val_exp_rgb[d_color] * depth_weight_w[x_w];
+            sum += weight * depth_w[x_w];
+            norm_sum += weight;
           }
+        }
 
-        output[y*input_->width + x].r = (*input_)[y*input_->width + x].r;
-        output[y*input_->width + x].g = (*input_)[y*input_->width + x].g;
-        output[y*input_->width + x].b = (*input_)[y*input_->width + x].b;
+        output[idx].r = (*input_)[idx].r;
+        output[idx].g = (*input_)[idx].g;
+        output[idx].b = (*input_)[idx].b;
 
-        if (norm_sum != 0.0f)
+        if (norm_sum != 0.0)
         {
-          float depth = sum / norm_sum;
-          Eigen::Vector3f pc (static_cast<float> (x) * depth, static_cast<float> (y) * depth, depth);
+          float depth_p = static_cast<float> (sum / norm_sum);
+          Eigen::Vector3f pc (static_cast<float> (x) * depth_p, static_cast<float> (y) * depth_p, depth_p);
           Eigen::Vector3f pw (unprojection_matrix_ * pc);
-          output[y*input_->width + x].x = pw[0];
-          output[y*input_->width + x].y = pw[1];
-          output[y*input_->width + x].z = pw[2];
+          output[idx].x = pw[0];
+          output[idx].y = pw[1];
+          output[idx].z = pw[2];
         }
         else
         {
-          output[y*input_->width + x].x = nan;
-          output[y*input_->width + x].y = nan;
-          output[y*input_->width + x].z = nan;
+          output[idx].x = nan;
+          output[idx].y = nan;
+          output[idx].z = nan;
         }
       }
+    }
 
     output.header = input_->header;
     output.width = input_->width;
     output.height = input_->height;
 }
 
-
 template <typename PointInT, typename PointOutT> void
 pcl::BilateralUpsampling<PointInT, PointOutT>::computeDistances (Eigen::MatrixXf &val_exp_depth, Eigen::VectorXf &val_exp_rgb)
 {
   val_exp_depth.resize (2*window_size_+1,2*window_size_+1);
   val_exp_rgb.resize (3*255+1);
 
+  // Denormal weights are set to 0, they are very slow to compute with; the products of the remaining weights are
+  // computed in double precision, where they are never denormal
+  const float min_weight = std::numeric_limits<float>::min ();
+
   int j = 0;
   for (int dx = -window_size_; dx < window_size_+1; ++dx)
   {
@@ -165,7 +208,7 @@ pcl::BilateralUpsampling<PointInT, PointOutT>::computeDistances (Eigen::MatrixXf
     for (int dy = -window_size_; dy < window_size_+1; ++dy)
     {
       float val_exp = std::exp (- (dx*dx + dy*dy) / (2.0f * static_cast<float> (sigma_depth_ * sigma_depth_)));
-      val_exp_depth(i,j) = val_exp;
+      val_exp_depth(i,j) = val_exp < min_weight ? 0.0f : val_exp;
       i++;
     }
     j++;
@@ -174,7 +217,7 @@ pcl::BilateralUpsampling<PointInT, PointOutT>::computeDistances (Eigen::MatrixXf
   for (int d_color = 0; d_color < 3*255+1; d_color++)
   {
     float val_exp = std::exp (- d_color * d_color / (2.0f * sigma_color_ * sigma_color_));
-    val_exp_rgb(d_color) = val_exp;
+    val_exp_rgb(d_color) = val_exp < min_weight ? 0.0f : val_exp;
   }
 }
 
@@ -50,6 +50,7 @@
 #include <pcl/common/io.h>
 #include <cstdio>
 #include <cstdlib>
+#include <numeric> // for iota
 #include <pcl/surface/qhull.h>
 
 //////////////////////////////////////////////////////////////////////////
@@ -273,6 +274,27 @@ pcl::ConvexHull<PointInT>::performReconstruction2D (PointCloud &hull, std::vecto
     hull[j] = (*input_)[(*indices_)[idx_points[j].first]];
     polygons[0].vertices[j] = static_cast<unsigned int> (j);
   }
+
+  // The planes through the edges of the polygon, orthogonal to its plane, bound the hull for the next update
+  if (incremental_)
+  {
+    hull_planes_.clear ();
+    hull_planes_.reserve (hull.size ());
+    const Eigen::Vector4d hull_centroid = centroid.cast<double> ();
+    for (std::size_t j = 0; j < hull.size (); j++)
+    {
+      const Eigen::Vector3d a = hull[j].getVector3fMap ().template cast<double> ();
+      const Eigen::Vector3d b = hull[(j + 1) % hull.size ()].getVector3fMap ().template cast<double> ();
+      Eigen::Vector3d normal = (b - a).cross (plane_params);
+      if (normal.squaredNorm () == 0.0)
+        continue;
+      normal.normalize ();
+      Eigen::Vector4d plane (normal[0], normal[1], normal[2], -normal.dot (a));
+      if (plane.dot (hull_centroid) > 0.0)
+        plane = -plane;
+      hull_planes_.push_back (plane);
+    }
+  }
     
   qh_freeqhull (qh, !qh_ALL);
   int curlong, totlong;
@@ -353,6 +375,16 @@ pcl::ConvexHull<PointInT>::performReconstruction3D (
 
   int num_facets = qh->num_facets;
 
+  // The facets bound the hull for the next update, qhull orients their normals outwards
+  if (incremental_)
+  {
+    hull_planes_.clear ();
+    hull_planes_.reserve (num_facets);
+    facetT * facet;
+    FORALLfacets
+      hull_planes_.emplace_back (facet->normal[0], facet->normal[1], facet->normal[2], facet->offset);
+  }
+
   int num_vertices = qh->num_vertices;
   hull.resize (num_vertices);
 
@@ -427,12 +459,82 @@ pcl::ConvexHull<PointInT>::performReconstruction (PointCloud &hull, std::vector<
 {
   if (dimension_ == 0)
     calculateInputDimension ();
+  if (incremental_ && !incremental_hull_.empty ())
+  {
+    performIncrementalReconstruction (hull, polygons);
+    return;
+  }
+  // The polygons of the hull are kept for the updates, even if they are not requested
   if (dimension_ == 2)
-    performReconstruction2D (hull, polygons, fill_polygon_data);
+    performReconstruction2D (hull, polygons, fill_polygon_data || incremental_);
   else if (dimension_ == 3)
-    performReconstruction3D (hull, polygons, fill_polygon_data);
+    performReconstruction3D (hull, polygons, fill_polygon_data || incremental_);
   else
     PCL_ERROR ("[pcl::%s::performReconstruction] Error: invalid input dimension requested: %d\n",getClassName ().c_str (),dimension_);
+
+  if (incremental_)
+  {
+    incremental_hull_ = hull;
+    incremental_polygons_ = polygons;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::ConvexHull<PointInT>::performIncrementalReconstruction (PointCloud &hull, std::vector<pcl::Vertices> &polygons)
+{
+  // Only the points outside of the previous hull can be vertices of the new hull
+  pcl::Indices outside;
+  for (const auto &index : *indices_)
+  {
+    const Eigen::Vector4d p ((*input_)[index].x, (*input_)[index].y, (*input_)[index].z, 1.0);
+    for (const auto &plane : hull_planes_)
+    {
+      if (plane.dot (p) > 0.0)
+      {
+        outside.push_back (index);
+        break;
+      }
+    }
+  }
+
+  hull_indices_.header = input_->header;
+  hull_indices_.indices.clear ();
+  if (outside.empty ())
+  {
+    hull = incremental_hull_;
+    polygons = incremental_polygons_;
+    return;
+  }
+
+  // Compute the hull of the vertices of the previous hull and of the outside points
+  const PointCloudConstPtr input = input_;
+  const IndicesPtr indices = indices_;
+  PointCloudPtr candidates (new PointCloud (incremental_hull_));
+  for (const auto &index : outside)
+    candidates->push_back ((*input_)[index]);
+  input_ = candidates;
+  indices_.reset (new pcl::Indices (candidates->size ()));
+  std::iota (indices_->begin (), indices_->end (), 0);
+
+  if (dimension_ == 2)
+    performReconstruction2D (hull, polygons, true);
+  else
+    performReconstruction3D (hull, polygons, true);
+
+  const std::size_t nr_previous = incremental_hull_.size ();
+  incremental_hull_ = hull;
+  incremental_polygons_ = polygons;
+  input_ = input;
+  indices_ = indices;
+
+  // Keep the indices of the hull points that belong to the current input
+  pcl::Indices hull_indices;
+  for (const auto &index : hull_indices_.indices)
+    if (static_cast<std::size_t> (index) >= nr_previous)
+      hull_indices.push_back (outside[index - nr_previous]);
+  hull_indices_.header = input_->header;
+  hull_indices_.indices = hull_indices;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -39,6 +39,24 @@
 #define PCL_SURFACE_IMPL_GP3_H_
 
 #include <pcl/surface/gp3.h>
+#include <pcl/common/common.h> // for getMinMax3D
+
+#include <numeric> // for partial_sum
+#include <unordered_map>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::GreedyProjectionTriangulation<PointInT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
@@ -77,6 +95,9 @@ pcl::GreedyProjectionTriangulation<PointInT>::reconstructPolygons (std::vector<p
     polygons.clear ();
     return (false);
   }
+  if (tile_size_ > 0)
+    return (reconstructTiles (polygons));
+
   const double sqr_mu = mu_*mu_;
   const double sqr_max_edge = search_radius_*search_radius_;
   if (nnn_ > static_cast<int> (indices_->size ()))
@@ -116,21 +137,26 @@ pcl::GreedyProjectionTriangulation<PointInT>::reconstructPolygons (std::vector<p
   if (!input_->is_dense)
   {
     // Skip invalid points from the indices list
-    for (const auto& idx : (*indices_))
-      if (!std::isfinite ((*input_)[idx].x) ||
-          !std::isfinite ((*input_)[idx].y) ||
-          !std::isfinite ((*input_)[idx].z))
-        state_[idx] = NONE;
+    for (std::size_t cp = 0; cp < indices_->size (); ++cp)
+      if (!std::isfinite ((*input_)[(*indices_)[cp]].x) ||
+          !std::isfinite ((*input_)[(*indices_)[cp]].y) ||
+          !std::isfinite ((*input_)[(*indices_)[cp]].z))
+        state_[cp] = NONE;
   }
+  // Points that are only neighbors of the points to triangulate are never connected
+  std::fill (state_.end () - nr_halo_points_, state_.end (), NONE);
 
-  // Saving coordinates and point to index mapping
+  // Saving coordinates and point to index mapping (not needed with precomputed neighbors)
   coords_.clear ();
   coords_.reserve (indices_->size ());
-  std::vector<int> point2index (input_->size (), -1);
+  std::vector<int> point2index;
+  if (nn_cache_indices_.empty ())
+    point2index.resize (input_->size (), -1);
   for (int cp = 0; cp < static_cast<int> (indices_->size ()); ++cp)
   {
     coords_.push_back((*input_)[(*indices_)[cp]].getVector3fMap());
-    point2index[(*indices_)[cp]] = cp;
+    if (nn_cache_indices_.empty ())
+      point2index[(*indices_)[cp]] = cp;
   }
 
   // Initializing
@@ -149,19 +175,9 @@ pcl::GreedyProjectionTriangulation<PointInT>::reconstructPolygons (std::vector<p
       part_[R_] = part_index++;
 
       // creating starting triangle
-      //searchForNeighbors ((*indices_)[R_], nnIdx, sqrDists);
-      //tree_->nearestKSearch ((*input_)[(*indices_)[R_]], nnn_, nnIdx, sqrDists);
-      tree_->nearestKSearch (indices_->at (R_), nnn_, nnIdx, sqrDists);
+      searchForNeighbors (R_, point2index, nnIdx, sqrDists);
       double sqr_dist_threshold = (std::min)(sqr_max_edge, sqr_mu * sqrDists[1]);
 
-      // Search tree returns indices into the original cloud, but we are working with indices. TODO: make that optional!
-      for (int i = 1; i < nnn_; i++)
-      {
-        //if (point2index[nnIdx[i]] == -1)
-        //  std::cerr << R_ << " [" << indices_->at (R_) << "] " << i << ": " << nnIdx[i] << " / " << point2index[nnIdx[i]] << std::endl;
-        nnIdx[i] = point2index[nnIdx[i]];
-      }
-
       // Get the normal estimate at the current point 
       const Eigen::Vector3f nc = (*input_)[(*indices_)[R_]].getNormalVector3fMap ();
 
@@ -303,17 +319,7 @@ pcl::GreedyProjectionTriangulation<PointInT>::reconstructPolygons (std::vector<p
         state_[R_] = COMPLETED;
         continue;
       }
-      //searchForNeighbors ((*indices_)[R_], nnIdx, sqrDists);
-      //tree_->nearestKSearch ((*input_)[(*indices_)[R_]], nnn_, nnIdx, sqrDists);
-      tree_->nearestKSearch (indices_->at (R_), nnn_, nnIdx, sqrDists);
-
-      // Search tree returns indices into the original cloud, but we are working with indices TODO: make that optional!
-      for (int i = 1; i < nnn_; i++)
-      {
-        //if (point2index[nnIdx[i]] == -1)
-        //  std::cerr << R_ << " [" << indices_->at (R_) << "] " << i << ": " << nnIdx[i] << " / " << point2index[nnIdx[i]] << std::endl;
-        nnIdx[i] = point2index[nnIdx[i]];
-      }
+      searchForNeighbors (R_, point2index, nnIdx, sqrDists);
 
       // Locating FFN and SFN to adapt distance threshold
       double sqr_source_dist = (coords_[R_] - coords_[source_[R_]]).squaredNorm ();
@@ -1046,6 +1052,228 @@ pcl::GreedyProjectionTriangulation<PointInT>::reconstructPolygons (std::vector<p
   return (true);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::GreedyProjectionTriangulation<PointInT>::searchForNeighbors (
+    int index, const std::vector<int> &point2index, pcl::Indices &nnIdx, std::vector<float> &sqrDists) const
+{
+  if (!nn_cache_indices_.empty ())
+  {
+    const std::size_t offset = static_cast<std::size_t> (index) * nnn_;
+    nnIdx.assign (nn_cache_indices_.begin () + offset, nn_cache_indices_.begin () + offset + nnn_);
+    sqrDists.assign (nn_cache_sqr_dists_.begin () + offset, nn_cache_sqr_dists_.begin () + offset + nnn_);
+    return;
+  }
+
+  tree_->nearestKSearch (indices_->at (index), nnn_, nnIdx, sqrDists);
+
+  // Search tree returns indices into the original cloud, but we are working with indices. TODO: make that optional!
+  for (int i = 1; i < nnn_; i++)
+    nnIdx[i] = point2index[nnIdx[i]];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> bool
+pcl::GreedyProjectionTriangulation<PointInT>::reconstructTiles (std::vector<pcl::Vertices> &polygons)
+{
+  if (nnn_ > static_cast<int> (indices_->size ()))
+    nnn_ = static_cast<int> (indices_->size ());
+  int nnn = nnn_;
+  float tile_size = static_cast<float> (tile_size_);
+  float overlap = static_cast<float> ((std::min) ((tile_overlap_ > 0) ? tile_overlap_ : 2 * search_radius_, tile_size_));
+
+  polygons.clear ();
+  part_.assign (indices_->size (), -1);
+  state_.assign (indices_->size (), NONE);
+  source_.assign (indices_->size (), NONE);
+  ffn_.assign (indices_->size (), NONE);
+  sfn_.assign (indices_->size (), NONE);
+
+  // Assigning the finite points to the tiles of a regular grid, sorted by tile and position in indices_
+  Eigen::Vector4f min_pt, max_pt;
+  pcl::getMinMax3D (*input_, *indices_, min_pt, max_pt);
+  if ((min_pt.head<3> ().array () > max_pt.head<3> ().array ()).any ())
+    return (true);
+  const Eigen::Array3i nr_tiles_3d = ((max_pt - min_pt).head<3> ().array () / tile_size).floor ().template cast<int> () + 1;
+
+  std::vector<std::pair<std::uint64_t, int> > sorted_points;
+  sorted_points.reserve (indices_->size ());
+  for (int cp = 0; cp < static_cast<int> (indices_->size ()); ++cp)
+  {
+    const Eigen::Vector3f p = (*input_)[(*indices_)[cp]].getVector3fMap ();
+    if (!p.allFinite ())
+      continue;
+    const Eigen::Array3i tile = ((p - min_pt.head<3> ()).array () / tile_size).floor ().template cast<int> ().max (0).min (nr_tiles_3d - 1);
+    sorted_points.emplace_back ((static_cast<std::uint64_t> (tile[0]) * nr_tiles_3d[1] + tile[1]) * nr_tiles_3d[2] + tile[2], cp);
+  }
+  std::sort (sorted_points.begin (), sorted_points.end ());
+
+  std::vector<std::uint64_t> tile_keys;
+  std::vector<std::size_t> tile_begin;
+  std::unordered_map<std::uint64_t, std::size_t> key2tile;
+  std::vector<int> point2tile (indices_->size (), -1);
+  for (std::size_t i = 0; i < sorted_points.size (); ++i)
+  {
+    if (tile_keys.empty () || tile_keys.back () != sorted_points[i].first)
+    {
+      key2tile[sorted_points[i].first] = tile_keys.size ();
+      tile_keys.push_back (sorted_points[i].first);
+      tile_begin.push_back (i);
+    }
+    point2tile[sorted_points[i].second] = static_cast<int> (tile_keys.size ()) - 1;
+  }
+  tile_begin.push_back (sorted_points.size ());
+  std::ptrdiff_t nr_tiles = static_cast<std::ptrdiff_t> (tile_keys.size ());
+
+  std::vector<int> point2index (input_->size (), -1);
+  for (int cp = 0; cp < static_cast<int> (indices_->size ()); ++cp)
+    point2index[(*indices_)[cp]] = cp;
+
+  std::vector<std::vector<pcl::Vertices> > tile_polygons (nr_tiles);
+  std::vector<int> tile_nr_parts (nr_tiles, 0);
+
+#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
+#pragma omp parallel for \
+  default(none) \
+  shared(min_pt, sorted_points, tile_keys, tile_begin, key2tile, point2tile, point2index, tile_polygons, tile_nr_parts) \
+  firstprivate(nr_tiles, nnn, tile_size, overlap) \
+  schedule(dynamic) \
+  num_threads(threads_)
+#else
+#pragma omp parallel for \
+  default(none) \
+  shared(min_pt, nr_tiles_3d, sorted_points, tile_keys, tile_begin, key2tile, point2tile, point2index, tile_polygons, tile_nr_parts) \
+  firstprivate(nr_tiles, nnn, tile_size, overlap) \
+  schedule(dynamic) \
+  num_threads(threads_)
+#endif
+  for (std::ptrdiff_t t = 0; t < nr_tiles; ++t)
+  {
+    const std::uint64_t key = tile_keys[t];
+    const Eigen::Array3i tile (static_cast<int> (key / (static_cast<std::uint64_t> (nr_tiles_3d[1]) * nr_tiles_3d[2])),
+                               static_cast<int> ((key / nr_tiles_3d[2]) % nr_tiles_3d[1]),
+                               static_cast<int> (key % nr_tiles_3d[2]));
+    const Eigen::Array3f lower = min_pt.head<3> ().array () + tile.cast<float> () * tile_size - overlap;
+    const Eigen::Array3f upper = lower + tile_size + 2 * overlap;
+
+    // Collecting the points of the tile and of the borders of its neighbors
+    std::vector<int> members;
+    for (int dx = -1; dx <= 1; ++dx)
+      for (int dy = -1; dy <= 1; ++dy)
+        for (int dz = -1; dz <= 1; ++dz)
+        {
+          const Eigen::Array3i neighbor = tile + Eigen::Array3i (dx, dy, dz);
+          if ((neighbor < 0).any () || (neighbor >= nr_tiles_3d).any ())
+            continue;
+          const auto it = key2tile.find ((static_cast<std::uint64_t> (neighbor[0]) * nr_tiles_3d[1] + neighbor[1]) * nr_tiles_3d[2] + neighbor[2]);
+          if (it == key2tile.end ())
+            continue;
+          for (std::size_t i = tile_begin[it->second]; i < tile_begin[it->second + 1]; ++i)
+          {
+            const Eigen::Array3f p = (*input_)[(*indices_)[sorted_points[i].second]].getArray3fMap ();
+            if ((static_cast<std::ptrdiff_t> (it->second) == t) || ((p >= lower).all () && (p <= upper).all ()))
+              members.push_back (sorted_points[i].second);
+          }
+        }
+    std::sort (members.begin (), members.end ());
+
+    // Computing the neighbors once, the ones outside of the tile are appended as halo points
+    GreedyProjectionTriangulation<PointInT> tile_gp3;
+    tile_gp3.mu_ = mu_;
+    tile_gp3.search_radius_ = search_radius_;
+    tile_gp3.nnn_ = nnn;
+    tile_gp3.minimum_angle_ = minimum_angle_;
+    tile_gp3.maximum_angle_ = maximum_angle_;
+    tile_gp3.eps_angle_ = eps_angle_;
+    tile_gp3.consistent_ = consistent_;
+    tile_gp3.consistent_ordering_ = consistent_ordering_;
+    tile_gp3.tree_ = tree_;
+    tile_gp3.setInputCloud (input_);
+
+    pcl::IndicesPtr tile_indices (new pcl::Indices);
+    tile_indices->reserve (members.size ());
+    std::unordered_map<pcl::index_t, int> cloud2tile;
+    for (const int cp : members)
+    {
+      cloud2tile.emplace ((*indices_)[cp], static_cast<int> (tile_indices->size ()));
+      tile_indices->push_back ((*indices_)[cp]);
+    }
+    tile_gp3.nn_cache_indices_.resize (members.size () * nnn);
+    tile_gp3.nn_cache_sqr_dists_.resize (members.size () * nnn);
+    pcl::Indices nn_indices;
+    std::vector<float> nn_sqr_dists;
+    for (std::size_t m = 0; m < members.size (); ++m)
+    {
+      tree_->nearestKSearch ((*input_)[(*tile_indices)[m]], nnn, nn_indices, nn_sqr_dists);
+      for (int i = 0; i < nnn; ++i)
+      {
+        const int k = (std::min) (i, static_cast<int> (nn_indices.size ()) - 1);
+        const auto inserted = cloud2tile.emplace (nn_indices[k], static_cast<int> (tile_indices->size ()));
+        if (inserted.second)
+          tile_indices->push_back (nn_indices[k]);
+        tile_gp3.nn_cache_indices_[m * nnn + i] = inserted.first->second;
+        tile_gp3.nn_cache_sqr_dists_[m * nnn + i] = nn_sqr_dists[k];
+      }
+    }
+    // reconstructPolygons clamps nnn_ to the number of points of the tile, the cache has to use the same stride
+    const int tile_nnn = (std::min) (nnn, static_cast<int> (tile_indices->size ()));
+    if (tile_nnn < nnn)
+    {
+      for (std::size_t m = 0; m < members.size (); ++m)
+        for (int i = 0; i < tile_nnn; ++i)
+        {
+          tile_gp3.nn_cache_indices_[m * tile_nnn + i] = tile_gp3.nn_cache_indices_[m * nnn + i];
+          tile_gp3.nn_cache_sqr_dists_[m * tile_nnn + i] = tile_gp3.nn_cache_sqr_dists_[m * nnn + i];
+        }
+      tile_gp3.nn_cache_indices_.resize (members.size () * tile_nnn);
+      tile_gp3.nn_cache_sqr_dists_.resize (members.size () * tile_nnn);
+      tile_gp3.nnn_ = tile_nnn;
+    }
+    tile_gp3.nr_halo_points_ = tile_indices->size () - members.size ();
+    tile_gp3.setIndices (tile_indices);
+
+    std::vector<pcl::Vertices> local_polygons;
+    tile_gp3.reconstructPolygons (local_polygons);
+
+    // Keeping the results of the points of the tile, mapped back to positions in indices_
+    const auto toGlobal = [&] (int local) { return ((local < 0) ? local : point2index[(*tile_indices)[local]]); };
+    int nr_parts = 0;
+    for (std::size_t m = 0; m < members.size (); ++m)
+    {
+      nr_parts = (std::max) (nr_parts, tile_gp3.part_[m] + 1);
+      const int cp = members[m];
+      if (point2tile[cp] != t)
+        continue;
+      state_[cp] = tile_gp3.state_[m];
+      part_[cp] = tile_gp3.part_[m];
+      source_[cp] = toGlobal (tile_gp3.source_[m]);
+      ffn_[cp] = toGlobal (tile_gp3.ffn_[m]);
+      sfn_[cp] = toGlobal (tile_gp3.sfn_[m]);
+    }
+    tile_nr_parts[t] = nr_parts;
+
+    // A triangle belongs to the tile of its vertex with the lowest index
+    for (pcl::Vertices &polygon : local_polygons)
+    {
+      for (auto &vertex : polygon.vertices)
+        vertex = toGlobal (vertex);
+      if (point2tile[*std::min_element (polygon.vertices.begin (), polygon.vertices.end ())] == t)
+        tile_polygons[t].push_back (std::move (polygon));
+    }
+  }
+
+  // Numbering the parts of all tiles consecutively and concatenating the triangles
+  std::vector<int> part_offset (nr_tiles + 1, 0);
+  std::partial_sum (tile_nr_parts.begin (), tile_nr_parts.end (), part_offset.begin () + 1);
+  for (std::size_t cp = 0; cp < indices_->size (); ++cp)
+    if (part_[cp] >= 0)
+      part_[cp] += part_offset[point2tile[cp]];
+  for (auto &tile_polygon : tile_polygons)
+    polygons.insert (polygons.end (), tile_polygon.begin (), tile_polygon.end ());
+  PCL_DEBUG ("Number of triangles: %zu in %td tiles\n", polygons.size (), nr_tiles);
+  return (true);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::GreedyProjectionTriangulation<PointInT>::closeTriangle (std::vector<pcl::Vertices> &polygons)
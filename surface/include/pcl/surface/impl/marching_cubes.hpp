@@ -38,13 +38,30 @@
 
 #include <pcl/surface/marching_cubes.h>
 #include <pcl/common/common.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
+#include <algorithm>
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT>
 pcl::MarchingCubes<PointNT>::~MarchingCubes () = default;
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> void
 pcl::MarchingCubes<PointNT>::getBoundingBox ()
@@ -63,6 +80,54 @@ pcl::MarchingCubes<PointNT>::getBoundingBox ()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::createNarrowBand ()
+{
+  block_indices_.clear ();
+
+  const Eigen::Array3i res (res_x_, res_y_, res_z_);
+  const Eigen::Array3f inv_size_voxel = size_voxel_.inverse ();
+  for (const auto &point : *input_)
+  {
+    if (!pcl::isFinite (point))
+      continue;
+
+    // Grid cells whose cubes are within narrow_band_ cells of the point
+    const Eigen::Array3i cell = ((point.getArray3fMap () - lower_boundary_) * inv_size_voxel).floor ().template cast<int> ();
+    const Eigen::Array3i first_block = (cell - narrow_band_).max (0).min (res - 1) / block_size_;
+    const Eigen::Array3i last_block = (cell + narrow_band_ + 1).max (0).min (res - 1) / block_size_;
+
+    Eigen::Vector3i block;
+    for (block[0] = first_block[0]; block[0] <= last_block[0]; ++block[0])
+      for (block[1] = first_block[1]; block[1] <= last_block[1]; ++block[1])
+        for (block[2] = first_block[2]; block[2] <= last_block[2]; ++block[2])
+          block_indices_.emplace (getBlockKey (block * block_size_), 0);
+  }
+
+  // Blocks are numbered in the order of their keys, which is the x-major order of the dense grid
+  std::vector<std::uint64_t> block_keys;
+  block_keys.reserve (block_indices_.size ());
+  for (const auto &block_index : block_indices_)
+    block_keys.push_back (block_index.first);
+  std::sort (block_keys.begin (), block_keys.end ());
+
+  const std::uint64_t nr_blocks_y = (res_y_ + block_size_ - 1) / block_size_;
+  const std::uint64_t nr_blocks_z = (res_z_ + block_size_ - 1) / block_size_;
+  block_origins_.resize (block_keys.size ());
+  for (std::size_t i = 0; i < block_keys.size (); ++i)
+  {
+    const std::uint64_t key = block_keys[i];
+    block_indices_[key] = i;
+    block_origins_[i] = block_size_ * Eigen::Vector3i (static_cast<int> (key / (nr_blocks_y * nr_blocks_z)),
+                                                       static_cast<int> (key / nr_blocks_z % nr_blocks_y),
+                                                       static_cast<int> (key % nr_blocks_z));
+  }
+
+  grid_ = std::vector<float> (block_origins_.size () * block_volume_, NAN);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> void
 pcl::MarchingCubes<PointNT>::interpolateEdge (Eigen::Vector3f &p1,
@@ -80,7 +145,8 @@ pcl::MarchingCubes<PointNT>::interpolateEdge (Eigen::Vector3f &p1,
 template <typename PointNT> void
 pcl::MarchingCubes<PointNT>::createSurface (const std::vector<float> &leaf_node,
                                             const Eigen::Vector3i &index_3d,
-                                            pcl::PointCloud<PointNT> &cloud)
+                                            pcl::PointCloud<PointNT> &cloud,
+                                            std::vector<std::uint64_t> *edge_keys)
 {
   int cubeindex = 0;
   if (leaf_node[0] < iso_level_) cubeindex |= 1;
@@ -155,6 +221,21 @@ pcl::MarchingCubes<PointNT>::createSurface (const std::vector<float> &leaf_node,
     p3.getVector3fMap () = vertex_list[triTable[cubeindex][i+2]];
     cloud.push_back (p3);
   }
+
+  if (!edge_keys)
+    return;
+
+  // Lower end (offset from index_3d) and axis of the grid edge of each of the 12 edges of the cube
+  static const int edge_start[12][3] = {{0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {0, 0, 0},
+                                        {0, 1, 0}, {1, 1, 0}, {0, 1, 1}, {0, 1, 0},
+                                        {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}};
+  static const int edge_axis[12] = {0, 2, 0, 2, 0, 2, 0, 2, 1, 1, 1, 1};
+  for (int i = 0; triTable[cubeindex][i] != -1; ++i)
+  {
+    const int edge = triTable[cubeindex][i];
+    const Eigen::Vector3i start = index_3d + Eigen::Vector3i (edge_start[edge][0], edge_start[edge][1], edge_start[edge][2]);
+    edge_keys->push_back (getEdgeKey (start, edge_axis[edge]));
+  }
 }
 
 
@@ -197,10 +278,136 @@ pcl::MarchingCubes<PointNT>::getGridValue (Eigen::Vector3i pos)
   if (pos[2] < 0 || pos[2] >= res_z_)
     return -1.0f;
 
+  if (narrow_band_ > 0)
+  {
+    const auto block = block_indices_.find (getBlockKey (pos));
+    if (block == block_indices_.end ())
+      return NAN;
+    const Eigen::Vector3i local = pos - block_origins_[block->second];
+    return grid_[block->second * block_volume_ + (local[0] * block_size_ + local[1]) * block_size_ + local[2]];
+  }
+
   return grid_[pos[0]*res_y_*res_z_ + pos[1]*res_z_ + pos[2]];
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::extractDenseSurface (pcl::PointCloud<PointNT> &cloud,
+                                                  std::vector<std::uint64_t> *edge_keys)
+{
+  const auto nr_slices = static_cast<std::ptrdiff_t> (std::max (res_x_ - 2, 0));
+  std::vector<pcl::PointCloud<PointNT> > slice_clouds (nr_slices);
+  std::vector<std::vector<std::uint64_t> > slice_keys (edge_keys ? nr_slices : 0);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(slice_clouds, slice_keys) \
+  firstprivate(nr_slices, edge_keys) \
+  schedule(dynamic) \
+  num_threads(threads_)
+  for (std::ptrdiff_t slice = 0; slice < nr_slices; ++slice)
+  {
+    std::vector<float> leaf_node;
+    for (int y = 1; y < res_y_-1; ++y)
+      for (int z = 1; z < res_z_-1; ++z)
+      {
+        Eigen::Vector3i index_3d (static_cast<int> (slice) + 1, y, z);
+        getNeighborList1D (leaf_node, index_3d);
+        if (!leaf_node.empty ())
+          createSurface (leaf_node, index_3d, slice_clouds[slice], edge_keys ? &slice_keys[slice] : nullptr);
+      }
+  }
+
+  std::size_t nr_points = 0;
+  for (const auto &slice_cloud : slice_clouds)
+    nr_points += slice_cloud.size ();
+  cloud.reserve (nr_points);
+  for (const auto &slice_cloud : slice_clouds)
+    cloud.insert (cloud.end (), slice_cloud.begin (), slice_cloud.end ());
+
+  if (edge_keys)
+  {
+    edge_keys->reserve (nr_points);
+    for (const auto &keys : slice_keys)
+      edge_keys->insert (edge_keys->end (), keys.begin (), keys.end ());
+  }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::extractNarrowBandSurface (pcl::PointCloud<PointNT> &cloud,
+                                                       std::vector<std::uint64_t> *edge_keys)
+{
+  const auto nr_blocks = static_cast<std::ptrdiff_t> (block_origins_.size ());
+  std::vector<pcl::PointCloud<PointNT> > block_clouds (nr_blocks);
+  std::vector<std::vector<std::uint64_t> > block_keys (edge_keys ? nr_blocks : 0);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(block_clouds, block_keys) \
+  firstprivate(nr_blocks, edge_keys) \
+  schedule(dynamic) \
+  num_threads(threads_)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    const float *values = &grid_[block * block_volume_];
+    std::vector<float> leaf_node;
+
+    for (int x = 0; x < block_size_; ++x)
+      for (int y = 0; y < block_size_; ++y)
+        for (int z = 0; z < block_size_; ++z)
+        {
+          Eigen::Vector3i index_3d = block_origins_[block] + Eigen::Vector3i (x, y, z);
+          if (index_3d[0] < 1 || index_3d[0] >= res_x_ - 1 ||
+              index_3d[1] < 1 || index_3d[1] >= res_y_ - 1 ||
+              index_3d[2] < 1 || index_3d[2] >= res_z_ - 1)
+            continue;
+
+          // Cubes inside of the block are read from it directly, the others look up the neighboring blocks
+          if (x < block_size_ - 1 && y < block_size_ - 1 && z < block_size_ - 1)
+          {
+            const auto value = [values] (int dx, int dy, int dz)
+            {
+              return (values[(dx * block_size_ + dy) * block_size_ + dz]);
+            };
+            leaf_node.resize (8);
+            leaf_node[0] = value (x, y, z);
+            leaf_node[1] = value (x + 1, y, z);
+            leaf_node[2] = value (x + 1, y, z + 1);
+            leaf_node[3] = value (x, y, z + 1);
+            leaf_node[4] = value (x, y + 1, z);
+            leaf_node[5] = value (x + 1, y + 1, z);
+            leaf_node[6] = value (x + 1, y + 1, z + 1);
+            leaf_node[7] = value (x, y + 1, z + 1);
+            if (std::any_of (leaf_node.begin (), leaf_node.end (), [] (float v) { return (std::isnan (v)); }))
+              leaf_node.clear ();
+          }
+          else
+            getNeighborList1D (leaf_node, index_3d);
+
+          if (!leaf_node.empty ())
+            createSurface (leaf_node, index_3d, block_clouds[block], edge_keys ? &block_keys[block] : nullptr);
+        }
+  }
+
+  std::size_t nr_points = 0;
+  for (const auto &block_cloud : block_clouds)
+    nr_points += block_cloud.size ();
+  cloud.reserve (nr_points);
+  for (const auto &block_cloud : block_clouds)
+    cloud.insert (cloud.end (), block_cloud.begin (), block_cloud.end ());
+
+  if (edge_keys)
+  {
+    edge_keys->reserve (nr_points);
+    for (const auto &keys : block_keys)
+      edge_keys->insert (edge_keys->end (), keys.begin (), keys.end ());
+  }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> void
 pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PolygonMesh &output)
@@ -230,44 +437,63 @@ pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &po
   // the point cloud really generated from Marching Cubes, prev intermediate_cloud_
   pcl::PointCloud<PointNT> intermediate_cloud;
 
-  // Create grid
-  grid_ = std::vector<float> (res_x_*res_y_*res_z_, NAN);
-
   // Compute bounding box and voxel size
   getBoundingBox ();
   size_voxel_ = (upper_boundary_ - lower_boundary_) 
     * Eigen::Array3f (res_x_, res_y_, res_z_).inverse ();
 
+  // Create grid, either dense or the blocks of the narrow band
+  if (narrow_band_ > 0)
+    createNarrowBand ();
+  else
+  {
+    block_origins_.clear ();
+    block_indices_.clear ();
+    grid_ = std::vector<float> (res_x_*res_y_*res_z_, NAN);
+  }
+
   // Transform the point cloud into a voxel grid
   // This needs to be implemented in a child class
   voxelizeData ();
 
-  // preallocate memory assuming a hull. suppose 6 point per voxel
-  double size_reserve = std::min(static_cast<double>(intermediate_cloud.points.max_size ()),
-      2.0 * 6.0 * static_cast<double>(res_y_*res_z_ + res_x_*res_z_ + res_x_*res_y_));
-  intermediate_cloud.reserve (static_cast<std::size_t>(size_reserve));
-
-  for (int x = 1; x < res_x_-1; ++x)
-    for (int y = 1; y < res_y_-1; ++y)
-      for (int z = 1; z < res_z_-1; ++z)
-      {
-        Eigen::Vector3i index_3d (x, y, z);
-        std::vector<float> leaf_node;
-        getNeighborList1D (leaf_node, index_3d);
-        if (!leaf_node.empty ())
-          createSurface (leaf_node, index_3d, intermediate_cloud);
-      }
+  std::vector<std::uint64_t> edge_keys;
+  std::vector<std::uint64_t> *edge_keys_ptr = merge_vertices_ ? &edge_keys : nullptr;
+  if (narrow_band_ > 0)
+    extractNarrowBandSurface (intermediate_cloud, edge_keys_ptr);
+  else
+    extractDenseSurface (intermediate_cloud, edge_keys_ptr);
 
-  points.swap (intermediate_cloud);
+  polygons.resize (intermediate_cloud.size () / 3);
+  if (!merge_vertices_)
+  {
+    points.swap (intermediate_cloud);
+    for (std::size_t i = 0; i < polygons.size (); ++i)
+    {
+      pcl::Vertices v;
+      v.vertices.resize (3);
+      for (int j = 0; j < 3; ++j)
+        v.vertices[j] = static_cast<int> (i) * 3 + j;
+      polygons[i] = v;
+    }
+    return;
+  }
 
-  polygons.resize (points.size () / 3);
+  // Triangles with a vertex on the same grid edge share it, the vertices are kept in the order of their first use
+  std::unordered_map<std::uint64_t, pcl::index_t> vertex_indices;
+  vertex_indices.reserve (edge_keys.size () / 4);
+  points.clear ();
+  points.reserve (edge_keys.size () / 4);
   for (std::size_t i = 0; i < polygons.size (); ++i)
   {
-    pcl::Vertices v;
+    pcl::Vertices &v = polygons[i];
     v.vertices.resize (3);
-    for (int j = 0; j < 3; ++j)
-      v.vertices[j] = static_cast<int> (i) * 3 + j;
-    polygons[i] = v;
+    for (std::size_t j = 0; j < 3; ++j)
+    {
+      const auto vertex = vertex_indices.emplace (edge_keys[i * 3 + j], static_cast<pcl::index_t> (points.size ()));
+      if (vertex.second)
+        points.push_back (intermediate_cloud[i * 3 + j]);
+      v.vertices[j] = vertex.first->second;
+    }
   }
 }
 
@@ -48,41 +48,41 @@ template <typename PointNT> void
 pcl::MarchingCubesHoppe<PointNT>::voxelizeData ()
 {
   const bool is_far_ignored = dist_ignore_ > 0.0f;
-
-  for (int x = 0; x < res_x_; ++x)
+  const auto nr_cells = static_cast<std::ptrdiff_t> (grid_.size ());
+
+  // The cells are independent, the nearest neighbor searches run in parallel
+#pragma omp parallel for \
+  default(none) \
+  firstprivate(is_far_ignored, nr_cells) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
+  for (std::ptrdiff_t cell = 0; cell < nr_cells; ++cell)
   {
-    const int y_start = x * res_y_ * res_z_;
-
-    for (int y = 0; y < res_y_; ++y)
-    {
-      const int z_start = y_start + y * res_z_;
+    Eigen::Vector3i index_3d;
+    if (!this->getGridCellPosition (cell, index_3d))
+      continue;
 
-      for (int z = 0; z < res_z_; ++z)
-      {
-        pcl::Indices nn_indices (1, 0);
-        std::vector<float> nn_sqr_dists (1, 0.0f);
-        const Eigen::Vector3f point = (lower_boundary_ + size_voxel_ * Eigen::Array3f (x, y, z)).matrix ();
-        PointNT p;
+    pcl::Indices nn_indices (1, 0);
+    std::vector<float> nn_sqr_dists (1, 0.0f);
+    const Eigen::Vector3f point = (lower_boundary_ + size_voxel_ * index_3d.cast<float> ().array ()).matrix ();
+    PointNT p;
 
-        p.getVector3fMap () = point;
+    p.getVector3fMap () = point;
 
-        tree_->nearestKSearch (p, 1, nn_indices, nn_sqr_dists);
+    tree_->nearestKSearch (p, 1, nn_indices, nn_sqr_dists);
 
-        if (!is_far_ignored || nn_sqr_dists[0] < dist_ignore_)
-        {
-          const Eigen::Vector3f normal = (*input_)[nn_indices[0]].getNormalVector3fMap ();
+    if (!is_far_ignored || nn_sqr_dists[0] < dist_ignore_)
+    {
+      const Eigen::Vector3f normal = (*input_)[nn_indices[0]].getNormalVector3fMap ();
 
-          if (!std::isnan (normal (0)) && normal.norm () > 0.5f)
-            grid_[z_start + z] = normal.dot (
-                point - (*input_)[nn_indices[0]].getVector3fMap ());
-        }
-      }
+      if (!std::isnan (normal (0)) && normal.norm () > 0.5f)
+        grid_[cell] = normal.dot (
+            point - (*input_)[nn_indices[0]].getVector3fMap ());
     }
   }
 }
 
 
-
 #define PCL_INSTANTIATE_MarchingCubesHoppe(T) template class PCL_EXPORTS pcl::MarchingCubesHoppe<T>;
 
 #endif    // PCL_SURFACE_IMPL_MARCHING_CUBES_HOPPE_H_
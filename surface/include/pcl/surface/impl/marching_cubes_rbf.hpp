@@ -54,7 +54,13 @@ pcl::MarchingCubesRBF<PointNT>::voxelizeData ()
   Eigen::MatrixXd M (2*N, 2*N),
                   d (2*N, 1);
 
-  for (unsigned int row_i = 0; row_i < 2*N; ++row_i)
+  const auto nr_rows = static_cast<std::ptrdiff_t> (2*N);
+#pragma omp parallel for \
+  default(none) \
+  shared(M, d) \
+  firstprivate(N, nr_rows) \
+  num_threads(threads_)
+  for (std::ptrdiff_t row_i = 0; row_i < nr_rows; ++row_i)
   {
     // boolean variable to determine whether we are in the off_surface domain for the rows
     bool row_off = (row_i >= N);
@@ -75,32 +81,42 @@ pcl::MarchingCubesRBF<PointNT>::voxelizeData ()
   // Solve_linear_system (M, d, w);
   w = M.fullPivLu ().solve (d);
 
-  std::vector<double> weights (2*N);
-  std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > centers (2*N);
+  // The centers are stored by coordinate, so that the evaluation of all centers at a point is vectorized
+  Eigen::ArrayXd weights (2*N);
+  Eigen::ArrayX3d centers (2*N, 3);
   for (unsigned int i = 0; i < N; ++i)
   {
-    centers[i] = Eigen::Vector3f ((*input_)[i].getVector3fMap ()).cast<double> ();
-    centers[i + N] = Eigen::Vector3f ((*input_)[i].getVector3fMap ()).cast<double> () + Eigen::Vector3f ((*input_)[i].getNormalVector3fMap ()).cast<double> () * off_surface_epsilon_;
+    const Eigen::Vector3d point = Eigen::Vector3f ((*input_)[i].getVector3fMap ()).cast<double> ();
+    centers.row (i) = point.transpose ();
+    centers.row (i + N) = (point + Eigen::Vector3f ((*input_)[i].getNormalVector3fMap ()).cast<double> () * off_surface_epsilon_).transpose ();
     weights[i] = w (i, 0);
     weights[i + N] = w (i + N, 0);
   }
 
-  for (int x = 0; x < res_x_; ++x)
-    for (int y = 0; y < res_y_; ++y)
-      for (int z = 0; z < res_z_; ++z)
-      {
-        const Eigen::Vector3f point_f = (size_voxel_ * Eigen::Array3f (x, y, z) 
-            + lower_boundary_).matrix ();
-        const Eigen::Vector3d point = point_f.cast<double> ();
-
-        double f = 0.0;
-        std::vector<double>::const_iterator w_it (weights.begin());
-        for (std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> >::const_iterator c_it = centers.begin ();
-             c_it != centers.end (); ++c_it, ++w_it)
-          f += *w_it * kernel (*c_it, point);
-
-        grid_[x * res_y_*res_z_ + y * res_z_ + z] = static_cast<float>(f);
-      }
+  const auto nr_cells = static_cast<std::ptrdiff_t> (grid_.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(centers, weights) \
+  firstprivate(nr_cells) \
+  schedule(dynamic, 64) \
+  num_threads(threads_)
+  for (std::ptrdiff_t cell = 0; cell < nr_cells; ++cell)
+  {
+    Eigen::Vector3i index_3d;
+    if (!this->getGridCellPosition (cell, index_3d))
+      continue;
+
+    const Eigen::Vector3f point_f = (size_voxel_ * index_3d.cast<float> ().array ()
+        + lower_boundary_).matrix ();
+    const Eigen::Vector3d point = point_f.cast<double> ();
+
+    // Sum of weights * kernel (center, point), see kernel ()
+    const double f = (weights * ((centers.col (0) - point[0]).square () +
+                                 (centers.col (1) - point[1]).square () +
+                                 (centers.col (2) - point[2]).square ()).sqrt ().cube ()).sum ();
+
+    grid_[cell] = static_cast<float>(f);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
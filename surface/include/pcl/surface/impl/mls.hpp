@@ -52,9 +52,7 @@
 #include <Eigen/Geometry> // for cross
 #include <Eigen/LU> // for inverse
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
+#include <algorithm> // for copy, min
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
@@ -106,8 +104,12 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::process (PointCloudOut &output)
     setSearchMethod (tree);
   }
 
+  // The cached mls results can only be reused if they were computed for this input with the same search
+  const bool reuse_mls_results = canReuseMLSResults ();
+
   // Send the surface dataset to the spatial locator
-  tree_->setInputCloud (input_);
+  if (!reuse_mls_results)
+    tree_->setInputCloud (input_);
 
   switch (upsample_method_)
   {
@@ -115,10 +117,7 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::process (PointCloudOut &output)
     case (RANDOM_UNIFORM_DENSITY):
     {
       std::random_device rd;
-      rng_.seed (rd());
-      const double tmp = search_radius_ / 2.0;
-      rng_uniform_distribution_.reset (new std::uniform_real_distribution<> (-tmp, tmp));
-
+      rng_seed_ = rd ();
       break;
     }
     case (VOXEL_GRID_DILATION):
@@ -134,18 +133,27 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::process (PointCloudOut &output)
       break;
   }
 
-  if (cache_mls_results_)
-  {
-    mls_results_.resize (input_->size ());
-  }
-  else
+  if (!reuse_mls_results)
   {
-    mls_results_.resize (1); // Need to have a reference to a single dummy result.
+    mls_results_input_.reset ();
+    if (cache_mls_results_)
+      mls_results_.assign (input_->size (), MLSResult ());
+    else
+      mls_results_.clear ();
   }
 
   // Perform the actual surface reconstruction
   performProcessing (output);
 
+  if (cache_mls_results_ && !reuse_mls_results)
+  {
+    mls_results_input_ = input_;
+    mls_results_indices_ = indices_;
+    mls_results_tree_ = tree_;
+    mls_results_search_radius_ = search_radius_;
+    mls_results_order_ = order_;
+  }
+
   if (compute_normals_)
   {
     normals_->height = 1;
@@ -183,6 +191,18 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::computeMLSPointNormal (pcl::index_
 
   mls_result.computeMLSSurface<PointInT> (*input_, index, nn_indices, search_radius_, order_);
 
+  projectMLSResult (index, nn_indices.size (), mls_result, projected_points, projected_points_normals, corresponding_input_indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MovingLeastSquares<PointInT, PointOutT>::projectMLSResult (pcl::index_t index,
+                                                                std::size_t nr_neighbors,
+                                                                const MLSResult &mls_result,
+                                                                PointCloudOut &projected_points,
+                                                                NormalCloud &projected_points_normals,
+                                                                PointIndices &corresponding_input_indices) const
+{
   switch (upsample_method_)
   {
     case (NONE):
@@ -208,7 +228,7 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::computeMLSPointNormal (pcl::index_
     case (RANDOM_UNIFORM_DENSITY):
     {
       // Compute the local point density and add more samples if necessary
-      const int num_points_to_add = static_cast<int> (std::floor (desired_num_points_in_radius_ / 2.0 / static_cast<double> (nn_indices.size ())));
+      const int num_points_to_add = static_cast<int> (std::floor (desired_num_points_in_radius_ / 2.0 / static_cast<double> (nr_neighbors)));
 
       // Just add the query point, because the density is good
       if (num_points_to_add <= 0)
@@ -219,11 +239,15 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::computeMLSPointNormal (pcl::index_
       }
       else
       {
+        // Every point has its own generator, the samples do not depend on the order in which the points are processed
+        std::mt19937 rng (rng_seed_ + static_cast<std::uint32_t> (index));
+        std::uniform_real_distribution<> rng_uniform_distribution (-search_radius_ / 2.0, search_radius_ / 2.0);
+
         // Sample the local plane
         for (int num_added = 0; num_added < num_points_to_add;)
         {
-          const double u = (*rng_uniform_distribution_) (rng_);
-          const double v = (*rng_uniform_distribution_) (rng_);
+          const double u = rng_uniform_distribution (rng);
+          const double v = rng_uniform_distribution (rng);
 
           // Check if inside circle; if not, try another coin flip
           if (u * u + v * v > search_radius_ * search_radius_ / 4)
@@ -286,80 +310,65 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performProcessing (PointCloudOut &
   // Compute the number of coefficients
   nr_coeff_ = (order_ + 1) * (order_ + 2) / 2;
 
-#ifdef _OPENMP
   // (Maximum) number of threads
   const unsigned int threads = threads_ == 0 ? 1 : threads_;
-  // Create temporaries for each thread in order to avoid synchronization
-  typename PointCloudOut::CloudVectorType projected_points (threads);
-  typename NormalCloud::CloudVectorType projected_points_normals (threads);
-  std::vector<PointIndices> corresponding_input_indices (threads);
-#endif
+
+  const bool reuse_mls_results = canReuseMLSResults ();
+
+  // Create temporaries for each chunk of points in order to avoid synchronization
+  const std::size_t nr_points = indices_->size ();
+  const auto nr_chunks = static_cast<std::ptrdiff_t> ((nr_points + chunk_size_ - 1) / chunk_size_);
+  typename PointCloudOut::CloudVectorType projected_points (nr_chunks);
+  typename NormalCloud::CloudVectorType projected_points_normals (nr_chunks);
+  std::vector<PointIndices> corresponding_input_indices (nr_chunks);
 
   // For all points
 #pragma omp parallel for \
   default(none) \
   shared(corresponding_input_indices, projected_points, projected_points_normals) \
-  schedule(dynamic,1000) \
+  firstprivate(nr_points, nr_chunks, reuse_mls_results) \
+  schedule(dynamic) \
   num_threads(threads)
-  for (int cp = 0; cp < static_cast<int> (indices_->size ()); ++cp)
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
   {
     // Allocate enough space to hold the results of nearest neighbor searches
     // \note resize is irrelevant for a radiusSearch ().
     pcl::Indices nn_indices;
     std::vector<float> nn_sqr_dists;
+    // Result of the points whose mls result is not cached
+    MLSResult mls_result;
 
-    // Get the initial estimates of point positions and their neighborhoods
-    if (searchForNeighbors ((*indices_)[cp], nn_indices, nn_sqr_dists))
+    const std::size_t end = std::min (nr_points, (chunk + 1) * chunk_size_);
+    for (std::size_t cp = chunk * chunk_size_; cp < end; ++cp)
     {
-      // Check the number of nearest neighbors for normal estimation (and later for polynomial fit as well)
-      if (nn_indices.size () >= 3)
+      const pcl::index_t index = (*indices_)[cp];
+
+      // Only project the points to their cached MLS surfaces
+      if (reuse_mls_results)
       {
-        // This thread's ID (range 0 to threads-1)
-#ifdef _OPENMP
-        const int tn = omp_get_thread_num ();
-        // Size of projected points before computeMLSPointNormal () adds points
-        std::size_t pp_size = projected_points[tn].size ();
-#else
-        PointCloudOut projected_points;
-        NormalCloud projected_points_normals;
-#endif
-
-        // Get a plane approximating the local surface's tangent and project point onto it
-        const int index = (*indices_)[cp];
-
-        std::size_t mls_result_index = 0;
-        if (cache_mls_results_)
-          mls_result_index = index; // otherwise we give it a dummy location.
-
-#ifdef _OPENMP
-        computeMLSPointNormal (index, nn_indices, projected_points[tn], projected_points_normals[tn], corresponding_input_indices[tn], mls_results_[mls_result_index]);
-
-        // Copy all information from the input cloud to the output points (not doing any interpolation)
-        for (std::size_t pp = pp_size; pp < projected_points[tn].size (); ++pp)
-          copyMissingFields ((*input_)[(*indices_)[cp]], projected_points[tn][pp]);
-#else
-        computeMLSPointNormal (index, nn_indices, projected_points, projected_points_normals, *corresponding_input_indices_, mls_results_[mls_result_index]);
-
-        // Append projected points to output
-        output.insert (output.end (), projected_points.begin (), projected_points.end ());
-        if (compute_normals_)
-          normals_->insert (normals_->end (), projected_points_normals.begin (), projected_points_normals.end ());
-#endif
+        const MLSResult &cached_result = mls_results_[index];
+        if (cached_result.valid)
+          projectMLSResult (index, cached_result.num_neighbors, cached_result,
+                            projected_points[chunk], projected_points_normals[chunk], corresponding_input_indices[chunk]);
+        continue;
       }
+
+      // Get the initial estimates of point positions and their neighborhoods
+      if (!searchForNeighbors (index, nn_indices, nn_sqr_dists))
+        continue;
+
+      // Check the number of nearest neighbors for normal estimation (and later for polynomial fit as well)
+      if (nn_indices.size () < 3)
+        continue;
+
+      // Get a plane approximating the local surface's tangent and project point onto it
+      computeMLSPointNormal (index, nn_indices, projected_points[chunk], projected_points_normals[chunk],
+                             corresponding_input_indices[chunk], cache_mls_results_ ? mls_results_[index] : mls_result);
     }
   }
 
-#ifdef _OPENMP
-  // Combine all threads' results into the output vectors
-  for (unsigned int tn = 0; tn < threads; ++tn)
-  {
-    output.insert (output.end (), projected_points[tn].begin (), projected_points[tn].end ());
-    corresponding_input_indices_->indices.insert (corresponding_input_indices_->indices.end (),
-                                                  corresponding_input_indices[tn].indices.begin (), corresponding_input_indices[tn].indices.end ());
-    if (compute_normals_)
-      normals_->insert (normals_->end (), projected_points_normals[tn].begin (), projected_points_normals[tn].end ());
-  }
-#endif
+  // Combine all chunks' results into the output vectors
+  appendChunks (projected_points, projected_points_normals, corresponding_input_indices, output);
 
   // Perform the distinct-cloud or voxel-grid upsampling
   performUpsampling (output);
@@ -367,23 +376,73 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performProcessing (PointCloudOut &
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &output)
+pcl::MovingLeastSquares<PointInT, PointOutT>::appendChunks (const typename PointCloudOut::CloudVectorType &projected_points,
+                                                            const typename NormalCloud::CloudVectorType &projected_points_normals,
+                                                            const std::vector<PointIndices> &corresponding_input_indices,
+                                                            PointCloudOut &output)
 {
+  // Offsets of the chunks in the output, relative to the current end of output
+  const auto nr_chunks = static_cast<std::ptrdiff_t> (projected_points.size ());
+  std::vector<std::size_t> offsets (nr_chunks + 1, 0);
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
+    offsets[chunk + 1] = offsets[chunk] + projected_points[chunk].size ();
+
+  const std::size_t output_begin = output.size ();
+  const std::size_t indices_begin = corresponding_input_indices_->indices.size ();
+  const std::size_t normals_begin = normals_->size ();
+  output.resize (output_begin + offsets.back ());
+  corresponding_input_indices_->indices.resize (indices_begin + offsets.back ());
+  if (compute_normals_)
+    normals_->resize (normals_begin + offsets.back ());
 
-  if (upsample_method_ == DISTINCT_CLOUD)
+  const unsigned int threads = threads_ == 0 ? 1 : threads_;
+#pragma omp parallel for \
+  default(none) \
+  shared(projected_points, projected_points_normals, corresponding_input_indices, offsets, output) \
+  firstprivate(nr_chunks, output_begin, indices_begin, normals_begin) \
+  num_threads(threads)
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
   {
-    corresponding_input_indices_.reset (new PointIndices);
-    for (std::size_t dp_i = 0; dp_i < distinct_cloud_->size (); ++dp_i) // dp_i = distinct_point_i
+    std::copy (projected_points[chunk].begin (), projected_points[chunk].end (), output.begin () + output_begin + offsets[chunk]);
+    std::copy (corresponding_input_indices[chunk].indices.begin (), corresponding_input_indices[chunk].indices.end (),
+               corresponding_input_indices_->indices.begin () + indices_begin + offsets[chunk]);
+    if (compute_normals_)
+      std::copy (projected_points_normals[chunk].begin (), projected_points_normals[chunk].end (),
+                 normals_->begin () + normals_begin + offsets[chunk]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MovingLeastSquares<PointInT, PointOutT>::projectToMLSSurface (const PointCloudIn &query_points, PointCloudOut &output)
+{
+  const unsigned int threads = threads_ == 0 ? 1 : threads_;
+
+  const std::size_t nr_points = query_points.size ();
+  const auto nr_chunks = static_cast<std::ptrdiff_t> ((nr_points + chunk_size_ - 1) / chunk_size_);
+  typename PointCloudOut::CloudVectorType projected_points (nr_chunks);
+  typename NormalCloud::CloudVectorType projected_points_normals (nr_chunks);
+  std::vector<PointIndices> corresponding_input_indices (nr_chunks);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(query_points, corresponding_input_indices, projected_points, projected_points_normals) \
+  firstprivate(nr_points, nr_chunks) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
+  {
+    pcl::Indices nn_indices;
+    std::vector<float> nn_dists;
+
+    const std::size_t end = std::min (nr_points, (chunk + 1) * chunk_size_);
+    for (std::size_t qp = chunk * chunk_size_; qp < end; ++qp)
     {
-      // Distinct cloud may have nan points, skip them
-      if (!std::isfinite ((*distinct_cloud_)[dp_i].x))
+      // The query points may have nan points, skip them
+      if (!std::isfinite (query_points[qp].x))
         continue;
 
-      // Get 3D position of point
-      //Eigen::Vector3f pos = (*distinct_cloud_)[dp_i].getVector3fMap ();
-      pcl::Indices nn_indices;
-      std::vector<float> nn_dists;
-      tree_->nearestKSearch ((*distinct_cloud_)[dp_i], 1, nn_indices, nn_dists);
+      tree_->nearestKSearch (query_points[qp], 1, nn_indices, nn_dists);
       const auto input_index = nn_indices.front ();
 
       // If the closest point did not have a valid MLS fitting result
@@ -391,12 +450,27 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &
       if (mls_results_[input_index].valid == false)
         continue;
 
-      Eigen::Vector3d add_point = (*distinct_cloud_)[dp_i].getVector3fMap ().template cast<double> ();
-      MLSResult::MLSProjectionResults proj =  mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
-      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
+      Eigen::Vector3d add_point = query_points[qp].getVector3fMap ().template cast<double> ();
+      MLSResult::MLSProjectionResults proj = mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
+      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature,
+                               projected_points[chunk], projected_points_normals[chunk], corresponding_input_indices[chunk]);
     }
   }
 
+  appendChunks (projected_points, projected_points_normals, corresponding_input_indices, output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &output)
+{
+
+  if (upsample_method_ == DISTINCT_CLOUD)
+  {
+    corresponding_input_indices_.reset (new PointIndices);
+    projectToMLSSurface (*distinct_cloud_, output);
+  }
+
   // For the voxel grid upsampling method, generate the voxel grid and dilate it
   // Then, project the newly obtained points to the MLS surface
   if (upsample_method_ == VOXEL_GRID_DILATION)
@@ -407,9 +481,11 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &
     for (int iteration = 0; iteration < dilation_iteration_num_; ++iteration)
       voxel_grid.dilate ();
 
+    // Get 3D position of the voxels
+    PointCloudIn voxel_points;
+    voxel_points.reserve (voxel_grid.voxel_grid_.size ());
     for (auto m_it = voxel_grid.voxel_grid_.begin (); m_it != voxel_grid.voxel_grid_.end (); ++m_it)
     {
-      // Get 3D position of point
       Eigen::Vector3f pos;
       voxel_grid.getPosition (m_it->first, pos);
 
@@ -417,21 +493,10 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &
       p.x = pos[0];
       p.y = pos[1];
       p.z = pos[2];
-
-      pcl::Indices nn_indices;
-      std::vector<float> nn_dists;
-      tree_->nearestKSearch (p, 1, nn_indices, nn_dists);
-      const auto input_index = nn_indices.front ();
-
-      // If the closest point did not have a valid MLS fitting result
-      // OR if it is too far away from the sampled point
-      if (mls_results_[input_index].valid == false)
-        continue;
-
-      Eigen::Vector3d add_point = p.getVector3fMap ().template cast<double> ();
-      MLSResult::MLSProjectionResults proj = mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
-      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
+      voxel_points.push_back (p);
     }
+
+    projectToMLSSurface (voxel_points, output);
   }
 }
 
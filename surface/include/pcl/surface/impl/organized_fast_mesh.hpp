@@ -44,6 +44,8 @@
 #include <pcl/surface/organized_fast_mesh.h>
 #include <pcl/common/io.h> // for getFieldIndex
 
+#include <algorithm>
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::performReconstruction (pcl::PolygonMesh &output)
@@ -80,35 +82,147 @@ pcl::OrganizedFastMesh<PointInT>::performReconstruction (std::vector<pcl::Vertic
   reconstructPolygons (polygons);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::reconstruct (std::vector<std::uint32_t> &vertex_indices)
+{
+  vertex_indices.clear ();
+  if (!initCompute ())
+    return;
+
+  if (!input_->isOrganized ())
+  {
+    PCL_ERROR ("[OrganizedFastMesh::reconstruct] Input point cloud must be organized but isn't!\n");
+    deinitCompute ();
+    return;
+  }
+  makeIndexBuffer (vertex_indices);
+
+  deinitCompute ();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::reconstructPolygons (std::vector<pcl::Vertices> &polygons)
+{
+  makeIndexBuffer (index_buffer_);
+  indicesToPolygons (index_buffer_, triangulation_type_ == QUAD_MESH ? 4 : 3, polygons);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::makeIndexBuffer (std::vector<std::uint32_t> &vertex_indices)
+{
+  vertex_indices.clear ();
+  const int last_row = static_cast<int> (input_->height) - triangle_pixel_size_rows_;
+  if (last_row <= 0)
+    return;
+
+  // Split the rows into more bands than threads, as the number of polygons per row varies
+  const int nr_row_steps = (last_row + triangle_pixel_size_rows_ - 1) / triangle_pixel_size_rows_;
+  const int nr_bands = threads_ > 1 ? std::min (nr_row_steps, static_cast<int> (4 * threads_)) : 1;
+  if (nr_bands == 1)
+  {
+    makeMesh (0, last_row, vertex_indices);
+    return;
+  }
+
+  // The buffers of the bands are kept, so that their memory is reused for the next frame
+  band_index_buffers_.resize (nr_bands);
+#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
+#pragma omp parallel for \
+  default(none) \
+  schedule(dynamic) \
+  num_threads(threads_)
+#else
+#pragma omp parallel for \
+  default(none) \
+  shared(last_row, nr_bands, nr_row_steps) \
+  schedule(dynamic) \
+  num_threads(threads_)
+#endif
+  for (int band = 0; band < nr_bands; ++band)
+  {
+    const int row_begin = (nr_row_steps * band / nr_bands) * triangle_pixel_size_rows_;
+    const int row_end = std::min (last_row, (nr_row_steps * (band + 1) / nr_bands) * triangle_pixel_size_rows_);
+    band_index_buffers_[band].clear ();
+    makeMesh (row_begin, row_end, band_index_buffers_[band]);
+  }
+
+  // Concatenate the bands in order, the result is the same as the one of a single band
+  std::size_t nr_indices = 0;
+  for (const auto &band_indices : band_index_buffers_)
+    nr_indices += band_indices.size ();
+  vertex_indices.reserve (nr_indices);
+  for (const auto &band_indices : band_index_buffers_)
+    vertex_indices.insert (vertex_indices.end (), band_indices.begin (), band_indices.end ());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::makeMesh (int row_begin, int row_end, std::vector<std::uint32_t> &vertex_indices)
 {
   if (triangulation_type_ == TRIANGLE_RIGHT_CUT)
-    makeRightCutMesh (polygons);
+    makeRightCutMesh (row_begin, row_end, vertex_indices);
   else if (triangulation_type_ == TRIANGLE_LEFT_CUT)
-    makeLeftCutMesh (polygons);
+    makeLeftCutMesh (row_begin, row_end, vertex_indices);
   else if (triangulation_type_ == TRIANGLE_ADAPTIVE_CUT)
-    makeAdaptiveCutMesh (polygons);
+    makeAdaptiveCutMesh (row_begin, row_end, vertex_indices);
   else if (triangulation_type_ == QUAD_MESH)
-    makeQuadMesh (polygons);
+    makeQuadMesh (row_begin, row_end, vertex_indices);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::indicesToPolygons (const std::vector<std::uint32_t> &vertex_indices,
+                                                     std::size_t polygon_size,
+                                                     std::vector<pcl::Vertices> &polygons) const
+{
+  // Resizing keeps the vertex lists of the existing polygons, assign () then reuses their memory
+  polygons.resize (vertex_indices.size () / polygon_size);
+  auto it = vertex_indices.cbegin ();
+  for (auto &polygon : polygons)
+  {
+    polygon.vertices.assign (it, it + polygon_size);
+    it += polygon_size;
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::makeQuadMesh (std::vector<pcl::Vertices>& polygons)
+{
+  index_buffer_.clear ();
+  makeQuadMesh (0, static_cast<int> (input_->height) - triangle_pixel_size_rows_, index_buffer_);
+  indicesToPolygons (index_buffer_, 4, polygons);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::makeQuadMesh (int row_begin, int row_end, std::vector<std::uint32_t>& vertex_indices)
 {
   int last_column = input_->width - triangle_pixel_size_columns_;
-  int last_row = input_->height - triangle_pixel_size_rows_;
 
-  int i = 0, index_down = 0, index_right = 0, index_down_right = 0, idx = 0;
+  int i = 0, index_down = 0, index_right = 0, index_down_right = 0;
   int y_big_incr = triangle_pixel_size_rows_ * input_->width,
       x_big_incr = y_big_incr + triangle_pixel_size_columns_;
-  // Reserve enough space
-  polygons.resize (input_->width * input_->height);
 
   // Go over the rows first
-  for (int y = 0; y < last_row; y += triangle_pixel_size_rows_)
+  for (int y = row_begin; y < row_end; y += triangle_pixel_size_rows_)
   {
     // Initialize a new row
     i = y * input_->width;
@@ -125,27 +239,32 @@ pcl::OrganizedFastMesh<PointInT>::makeQuadMesh (std::vector<pcl::Vertices>& poly
     {
       if (isValidQuad (i, index_right, index_down_right, index_down))
         if (store_shadowed_faces_ || !isShadowedQuad (i, index_right, index_down_right, index_down))
-          addQuad (i, index_right, index_down_right, index_down, idx++, polygons);
+          addQuad (i, index_right, index_down_right, index_down, vertex_indices);
     }
   }
-  polygons.resize (idx);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::makeRightCutMesh (std::vector<pcl::Vertices>& polygons)
+{
+  index_buffer_.clear ();
+  makeRightCutMesh (0, static_cast<int> (input_->height) - triangle_pixel_size_rows_, index_buffer_);
+  indicesToPolygons (index_buffer_, 3, polygons);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::makeRightCutMesh (int row_begin, int row_end, std::vector<std::uint32_t>& vertex_indices)
 {
   int last_column = input_->width - triangle_pixel_size_columns_;
-  int last_row = input_->height - triangle_pixel_size_rows_;
 
-  int i = 0, index_down = 0, index_right = 0, index_down_right = 0, idx = 0;
+  int i = 0, index_down = 0, index_right = 0, index_down_right = 0;
   int y_big_incr = triangle_pixel_size_rows_ * input_->width,
       x_big_incr = y_big_incr + triangle_pixel_size_columns_;
-  // Reserve enough space
-  polygons.resize (input_->width * input_->height * 2);
 
   // Go over the rows first
-  for (int y = 0; y < last_row; y += triangle_pixel_size_rows_)
+  for (int y = row_begin; y < row_end; y += triangle_pixel_size_rows_)
   {
     // Initialize a new row
     i = y * input_->width;
@@ -162,31 +281,36 @@ pcl::OrganizedFastMesh<PointInT>::makeRightCutMesh (std::vector<pcl::Vertices>&
     {
       if (isValidTriangle (i, index_down_right, index_right))
         if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
-          addTriangle (i, index_down_right, index_right, idx++, polygons);
+          addTriangle (i, index_down_right, index_right, vertex_indices);
 
       if (isValidTriangle (i, index_down, index_down_right))
         if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
-          addTriangle (i, index_down, index_down_right, idx++, polygons);
+          addTriangle (i, index_down, index_down_right, vertex_indices);
     }
   }
-  polygons.resize (idx);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::makeLeftCutMesh (std::vector<pcl::Vertices>& polygons)
+{
+  index_buffer_.clear ();
+  makeLeftCutMesh (0, static_cast<int> (input_->height) - triangle_pixel_size_rows_, index_buffer_);
+  indicesToPolygons (index_buffer_, 3, polygons);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::makeLeftCutMesh (int row_begin, int row_end, std::vector<std::uint32_t>& vertex_indices)
 {
   int last_column = input_->width - triangle_pixel_size_columns_;
-  int last_row = input_->height - triangle_pixel_size_rows_;
 
-  int i = 0, index_down = 0, index_right = 0, index_down_right = 0, idx = 0;
+  int i = 0, index_down = 0, index_right = 0, index_down_right = 0;
   int y_big_incr = triangle_pixel_size_rows_ * input_->width,
       x_big_incr = y_big_incr + triangle_pixel_size_columns_;
-  // Reserve enough space
-  polygons.resize (input_->width * input_->height * 2);
 
   // Go over the rows first
-  for (int y = 0; y < last_row; y += triangle_pixel_size_rows_)
+  for (int y = row_begin; y < row_end; y += triangle_pixel_size_rows_)
   {
     // Initialize a new row
     i = y * input_->width;
@@ -203,31 +327,35 @@ pcl::OrganizedFastMesh<PointInT>::makeLeftCutMesh (std::vector<pcl::Vertices>& p
     {
       if (isValidTriangle (i, index_down, index_right))
         if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
-          addTriangle (i, index_down, index_right, idx++, polygons);
+          addTriangle (i, index_down, index_right, vertex_indices);
 
       if (isValidTriangle (index_right, index_down, index_down_right))
         if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
-          addTriangle (index_right, index_down, index_down_right, idx++, polygons);
+          addTriangle (index_right, index_down, index_down_right, vertex_indices);
     }
   }
-  polygons.resize (idx);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::makeAdaptiveCutMesh (std::vector<pcl::Vertices>& polygons)
+{
+  index_buffer_.clear ();
+  makeAdaptiveCutMesh (0, static_cast<int> (input_->height) - triangle_pixel_size_rows_, index_buffer_);
+  indicesToPolygons (index_buffer_, 3, polygons);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::makeAdaptiveCutMesh (int row_begin, int row_end, std::vector<std::uint32_t>& vertex_indices)
 {
   int last_column = input_->width - triangle_pixel_size_columns_;
-  int last_row = input_->height - triangle_pixel_size_rows_;
 
-  int idx = 0;
   int y_big_incr = triangle_pixel_size_rows_ * input_->width,
       x_big_incr = y_big_incr + triangle_pixel_size_columns_;
-  // Reserve enough space
-  polygons.resize (input_->width * input_->height * 2);
 
   // Go over the rows first
-  for (int y = 0; y < last_row; y += triangle_pixel_size_rows_)
+  for (int y = row_begin; y < row_end; y += triangle_pixel_size_rows_)
   {
     // Initialize a new row
     int i = y * input_->width;
@@ -254,36 +382,35 @@ pcl::OrganizedFastMesh<PointInT>::makeAdaptiveCutMesh (std::vector<pcl::Vertices
         if (dist_right_cut >= dist_left_cut)
         {
           if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
-            addTriangle (i, index_down_right, index_right, idx++, polygons);
+            addTriangle (i, index_down_right, index_right, vertex_indices);
           if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
-            addTriangle (i, index_down, index_down_right, idx++, polygons);
+            addTriangle (i, index_down, index_down_right, vertex_indices);
         }
         else
         {
           if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
-            addTriangle (i, index_down, index_right, idx++, polygons);
+            addTriangle (i, index_down, index_right, vertex_indices);
           if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
-            addTriangle (index_right, index_down, index_down_right, idx++, polygons);
+            addTriangle (index_right, index_down, index_down_right, vertex_indices);
         }
       }
       else
       {
         if (right_cut_upper)
           if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
-            addTriangle (i, index_down_right, index_right, idx++, polygons);
+            addTriangle (i, index_down_right, index_right, vertex_indices);
         if (right_cut_lower)
           if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
-            addTriangle (i, index_down, index_down_right, idx++, polygons);
+            addTriangle (i, index_down, index_down_right, vertex_indices);
         if (left_cut_upper)
           if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
-            addTriangle (i, index_down, index_right, idx++, polygons);
+            addTriangle (i, index_down, index_right, vertex_indices);
         if (left_cut_lower)
           if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
-            addTriangle (index_right, index_down, index_down_right, idx++, polygons);
+            addTriangle (index_right, index_down, index_down_right, vertex_indices);
       }
     }
   }
-  polygons.resize (idx);
 }
 
 #define PCL_INSTANTIATE_OrganizedFastMesh(T)                \
@@ -42,6 +42,8 @@
 
 #include <pcl/surface/poisson.h>
 #include <pcl/common/common.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/common/time.h>
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
@@ -54,7 +56,10 @@
 
 #define MEMORY_ALLOCATOR_BLOCK_SIZE 1<<12
 
+#include <algorithm>
+#include <cmath>
 #include <cstdarg>
+#include <limits>
 
 using namespace pcl;
 
@@ -81,6 +86,8 @@ pcl::Poisson<PointNT>::Poisson ()
   , min_iterations_ (8)
   , solver_accuracy_ (1e-3f)
   , threads_(1)
+  , max_slab_points_ (0)
+  , slab_overlap_ (0.5f)
 {
 }
 
@@ -104,7 +111,9 @@ pcl::Poisson<PointNT>::setThreads (int threads)
       
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> template <int Degree> void
-pcl::Poisson<PointNT>::execute (poisson::CoredVectorMeshData &mesh,
+pcl::Poisson<PointNT>::execute (const PointCloudConstPtr &cloud,
+                                int depth,
+                                poisson::CoredVectorMeshData &mesh,
                                 poisson::Point3D<float> &center,
                                 float &scale)
 {
@@ -128,40 +137,60 @@ pcl::Poisson<PointNT>::execute (poisson::CoredVectorMeshData &mesh,
     iso_divide_ = min_depth_;
   }
 
+  pcl::StopWatch watch;
   pcl::poisson::TreeOctNode::SetAllocator (MEMORY_ALLOCATOR_BLOCK_SIZE);
 
-  kernel_depth_ = depth_ - 2;
+  kernel_depth_ = depth - 2;
 
-  tree.setBSplineData (depth_, static_cast<pcl::poisson::Real>(1.0 / (1 << depth_)), true);
+  tree.setBSplineData (depth, static_cast<pcl::poisson::Real>(1.0 / (1 << depth)), true);
 
   tree.maxMemoryUsage = 0;
 
 
-  int point_count = tree.template setTree<PointNT> (input_, depth_, min_depth_, kernel_depth_, samples_per_node_,
+  int point_count = tree.template setTree<PointNT> (cloud, depth, min_depth_, kernel_depth_, samples_per_node_,
                                                     scale_, center, scale, confidence_, point_weight_, !non_adaptive_weights_);
 
   tree.ClipTree ();
   tree.finalize ();
   tree.RefineBoundary (iso_divide_);
+  const int nr_nodes = tree.tree.nodes ();
+  statistics_.tree_time += watch.getTimeSeconds ();
 
   PCL_DEBUG ("Input Points: %d\n" , point_count );
-  PCL_DEBUG ("Leaves/Nodes: %d/%d\n" , tree.tree.leaves() , tree.tree.nodes() );
+  PCL_DEBUG ("Leaves/Nodes: %d/%d\n" , tree.tree.leaves() , nr_nodes );
 
+  watch.reset ();
   tree.maxMemoryUsage = 0;
   tree.SetLaplacianConstraints ();
+  statistics_.constraints_time += watch.getTimeSeconds ();
 
+  watch.reset ();
   tree.maxMemoryUsage = 0;
   tree.LaplacianMatrixIteration (solver_divide_, show_residual_, min_iterations_, solver_accuracy_);
 
   iso_value = tree.GetIsoValue ();
+  statistics_.solver_time += watch.getTimeSeconds ();
 
+  watch.reset ();
   tree.GetMCIsoTriangles (iso_value, iso_divide_, &mesh, 0, 1, manifold_, output_polygons_);
+  statistics_.extraction_time += watch.getTimeSeconds ();
+
+  // The allocation tracking of the solver is disabled, the memory is estimated from the sizes of its data
+  const std::size_t memory = static_cast<std::size_t> (nr_nodes) * sizeof (poisson::TreeOctNode)
+                           + point_count * 2 * sizeof (poisson::Point3D<poisson::Real>)
+                           + (mesh.inCorePoints.size () + mesh.outOfCorePointCount ()) * sizeof (poisson::Point3D<float>)
+                           + mesh.polygonCount () * 3 * sizeof (int);
+  statistics_.nr_slabs++;
+  statistics_.nr_samples += point_count;
+  statistics_.max_tree_nodes = (std::max) (statistics_.max_tree_nodes, static_cast<std::size_t> (nr_nodes));
+  statistics_.max_memory = (std::max) (statistics_.max_memory, memory);
 }
 
-
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointNT> void
-pcl::Poisson<PointNT>::performReconstruction (PolygonMesh &output)
+template <typename PointNT> template <typename PointT> void
+pcl::Poisson<PointNT>::reconstructSlab (const PointCloudConstPtr &cloud, int depth,
+                                        int axis, float min_coord, float max_coord,
+                                        pcl::PointCloud<PointT> &points, std::vector<pcl::Vertices> &polygons)
 {
   poisson::CoredVectorMeshData mesh;
   poisson::Point3D<float> center;
@@ -171,27 +200,27 @@ pcl::Poisson<PointNT>::performReconstruction (PolygonMesh &output)
   {
   case 1:
   {
-    execute<1> (mesh, center, scale);
+    execute<1> (cloud, depth, mesh, center, scale);
     break;
   }
   case 2:
   {
-    execute<2> (mesh, center, scale);
+    execute<2> (cloud, depth, mesh, center, scale);
     break;
   }
   case 3:
   {
-    execute<3> (mesh, center, scale);
+    execute<3> (cloud, depth, mesh, center, scale);
     break;
   }
   case 4:
   {
-    execute<4> (mesh, center, scale);
+    execute<4> (cloud, depth, mesh, center, scale);
     break;
   }
   case 5:
   {
-    execute<5> (mesh, center, scale);
+    execute<5> (cloud, depth, mesh, center, scale);
     break;
   }
   default:
@@ -200,28 +229,26 @@ pcl::Poisson<PointNT>::performReconstruction (PolygonMesh &output)
   }
   }
 
-  // Write output PolygonMesh
-  pcl::PointCloud<pcl::PointXYZ> cloud;
-  cloud.resize (static_cast<int>(mesh.outOfCorePointCount () + mesh.inCorePoints.size ()));
+  // Write vertices
+  const std::size_t offset = points.size ();
+  const int nr_in_core = static_cast<int> (mesh.inCorePoints.size ());
+  const int nr_vertices = nr_in_core + mesh.outOfCorePointCount ();
+  points.resize (offset + nr_vertices);
   poisson::Point3D<float> p;
-  for (int i = 0; i < static_cast<int>(mesh.inCorePoints.size ()); i++)
-  {
-    p = mesh.inCorePoints[i];
-    cloud[i].x = p.coords[0]*scale+center.coords[0];
-    cloud[i].y = p.coords[1]*scale+center.coords[1];
-    cloud[i].z = p.coords[2]*scale+center.coords[2];
-  }
-  for (int i = static_cast<int>(mesh.inCorePoints.size ()); i < static_cast<int>(mesh.outOfCorePointCount () + mesh.inCorePoints.size ()); i++)
+  for (int i = 0; i < nr_vertices; i++)
   {
-    mesh.nextOutOfCorePoint (p);
-    cloud[i].x = p.coords[0]*scale+center.coords[0];
-    cloud[i].y = p.coords[1]*scale+center.coords[1];
-    cloud[i].z = p.coords[2]*scale+center.coords[2];
+    if (i < nr_in_core)
+      p = mesh.inCorePoints[i];
+    else
+      mesh.nextOutOfCorePoint (p);
+    points[offset + i].x = p.coords[0]*scale+center.coords[0];
+    points[offset + i].y = p.coords[1]*scale+center.coords[1];
+    points[offset + i].z = p.coords[2]*scale+center.coords[2];
   }
-  pcl::toPCLPointCloud2 (cloud, output.cloud);
-  output.polygons.resize (mesh.polygonCount ());
 
-  // Write faces
+  // Write faces, keeping the ones whose center lies in the slab
+  const std::size_t polygons_begin = polygons.size ();
+  polygons.reserve (polygons_begin + mesh.polygonCount ());
   std::vector<poisson::CoredVertexIndex> polygon;
   for (int p_i = 0; p_i < mesh.polygonCount (); p_i++)
   {
@@ -229,95 +256,116 @@ pcl::Poisson<PointNT>::performReconstruction (PolygonMesh &output)
     mesh.nextPolygon (polygon);
     v.vertices.resize (polygon.size ());
 
+    float center_coord = 0;
     for (int i = 0; i < static_cast<int> (polygon.size ()); ++i)
+    {
       if (polygon[i].inCore )
-        v.vertices[i] = polygon[i].idx;
+        v.vertices[i] = static_cast<index_t> (offset) + polygon[i].idx;
       else
-        v.vertices[i] = polygon[i].idx + static_cast<int>(mesh.inCorePoints.size ());
+        v.vertices[i] = static_cast<index_t> (offset) + polygon[i].idx + nr_in_core;
+      center_coord += points[v.vertices[i]].getVector3fMap ()[axis];
+    }
+    center_coord /= static_cast<float> (polygon.size ());
 
-    output.polygons[p_i] = v;
+    if ((min_coord <= center_coord) && (center_coord < max_coord))
+      polygons.push_back (std::move (v));
+  }
+
+  // Remove the vertices of the clipped polygons, keeping the order of the others
+  if (std::isfinite (min_coord) || std::isfinite (max_coord))
+  {
+    std::vector<index_t> new_index (nr_vertices, -1);
+    for (std::size_t p_i = polygons_begin; p_i < polygons.size (); ++p_i)
+      for (const auto &vertex : polygons[p_i].vertices)
+        new_index[vertex - offset] = 0;
+    index_t nr_used = 0;
+    for (int i = 0; i < nr_vertices; i++)
+      if (new_index[i] == 0)
+      {
+        new_index[i] = nr_used;
+        points[offset + nr_used++] = points[offset + i];
+      }
+    points.resize (offset + nr_used);
+    for (std::size_t p_i = polygons_begin; p_i < polygons.size (); ++p_i)
+      for (auto &vertex : polygons[p_i].vertices)
+        vertex = static_cast<index_t> (offset) + new_index[vertex - offset];
   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointNT> void
-pcl::Poisson<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &points,
-                                              std::vector<pcl::Vertices> &polygons)
+template <typename PointNT> template <typename PointT> void
+pcl::Poisson<PointNT>::reconstructSurface (pcl::PointCloud<PointT> &points, std::vector<pcl::Vertices> &polygons)
 {
-  poisson::CoredVectorMeshData mesh;
-  poisson::Point3D<float> center;
-  float scale = 1.0f;
-
-  switch (degree_)
-  {
-  case 1:
-  {
-    execute<1> (mesh, center, scale);
-    break;
-  }
-  case 2:
+  statistics_ = Statistics ();
+  points.clear ();
+  polygons.clear ();
+  const float inf = std::numeric_limits<float>::infinity ();
+  if ((max_slab_points_ == 0) || (input_->size () <= max_slab_points_))
   {
-    execute<2> (mesh, center, scale);
-    break;
-  }
-  case 3:
-  {
-    execute<3> (mesh, center, scale);
-    break;
-  }
-  case 4:
-  {
-    execute<4> (mesh, center, scale);
-    break;
-  }
-  case 5:
-  {
-    execute<5> (mesh, center, scale);
-    break;
-  }
-  default:
-  {
-    PCL_ERROR (stderr, "Degree %d not supported\n", degree_);
-  }
+    reconstructSlab (input_, depth_, 0, -inf, inf, points, polygons);
+    return;
   }
 
-  // Write output PolygonMesh
-  // Write vertices
-  points.resize (static_cast<int>(mesh.outOfCorePointCount () + mesh.inCorePoints.size ()));
-  poisson::Point3D<float> p;
-  for (int i = 0; i < static_cast<int>(mesh.inCorePoints.size ()); i++)
+  // Sort the points along the longest axis of their bounding box
+  Eigen::Vector4f min_pt, max_pt;
+  pcl::getMinMax3D (*input_, min_pt, max_pt);
+  int axis;
+  const float extent = (max_pt - min_pt).head<3> ().maxCoeff (&axis);
+
+  pcl::Indices order;
+  order.reserve (input_->size ());
+  for (index_t i = 0; i < static_cast<index_t> (input_->size ()); ++i)
+    if (input_->is_dense || pcl::isFinite ((*input_)[i]))
+      order.push_back (i);
+  const auto coord = [this, axis] (index_t i) { return ((*input_)[i].getVector3fMap ()[axis]); };
+  std::sort (order.begin (), order.end (), [&coord] (index_t a, index_t b) { return (coord (a) < coord (b)); });
+
+  // Reconstruct the slabs one after the other, each one with the points of its overlap
+  const std::size_t nr_slabs = (order.size () + max_slab_points_ - 1) / max_slab_points_;
+  for (std::size_t slab = 0; slab < nr_slabs; ++slab)
   {
-    p = mesh.inCorePoints[i];
-    points[i].x = p.coords[0]*scale+center.coords[0];
-    points[i].y = p.coords[1]*scale+center.coords[1];
-    points[i].z = p.coords[2]*scale+center.coords[2];
+    const std::size_t begin = slab * max_slab_points_;
+    const std::size_t end = (std::min) (begin + max_slab_points_, order.size ());
+    const float min_coord = (slab == 0) ? -inf : 0.5f * (coord (order[begin - 1]) + coord (order[begin]));
+    const float max_coord = (end == order.size ()) ? inf : 0.5f * (coord (order[end - 1]) + coord (order[end]));
+    const float overlap = slab_overlap_ * (coord (order[end - 1]) - coord (order[begin]));
+
+    const auto first = std::lower_bound (order.begin (), order.end (), coord (order[begin]) - overlap,
+                                         [&coord] (index_t i, float value) { return (coord (i) < value); });
+    const auto last = std::upper_bound (order.begin (), order.end (), coord (order[end - 1]) + overlap,
+                                        [&coord] (float value, index_t i) { return (value < coord (i)); });
+    PointCloudPtr slab_cloud (new pcl::PointCloud<PointNT>);
+    slab_cloud->reserve (std::distance (first, last));
+    for (auto it = first; it != last; ++it)
+      slab_cloud->push_back ((*input_)[*it]);
+
+    // Keep the resolution of the whole input, the octree is fitted to the bounding cube of the slab
+    Eigen::Vector4f slab_min_pt, slab_max_pt;
+    pcl::getMinMax3D (*slab_cloud, slab_min_pt, slab_max_pt);
+    const float slab_extent = (std::max) ((slab_max_pt - slab_min_pt).head<3> ().maxCoeff (), std::numeric_limits<float>::min ());
+    const int depth = (std::max) (min_depth_, depth_ - static_cast<int> (std::floor (std::log2 (extent / slab_extent))));
+
+    PCL_DEBUG ("[pcl::Poisson] Slab %zu/%zu: %zu points, depth %d\n", slab + 1, nr_slabs, slab_cloud->size (), depth);
+    reconstructSlab (slab_cloud, depth, axis, min_coord, max_coord, points, polygons);
   }
-  for (int i = static_cast<int>(mesh.inCorePoints.size()); i < static_cast<int>(mesh.outOfCorePointCount() + mesh.inCorePoints.size ()); i++)
-  {
-    mesh.nextOutOfCorePoint (p);
-    points[i].x = p.coords[0]*scale+center.coords[0];
-    points[i].y = p.coords[1]*scale+center.coords[1];
-    points[i].z = p.coords[2]*scale+center.coords[2];
-  }
-
-  polygons.resize (mesh.polygonCount ());
-
-  // Write faces
-  std::vector<poisson::CoredVertexIndex> polygon;
-  for (int p_i = 0; p_i < mesh.polygonCount (); p_i++)
-  {
-    pcl::Vertices v;
-    mesh.nextPolygon (polygon);
-    v.vertices.resize (polygon.size ());
+}
 
-    for (int i = 0; i < static_cast<int> (polygon.size ()); ++i)
-      if (polygon[i].inCore )
-        v.vertices[i] = polygon[i].idx;
-      else
-        v.vertices[i] = polygon[i].idx + static_cast<int>(mesh.inCorePoints.size ());
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::Poisson<PointNT>::performReconstruction (PolygonMesh &output)
+{
+  // Write output PolygonMesh
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  reconstructSurface (cloud, output.polygons);
+  pcl::toPCLPointCloud2 (cloud, output.cloud);
+}
 
-    polygons[p_i] = v;
-  }
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::Poisson<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &points,
+                                              std::vector<pcl::Vertices> &polygons)
+{
+  reconstructSurface (points, polygons);
 }
 
 
@@ -80,6 +80,20 @@ pcl::SurfelSmoothing<PointT, PointNT>::initCompute ()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> void
+pcl::SurfelSmoothing<PointT, PointNT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> float
 pcl::SurfelSmoothing<PointT, PointNT>::smoothCloudIteration (PointCloudInPtr &output_positions,
@@ -95,10 +109,17 @@ pcl::SurfelSmoothing<PointT, PointNT>::smoothCloudIteration (PointCloudInPtr &ou
   pcl::Indices nn_indices;
   std::vector<float> nn_distances;
 
-  std::vector<float> diffs (interm_cloud_->size ());
   float total_residual = 0.0f;
 
-  for (std::size_t i = 0; i < interm_cloud_->size (); ++i)
+  // The points are independent, the neighbors are searched in the input and the intermediate clouds only
+#pragma omp parallel for \
+  default(none) \
+  shared(output_normals, output_positions) \
+  firstprivate(nn_indices, nn_distances) \
+  reduction(+: total_residual) \
+  schedule(dynamic, 64) \
+  num_threads(threads_)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (interm_cloud_->size ()); ++i)
   {
     Eigen::Vector4f smoothed_point  = Eigen::Vector4f::Zero ();
     Eigen::Vector4f smoothed_normal = Eigen::Vector4f::Zero (); 
@@ -265,9 +286,15 @@ pcl::SurfelSmoothing<PointT, PointNT>::computeSmoothedCloud (PointCloudInPtr &ou
 
   output_positions->points.resize (input_->size ());
   output_normals->points.resize (input_->size ());
-  for (std::size_t i = 0; i < input_->size (); ++i)
+#pragma omp parallel for \
+  default(none) \
+  shared(output_normals, output_positions) \
+  schedule(dynamic, 64) \
+  num_threads(threads_)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (input_->size ()); ++i)
   {
-    smoothPoint (i, (*output_positions)[i], (*output_normals)[i]);
+    std::size_t point_index = i;
+    smoothPoint (point_index, (*output_positions)[i], (*output_normals)[i]);
   }
 }
 
@@ -293,6 +320,12 @@ pcl::SurfelSmoothing<PointT, PointNT>::extractSalientFeaturesBetweenScales (Poin
   std::vector<float> nn_distances;
 
   output_features->resize (cloud2->size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud2, diffs, output_features) \
+  firstprivate(nn_indices, nn_distances) \
+  schedule(dynamic, 64) \
+  num_threads(threads_)
   for (int point_i = 0; point_i < static_cast<int> (cloud2->size ()); ++point_i)
   {
     // Get neighbors
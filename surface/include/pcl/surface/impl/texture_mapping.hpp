@@ -40,6 +40,7 @@
 
 #include <pcl/common/distances.h>
 #include <pcl/surface/texture_mapping.h>
+#include <algorithm>
 #include <unordered_set>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -938,6 +939,167 @@ pcl::TextureMapping<PointInT>::textureMeshwithMultipleCameras (pcl::TextureMesh
 
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT> void
+pcl::TextureMapping<PointInT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT> void
+pcl::TextureMapping<PointInT>::textureMeshwithMultipleCamerasRaycast (pcl::TextureMesh &mesh, const pcl::texture_mapping::CameraVector &cameras)
+{
+  if (mesh.tex_polygons.size () != 1)
+    return;
+
+  typename pcl::PointCloud<PointInT>::Ptr mesh_cloud (new pcl::PointCloud<PointInT>);
+  pcl::fromPCLPointCloud2 (mesh.cloud, *mesh_cloud);
+
+  // The faces are moved out of the mesh, its sub-meshes are rebuilt from them at the end
+  const std::vector<pcl::Vertices> faces = std::move (mesh.tex_polygons[0]);
+  mesh.tex_polygons[0].clear ();
+  const std::ptrdiff_t nr_vertices = static_cast<std::ptrdiff_t> (mesh_cloud->size ());
+  const std::ptrdiff_t nr_faces = static_cast<std::ptrdiff_t> (faces.size ());
+
+  // Build the hierarchy used to cast the occlusion rays once, for all the cameras
+  std::vector<Eigen::Vector3f> vertices (nr_vertices);
+  for (std::ptrdiff_t idx = 0; idx < nr_vertices; ++idx)
+    vertices[idx] = (*mesh_cloud)[idx].getVector3fMap ();
+  pcl::texture_mapping::FaceBVH bvh;
+  bvh.build (vertices, faces);
+
+  // Camera of each face (-1 while it is not visible) and its UV coordinates in that camera
+  std::vector<int> face_camera (nr_faces, -1);
+  std::vector<pcl::PointXY> face_uv (3 * nr_faces);
+
+  // Visibility of each vertex from the current camera: 0 not needed, 1 needed, 2 visible, 3 not visible
+  std::vector<std::uint8_t> vertex_state (nr_vertices);
+  std::vector<pcl::PointXY> vertex_uv (nr_vertices);
+
+  std::ptrdiff_t nr_remaining = nr_faces;
+  for (int current_cam = 0; current_cam < static_cast<int> (cameras.size ()) && nr_remaining > 0; ++current_cam)
+  {
+    PCL_INFO ("Processing camera %d of %zu.\n", current_cam+1, cameras.size ());
+    const Camera &camera = cameras[current_cam];
+    const Eigen::Affine3f world_to_camera = camera.pose.inverse ();
+    const Eigen::Vector3f camera_center = camera.pose.translation ();
+
+    // Only the vertices of the faces that no previous camera sees are tested
+    std::fill (vertex_state.begin (), vertex_state.end (), std::uint8_t (0));
+    for (std::ptrdiff_t idx_face = 0; idx_face < nr_faces; ++idx_face)
+      if (face_camera[idx_face] < 0)
+        for (const auto &vertex : faces[idx_face].vertices)
+          vertex_state[vertex] = 1;
+
+#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
+#pragma omp parallel for \
+  default(none) \
+  shared(bvh, camera, mesh_cloud, vertex_state, vertex_uv, vertices) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
+#else
+#pragma omp parallel for \
+  default(none) \
+  shared(bvh, camera, camera_center, mesh_cloud, nr_vertices, vertex_state, vertex_uv, vertices, world_to_camera) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
+#endif
+    for (std::ptrdiff_t idx = 0; idx < nr_vertices; ++idx)
+    {
+      if (vertex_state[idx] != 1)
+        continue;
+      PointInT pt = (*mesh_cloud)[idx];
+      pt.getVector3fMap () = world_to_camera * vertices[idx];
+      if (getPointUVCoordinates (pt, camera, vertex_uv[idx]) &&
+          !isPointOccluded (vertices[idx], camera_center, bvh, static_cast<pcl::index_t> (idx)))
+        vertex_state[idx] = 2;
+      else
+        vertex_state[idx] = 3;
+    }
+
+#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
+#pragma omp parallel for \
+  default(none) \
+  shared(current_cam, face_camera, face_uv, vertex_state, vertex_uv) \
+  reduction(-: nr_remaining) \
+  num_threads(threads_)
+#else
+#pragma omp parallel for \
+  default(none) \
+  shared(current_cam, face_camera, face_uv, faces, nr_faces, vertex_state, vertex_uv) \
+  reduction(-: nr_remaining) \
+  num_threads(threads_)
+#endif
+    for (std::ptrdiff_t idx_face = 0; idx_face < nr_faces; ++idx_face)
+    {
+      if (face_camera[idx_face] >= 0 || faces[idx_face].vertices.size () != 3)
+        continue;
+      const auto &face_vertices = faces[idx_face].vertices;
+      if (vertex_state[face_vertices[0]] == 2 && vertex_state[face_vertices[1]] == 2 && vertex_state[face_vertices[2]] == 2)
+      {
+        face_camera[idx_face] = current_cam;
+        for (int k = 0; k < 3; ++k)
+          face_uv[3 * idx_face + k] = vertex_uv[face_vertices[k]];
+        --nr_remaining;
+      }
+    }
+  }
+
+  // Position of each face in the sub-mesh of its camera, the last sub-mesh holds the faces that no camera sees
+  const int nr_meshes = static_cast<int> (cameras.size ()) + 1;
+  std::vector<std::size_t> mesh_sizes (nr_meshes, 0);
+  std::vector<std::size_t> face_position (nr_faces);
+  for (std::ptrdiff_t idx_face = 0; idx_face < nr_faces; ++idx_face)
+  {
+    if (face_camera[idx_face] < 0)
+      face_camera[idx_face] = nr_meshes - 1;
+    face_position[idx_face] = mesh_sizes[face_camera[idx_face]]++;
+  }
+
+  mesh.tex_polygons.resize (nr_meshes);
+  mesh.tex_coordinates.resize (nr_meshes);
+  for (int idx_mesh = 0; idx_mesh < nr_meshes; ++idx_mesh)
+  {
+    mesh.tex_polygons[idx_mesh].resize (mesh_sizes[idx_mesh]);
+    mesh.tex_coordinates[idx_mesh].resize (3 * mesh_sizes[idx_mesh]);
+  }
+
+  // Copy the faces and their UV coordinates into the sub-meshes
+#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
+#pragma omp parallel for \
+  default(none) \
+  shared(face_camera, face_position, face_uv, mesh) \
+  num_threads(threads_)
+#else
+#pragma omp parallel for \
+  default(none) \
+  shared(face_camera, face_position, face_uv, faces, mesh, nr_faces, nr_meshes) \
+  num_threads(threads_)
+#endif
+  for (std::ptrdiff_t idx_face = 0; idx_face < nr_faces; ++idx_face)
+  {
+    const int idx_mesh = face_camera[idx_face];
+    const std::size_t position = face_position[idx_face];
+    mesh.tex_polygons[idx_mesh][position] = faces[idx_face];
+    for (std::size_t k = 0; k < 3; ++k)
+    {
+      if (idx_mesh == nr_meshes - 1)
+        mesh.tex_coordinates[idx_mesh][3 * position + k] = Eigen::Vector2f (-1.0f, -1.0f);
+      else
+        mesh.tex_coordinates[idx_mesh][3 * position + k] = Eigen::Vector2f (face_uv[3 * idx_face + k].x,
+                                                                            face_uv[3 * idx_face + k].y);
+    }
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT> inline void
 pcl::TextureMapping<PointInT>::getTriangleCircumcenterAndSize(const pcl::PointXY &p1, const pcl::PointXY &p2, const pcl::PointXY &p3, pcl::PointXY &circomcenter, double &radius)
@@ -39,6 +39,10 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/surface/reconstruction.h>
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 namespace pcl
 {
   /*
@@ -433,10 +437,72 @@ namespace pcl
       getPercentageExtendGrid ()
       { return percentage_extend_grid_; }
 
+      /** \brief Method that sets the width of the narrow band around the input points in which the grid is evaluated.
+        * If it is larger than 0, only the blocks of 8x8x8 grid cells within this many cells of an input point are
+        * stored and evaluated, so that the memory and the time of the reconstruction grow with the area of the
+        * surface instead of the volume of the grid. The surface is not extracted outside of the narrow band.
+        * \note Subclasses fill the active blocks in voxelizeData () through getGridCellPosition (), as done by
+        * MarchingCubesHoppe and MarchingCubesRBF.
+        * \param[in] narrow_band the width of the narrow band in grid cells, 0 (default) evaluates the whole grid
+        */
+      inline void
+      setNarrowBand (int narrow_band)
+      { narrow_band_ = narrow_band; }
+
+      /** \brief Method that returns the width of the narrow band around the input points in which the grid is
+        * evaluated, 0 if the whole grid is evaluated.
+        */
+      inline int
+      getNarrowBand () const
+      { return narrow_band_; }
+
+      /** \brief Method that sets whether the vertices shared by neighboring triangles are merged.
+        * If false (default), every triangle has its own three vertices. If true, the triangles which intersect the
+        * same edge of the grid share a single vertex, which makes the mesh about six times smaller and connected.
+        * \param[in] merge_vertices true if the vertices shared by triangles should be merged
+        */
+      inline void
+      setMergeVertices (bool merge_vertices)
+      { merge_vertices_ = merge_vertices; }
+
+      /** \brief Method that returns whether the vertices shared by neighboring triangles are merged. */
+      inline bool
+      getMergeVertices () const
+      { return merge_vertices_; }
+
+      /** \brief Set the number of threads used to compute the grid and to extract the surface.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
     protected:
-      /** \brief The data structure storing the 3D grid */
+      /** \brief Side length in grid cells of the blocks of the narrow band */
+      static constexpr int block_size_ = 8;
+
+      /** \brief Number of grid cells in a block of the narrow band */
+      static constexpr int block_volume_ = block_size_ * block_size_ * block_size_;
+
+      /** \brief The data structure storing the 3D grid. If a narrow band is used, it stores the values of the active
+        * blocks one after the other, with block_volume_ values per block.
+        */
       std::vector<float> grid_;
 
+      /** \brief Width of the narrow band in grid cells, 0 if the whole grid is evaluated */
+      int narrow_band_ = 0;
+
+      /** \brief Grid position of the lower corner of every active block of the narrow band */
+      std::vector<Eigen::Vector3i> block_origins_;
+
+      /** \brief Index of the active block for a block key, see getBlockKey () */
+      std::unordered_map<std::uint64_t, std::size_t> block_indices_;
+
+      /** \brief Whether the vertices shared by neighboring triangles are merged */
+      bool merge_vertices_ = false;
+
+      /** \brief The number of threads the scheduler should use */
+      unsigned int threads_ = 1;
+
       /** \brief The grid resolution */
       int res_x_ = 32, res_y_ = 32, res_z_ = 32;
 
@@ -474,17 +540,69 @@ namespace pcl
         * \param leaf_node the leaf node to be checked
         * \param index_3d the 3d index of the leaf node to be checked
         * \param cloud point cloud to store the vertices of the polygon
+        * \param edge_keys if not null, the key of the grid edge of every vertex added to cloud is appended to it,
+        * see getEdgeKey ()
         */
       void
       createSurface (const std::vector<float> &leaf_node,
                      const Eigen::Vector3i &index_3d,
-                     pcl::PointCloud<PointNT> &cloud);
+                     pcl::PointCloud<PointNT> &cloud,
+                     std::vector<std::uint64_t> *edge_keys = nullptr);
 
       /** \brief Get the bounding box for the input data points. 
         */
       void
       getBoundingBox ();
 
+      /** \brief Activate the blocks of the narrow band which are within narrow_band_ grid cells of an input point
+        * and allocate their values in grid_.
+        */
+      void
+      createNarrowBand ();
+
+      /** \brief Method that returns the key of the block containing the given grid position. */
+      inline std::uint64_t
+      getBlockKey (const Eigen::Vector3i &pos) const
+      {
+        const std::uint64_t nr_blocks_y = (res_y_ + block_size_ - 1) / block_size_;
+        const std::uint64_t nr_blocks_z = (res_z_ + block_size_ - 1) / block_size_;
+        return ((static_cast<std::uint64_t> (pos[0] / block_size_) * nr_blocks_y +
+                 pos[1] / block_size_) * nr_blocks_z + pos[2] / block_size_);
+      }
+
+      /** \brief Method that returns a unique key for the edge of the grid which starts at the given grid position
+        * and goes along the given axis.
+        * \param[in] pos the lower end of the edge
+        * \param[in] axis the direction of the edge, 0 for x, 1 for y and 2 for z
+        */
+      inline std::uint64_t
+      getEdgeKey (const Eigen::Vector3i &pos, int axis) const
+      {
+        return (((static_cast<std::uint64_t> (pos[0]) * res_y_ + pos[1]) * res_z_ + pos[2]) * 3 + axis);
+      }
+
+      /** \brief Method that returns the grid position of the value grid_[cell], for both the dense grid and the
+        * blocks of the narrow band. voxelizeData () computes the values of all cells for which it returns true.
+        * \param[in] cell the index of the value in grid_
+        * \param[out] pos the position of the cell in the grid
+        * \return false if the cell lies in a block of the narrow band, but outside of the grid
+        */
+      inline bool
+      getGridCellPosition (std::size_t cell, Eigen::Vector3i &pos) const
+      {
+        if (narrow_band_ <= 0)
+        {
+          pos[0] = static_cast<int> (cell / (static_cast<std::size_t> (res_y_) * res_z_));
+          pos[1] = static_cast<int> (cell / res_z_ % res_y_);
+          pos[2] = static_cast<int> (cell % res_z_);
+          return (true);
+        }
+        const auto local = static_cast<int> (cell % block_volume_);
+        pos = block_origins_[cell / block_volume_] +
+              Eigen::Vector3i (local / (block_size_ * block_size_), local / block_size_ % block_size_, local % block_size_);
+        return (pos[0] < res_x_ && pos[1] < res_y_ && pos[2] < res_z_);
+      }
+
 
       /** \brief Method that returns the scalar value at the given grid position.
         * \param[in] pos The 3D position in the grid
@@ -500,6 +618,23 @@ namespace pcl
       getNeighborList1D (std::vector<float> &leaf,
                          Eigen::Vector3i &index3d);
 
+      /** \brief Extract the surface from the dense grid in parallel, one slice of the grid along the x-axis per task.
+        * The triangles are stored in the same order as by a serial extraction.
+        * \param[out] cloud point cloud to store the vertices of the polygons
+        * \param[out] edge_keys if not null, the keys of the grid edges of the vertices
+        */
+      void
+      extractDenseSurface (pcl::PointCloud<PointNT> &cloud,
+                           std::vector<std::uint64_t> *edge_keys);
+
+      /** \brief Extract the surface from the active blocks of the narrow band in parallel.
+        * \param[out] cloud point cloud to store the vertices of the polygons
+        * \param[out] edge_keys if not null, the keys of the grid edges of the vertices
+        */
+      void
+      extractNarrowBandSurface (pcl::PointCloud<PointNT> &cloud,
+                                std::vector<std::uint64_t> *edge_keys);
+
       /** \brief Class get name method. */
       std::string getClassName () const override { return ("MarchingCubes"); }
 
@@ -49,6 +49,8 @@ namespace pcl
     *
     * \note This algorithm in its current implementation may not be suitable for very
     * large point clouds, due to high memory requirements.
+    * \note The kernel is not compactly supported, every RBF center contributes to every grid cell. Use
+    * setNarrowBand () to evaluate only the cells close to the input points.
     * \author Alexandru E. Ichim
     * \ingroup surface
     */
@@ -68,6 +70,7 @@ namespace pcl
       using MarchingCubes<PointNT>::size_voxel_;
       using MarchingCubes<PointNT>::upper_boundary_;
       using MarchingCubes<PointNT>::lower_boundary_;
+      using MarchingCubes<PointNT>::threads_;
 
       using PointCloudPtr = typename pcl::PointCloud<PointNT>::Ptr;
 
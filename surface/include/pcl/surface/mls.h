@@ -253,8 +253,10 @@ namespace pcl
     * www.sci.utah.edu/~shachar/Publications/crpss.pdf
     * \note There is a parallelized version of the processing step, using the OpenMP standard.
     * Compared to the standard version, an overhead is incurred in terms of runtime and memory usage.
-    * The upsampling methods DISTINCT_CLOUD and VOXEL_GRID_DILATION are not parallelized completely,
-    * i.e. parts of the algorithm run on a single thread only.
+    * The points are processed in parallel if setNumberOfThreads () is used; the output does not depend on the
+    * number of threads. The random samples of RANDOM_UNIFORM_DENSITY are drawn from a new random seed on every
+    * call to process (), so they differ between calls. The dilation of the voxel grid of VOXEL_GRID_DILATION
+    * runs on a single thread only.
     * \author Zoltan Csaba Marton, Radu B. Rusu, Alexandru E. Ichim, Suat Gedikli, Robert Huitl
     * \ingroup surface
     */
@@ -316,12 +318,15 @@ namespace pcl
                               upsampling_step_ (0.0),
                               desired_num_points_in_radius_ (0),
                               cache_mls_results_ (true),
+                              reuse_mls_results_ (false),
+                              mls_results_search_radius_ (0.0),
+                              mls_results_order_ (0),
                               projection_method_ (MLSResult::SIMPLE),
                               threads_ (1),
                               voxel_size_ (1.0),
                               dilation_iteration_num_ (0),
                               nr_coeff_ (),
-                              rng_uniform_distribution_ ()
+                              rng_seed_ (0)
                               {};
 
       /** \brief Empty destructor */
@@ -481,6 +486,22 @@ namespace pcl
       inline bool
       getCacheMLSResults () const { return (cache_mls_results_); }
 
+      /** \brief Set whether the cached mls results of the previous call to process () should be reused.
+        * If true, and the input cloud, the indices, the search method, the search radius and the polynomial order
+        * are the same as in the previous call, the neighbor searches and polynomial fits are skipped and the points
+        * are only projected to the cached surfaces, e.g. to project several distinct clouds or to try different
+        * upsampling or projection methods.
+        * \param[in] reuse_mls_results True if the cached mls results should be reused, otherwise false.
+        * \note The input cloud is compared by pointer, call setInputCloud () with a new cloud after modifying it.
+        * \note Only points with a valid mls result are projected when the results are reused.
+        */
+      inline void
+      setReuseMLSResults (bool reuse_mls_results) { reuse_mls_results_ = reuse_mls_results; }
+
+      /** \brief Get whether the cached mls results of the previous call to process () are reused. */
+      inline bool
+      getReuseMLSResults () const { return (reuse_mls_results_); }
+
       /** \brief Set the method to be used when projection the point on to the MLS surface.
         * \param method
         * \note This is only used when polynomial fit is enabled.
@@ -574,6 +595,18 @@ namespace pcl
         */
       std::vector<MLSResult> mls_results_;
 
+      /** \brief True if the cached mls results of the previous call to process () should be reused */
+      bool reuse_mls_results_;
+
+      /** \brief The input cloud, indices and search method of the cached mls results, see setReuseMLSResults () */
+      PointCloudInConstPtr mls_results_input_;
+      IndicesPtr mls_results_indices_;
+      KdTreePtr mls_results_tree_;
+
+      /** \brief The search radius and the polynomial order of the cached mls results */
+      double mls_results_search_radius_;
+      int mls_results_order_;
+
       /** \brief Parameter that specifies the projection method to be used. */
       MLSResult::ProjectionMethod projection_method_;
 
@@ -682,6 +715,57 @@ namespace pcl
                              MLSResult &mls_result) const;
 
 
+      /** \brief Add the points of the given upsampling method for a point whose MLS surface has been computed.
+        * \param[in] index the index of the query point in the input cloud
+        * \param[in] nr_neighbors the number of neighbors of the query point
+        * \param[in] mls_result the MLS result of the query point
+        * \param[out] projected_points the set of projected points around the query point
+        * \param[out] projected_points_normals the normals corresponding to the projected points
+        * \param[out] corresponding_input_indices the set of indices with each point in output having the corresponding point in input
+        */
+      void
+      projectMLSResult (pcl::index_t index,
+                        std::size_t nr_neighbors,
+                        const MLSResult &mls_result,
+                        PointCloudOut &projected_points,
+                        NormalCloud &projected_points_normals,
+                        PointIndices &corresponding_input_indices) const;
+
+      /** \brief Project points to the MLS surface of their nearest input point in parallel and append them to
+        * output, used by the DISTINCT_CLOUD and VOXEL_GRID_DILATION upsampling methods.
+        * \param[in] query_points the points to project, points which are not finite are skipped
+        * \param[out] output the cloud to append the projected points to
+        */
+      void
+      projectToMLSSurface (const PointCloudIn &query_points, PointCloudOut &output);
+
+      /** \brief Append the points computed for consecutive chunks of points to output, normals_ and
+        * corresponding_input_indices_, in the order of the chunks. The chunks are copied in parallel to their
+        * offsets, which are computed with a prefix sum over the chunk sizes, so the output is allocated only once.
+        * \param[in] projected_points the points of every chunk
+        * \param[in] projected_points_normals the normals of every chunk
+        * \param[in] corresponding_input_indices the input indices of every chunk
+        * \param[out] output the cloud to append the points to
+        */
+      void
+      appendChunks (const typename PointCloudOut::CloudVectorType &projected_points,
+                    const typename NormalCloud::CloudVectorType &projected_points_normals,
+                    const std::vector<PointIndices> &corresponding_input_indices,
+                    PointCloudOut &output);
+
+      /** \brief Returns true if the cached mls results can be reused, see setReuseMLSResults () */
+      inline bool
+      canReuseMLSResults () const
+      {
+        return (reuse_mls_results_ && mls_results_input_ && mls_results_input_ == input_ &&
+                mls_results_indices_ == indices_ && mls_results_tree_ == tree_ &&
+                mls_results_search_radius_ == search_radius_ && mls_results_order_ == order_ &&
+                mls_results_.size () == input_->size ());
+      }
+
+      /** \brief Number of points processed by a task of the parallel loops */
+      static constexpr std::size_t chunk_size_ = 256;
+
       /** \brief This is a helper function for adding projected points
         * \param[in] index the index of the query point in the input cloud
         * \param[in] point the projected point to be added
@@ -718,13 +802,12 @@ namespace pcl
       performUpsampling (PointCloudOut &output);
 
     private:
-      /** \brief Random number generator algorithm. */
-      mutable std::mt19937 rng_;
-
-      /** \brief Random number generator using an uniform distribution of floats
+      /** \brief Seed of the random number generators, drawn anew on every call to process (). Every input
+        * point uses its own generator seeded with the sum of this seed and its index, so that the samples do not
+        * depend on the threads.
         * \note Used only in the case of RANDOM_UNIFORM_DENSITY upsampling
         */
-      std::unique_ptr<std::uniform_real_distribution<>> rng_uniform_distribution_;
+      std::uint32_t rng_seed_;
 
       /** \brief Abstract class get name method. */
       std::string
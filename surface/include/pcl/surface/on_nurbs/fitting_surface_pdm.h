@@ -144,6 +144,12 @@ namespace pcl
       void
       setInvMapParams (unsigned in_max_steps, double in_accuracy);
 
+      /** \brief Set the number of threads used for the inverse mapping of the points in assemble ().
+       * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+       */
+      void
+      setNumberOfThreads (unsigned nr_threads = 0);
+
       /** \brief Get the elements of a B-Spline surface.*/
       static std::vector<double>
       getElementVector (const ON_NurbsSurface &nurbs, int dim);
@@ -289,6 +295,9 @@ namespace pcl
       int in_max_steps;
       double in_accuracy;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned m_threads;
+
       // index routines
       int
       grc2gl (int I, int J) const
@@ -42,13 +42,20 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/surface/on_nurbs/sparse_mat.h>
 
+#include <utility>
+#include <vector>
+
 namespace pcl
 {
   namespace on_nurbs
   {
 
     /** \brief Solving the linear system of equations using Eigen or UmfPack.
-     * (can be defined in on_nurbs.cmake)*/
+     * (can be defined in on_nurbs.cmake)
+     * With Eigen the non-zero entries of K are stored per row and assembled into a sparse
+     * matrix from triplets. The least squares problem is solved with the sparse Cholesky
+     * decomposition of the normal equations, or by sparse QR decomposition if they are ill
+     * conditioned. Rank deficient systems fall back to the minimum norm solution of a dense SVD.*/
     class NurbsSolve
     {
     public:
@@ -124,7 +131,7 @@ namespace pcl
     private:
       bool m_quiet;
       SparseMat m_Ksparse;
-      Eigen::MatrixXd m_Keig;
+      std::vector<std::vector<std::pair<unsigned, double> > > m_Krows;
       Eigen::MatrixXd m_xeig;
       Eigen::MatrixXd m_feig;
 
@@ -71,6 +71,9 @@ namespace pcl
 
       using MeshConstruction<PointInT>::input_;
       using MeshConstruction<PointInT>::check_tree_;
+      using MeshConstruction<PointInT>::initCompute;
+      using MeshConstruction<PointInT>::deinitCompute;
+      using MeshConstruction<PointInT>::reconstruct;
 
       using PointCloudPtr = typename pcl::PointCloud<PointInT>::Ptr;
 
@@ -100,6 +103,7 @@ namespace pcl
       , distance_tolerance_ (-1.0f)
       , distance_dependent_ (false)
       , use_depth_as_distance_(false)
+      , threads_ (1)
       {
         check_tree_ = false;
       };
@@ -229,6 +233,21 @@ namespace pcl
         use_depth_as_distance_ = enable;
       }
 
+      /** \brief Set the number of threads used to triangulate bands of rows of the input in parallel.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Create the mesh as a flat list of vertex indices, 3 per triangle, or 4 per quad for \a QUAD_MESH.
+        *
+        * The polygons are the ones of the other reconstruct methods, in the same order. The list is cleared and
+        * refilled, so that passing the same list for each frame reuses its memory.
+        * \param[out] vertex_indices the indices of the vertices of the polygons
+        */
+      void
+      reconstruct (std::vector<std::uint32_t> &vertex_indices);
+
     protected:
       /** \brief max length of edge, scalar component */
       float max_edge_length_a_;
@@ -270,6 +289,15 @@ namespace pcl
           This flag may be set using useDepthAsDistance(true) for (RGB-)Depth cameras to skip computations and gain additional speed up. */
       bool use_depth_as_distance_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Vertex indices of the polygons, kept to reuse its memory for the next reconstruction. */
+      std::vector<std::uint32_t> index_buffer_;
+
+      /** \brief Vertex indices of the polygons of each band of rows, kept to reuse their memory. */
+      std::vector<std::vector<std::uint32_t> > band_index_buffers_;
+
 
       /** \brief Perform the actual polygonal reconstruction.
         * \param[out] polygons the resultant polygons
@@ -293,6 +321,59 @@ namespace pcl
       void
       performReconstruction (pcl::PolygonMesh &output) override;
 
+      /** \brief Create the polygons of all rows as a flat list of vertex indices, in parallel bands of rows.
+        * \param[out] vertex_indices the indices of the vertices of the polygons
+        */
+      void
+      makeIndexBuffer (std::vector<std::uint32_t> &vertex_indices);
+
+      /** \brief Append the polygons of the rows [row_begin, row_end) to a flat list of vertex indices.
+        * \param[in] row_begin the first row (a multiple of the row step)
+        * \param[in] row_end the end of the rows
+        * \param[in,out] vertex_indices the indices of the vertices of the polygons
+        */
+      void
+      makeMesh (int row_begin, int row_end, std::vector<std::uint32_t> &vertex_indices);
+
+      /** \brief Convert a flat list of vertex indices into polygons, reusing the memory of \a polygons.
+        * \param[in] vertex_indices the indices of the vertices of the polygons
+        * \param[in] polygon_size the number of vertices of each polygon
+        * \param[out] polygons the resultant polygons
+        */
+      void
+      indicesToPolygons (const std::vector<std::uint32_t> &vertex_indices, std::size_t polygon_size,
+                         std::vector<pcl::Vertices> &polygons) const;
+
+      /** \brief Add a new triangle to a flat list of vertex indices
+        * \param[in] a index of the first vertex
+        * \param[in] b index of the second vertex
+        * \param[in] c index of the third vertex
+        * \param[out] vertex_indices the list to be updated
+        */
+      inline void
+      addTriangle (int a, int b, int c, std::vector<std::uint32_t>& vertex_indices)
+      {
+        vertex_indices.push_back (a);
+        vertex_indices.push_back (b);
+        vertex_indices.push_back (c);
+      }
+
+      /** \brief Add a new quad to a flat list of vertex indices
+        * \param[in] a index of the first vertex
+        * \param[in] b index of the second vertex
+        * \param[in] c index of the third vertex
+        * \param[in] d index of the fourth vertex
+        * \param[out] vertex_indices the list to be updated
+        */
+      inline void
+      addQuad (int a, int b, int c, int d, std::vector<std::uint32_t>& vertex_indices)
+      {
+        vertex_indices.push_back (a);
+        vertex_indices.push_back (b);
+        vertex_indices.push_back (c);
+        vertex_indices.push_back (d);
+      }
+
       /** \brief Add a new triangle to the current polygon mesh
         * \param[in] a index of the first vertex
         * \param[in] b index of the second vertex
@@ -466,23 +547,55 @@ namespace pcl
       void
       makeQuadMesh (std::vector<pcl::Vertices>& polygons);
 
+      /** \brief Append the quads of the rows [row_begin, row_end) to a flat list of vertex indices.
+        * \param[in] row_begin the first row
+        * \param[in] row_end the end of the rows
+        * \param[in,out] vertex_indices the indices of the vertices of the quads
+        */
+      void
+      makeQuadMesh (int row_begin, int row_end, std::vector<std::uint32_t>& vertex_indices);
+
       /** \brief Create a right cut mesh.
         * \param[out] polygons the resultant mesh
         */
       void
       makeRightCutMesh (std::vector<pcl::Vertices>& polygons);
 
+      /** \brief Append the right cut triangles of the rows [row_begin, row_end) to a flat list of vertex indices.
+        * \param[in] row_begin the first row
+        * \param[in] row_end the end of the rows
+        * \param[in,out] vertex_indices the indices of the vertices of the triangles
+        */
+      void
+      makeRightCutMesh (int row_begin, int row_end, std::vector<std::uint32_t>& vertex_indices);
+
       /** \brief Create a left cut mesh.
         * \param[out] polygons the resultant mesh
         */
       void
       makeLeftCutMesh (std::vector<pcl::Vertices>& polygons);
 
+      /** \brief Append the left cut triangles of the rows [row_begin, row_end) to a flat list of vertex indices.
+        * \param[in] row_begin the first row
+        * \param[in] row_end the end of the rows
+        * \param[in,out] vertex_indices the indices of the vertices of the triangles
+        */
+      void
+      makeLeftCutMesh (int row_begin, int row_end, std::vector<std::uint32_t>& vertex_indices);
+
       /** \brief Create an adaptive cut mesh.
         * \param[out] polygons the resultant mesh
         */
       void
       makeAdaptiveCutMesh (std::vector<pcl::Vertices>& polygons);
+
+      /** \brief Append the adaptive cut triangles of the rows [row_begin, row_end) to a flat list of vertex indices.
+        * \param[in] row_begin the first row
+        * \param[in] row_end the end of the rows
+        * \param[in,out] vertex_indices the indices of the vertices of the triangles
+        */
+      void
+      makeAdaptiveCutMesh (int row_begin, int row_end, std::vector<std::uint32_t>& vertex_indices);
   };
 }
 
@@ -68,10 +68,32 @@ namespace pcl
       using SurfaceReconstruction<PointNT>::tree_;
 
       using PointCloudPtr = typename pcl::PointCloud<PointNT>::Ptr;
+      using PointCloudConstPtr = typename pcl::PointCloud<PointNT>::ConstPtr;
 
       using KdTree = pcl::KdTree<PointNT>;
       using KdTreePtr = typename KdTree::Ptr;
 
+      /** \brief Timing and size statistics of a reconstruction, to estimate the resources needed by a job. */
+      struct Statistics
+      {
+        /** \brief Number of slabs the input was divided into (1 if it was reconstructed at once) */
+        std::size_t nr_slabs = 0;
+        /** \brief Number of samples inserted into the octrees, points in the overlap of slabs are counted twice */
+        std::size_t nr_samples = 0;
+        /** \brief Largest number of octree nodes of a slab */
+        std::size_t max_tree_nodes = 0;
+        /** \brief Largest memory in bytes used by the octree, the samples and the mesh of a slab (estimated from their sizes) */
+        std::size_t max_memory = 0;
+        /** \brief Time in seconds spent to build and refine the octrees */
+        double tree_time = 0;
+        /** \brief Time in seconds spent to set the constraints of the Laplacian equation */
+        double constraints_time = 0;
+        /** \brief Time in seconds spent to solve the Laplacian equation */
+        double solver_time = 0;
+        /** \brief Time in seconds spent to extract the iso-surface */
+        double extraction_time = 0;
+      };
+
       /** \brief Constructor that sets all the parameters to working default values. */
       Poisson ();
 
@@ -230,6 +252,38 @@ namespace pcl
         return threads_;
       }
 
+      /** \brief Set the maximum number of points that are reconstructed at once, to bound the memory of the solver.
+        * \note Larger inputs are divided into slabs along the longest axis of their bounding box, which are
+        * reconstructed one after the other, with the same resolution as the whole input. Each slab is solved with the
+        * points of its neighbors that lie within the slab overlap, and only keeps the polygons whose center lies inside
+        * the slab. The meshes of the slabs are not connected.
+        * \param[in] max_slab_points the maximum number of points of a slab, without its overlap (0 to reconstruct
+        * the whole input at once, which is the default)
+        */
+      inline void
+      setMaxSlabPoints (std::size_t max_slab_points) { max_slab_points_ = max_slab_points; }
+
+      /** \brief Get the maximum number of points that are reconstructed at once */
+      inline std::size_t
+      getMaxSlabPoints () const { return max_slab_points_; }
+
+      /** \brief Set the width of the overlap between slabs, relative to the width of a slab.
+        * \note The solver closes the surface of each slab beyond its points, the overlap has to be wide enough for
+        * these closing surfaces to fall outside of the slab.
+        * \param[in] slab_overlap the ratio between the width of the overlap on each side and the width of the slab
+        * (0.5 by default)
+        */
+      inline void
+      setSlabOverlap (float slab_overlap) { slab_overlap_ = slab_overlap; }
+
+      /** \brief Get the width of the overlap between slabs, relative to the width of a slab */
+      inline float
+      getSlabOverlap () const { return slab_overlap_; }
+
+      /** \brief Get the timing and size statistics of the last reconstruction */
+      inline const Statistics&
+      getStatistics () const { return statistics_; }
+
     protected:
       /** \brief Class get name method. */
       std::string
@@ -259,11 +313,38 @@ namespace pcl
       float solver_accuracy_;
       int threads_;
 
+      std::size_t max_slab_points_;
+      float slab_overlap_;
+      Statistics statistics_;
+
       template<int Degree> void
-      execute (poisson::CoredVectorMeshData &mesh,
+      execute (const PointCloudConstPtr &cloud,
+               int depth,
+               poisson::CoredVectorMeshData &mesh,
                poisson::Point3D<float> &translate,
                float &scale);
 
+      /** \brief Reconstruct the surface of the input, at once or slab by slab.
+        * \param[out] points the vertex positions of the resulting mesh
+        * \param[out] polygons the connectivity of the resulting mesh
+        */
+      template<typename PointT> void
+      reconstructSurface (pcl::PointCloud<PointT> &points, std::vector<pcl::Vertices> &polygons);
+
+      /** \brief Reconstruct the surface of a cloud and append the polygons whose center lies in a slab.
+        * \param[in] cloud the points to reconstruct
+        * \param[in] depth the maximum depth of the octree
+        * \param[in] axis the axis along which the slab is bounded
+        * \param[in] min_coord the lower bound of the slab
+        * \param[in] max_coord the upper bound of the slab
+        * \param[in,out] points the vertex positions of the resulting mesh
+        * \param[in,out] polygons the connectivity of the resulting mesh
+        */
+      template<typename PointT> void
+      reconstructSlab (const PointCloudConstPtr &cloud, int depth,
+                       int axis, float min_coord, float max_coord,
+                       pcl::PointCloud<PointT> &points, std::vector<pcl::Vertices> &polygons);
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
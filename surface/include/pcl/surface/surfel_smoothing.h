@@ -67,6 +67,7 @@ namespace pcl
         , interm_cloud_ ()
         , interm_normals_ ()
         , tree_ ()
+        , threads_ (1)
       {
       }
 
@@ -76,6 +77,12 @@ namespace pcl
       void
       setSearchMethod (const CloudKdTreePtr &a_tree) { tree_ = a_tree; };
 
+      /** \brief Set the number of threads used to smooth the points in parallel.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       bool
       initCompute ();
 
@@ -107,6 +114,8 @@ namespace pcl
 
       CloudKdTreePtr tree_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
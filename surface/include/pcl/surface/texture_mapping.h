@@ -89,7 +89,67 @@ namespace pcl
     };
     
     using CameraVector = std::vector<Camera, Eigen::aligned_allocator<Camera> >;
-    
+
+    /** \brief Bounding volume hierarchy over the faces of a mesh, used to cast occlusion rays.
+      *
+      * Polygons with more than 3 vertices are split into a fan of triangles, faces with
+      * non-finite vertices are skipped. The hierarchy is built once, after which
+      * intersectsSegment () can be called concurrently from several threads.
+      */
+    class PCL_EXPORTS FaceBVH
+    {
+      public:
+        /** \brief Build the hierarchy.
+          * \param[in] vertices the vertices of the mesh
+          * \param[in] faces the faces of the mesh, indexing into \a vertices
+          */
+        void
+        build (const std::vector<Eigen::Vector3f> &vertices, const std::vector<pcl::Vertices> &faces);
+
+        /** \brief Check whether the segment from \a start to \a end crosses a face of the mesh.
+          * \param[in] start the start of the segment, e.g. a vertex of the mesh
+          * \param[in] end the end of the segment, e.g. the center of a camera
+          * \param[in] ignored_vertex faces containing this vertex are not tested (-1 to test all faces)
+          * \param[in] min_t intersections closer to \a start than this fraction of the segment are ignored
+          */
+        bool
+        intersectsSegment (const Eigen::Vector3f &start, const Eigen::Vector3f &end,
+                           pcl::index_t ignored_vertex = -1, float min_t = 1e-4f) const;
+
+        /** \brief Get the number of triangles in the hierarchy. */
+        inline std::size_t
+        size () const
+        {
+          return (triangles_.size ());
+        }
+
+      private:
+        /** \brief A triangle stored as a vertex and two edges, for ray intersection. */
+        struct Triangle
+        {
+          Eigen::Vector3f v0, e1, e2;
+          pcl::index_t a, b, c;
+        };
+
+        /** \brief A node of the hierarchy, a leaf if \a left is negative. */
+        struct Node
+        {
+          Eigen::AlignedBox3f box;
+          int begin, end;
+          int left;
+        };
+
+        /** \brief Intersect the segment start + t * direction, t in ]min_t, 1[, with a triangle. */
+        static bool
+        intersectsTriangle (const Triangle &triangle, const Eigen::Vector3f &start,
+                            const Eigen::Vector3f &direction, float min_t);
+
+        /** \brief The triangles, sorted so that each leaf covers a contiguous range. */
+        std::vector<Triangle> triangles_;
+
+        /** \brief The nodes, the children of a node are stored next to each other. */
+        std::vector<Node> nodes_;
+    };
   }
   
   /** \brief The texture mapping algorithm
@@ -117,7 +177,7 @@ namespace pcl
 
       /** \brief Constructor. */
       TextureMapping () :
-        f_ ()
+        f_ (), threads_ (1)
       {
       }
 
@@ -164,6 +224,12 @@ namespace pcl
         tex_material_ = tex_material;
       }
 
+      /** \brief Set the number of threads used by textureMeshwithMultipleCamerasRaycast ().
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Map texture to a mesh synthesis algorithm
         * \param[in] tex_mesh texture mesh
         */
@@ -245,6 +311,20 @@ namespace pcl
       inline bool
       isPointOccluded (const PointInT &pt, const OctreePtr octree);
 
+      /** \brief Check if a point is occluded by casting a ray toward the camera against the faces of a mesh.
+        * \param[in] pt the point from which the ray starts, in the frame of the mesh
+        * \param[in] camera_center the center of the camera, in the frame of the mesh
+        * \param[in] bvh the hierarchy built over the faces of the mesh
+        * \param[in] vertex the index of \a pt in the mesh, its faces do not occlude it (-1 if it is not a vertex)
+        * \returns true if the point is occluded.
+        */
+      inline bool
+      isPointOccluded (const Eigen::Vector3f &pt, const Eigen::Vector3f &camera_center,
+                       const pcl::texture_mapping::FaceBVH &bvh, pcl::index_t vertex = -1) const
+      {
+        return (bvh.intersectsSegment (pt, camera_center, vertex));
+      }
+
       /** \brief Remove occluded points from a point cloud
         * \param[in] input_cloud the cloud on which to perform occlusion detection
         * \param[out] filtered_cloud resulting cloud, containing only visible points
@@ -333,10 +413,27 @@ namespace pcl
       textureMeshwithMultipleCameras (pcl::TextureMesh &mesh, 
                                       const pcl::texture_mapping::CameraVector &cameras);
 
+      /** \brief Segment and texture faces by camera visibility, with occlusions found by ray casting.
+        * \details The output is arranged as by textureMeshwithMultipleCameras (): each face is assigned to the
+        * first camera that sees it, faces not visible from any camera go to the last sub-mesh. A face is
+        * visible if all its vertices are projected on the image of the camera and if the segments from them
+        * to the center of the camera do not cross any other face of the mesh. The segments are tested against
+        * a bounding volume hierarchy of the faces, and the vertices and faces are processed in parallel
+        * (see setNumberOfThreads ()).
+        * \param mesh input mesh that needs sorting. Should contain only 1 sub-mesh, made of triangles.
+        * \param[in] cameras vector containing the cameras used for texture mapping.
+        */
+      void
+      textureMeshwithMultipleCamerasRaycast (pcl::TextureMesh &mesh,
+                                             const pcl::texture_mapping::CameraVector &cameras);
+
     protected:
       /** \brief mesh scale control. */
       float f_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief vector field */
       Eigen::Vector3f vector_field_;
 
@@ -48,6 +48,78 @@ using namespace pcl;
 using namespace on_nurbs;
 using namespace Eigen;
 
+namespace
+{
+  /** \brief Get the first and the last entry of FittingSurface::getElementVector (),
+   * i.e. the parametric domain, without building the element vector. */
+  void
+  getElementBounds (const ON_NurbsSurface &nurbs, int dim, double &min, double &max)
+  {
+    int idx_min = 0;
+    int idx_max = nurbs.KnotCount (dim) - 1;
+    if (nurbs.IsClosed (dim))
+    {
+      idx_min = nurbs.Order (dim) - 2;
+      idx_max = nurbs.KnotCount (dim) - nurbs.Order (dim) + 1;
+    }
+
+    const double* knots = nurbs.Knot (dim);
+    min = knots[idx_min];
+    max = knots[idx_max];
+  }
+
+  /** \brief Midpoints of the elements of a B-Spline surface, evaluated once to find the
+   * starting points of the inverse mapping for many points (see findClosestElementMidPoint). */
+  class ElementMidPoints
+  {
+  public:
+    void
+    compute (const ON_NurbsSurface &nurbs)
+    {
+      std::vector<double> elementsU = FittingSurface::getElementVector (nurbs, 0);
+      std::vector<double> elementsV = FittingSurface::getElementVector (nurbs, 1);
+
+      params.clear ();
+      points.clear ();
+      for (std::size_t i = 0; i < elementsU.size () - 1; i++)
+      {
+        for (std::size_t j = 0; j < elementsV.size () - 1; j++)
+        {
+          double point[3];
+
+          double xi = elementsU[i] + 0.5 * (elementsU[i + 1] - elementsU[i]);
+          double eta = elementsV[j] + 0.5 * (elementsV[j + 1] - elementsV[j]);
+
+          nurbs.Evaluate (xi, eta, 0, 3, point);
+          params.emplace_back (xi, eta);
+          points.emplace_back (point[0], point[1], point[2]);
+        }
+      }
+    }
+
+    Vector2d
+    closest (const Vector3d &pt) const
+    {
+      std::size_t idx (0);
+      double d_shortest (std::numeric_limits<double>::max ());
+      for (std::size_t i = 0; i < points.size (); i++)
+      {
+        double d = (points[i] - pt).squaredNorm ();
+        if (i == 0 || d < d_shortest)
+        {
+          d_shortest = d;
+          idx = i;
+        }
+      }
+      return params[idx];
+    }
+
+  private:
+    vector_vec2d params;
+    vector_vec3d points;
+  };
+}
+
 //FittingSurface::FittingSurface(int order, NurbsDataSurface *m_data, ON_3dPoint ll, ON_3dPoint lr,
 //    ON_3dPoint ur, ON_3dPoint ul)
 //{
@@ -204,6 +276,8 @@ FittingSurface::init ()
   in_max_steps = 100;
   in_accuracy = 1e-4;
 
+  m_threads = 1;
+
   m_quiet = true;
 }
 
@@ -246,6 +320,19 @@ FittingSurface::setInvMapParams (unsigned in_max_steps, double in_accuracy)
   this->in_accuracy = in_accuracy;
 }
 
+void
+FittingSurface::setNumberOfThreads (unsigned nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    m_threads = omp_get_num_procs ();
+#else
+    m_threads = 1;
+#endif
+  else
+    m_threads = nr_threads;
+}
+
 std::vector<double>
 FittingSurface::getElementVector (const ON_NurbsSurface &nurbs, int dim) // !
 {
@@ -278,41 +365,46 @@ FittingSurface::getElementVector (const ON_NurbsSurface &nurbs, int dim) // !
 void
 FittingSurface::assembleInterior (double wInt, unsigned &row)
 {
-  m_data->interior_line_start.clear ();
-  m_data->interior_line_end.clear ();
-  m_data->interior_error.clear ();
-  m_data->interior_normals.clear ();
-  unsigned nInt = static_cast<unsigned> (m_data->interior.size ());
-  for (unsigned p = 0; p < nInt; p++)
+  int nInt = static_cast<int> (m_data->interior.size ());
+  int nParam = static_cast<int> (m_data->interior_param.size ());
+  m_data->interior_line_start.resize (nInt);
+  m_data->interior_line_end.resize (nInt);
+  m_data->interior_error.resize (nInt);
+  m_data->interior_normals.resize (nInt);
+
+  // points without parameters of a previous assembly start at the closest element midpoint
+  ElementMidPoints mid_points;
+  if (nParam < nInt)
+  {
+    m_data->interior_param.resize (nInt);
+    mid_points.compute (m_nurbs);
+  }
+
+  // inverse mapping
+#pragma omp parallel for default(none) shared(nInt, nParam, mid_points) schedule(dynamic, 64) num_threads(m_threads)
+  for (std::ptrdiff_t p = 0; p < nInt; p++)
   {
-    Vector3d &pcp = m_data->interior[p];
+    const Vector3d &pcp = m_data->interior[p];
 
-    // inverse mapping
-    Vector2d params;
+    Vector2d hint = (p < nParam) ? m_data->interior_param[p] : mid_points.closest (pcp);
     Vector3d pt, tu, tv, n;
     double error;
-    if (p < m_data->interior_param.size ())
-    {
-      params = inverseMapping (m_nurbs, pcp, m_data->interior_param[p], error, pt, tu, tv, in_max_steps, in_accuracy);
-      m_data->interior_param[p] = params;
-    }
-    else
-    {
-      params = findClosestElementMidPoint (m_nurbs, pcp);
-      params = inverseMapping (m_nurbs, pcp, params, error, pt, tu, tv, in_max_steps, in_accuracy);
-      m_data->interior_param.push_back (params);
-    }
-    m_data->interior_error.push_back (error);
+    m_data->interior_param[p] = inverseMapping (m_nurbs, pcp, hint, error, pt, tu, tv, in_max_steps, in_accuracy);
+    m_data->interior_error[p] = error;
 
     n = tu.cross (tv);
     n.normalize ();
 
-    m_data->interior_normals.push_back (n);
-    m_data->interior_line_start.push_back (pcp);
-    m_data->interior_line_end.push_back (pt);
+    m_data->interior_normals[p] = n;
+    m_data->interior_line_start[p] = pcp;
+    m_data->interior_line_end[p] = pt;
+  }
 
+  // the rows are added sequentially, the system matrix of UmfPack is not thread safe
+  for (int p = 0; p < nInt; p++)
+  {
     double w (wInt);
-    if (p < m_data->interior_weight.size ())
+    if (p < static_cast<int> (m_data->interior_weight.size ()))
       w = m_data->interior_weight[p];
 
     addPointConstraint (m_data->interior_param[p], m_data->interior[p], w, row);
@@ -322,38 +414,37 @@ FittingSurface::assembleInterior (double wInt, unsigned &row)
 void
 FittingSurface::assembleBoundary (double wBnd, unsigned &row)
 {
-  m_data->boundary_line_start.clear ();
-  m_data->boundary_line_end.clear ();
-  m_data->boundary_error.clear ();
-  m_data->boundary_normals.clear ();
-  unsigned nBnd = static_cast<unsigned> (m_data->boundary.size ());
-  for (unsigned p = 0; p < nBnd; p++)
+  int nBnd = static_cast<int> (m_data->boundary.size ());
+  m_data->boundary_line_start.resize (nBnd);
+  m_data->boundary_line_end.resize (nBnd);
+  m_data->boundary_error.resize (nBnd);
+  m_data->boundary_normals.resize (nBnd);
+  if (m_data->boundary_param.size () < m_data->boundary.size ())
+    m_data->boundary_param.resize (nBnd);
+
+  // inverse mapping
+#pragma omp parallel for default(none) shared(nBnd) schedule(dynamic, 16) num_threads(m_threads)
+  for (std::ptrdiff_t p = 0; p < nBnd; p++)
   {
-    Vector3d &pcp = m_data->boundary[p];
+    const Vector3d &pcp = m_data->boundary[p];
 
     double error;
     Vector3d pt, tu, tv, n;
-    Vector2d params = inverseMappingBoundary (m_nurbs, pcp, error, pt, tu, tv, in_max_steps, in_accuracy);
-    m_data->boundary_error.push_back (error);
-
-    if (p < m_data->boundary_param.size ())
-    {
-      m_data->boundary_param[p] = params;
-    }
-    else
-    {
-      m_data->boundary_param.push_back (params);
-    }
+    m_data->boundary_param[p] = inverseMappingBoundary (m_nurbs, pcp, error, pt, tu, tv, in_max_steps, in_accuracy);
+    m_data->boundary_error[p] = error;
 
     n = tu.cross (tv);
     n.normalize ();
 
-    m_data->boundary_normals.push_back (n);
-    m_data->boundary_line_start.push_back (pcp);
-    m_data->boundary_line_end.push_back (pt);
+    m_data->boundary_normals[p] = n;
+    m_data->boundary_line_start[p] = pcp;
+    m_data->boundary_line_end[p] = pt;
+  }
 
+  for (int p = 0; p < nBnd; p++)
+  {
     double w (wBnd);
-    if (p < m_data->boundary_weight.size ())
+    if (p < static_cast<int> (m_data->boundary_weight.size ()))
       w = m_data->boundary_weight[p];
 
     addPointConstraint (m_data->boundary_param[p], m_data->boundary[p], w, row);
@@ -973,12 +1064,9 @@ FittingSurface::inverseMapping (const ON_NurbsSurface &nurbs, const Vector3d &pt
   Matrix2d A;
   Vector2d b;
   Vector3d r;
-  std::vector<double> elementsU = getElementVector (nurbs, 0);
-  std::vector<double> elementsV = getElementVector (nurbs, 1);
-  double minU = elementsU[0];
-  double minV = elementsV[0];
-  double maxU = elementsU[elementsU.size () - 1];
-  double maxV = elementsV[elementsV.size () - 1];
+  double minU, maxU, minV, maxV;
+  getElementBounds (nurbs, 0, minU, maxU);
+  getElementBounds (nurbs, 1, minV, maxV);
 
   current = hint;
 
@@ -1051,12 +1139,9 @@ FittingSurface::inverseMapping (const ON_NurbsSurface &nurbs, const Vector3d &pt
   Matrix2d A;
   Vector2d b;
   Vector3d r, tu, tv;
-  std::vector<double> elementsU = getElementVector (nurbs, 0);
-  std::vector<double> elementsV = getElementVector (nurbs, 1);
-  double minU = elementsU[0];
-  double minV = elementsV[0];
-  double maxU = elementsU[elementsU.size () - 1];
-  double maxV = elementsV[elementsV.size () - 1];
+  double minU, maxU, minV, maxV;
+  getElementBounds (nurbs, 0, minU, maxU);
+  getElementBounds (nurbs, 1, minV, maxV);
 
   current = hint;
 
@@ -1213,12 +1298,9 @@ FittingSurface::inverseMappingBoundary (const ON_NurbsSurface &nurbs, const Vect
 
   current = hint;
 
-  std::vector<double> elementsU = getElementVector (nurbs, 0);
-  std::vector<double> elementsV = getElementVector (nurbs, 1);
-  double minU = elementsU[0];
-  double minV = elementsV[0];
-  double maxU = elementsU[elementsU.size () - 1];
-  double maxV = elementsV[elementsV.size () - 1];
+  double minU, maxU, minV, maxV;
+  getElementBounds (nurbs, 0, minU, maxU);
+  getElementBounds (nurbs, 1, minV, maxV);
 
   for (int k = 0; k < maxSteps; k++)
   {
@@ -35,9 +35,15 @@
  *
  */
 
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
+#include <Eigen/OrderingMethods> // for COLAMDOrdering
+#include <Eigen/SparseCore>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseQR>
 #include <Eigen/SVD> // for jacobiSvd
 
 #include <pcl/surface/on_nurbs/nurbs_solve.h>
@@ -45,10 +51,33 @@
 using namespace pcl;
 using namespace on_nurbs;
 
+namespace
+{
+  /** \brief Assemble the rows of the system matrix into a sparse matrix */
+  Eigen::SparseMatrix<double>
+  assembleSparse (const std::vector<std::vector<std::pair<unsigned, double> > > &rows, Eigen::Index cols)
+  {
+    std::size_t nnz (0);
+    for (const auto &row : rows)
+      nnz += row.size ();
+
+    std::vector<Eigen::Triplet<double> > triplets;
+    triplets.reserve (nnz);
+    for (std::size_t r = 0; r < rows.size (); r++)
+      for (const auto &entry : rows[r])
+        triplets.emplace_back (static_cast<int> (r), static_cast<int> (entry.first), entry.second);
+
+    Eigen::SparseMatrix<double> K (static_cast<Eigen::Index> (rows.size ()), cols);
+    K.setFromTriplets (triplets.begin (), triplets.end ());
+    return (K);
+  }
+}
+
 void
 NurbsSolve::assign (unsigned rows, unsigned cols, unsigned dims)
 {
-  m_Keig = Eigen::MatrixXd::Zero (rows, cols);
+  m_Krows.clear ();
+  m_Krows.resize (rows);
   m_xeig = Eigen::MatrixXd::Zero (cols, dims);
   m_feig = Eigen::MatrixXd::Zero (rows, dims);
 }
@@ -56,7 +85,16 @@ NurbsSolve::assign (unsigned rows, unsigned cols, unsigned dims)
 void
 NurbsSolve::K (unsigned i, unsigned j, double v)
 {
-  m_Keig (i, j) = v;
+  std::vector<std::pair<unsigned, double> > &row = m_Krows[i];
+  for (auto &entry : row)
+  {
+    if (entry.first == j)
+    {
+      entry.second = v;
+      return;
+    }
+  }
+  row.emplace_back (j, v);
 }
 void
 NurbsSolve::x (unsigned i, unsigned j, double v)
@@ -72,7 +110,12 @@ NurbsSolve::f (unsigned i, unsigned j, double v)
 double
 NurbsSolve::K (unsigned i, unsigned j)
 {
-  return m_Keig (i, j);
+  for (const auto &entry : m_Krows[i])
+  {
+    if (entry.first == j)
+      return entry.second;
+  }
+  return 0.0;
 }
 double
 NurbsSolve::x (unsigned i, unsigned j)
@@ -89,17 +132,17 @@ void
 NurbsSolve::resize (unsigned rows)
 {
   m_feig.conservativeResize (rows, m_feig.cols ());
-  m_Keig.conservativeResize (rows, m_Keig.cols ());
+  m_Krows.resize (rows);
 }
 
 void
 NurbsSolve::printK ()
 {
-  for (Eigen::Index r = 0; r < m_Keig.rows (); r++)
+  for (std::size_t r = 0; r < m_Krows.size (); r++)
   {
-    for (Eigen::Index c = 0; c < m_Keig.cols (); c++)
+    for (Eigen::Index c = 0; c < m_xeig.rows (); c++)
     {
-      printf (" %f", m_Keig (r, c));
+      printf (" %f", K (static_cast<unsigned> (r), static_cast<unsigned> (c)));
     }
     printf ("\n");
   }
@@ -134,9 +177,51 @@ NurbsSolve::printF ()
 bool
 NurbsSolve::solve ()
 {
-  //  m_xeig = m_Keig.colPivHouseholderQr().solve(m_feig);
-  //  Eigen::MatrixXd x = A.householderQr().solve(b);
-  m_xeig = m_Keig.jacobiSvd (Eigen::ComputeThinU | Eigen::ComputeThinV).solve (m_feig);
+  Eigen::SparseMatrix<double> K = assembleSparse (m_Krows, m_xeig.rows ());
+
+  if (K.rows () >= K.cols ())
+  {
+    // normal equations, if they are well conditioned: they square the condition number of K, so
+    // the pivot ratio of K^T K is kept above sqrt (eps), otherwise QR of K is used
+    Eigen::SparseMatrix<double> KtK = K.transpose () * K;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > ldlt (KtK);
+    if (ldlt.info () == Eigen::Success && KtK.cols () > 0)
+    {
+      Eigen::VectorXd d = ldlt.vectorD ().cwiseAbs ();
+      if (d.minCoeff () > d.maxCoeff () * std::sqrt (std::numeric_limits<double>::epsilon ()))
+      {
+        Eigen::MatrixXd x = ldlt.solve (K.transpose () * m_feig);
+        if (ldlt.info () == Eigen::Success && x.allFinite ())
+        {
+          m_xeig = x;
+          return true;
+        }
+      }
+    }
+
+    Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > qr (K);
+    if (qr.info () == Eigen::Success && qr.rank () == K.cols ())
+    {
+      Eigen::MatrixXd x = qr.solve (m_feig);
+      if (qr.info () == Eigen::Success)
+      {
+        m_xeig = x;
+        return true;
+      }
+    }
+  }
+
+  if (!m_quiet)
+  {
+    if (K.rows () < K.cols ())
+      printf ("[NurbsSolve[Eigen]::solve] Warning: system is underdetermined (%ld equations, %ld unknowns), solving with SVD.\n",
+              static_cast<long> (K.rows ()), static_cast<long> (K.cols ()));
+    else
+      printf ("[NurbsSolve[Eigen]::solve] Warning: system is rank deficient, solving with SVD.\n");
+  }
+
+  // minimum norm solution
+  m_xeig = Eigen::MatrixXd (K).jacobiSvd (Eigen::ComputeThinU | Eigen::ComputeThinV).solve (m_feig);
 
   return true;
 }
@@ -144,7 +229,7 @@ NurbsSolve::solve ()
 Eigen::MatrixXd
 NurbsSolve::diff ()
 {
-  Eigen::MatrixXd f (m_Keig * m_xeig);
+  Eigen::MatrixXd f (assembleSparse (m_Krows, m_xeig.rows ()) * m_xeig);
   return (f - m_feig);
 }
 
@@ -41,6 +41,176 @@
 #include "pcl/surface/texture_mapping.h"
 #include "pcl/surface/impl/texture_mapping.hpp"
 
+#include <algorithm>
+#include <numeric>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::texture_mapping::FaceBVH::build (const std::vector<Eigen::Vector3f> &vertices,
+                                      const std::vector<pcl::Vertices> &faces)
+{
+  triangles_.clear ();
+  nodes_.clear ();
+
+  // Split the faces into triangles, skipping the ones with invalid vertices
+  for (const auto &face : faces)
+  {
+    for (std::size_t k = 2; k < face.vertices.size (); ++k)
+    {
+      Triangle triangle;
+      triangle.a = face.vertices[0];
+      triangle.b = face.vertices[k - 1];
+      triangle.c = face.vertices[k];
+      const Eigen::Vector3f &pa = vertices[triangle.a];
+      const Eigen::Vector3f &pb = vertices[triangle.b];
+      const Eigen::Vector3f &pc = vertices[triangle.c];
+      if (!pa.allFinite () || !pb.allFinite () || !pc.allFinite ())
+        continue;
+      triangle.v0 = pa;
+      triangle.e1 = pb - pa;
+      triangle.e2 = pc - pa;
+      triangles_.push_back (triangle);
+    }
+  }
+  if (triangles_.empty ())
+    return;
+
+  std::vector<Eigen::Vector3f> centroids (triangles_.size ());
+  for (std::size_t i = 0; i < triangles_.size (); ++i)
+    centroids[i] = triangles_[i].v0 + (triangles_[i].e1 + triangles_[i].e2) / 3.0f;
+  std::vector<int> order (triangles_.size ());
+  std::iota (order.begin (), order.end (), 0);
+
+  // Split the nodes at the median of their longest axis, until they hold a few triangles
+  const int max_leaf_size = 4;
+  nodes_.reserve (2 * triangles_.size () / max_leaf_size + 1);
+  nodes_.push_back (Node {Eigen::AlignedBox3f (), 0, static_cast<int> (triangles_.size ()), -1});
+  std::vector<int> stack (1, 0);
+  while (!stack.empty ())
+  {
+    const int idx = stack.back ();
+    stack.pop_back ();
+    const int begin = nodes_[idx].begin, end = nodes_[idx].end;
+
+    Eigen::AlignedBox3f box, centroid_box;
+    for (int i = begin; i < end; ++i)
+    {
+      const Triangle &triangle = triangles_[order[i]];
+      box.extend (triangle.v0);
+      box.extend (triangle.v0 + triangle.e1);
+      box.extend (triangle.v0 + triangle.e2);
+      centroid_box.extend (centroids[order[i]]);
+    }
+    nodes_[idx].box = box;
+
+    int axis;
+    if (end - begin <= max_leaf_size || centroid_box.sizes ().maxCoeff (&axis) <= 0.0f)
+      continue;
+
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element (order.begin () + begin, order.begin () + middle, order.begin () + end,
+                      [&centroids, axis] (int a, int b) { return (centroids[a][axis] < centroids[b][axis]); });
+
+    const int left = static_cast<int> (nodes_.size ());
+    nodes_[idx].left = left;
+    nodes_.push_back (Node {Eigen::AlignedBox3f (), begin, middle, -1});
+    nodes_.push_back (Node {Eigen::AlignedBox3f (), middle, end, -1});
+    stack.push_back (left);
+    stack.push_back (left + 1);
+  }
+
+  // Store the triangles of each leaf next to each other
+  std::vector<Triangle> sorted_triangles (triangles_.size ());
+  for (std::size_t i = 0; i < order.size (); ++i)
+    sorted_triangles[i] = triangles_[order[i]];
+  triangles_.swap (sorted_triangles);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::texture_mapping::FaceBVH::intersectsSegment (const Eigen::Vector3f &start, const Eigen::Vector3f &end,
+                                                  pcl::index_t ignored_vertex, float min_t) const
+{
+  if (nodes_.empty ())
+    return (false);
+
+  const Eigen::Vector3f direction = end - start;
+  const Eigen::Vector3f inv_direction = direction.cwiseInverse ();
+
+  // The nodes are split at the median, so the depth of the hierarchy stays well below the size of the stack
+  int stack[64];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0)
+  {
+    const Node &node = nodes_[stack[--stack_size]];
+
+    // Clip the segment against the box of the node
+    float t_near = min_t, t_far = 1.0f;
+    bool crosses_box = true;
+    for (int k = 0; k < 3 && crosses_box; ++k)
+    {
+      if (direction[k] == 0.0f)
+      {
+        crosses_box = start[k] >= node.box.min ()[k] && start[k] <= node.box.max ()[k];
+        continue;
+      }
+      float t0 = (node.box.min ()[k] - start[k]) * inv_direction[k];
+      float t1 = (node.box.max ()[k] - start[k]) * inv_direction[k];
+      if (t0 > t1)
+        std::swap (t0, t1);
+      t_near = std::max (t_near, t0);
+      t_far = std::min (t_far, t1);
+      crosses_box = t_near <= t_far;
+    }
+    if (!crosses_box)
+      continue;
+
+    if (node.left >= 0)
+    {
+      stack[stack_size++] = node.left;
+      stack[stack_size++] = node.left + 1;
+      continue;
+    }
+
+    for (int i = node.begin; i < node.end; ++i)
+    {
+      const Triangle &triangle = triangles_[i];
+      if (triangle.a == ignored_vertex || triangle.b == ignored_vertex || triangle.c == ignored_vertex)
+        continue;
+      if (intersectsTriangle (triangle, start, direction, min_t))
+        return (true);
+    }
+  }
+  return (false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::texture_mapping::FaceBVH::intersectsTriangle (const Triangle &triangle, const Eigen::Vector3f &start,
+                                                   const Eigen::Vector3f &direction, float min_t)
+{
+  // Moller-Trumbore ray/triangle intersection
+  const Eigen::Vector3f p = direction.cross (triangle.e2);
+  const float det = triangle.e1.dot (p);
+  if (det == 0.0f)
+    return (false);
+  const float inv_det = 1.0f / det;
+
+  const Eigen::Vector3f s = start - triangle.v0;
+  const float u = s.dot (p) * inv_det;
+  if (u < 0.0f || u > 1.0f)
+    return (false);
+
+  const Eigen::Vector3f q = s.cross (triangle.e1);
+  const float v = direction.dot (q) * inv_det;
+  if (v < 0.0f || u + v > 1.0f)
+    return (false);
+
+  const float t = triangle.e2.dot (q) * inv_det;
+  return (t > min_t && t < 1.0f);
+}
+
 
 // Instantiations of specific point types
 #ifdef PCL_ONLY_CORE_POINT_TYPES
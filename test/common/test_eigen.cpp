@@ -797,6 +797,63 @@ TEST (PCL, eigen33f)
   EXPECT_LE (float(r_fail_count) / float(iterations), 0.01);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, eigen33Batch)
+{
+  using Scalar = double;
+  using Matrix = Eigen::Matrix<Scalar, 3, 3>;
+  constexpr Eigen::Index batch_size = 1000;
+  constexpr Scalar epsilon = 1e-6;
+
+  std::vector<Matrix, Eigen::aligned_allocator<Matrix> > matrices (batch_size);
+  Eigen::Array<Scalar, Eigen::Dynamic, 6> mats (batch_size, 6);
+  for (Eigen::Index i = 0; i < batch_size; ++i)
+  {
+    generateSymPosMatrix3x3 (matrices[i]);
+    // make sure the batch also contains the degenerate cases
+    if (i == 0)
+      matrices[i].setZero ();
+    else if (i == 1)
+      matrices[i] = Eigen::Matrix<Scalar, 3, 1> (3, 2, 1).asDiagonal ();
+    mats.row (i) << matrices[i] (0, 0), matrices[i] (0, 1), matrices[i] (0, 2),
+                    matrices[i] (1, 1), matrices[i] (1, 2), matrices[i] (2, 2);
+  }
+
+  Eigen::Array<Scalar, Eigen::Dynamic, 1> eigenvalues;
+  Eigen::Array<Scalar, Eigen::Dynamic, 3> eigenvectors;
+  eigen33Batch (mats, eigenvalues, eigenvectors);
+  ASSERT_EQ (eigenvalues.rows (), batch_size);
+  ASSERT_EQ (eigenvectors.rows (), batch_size);
+
+  EXPECT_EQ (eigenvalues (0), 0);
+  EXPECT_NEAR (eigenvalues (1), 1, epsilon);
+  EXPECT_NEAR (eigenvectors (1, 0), 0, epsilon);
+  EXPECT_NEAR (eigenvectors (1, 1), 0, epsilon);
+  EXPECT_NEAR (eigenvectors (1, 2), 1, epsilon);
+
+  // every other matrix must give the same eigenvalue as the single matrix version and a valid eigenvector. The
+  // eigenvectors themselves are not compared, since they are not unique for repeated eigenvalues
+  unsigned checked = 0;
+  for (Eigen::Index i = 1; i < batch_size; ++i)
+  {
+    Scalar eigenvalue;
+    Eigen::Matrix<Scalar, 3, 1> eigenvector;
+    eigen33 (matrices[i], eigenvalue, eigenvector);
+    EXPECT_NEAR (eigenvalues (i), eigenvalue, epsilon);
+
+    // skip the bad conditioned matrices on which the single matrix version does not find an accurate eigenvector
+    // either, the result is dominated by rounding errors there
+    if ((matrices[i] * eigenvector - eigenvalue * eigenvector).norm () > epsilon)
+      continue;
+
+    eigenvector = eigenvectors.row (i).transpose ();
+    EXPECT_NEAR (eigenvector.norm (), 1, epsilon);
+    EXPECT_LE ((matrices[i] * eigenvector - eigenvalues (i) * eigenvector).norm (), epsilon);
+    ++checked;
+  }
+  EXPECT_GE (checked, 0.9 * batch_size);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, transformLine)
 {
@@ -41,6 +41,9 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/cvfh.h>
+#include <pcl/features/our_cvfh.h>
+#include <pcl/features/esf.h>
+#include <pcl/features/cluster_descriptors.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/filters/voxel_grid.h>
 
@@ -118,6 +121,167 @@ TEST (PCL, CVFHEstimationMilk)
   EXPECT_EQ (static_cast<int>(vfhs->size ()), 2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CVFHEstimationMilkThreads)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud_milk);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (leaf_size_ * 4);
+  n.compute (*normals);
+
+  CVFHEstimation<PointXYZ, Normal, VFHSignature308> cvfh;
+  cvfh.setInputCloud (cloud_milk);
+  cvfh.setInputNormals (normals);
+  cvfh.setSearchMethod (tree_milk);
+  cvfh.setClusterTolerance (leaf_size_ * 3);
+  cvfh.setEPSAngleThreshold (0.13f);
+  cvfh.setCurvatureThreshold (0.025f);
+  cvfh.setNormalizeBins (false);
+  cvfh.setRadiusNormals (leaf_size_ * 4);
+
+  PointCloud<VFHSignature308> vfhs_serial, vfhs_parallel;
+  cvfh.setNumberOfThreads (1);
+  cvfh.compute (vfhs_serial);
+  // A second run with the same estimator must not accumulate the dominant regions of the first one
+  cvfh.setNumberOfThreads (4);
+  cvfh.compute (vfhs_parallel);
+
+  ASSERT_EQ (vfhs_serial.size (), 2);
+  ASSERT_EQ (vfhs_parallel.size (), vfhs_serial.size ());
+  for (std::size_t i = 0; i < vfhs_serial.size (); ++i)
+    for (int j = 0; j < 308; ++j)
+      EXPECT_EQ (vfhs_parallel[i].histogram[j], vfhs_serial[i].histogram[j]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, OURCVFHEstimationMilkThreads)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud_milk);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (leaf_size_ * 4);
+  n.compute (*normals);
+
+  OURCVFHEstimation<PointXYZ, Normal, VFHSignature308> ourcvfh;
+  ourcvfh.setInputCloud (cloud_milk);
+  ourcvfh.setInputNormals (normals);
+  ourcvfh.setSearchMethod (tree_milk);
+  ourcvfh.setClusterTolerance (leaf_size_ * 3);
+  ourcvfh.setEPSAngleThreshold (0.13f);
+  ourcvfh.setCurvatureThreshold (0.025f);
+  ourcvfh.setNormalizeBins (false);
+  ourcvfh.setRadiusNormals (leaf_size_ * 4);
+
+  PointCloud<VFHSignature308> vfhs_serial, vfhs_parallel;
+  std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > transforms_serial, transforms_parallel;
+  std::vector<bool> valid_serial, valid_parallel;
+  ourcvfh.setNumberOfThreads (1);
+  ourcvfh.compute (vfhs_serial);
+  ourcvfh.getTransforms (transforms_serial);
+  ourcvfh.getValidTransformsVec (valid_serial);
+  ourcvfh.setNumberOfThreads (4);
+  ourcvfh.compute (vfhs_parallel);
+  ourcvfh.getTransforms (transforms_parallel);
+  ourcvfh.getValidTransformsVec (valid_parallel);
+
+  ASSERT_FALSE (vfhs_serial.empty ());
+  ASSERT_EQ (vfhs_parallel.size (), vfhs_serial.size ());
+  ASSERT_EQ (transforms_serial.size (), vfhs_serial.size ());
+  ASSERT_EQ (transforms_parallel.size (), vfhs_serial.size ());
+  ASSERT_EQ (valid_parallel.size (), valid_serial.size ());
+  for (std::size_t i = 0; i < vfhs_serial.size (); ++i)
+  {
+    for (int j = 0; j < 308; ++j)
+      EXPECT_EQ (vfhs_parallel[i].histogram[j], vfhs_serial[i].histogram[j]);
+    EXPECT_EQ (transforms_parallel[i], transforms_serial[i]);
+    EXPECT_EQ (valid_parallel[i], valid_serial[i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ESFEstimationThreads)
+{
+  ESFEstimation<PointXYZ, ESFSignature640> esf;
+  esf.setInputCloud (cloud_milk);
+  esf.setSeed (42);
+
+  PointCloud<ESFSignature640> esf_serial, esf_parallel, esf_again;
+  esf.setNumberOfThreads (1);
+  esf.compute (esf_serial);
+  esf.setNumberOfThreads (4);
+  esf.compute (esf_parallel);
+  esf.compute (esf_again);
+
+  ASSERT_EQ (esf_serial.size (), 1);
+  ASSERT_EQ (esf_parallel.size (), 1);
+  ASSERT_EQ (esf_again.size (), 1);
+  float sum = 0.0f;
+  for (int j = 0; j < 640; ++j)
+  {
+    // The sampling only depends on the seed, not on the number of threads
+    EXPECT_EQ (esf_parallel[0].histogram[j], esf_serial[0].histogram[j]);
+    EXPECT_EQ (esf_again[0].histogram[j], esf_serial[0].histogram[j]);
+    sum += esf_serial[0].histogram[j];
+  }
+  EXPECT_GT (sum, 0.0f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ComputeClusterDescriptors)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  // Split the bunny in two halves along x
+  std::vector<PointIndices> clusters (2);
+  for (const auto &index : indices)
+    clusters[cloud[index].x < 0.0f ? 0 : 1].indices.push_back (index);
+
+  CVFHEstimation<PointXYZ, Normal, VFHSignature308> cvfh;
+  cvfh.setInputCloud (cloud.makeShared ());
+  cvfh.setInputNormals (normals);
+  cvfh.setSearchMethod (tree);
+
+  std::vector<PointCloud<VFHSignature308> > cvfh_batch;
+  computeClusterDescriptors (cvfh, clusters, cvfh_batch, 2);
+  ASSERT_EQ (cvfh_batch.size (), clusters.size ());
+
+  ESFEstimation<PointXYZ, ESFSignature640> esf;
+  esf.setInputCloud (cloud.makeShared ());
+  esf.setSeed (7);
+
+  std::vector<PointCloud<ESFSignature640> > esf_batch;
+  computeClusterDescriptors (esf, clusters, esf_batch, 2);
+  ASSERT_EQ (esf_batch.size (), clusters.size ());
+
+  // Compare to the descriptors of each cluster computed on its own
+  for (std::size_t c = 0; c < clusters.size (); ++c)
+  {
+    PointCloud<VFHSignature308> cvfh_single;
+    cvfh.setIndices (pcl::IndicesPtr (new pcl::Indices (clusters[c].indices)));
+    cvfh.compute (cvfh_single);
+    ASSERT_EQ (cvfh_batch[c].size (), cvfh_single.size ());
+    for (std::size_t i = 0; i < cvfh_single.size (); ++i)
+      for (int j = 0; j < 308; ++j)
+        EXPECT_EQ (cvfh_batch[c][i].histogram[j], cvfh_single[i].histogram[j]);
+
+    PointCloud<ESFSignature640> esf_single;
+    esf.setIndices (pcl::IndicesPtr (new pcl::Indices (clusters[c].indices)));
+    esf.compute (esf_single);
+    ASSERT_EQ (esf_batch[c].size (), 1);
+    ASSERT_EQ (esf_single.size (), 1);
+    for (int j = 0; j < 640; ++j)
+      EXPECT_EQ (esf_batch[c][0].histogram[j], esf_single[0].histogram[j]);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
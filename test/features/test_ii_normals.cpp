@@ -41,6 +41,7 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
 
+#include <array>
 #include <iostream>
 
 using namespace pcl;
@@ -489,6 +490,49 @@ TEST (PCL, IINormalEstimationSimple3DGradient)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationMultiThreaded)
+{
+  PointCloud<PointXYZ>::Ptr wave (new PointCloud<PointXYZ> (cloud));
+  for (std::size_t v = 0; v < wave->height; ++v)
+    for (std::size_t u = 0; u < wave->width; ++u)
+      (*wave) (u, v).z = 10.0f + 5.0f * std::sin (0.05f * static_cast<float> (u)) + (u > 320 ? 20.0f : 0.0f);
+
+  const std::array<IntegralImageNormalEstimation<PointXYZ, Normal>::NormalEstimationMethod, 4> methods = {
+    ne.COVARIANCE_MATRIX, ne.AVERAGE_3D_GRADIENT, ne.AVERAGE_DEPTH_CHANGE, ne.SIMPLE_3D_GRADIENT};
+  for (const auto method : methods)
+  {
+    IntegralImageNormalEstimation<PointXYZ, Normal> ne_serial, ne_parallel;
+    ne_serial.setNormalEstimationMethod (method);
+    ne_parallel.setNormalEstimationMethod (method);
+    ne_parallel.setNumberOfThreads (4);
+    ne_parallel.reserve (wave->width, wave->height);
+
+    PointCloud<Normal> output_serial, output_parallel;
+    ne_serial.setInputCloud (wave);
+    ne_serial.compute (output_serial);
+    // the buffers are reused across frames, so the second compute has to give the same result
+    for (int frame = 0; frame < 2; ++frame)
+    {
+      ne_parallel.setInputCloud (wave);
+      ne_parallel.compute (output_parallel);
+    }
+
+    ASSERT_EQ (output_serial.size (), output_parallel.size ());
+    for (std::size_t i = 0; i < output_serial.size (); ++i)
+    {
+      const Normal& a = output_serial[i];
+      const Normal& b = output_parallel[i];
+      ASSERT_EQ (std::isfinite (a.normal_x), std::isfinite (b.normal_x));
+      if (!std::isfinite (a.normal_x))
+        continue;
+      EXPECT_NEAR (a.normal_x, b.normal_x, 1e-5);
+      EXPECT_NEAR (a.normal_y, b.normal_y, 1e-5);
+      EXPECT_NEAR (a.normal_z, b.normal_z, 1e-5);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
 {
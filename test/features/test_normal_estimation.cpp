@@ -402,6 +402,70 @@ TEST (PCL, NormalEstimationOpenMP)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalEstimationBatched)
+{
+  // non-dense copy of the input, to also cover the invalid points
+  PointCloud<PointXYZ>::Ptr cloudptr (new PointCloud<PointXYZ> (cloud));
+  (*cloudptr)[0].x = (*cloudptr)[0].y = (*cloudptr)[0].z = std::numeric_limits<float>::quiet_NaN ();
+  cloudptr->is_dense = false;
+  KdTreePtr cloud_tree (new search::KdTree<PointXYZ> (false));
+
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (cloudptr);
+  n.setSearchMethod (cloud_tree);
+  n.setKSearch (10);
+  EXPECT_EQ (n.getBatchSize (), 0);
+
+  PointCloud<Normal> normals;
+  n.compute (normals);
+
+  // use a batch size which does not divide the number of points
+  PointCloud<Normal> normals_batched;
+  n.setBatchSize (50);
+  EXPECT_EQ (n.getBatchSize (), 50);
+  n.compute (normals_batched);
+
+  NormalEstimationOMP<PointXYZ, Normal> n_omp (4);
+  n_omp.setInputCloud (cloudptr);
+  n_omp.setSearchMethod (cloud_tree);
+  n_omp.setKSearch (10);
+  n_omp.setBatchSize (50);
+  PointCloud<Normal> normals_omp;
+  n_omp.compute (normals_omp);
+
+  ASSERT_EQ (normals.size (), cloudptr->size ());
+  ASSERT_EQ (normals_batched.size (), normals.size ());
+  ASSERT_EQ (normals_omp.size (), normals.size ());
+  EXPECT_FALSE (normals_batched.is_dense);
+  EXPECT_FALSE (normals_omp.is_dense);
+  EXPECT_TRUE (std::isnan (normals_batched[0].normal_x));
+  EXPECT_TRUE (std::isnan (normals_omp[0].curvature));
+
+  std::size_t nr_different = 0;
+  for (std::size_t i = 1; i < normals.size (); ++i)
+  {
+    // the blocks are the same, so the parallel version gives the exact same result
+    EXPECT_EQ (normals_omp[i].normal_x, normals_batched[i].normal_x);
+    EXPECT_EQ (normals_omp[i].normal_y, normals_batched[i].normal_y);
+    EXPECT_EQ (normals_omp[i].normal_z, normals_batched[i].normal_z);
+    EXPECT_EQ (normals_omp[i].curvature, normals_batched[i].curvature);
+
+    ASSERT_TRUE (pcl::isFinite (normals_batched[i]));
+    EXPECT_NEAR (normals_batched[i].curvature, normals[i].curvature, 1e-4);
+    // the normal is only unique if the smallest eigenvalue is not repeated, rounding may then pick another one
+    if (normals[i].getNormalVector3fMap ().dot (normals_batched[i].getNormalVector3fMap ()) < 0.999f)
+    {
+      ++nr_different;
+      continue;
+    }
+    EXPECT_NEAR (normals_batched[i].normal_x, normals[i].normal_x, 1e-4);
+    EXPECT_NEAR (normals_batched[i].normal_y, normals[i].normal_y, 1e-4);
+    EXPECT_NEAR (normals_batched[i].normal_z, normals[i].normal_z, 1e-4);
+  }
+  EXPECT_LE (nr_different, normals.size () / 100);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This tests the indexing issue from #3573
 // In certain cases when you used a subset of the indices
@@ -676,6 +676,75 @@ TYPED_TEST (SHOTShapeAndColorTest, Estimation)
   testSHOTLocalReferenceFrame<TypeParam, PointXYZRGBA, Normal, SHOT1344> (cloudWithColors.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SHOTKeepReferenceFrames)
+{
+  double mr = 0.002;
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (20 * mr);
+  n.compute (*normals);
+
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT352> shot (4);
+  shot.setInputNormals (normals);
+  shot.setRadiusSearch (20 * mr);
+  shot.setInputCloud (cloudptr);
+  shot.setSearchMethod (tree);
+  EXPECT_FALSE (shot.getKeepReferenceFrames ());
+  shot.setKeepReferenceFrames (true);
+
+  // The frames estimated by the first call are reused by the second one
+  PointCloud<SHOT352> shots, shots2;
+  shot.compute (shots);
+  PointCloud<ReferenceFrame>::ConstPtr frames = shot.getInputReferenceFrames ();
+  ASSERT_EQ (frames->size (), cloud.size ());
+  shot.compute (shots2);
+  EXPECT_EQ (shot.getInputReferenceFrames (), frames);
+  checkDesc<SHOT352> (shots, shots2);
+
+  // A new input invalidates them
+  shot.setInputCloud (cloud.makeShared ());
+  shot.compute (shots2);
+  EXPECT_NE (shot.getInputReferenceFrames (), frames);
+  checkDesc<SHOT352> (shots, shots2);
+
+  // Without the option, the frames are estimated again at each call
+  shot.setKeepReferenceFrames (false);
+  frames = shot.getInputReferenceFrames ();
+  shot.compute (shots2);
+  EXPECT_NE (shot.getInputReferenceFrames (), frames);
+
+  // Share the frames with a color descriptor working on the same points
+  PointCloud<PointXYZRGBA>::Ptr cloudWithColors (new PointCloud<PointXYZRGBA>);
+  for (int i = 0; i < static_cast<int> (cloud.size ()); ++i)
+  {
+    PointXYZRGBA p;
+    p.x = cloud[i].x;
+    p.y = cloud[i].y;
+    p.z = cloud[i].z;
+    p.rgba = ( (i%255) << 16 ) + ( ( (255 - i ) %255) << 8) + ( ( i*37 ) %255);
+    cloudWithColors->push_back (p);
+  }
+  search::KdTree<PointXYZRGBA>::Ptr rgbaTree (new search::KdTree<PointXYZRGBA> (false));
+
+  SHOTColorEstimation<PointXYZRGBA, Normal, SHOT1344> shot_color;
+  shot_color.setInputNormals (normals);
+  shot_color.setRadiusSearch (20 * mr);
+  shot_color.setInputCloud (cloudWithColors);
+  shot_color.setSearchMethod (rgbaTree);
+  PointCloud<SHOT1344> shots_color, shots_color2;
+  shot_color.compute (shots_color);
+
+  shot_color.setInputReferenceFrames (shot.getInputReferenceFrames ());
+  shot_color.compute (shots_color2);
+  EXPECT_EQ (shot_color.getInputReferenceFrames (), shot.getInputReferenceFrames ());
+  checkDesc<SHOT1344> (shots_color, shots_color2);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL,3DSCEstimation)
 {
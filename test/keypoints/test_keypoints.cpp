@@ -42,6 +42,7 @@
 #include <pcl/filters/approximate_voxel_grid.h>
 
 #include <pcl/keypoints/sift_keypoint.h>
+#include <pcl/keypoints/harris_3d.h>
 
 #include <set>
 
@@ -121,6 +122,69 @@ TEST (PCL, SIFTKeypoint)
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SIFTKeypoint_NumberOfThreads)
+{
+  SIFTKeypoint<PointXYZI, KeypointT> sift_detector;
+  sift_detector.setSearchMethod (search::KdTree<PointXYZI>::Ptr (new search::KdTree<PointXYZI>));
+  sift_detector.setScales (0.02f, 5, 3);
+  sift_detector.setMinimumContrast (0.03f);
+  sift_detector.setInputCloud (cloud_xyzi);
+
+  PointCloud<KeypointT> keypoints_single, keypoints_multi;
+  sift_detector.setNumberOfThreads (1);
+  sift_detector.compute (keypoints_single);
+  sift_detector.setNumberOfThreads (4);
+  sift_detector.compute (keypoints_multi);
+
+  // The keypoints do not depend on the number of threads, not even their order
+  ASSERT_FALSE (keypoints_single.empty ());
+  ASSERT_EQ (keypoints_single.size (), keypoints_multi.size ());
+  for (std::size_t i = 0; i < keypoints_single.size (); ++i)
+  {
+    EXPECT_EQ (keypoints_single[i].x, keypoints_multi[i].x);
+    EXPECT_EQ (keypoints_single[i].y, keypoints_multi[i].y);
+    EXPECT_EQ (keypoints_single[i].z, keypoints_multi[i].z);
+    EXPECT_EQ (keypoints_single[i].scale, keypoints_multi[i].scale);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HarrisKeypoint3D_NumberOfThreads)
+{
+  PointCloud<PointXYZI>::Ptr cloud (new PointCloud<PointXYZI>);
+  ApproximateVoxelGrid<PointXYZI> voxel_grid;
+  voxel_grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  voxel_grid.setInputCloud (cloud_xyzi);
+  voxel_grid.filter (*cloud);
+
+  for (const bool reuse_neighborhoods : {false, true})
+  {
+    HarrisKeypoint3D<PointXYZI, PointXYZI> harris_detector (HarrisKeypoint3D<PointXYZI, PointXYZI>::HARRIS, 0.05f);
+    harris_detector.setNonMaxSupression (true);
+    harris_detector.setRefine (false);
+    harris_detector.setReuseNeighborhoods (reuse_neighborhoods);
+    harris_detector.setInputCloud (cloud);
+
+    PointCloud<PointXYZI> keypoints_single, keypoints_multi;
+    harris_detector.setNumberOfThreads (1);
+    harris_detector.compute (keypoints_single);
+    harris_detector.setNumberOfThreads (4);
+    harris_detector.compute (keypoints_multi);
+
+    ASSERT_FALSE (keypoints_single.empty ());
+    ASSERT_EQ (keypoints_single.size (), keypoints_multi.size ());
+    for (std::size_t i = 0; i < keypoints_single.size (); ++i)
+    {
+      EXPECT_EQ (keypoints_single[i].x, keypoints_multi[i].x);
+      EXPECT_EQ (keypoints_single[i].y, keypoints_multi[i].y);
+      EXPECT_EQ (keypoints_single[i].z, keypoints_multi[i].z);
+      EXPECT_EQ (keypoints_single[i].intensity, keypoints_multi[i].intensity);
+    }
+    EXPECT_EQ (harris_detector.getKeypointsIndices ()->indices.size (), keypoints_multi.size ());
+  }
+}
+
 TEST (PCL, SIFTKeypoint_radiusSearch)
 {
   constexpr int nr_scales_per_octave = 3;
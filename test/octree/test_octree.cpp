@@ -38,6 +38,7 @@
  */
 #include <pcl/test/gtest.h>
 
+#include <random>
 #include <vector>
 
 #include <pcl/common/time.h>
@@ -237,6 +238,96 @@ TEST (PCL, Octree_Test)
   ASSERT_EQ (octreeA.getLeafCount (), leaf_count);
 }
 
+TEST (PCL, Octree_Node_Arena_Test)
+{
+  using ArenaOctree = OctreeBase<int, OctreeContainerEmpty, OctreeNodeArena>;
+
+  ArenaOctree octreeA;
+  OctreeBase<int> octreeHeap;
+  octreeA.setTreeDepth (8);
+  octreeHeap.setTreeDepth (8);
+
+  // fill both octrees with the same voxels
+  for (unsigned int i = 0; i < 256; i++)
+  {
+    *octreeA.createLeaf (i, 255 - i, (i * 7) % 256) = static_cast<int> (i);
+    *octreeHeap.createLeaf (i, 255 - i, (i * 7) % 256) = static_cast<int> (i);
+  }
+
+  // remove every other leaf, their nodes are recycled by the arena
+  for (unsigned int i = 0; i < 256; i += 2)
+  {
+    octreeA.removeLeaf (i, 255 - i, (i * 7) % 256);
+    octreeHeap.removeLeaf (i, 255 - i, (i * 7) % 256);
+  }
+  for (unsigned int i = 256; i < 300; i++)
+  {
+    *octreeA.createLeaf (i % 256, i % 128, i % 64) = static_cast<int> (i);
+    *octreeHeap.createLeaf (i % 256, i % 128, i % 64) = static_cast<int> (i);
+  }
+
+  ASSERT_EQ (octreeHeap.getLeafCount (), octreeA.getLeafCount ());
+  ASSERT_EQ (octreeHeap.getBranchCount (), octreeA.getBranchCount ());
+
+  // same structure and content as the octree allocating its nodes on the heap
+  std::vector<char> treeBinaryA, treeBinaryHeap;
+  std::vector<int*> leafVectorA, leafVectorHeap;
+  octreeA.serializeTree (treeBinaryA, leafVectorA);
+  octreeHeap.serializeTree (treeBinaryHeap, leafVectorHeap);
+  ASSERT_EQ (treeBinaryHeap, treeBinaryA);
+  ASSERT_EQ (leafVectorHeap.size (), leafVectorA.size ());
+  for (std::size_t i = 0; i < leafVectorA.size (); i++)
+    ASSERT_EQ (*leafVectorHeap[i], *leafVectorA[i]);
+
+  // deep copy into a new arena
+  ArenaOctree octreeB (octreeA);
+  ASSERT_EQ (octreeA.getLeafCount (), octreeB.getLeafCount ());
+  for (unsigned int i = 1; i < 256; i += 2)
+  {
+    int* container = octreeB.findLeaf (i, 255 - i, (i * 7) % 256);
+    ASSERT_NE (nullptr, container);
+    ASSERT_NE (octreeA.findLeaf (i, 255 - i, (i * 7) % 256), container);
+    ASSERT_EQ (static_cast<int> (i), *container);
+  }
+
+  octreeA.deleteTree ();
+  ASSERT_EQ (0u, octreeA.getLeafCount ());
+  ASSERT_TRUE (octreeB.existLeaf (1, 254, 7));
+
+  octreeA = octreeB;
+  ASSERT_EQ (octreeB.getLeafCount (), octreeA.getLeafCount ());
+  ASSERT_TRUE (octreeA.existLeaf (1, 254, 7));
+
+  // search on a point cloud octree using the arena gives the same results
+  using ArenaOctreeBase = OctreeBase<OctreeContainerPointIndices, OctreeContainerEmpty, OctreeNodeArena>;
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (std::size_t i = 0; i < 2000; i++)
+    cloudIn->push_back (PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (5.0 * rand () / RAND_MAX)));
+
+  OctreePointCloudSearch<PointXYZ> octreeSearchHeap (0.1);
+  OctreePointCloudSearch<PointXYZ, OctreeContainerPointIndices, OctreeContainerEmpty, ArenaOctreeBase> octreeSearchArena (0.1);
+  octreeSearchHeap.setInputCloud (cloudIn);
+  octreeSearchHeap.addPointsFromInputCloud ();
+  octreeSearchArena.setInputCloud (cloudIn);
+  octreeSearchArena.addPointsFromInputCloud ();
+  ASSERT_EQ (octreeSearchHeap.getLeafCount (), octreeSearchArena.getLeafCount ());
+
+  const PointXYZ searchPoint (5.0f, 5.0f, 2.5f);
+  Indices indicesHeap, indicesArena;
+  std::vector<float> distancesHeap, distancesArena;
+  octreeSearchHeap.nearestKSearch (searchPoint, 10, indicesHeap, distancesHeap);
+  octreeSearchArena.nearestKSearch (searchPoint, 10, indicesArena, distancesArena);
+  ASSERT_EQ (indicesHeap, indicesArena);
+  octreeSearchHeap.radiusSearch (searchPoint, 1.0, indicesHeap, distancesHeap);
+  octreeSearchArena.radiusSearch (searchPoint, 1.0, indicesArena, distancesArena);
+  ASSERT_EQ (indicesHeap, indicesArena);
+
+  octreeSearchArena.deleteTree ();
+  ASSERT_EQ (0u, octreeSearchArena.getLeafCount ());
+}
+
 TEST (PCL, Octree_Dynamic_Depth_Test)
 {
   constexpr int test_runs = 100;
@@ -810,6 +901,115 @@ TEST (PCL, Octree_Pointcloud_Test)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Bulk_Build_Test)
+{
+  constexpr int test_runs = 20;
+  constexpr int pointcount = 2000;
+
+  constexpr float resolution = 0.1f;
+
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> ());
+  OctreePointCloudSearch<PointXYZ>::IndicesPtr indices (new Indices ());
+  std::mt19937 rng (42);
+
+  for (int test = 0; test < test_runs; ++test)
+  {
+    cloud->clear ();
+    indices->clear ();
+
+    for (int point = 0; point < pointcount; point++)
+    {
+      // gereate a random point
+      cloud->emplace_back (static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                           static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                           static_cast<float> (10.0 * rand () / RAND_MAX - 5.0));
+
+      // add every second point to a subset of the cloud
+      if (point % 2)
+        indices->push_back (point);
+    }
+    (*cloud)[test].x = std::numeric_limits<float>::quiet_NaN ();
+    std::shuffle (indices->begin (), indices->end (), rng);
+
+    for (const bool use_indices : {false, true})
+    {
+      // octree filled in a single pass
+      OctreePointCloudSearch<PointXYZ> octree_bulk (resolution);
+      octree_bulk.setNumberOfThreads (4);
+      octree_bulk.setInputCloud (cloud, use_indices ? indices : nullptr);
+
+      // octree filled point by point
+      OctreePointCloudSearch<PointXYZ> octree_single (resolution);
+      octree_single.setInputCloud (cloud);
+
+      // let every other run grow a predefined bounding box
+      if (test % 2)
+      {
+        octree_bulk.defineBoundingBox (0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+        octree_single.defineBoundingBox (0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+      }
+
+      octree_bulk.addPointsFromInputCloud ();
+
+      Indices point_indices;
+      if (use_indices)
+        point_indices = *indices;
+      else
+        for (index_t i = 0; i < pointcount; ++i)
+          point_indices.push_back (i);
+      for (const auto& index : point_indices)
+        if (isFinite ((*cloud)[index]))
+          octree_single.addPointFromCloud (index, nullptr);
+
+      ASSERT_EQ (octree_single.getTreeDepth (), octree_bulk.getTreeDepth ());
+      ASSERT_EQ (octree_single.getLeafCount (), octree_bulk.getLeafCount ());
+      ASSERT_EQ (octree_single.getBranchCount (), octree_bulk.getBranchCount ());
+
+      double min_single[3], max_single[3], min_bulk[3], max_bulk[3];
+      octree_single.getBoundingBox (min_single[0], min_single[1], min_single[2],
+                                    max_single[0], max_single[1], max_single[2]);
+      octree_bulk.getBoundingBox (min_bulk[0], min_bulk[1], min_bulk[2],
+                                  max_bulk[0], max_bulk[1], max_bulk[2]);
+      for (int i = 0; i < 3; ++i)
+      {
+        EXPECT_EQ (min_single[i], min_bulk[i]);
+        EXPECT_EQ (max_single[i], max_bulk[i]);
+      }
+
+      // same structure, and the leaves hold the point indices in insertion order
+      std::vector<char> tree_single, tree_bulk;
+      std::vector<OctreeContainerPointIndices*> leaves_single, leaves_bulk;
+      octree_single.serializeTree (tree_single, leaves_single);
+      octree_bulk.serializeTree (tree_bulk, leaves_bulk);
+
+      ASSERT_EQ (tree_single, tree_bulk);
+      ASSERT_EQ (leaves_single.size (), leaves_bulk.size ());
+      for (std::size_t i = 0; i < leaves_single.size (); ++i)
+        ASSERT_EQ (leaves_single[i]->getPointIndicesVector (), leaves_bulk[i]->getPointIndicesVector ());
+    }
+
+    // the voxel centroid octree stores points instead of indices
+    OctreePointCloudVoxelCentroid<PointXYZ> centroids_bulk (resolution);
+    centroids_bulk.setInputCloud (cloud);
+    centroids_bulk.addPointsFromInputCloud ();
+
+    OctreePointCloudVoxelCentroid<PointXYZ> centroids_single (resolution);
+    centroids_single.setInputCloud (cloud);
+    for (index_t i = 0; i < pointcount; ++i)
+      if (isFinite ((*cloud)[i]))
+        centroids_single.addPointFromCloud (i, nullptr);
+
+    OctreePointCloudVoxelCentroid<PointXYZ>::AlignedPointTVector voxels_bulk, voxels_single;
+    ASSERT_EQ (centroids_single.getVoxelCentroids (voxels_single), centroids_bulk.getVoxelCentroids (voxels_bulk));
+    for (std::size_t i = 0; i < voxels_single.size (); ++i)
+    {
+      EXPECT_EQ (voxels_single[i].x, voxels_bulk[i].x);
+      EXPECT_EQ (voxels_single[i].y, voxels_bulk[i].y);
+      EXPECT_EQ (voxels_single[i].z, voxels_bulk[i].z);
+    }
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Density_Test)
 {
   // instantiate point cloud and fill it with point data
@@ -1022,6 +1222,63 @@ TEST (PCL, Octree_Pointcloud_Change_Detector_Test)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Change_Detector_Parallel_Test)
+{
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  // the parallel diff of detectorA has to match the serial diff of detectorB
+  OctreePointCloudChangeDetector<PointXYZ> detectorA (0.05f);
+  OctreePointCloudChangeDetector<PointXYZ> detectorB (0.05f);
+  detectorA.setNumberOfThreads (4);
+  detectorA.defineBoundingBox (0.0, 0.0, 0.0, 10.0, 10.0, 10.0);
+  detectorB.defineBoundingBox (0.0, 0.0, 0.0, 10.0, 10.0, 10.0);
+
+  for (unsigned int frame = 0; frame < 5; ++frame)
+  {
+    // a moving cloud, so that voxels appear and disappear between the frames
+    PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> (5000, 1));
+    for (auto& point : *cloud)
+      point = PointXYZ (static_cast<float> (frame + 4.0 * rand () / RAND_MAX),
+                        static_cast<float> (frame + 4.0 * rand () / RAND_MAX),
+                        static_cast<float> (4.0 * rand () / RAND_MAX));
+
+    detectorA.setInputCloud (cloud);
+    detectorA.addPointsFromInputCloud ();
+    detectorB.setInputCloud (cloud);
+    detectorB.addPointsFromInputCloud ();
+
+    std::vector<OctreeContainerPointIndices*> leafsA, leafsB;
+    detectorA.getNewLeafs (leafsA, 4);
+    detectorB.serializeNewLeafs (leafsB);
+    ASSERT_EQ (leafsB.size (), leafsA.size ());
+    for (std::size_t i = 0; i < leafsA.size (); ++i)
+      EXPECT_EQ (leafsB[i]->getPointIndicesVector (),
+                 leafsA[i]->getPointIndicesVector ());
+
+    Indices new_indicesA, new_indicesB;
+    detectorA.getPointIndicesFromNewVoxels (new_indicesA, 2);
+    for (const auto& leaf : leafsB)
+      if (leaf->getSize () >= 2)
+        leaf->getPointIndices (new_indicesB);
+    EXPECT_EQ (new_indicesB, new_indicesA);
+    if (frame == 0)
+    {
+      EXPECT_EQ (detectorA.getLeafCount (), leafsA.size ());
+    }
+
+    // the trees built from recycled nodes are the same
+    std::vector<char> treeA, treeB;
+    detectorA.serializeTree (treeA);
+    detectorB.serializeTree (treeB);
+    EXPECT_EQ (treeB, treeA);
+    EXPECT_EQ (detectorB.getLeafCount (), detectorA.getLeafCount ());
+    EXPECT_EQ (detectorB.getBranchCount (), detectorA.getBranchCount ());
+
+    detectorA.switchBuffers ();
+    detectorB.switchBuffers ();
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Voxel_Centroid_Test)
 {
 
@@ -1460,6 +1717,100 @@ TEST (PCL, Octree_Pointcloud_Neighbours_Within_Radius_Search)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Batch_Search)
+{
+  constexpr int pointcount = 3000;
+  constexpr int querycount = 500;
+
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> ());
+  PointCloud<PointXYZ> queries;
+  for (int point = 0; point < pointcount; point++)
+    cloud->emplace_back (static_cast<float> (10.0 * rand () / RAND_MAX),
+                         static_cast<float> (10.0 * rand () / RAND_MAX),
+                         static_cast<float> (10.0 * rand () / RAND_MAX));
+  for (int query = 0; query < querycount; query++)
+    queries.emplace_back (static_cast<float> (12.0 * rand () / RAND_MAX - 1.0),
+                          static_cast<float> (12.0 * rand () / RAND_MAX - 1.0),
+                          static_cast<float> (12.0 * rand () / RAND_MAX - 1.0));
+  // invalid query points get no neighbors
+  queries[7].x = std::numeric_limits<float>::quiet_NaN ();
+
+  OctreePointCloudSearch<PointXYZ> octree (0.5);
+  octree.setNumberOfThreads (4);
+  octree.setInputCloud (cloud);
+  octree.addPointsFromInputCloud ();
+
+  Indices query_indices;
+  for (index_t query = 0; query < querycount; query += 3)
+    query_indices.push_back (query);
+
+  for (const auto& indices : {Indices (), query_indices})
+  {
+    const std::size_t nr_queries = indices.empty () ? queries.size () : indices.size ();
+
+    std::vector<Indices> knn_indices, radius_indices;
+    std::vector<std::vector<float>> knn_distances, radius_distances;
+    octree.nearestKSearch (queries, indices, 8, knn_indices, knn_distances);
+    octree.radiusSearch (queries, indices, 0.7, radius_indices, radius_distances, 20);
+
+    ASSERT_EQ (nr_queries, knn_indices.size ());
+    ASSERT_EQ (nr_queries, knn_distances.size ());
+    ASSERT_EQ (nr_queries, radius_indices.size ());
+    ASSERT_EQ (nr_queries, radius_distances.size ());
+
+    for (std::size_t i = 0; i < nr_queries; ++i)
+    {
+      const PointXYZ& query = queries[indices.empty () ? i : indices[i]];
+      if (!isFinite (query))
+      {
+        EXPECT_TRUE (knn_indices[i].empty ());
+        EXPECT_TRUE (radius_indices[i].empty ());
+        continue;
+      }
+
+      Indices k_indices;
+      std::vector<float> k_sqr_distances;
+      octree.nearestKSearch (query, 8, k_indices, k_sqr_distances);
+      EXPECT_EQ (k_indices, knn_indices[i]);
+      EXPECT_EQ (k_sqr_distances, knn_distances[i]);
+
+      octree.radiusSearch (query, 0.7, k_indices, k_sqr_distances, 20);
+      EXPECT_EQ (k_indices, radius_indices[i]);
+      EXPECT_EQ (k_sqr_distances, radius_distances[i]);
+    }
+  }
+
+  // the distances of the k nearest neighbors are sorted
+  std::vector<Indices> knn_indices;
+  std::vector<std::vector<float>> knn_distances;
+  octree.nearestKSearch (*cloud, Indices (), 10, knn_indices, knn_distances);
+  for (std::size_t i = 0; i < knn_indices.size (); ++i)
+  {
+    ASSERT_EQ (10u, knn_indices[i].size ());
+    EXPECT_EQ (static_cast<index_t> (i), knn_indices[i][0]);
+    EXPECT_TRUE (std::is_sorted (knn_distances[i].begin (), knn_distances[i].end ()));
+  }
+
+  std::vector<Eigen::Vector3f> min_pts, max_pts;
+  for (int query = 0; query < 50; query++)
+  {
+    min_pts.emplace_back (static_cast<float> (6.0 * rand () / RAND_MAX),
+                          static_cast<float> (6.0 * rand () / RAND_MAX),
+                          static_cast<float> (6.0 * rand () / RAND_MAX));
+    max_pts.push_back (min_pts.back () + Eigen::Vector3f::Constant (static_cast<float> (4.0 * rand () / RAND_MAX)));
+  }
+
+  std::vector<Indices> box_indices;
+  octree.boxSearch (min_pts, max_pts, box_indices);
+  ASSERT_EQ (min_pts.size (), box_indices.size ());
+  for (std::size_t i = 0; i < min_pts.size (); ++i)
+  {
+    Indices k_indices;
+    octree.boxSearch (min_pts[i], max_pts[i], k_indices);
+    EXPECT_EQ (k_indices, box_indices[i]);
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Ray_Traversal)
 {
   constexpr unsigned int test_runs = 100;
@@ -1543,6 +1894,79 @@ TEST (PCL, Octree_Pointcloud_Ray_Traversal)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Batch_Ray_Traversal)
+{
+  constexpr std::size_t nr_rays = 500;
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (int i = 0; i < 2000; ++i)
+    cloudIn->push_back (PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX)));
+
+  octree::OctreePointCloudSearch<PointXYZ> octree_search (0.5f);
+  octree_search.setNumberOfThreads (4);
+  octree_search.setInputCloud (cloudIn);
+  octree_search.addPointsFromInputCloud ();
+
+  // rays in all directions, starting inside and outside of the octree, some of them
+  // parallel to an axis
+  std::vector<Eigen::Vector3f> origins, directions;
+  for (std::size_t i = 0; i < nr_rays; ++i)
+  {
+    origins.emplace_back (static_cast<float> (14.0 * rand () / RAND_MAX - 2.0),
+                          static_cast<float> (14.0 * rand () / RAND_MAX - 2.0),
+                          static_cast<float> (14.0 * rand () / RAND_MAX - 2.0));
+    Eigen::Vector3f direction (static_cast<float> (2.0 * rand () / RAND_MAX - 1.0),
+                               static_cast<float> (2.0 * rand () / RAND_MAX - 1.0),
+                               static_cast<float> (2.0 * rand () / RAND_MAX - 1.0));
+    if (i % 10 == 0)
+      direction[i % 3] = 0.0f;
+    directions.push_back (direction);
+  }
+
+  std::vector<pcl::PointCloud<pcl::PointXYZ>::VectorType> batch_voxels;
+  std::vector<Indices> batch_indices;
+  pcl::PointCloud<pcl::PointXYZ>::VectorType voxels;
+  Indices indices;
+
+  // all voxels and the first voxel along each ray are the same as for a single ray
+  for (const uindex_t max_voxel_count : {0u, 1u})
+  {
+    octree_search.getIntersectedVoxelCenters (origins, directions, batch_voxels, max_voxel_count);
+    octree_search.getIntersectedVoxelIndices (origins, directions, batch_indices, max_voxel_count);
+    ASSERT_EQ (nr_rays, batch_voxels.size ());
+    ASSERT_EQ (nr_rays, batch_indices.size ());
+
+    for (std::size_t i = 0; i < nr_rays; ++i)
+    {
+      octree_search.getIntersectedVoxelCenters (origins[i], directions[i], voxels, max_voxel_count);
+      octree_search.getIntersectedVoxelIndices (origins[i], directions[i], indices, max_voxel_count);
+
+      ASSERT_EQ (voxels.size (), batch_voxels[i].size ());
+      for (std::size_t j = 0; j < voxels.size (); ++j)
+      {
+        EXPECT_EQ (voxels[j].x, batch_voxels[i][j].x);
+        EXPECT_EQ (voxels[j].y, batch_voxels[i][j].y);
+        EXPECT_EQ (voxels[j].z, batch_voxels[i][j].z);
+      }
+      EXPECT_EQ (indices, batch_indices[i]);
+    }
+  }
+
+  // traversal stops after the given number of voxels
+  octree_search.getIntersectedVoxelCenters (origins, directions, batch_voxels, 3);
+  for (std::size_t i = 0; i < nr_rays; ++i)
+  {
+    octree_search.getIntersectedVoxelCenters (origins[i], directions[i], voxels);
+    ASSERT_EQ (std::min<std::size_t> (3, voxels.size ()), batch_voxels[i].size ());
+    for (std::size_t j = 0; j < batch_voxels[i].size (); ++j)
+      EXPECT_EQ (voxels[j].getVector3fMap (), batch_voxels[i][j].getVector3fMap ());
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Adjacency)
 {
   constexpr unsigned int test_runs = 100;
@@ -1614,6 +2038,64 @@ TEST (PCL, Octree_Pointcloud_Adjacency)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Adjacency_CSR)
+{
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (int i = 0; i < 5000; ++i)
+    cloudIn->push_back (PointXYZ (static_cast<float> (1.0 * rand () / RAND_MAX),
+                                  static_cast<float> (1.0 * rand () / RAND_MAX),
+                                  static_cast<float> (1.0 * rand () / RAND_MAX)));
+
+  const double resolution = 0.05;
+  OctreePointCloudAdjacency<PointXYZ> octree (resolution);
+  octree.setNumberOfThreads (4);
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+
+  const std::vector<uindex_t>& offsets = octree.getNeighborOffsets ();
+  const std::vector<uindex_t>& neighbors = octree.getNeighborIndices ();
+  ASSERT_EQ (octree.size () + 1, offsets.size ());
+  ASSERT_EQ (offsets.back (), neighbors.size ());
+
+  // keys of the leaves, in the order of the leaf vector
+  std::vector<OctreeKey> keys;
+  for (auto leaf_itr = octree.leaf_depth_begin (); leaf_itr != octree.leaf_depth_end (); ++leaf_itr)
+    keys.push_back (leaf_itr.getCurrentOctreeKey ());
+  ASSERT_EQ (octree.size (), keys.size ());
+
+  for (std::size_t i = 0; i < octree.size (); ++i)
+  {
+    // the compressed row holds the same neighbors as the leaf container
+    auto* leaf_container = octree.at (i);
+    ASSERT_EQ (offsets[i + 1] - offsets[i], leaf_container->size ());
+    auto neighbor_itr = leaf_container->cbegin ();
+    for (uindex_t j = offsets[i]; j < offsets[i + 1]; ++j, ++neighbor_itr)
+      EXPECT_EQ (octree.at (neighbors[j]), *neighbor_itr);
+
+    // and these are all voxels touching the leaf, including itself
+    std::vector<uindex_t> expected;
+    for (std::size_t k = 0; k < keys.size (); ++k)
+    {
+      const auto dx = static_cast<std::int64_t> (keys[i].x) - keys[k].x;
+      const auto dy = static_cast<std::int64_t> (keys[i].y) - keys[k].y;
+      const auto dz = static_cast<std::int64_t> (keys[i].z) - keys[k].z;
+      if (std::abs (dx) <= 1 && std::abs (dy) <= 1 && std::abs (dz) <= 1)
+        expected.push_back (static_cast<uindex_t> (k));
+    }
+    std::vector<uindex_t> row (neighbors.begin () + offsets[i], neighbors.begin () + offsets[i + 1]);
+    std::sort (row.begin (), row.end ());
+    EXPECT_EQ (expected, row);
+  }
+
+  // the adjacency graph has one edge per pair of touching voxels and a loop per voxel
+  OctreePointCloudAdjacency<PointXYZ>::VoxelAdjacencyList graph;
+  octree.computeVoxelAdjacencyGraph (graph);
+  EXPECT_EQ (octree.size (), boost::num_vertices (graph));
+  EXPECT_EQ ((neighbors.size () + octree.size ()) / 2, boost::num_edges (graph));
+}
+
 TEST (PCL, Octree_Pointcloud_Bounds)
 {
     constexpr double SOME_RESOLUTION (10 + 1/3.0);
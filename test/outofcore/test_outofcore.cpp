@@ -44,9 +44,12 @@
 
 #include <pcl/test/gtest.h>
 
+#include <fstream>
+#include <future>
 #include <vector>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 
 #include <pcl/common/time.h>
 
@@ -73,6 +76,7 @@ constexpr std::uint32_t rngseed = 0xAAFF33DD;
 
 const static boost::filesystem::path filename_otreeA = "treeA/tree_test.oct_idx";
 const static boost::filesystem::path filename_otreeB = "treeB/tree_test.oct_idx";
+const static boost::filesystem::path filename_otreeC = "treeC/tree_test.oct_idx";
 
 const static boost::filesystem::path filename_otreeA_LOD = "treeA_LOD/tree_test.oct_idx";
 const static boost::filesystem::path filename_otreeB_LOD = "treeB_LOD/tree_test.oct_idx";
@@ -86,6 +90,10 @@ using PointT = pcl::PointXYZ;
 using octree_disk = OutofcoreOctreeBase<OutofcoreOctreeDiskContainer < PointT > , PointT >;
 using octree_disk_node = OutofcoreOctreeBaseNode<OutofcoreOctreeDiskContainer < PointT > , PointT >;
 
+using octree_buffered = OutofcoreOctreeBase<OutofcoreOctreeBufferedDiskContainer<PointT>, PointT>;
+
+using octree_compressed = OutofcoreOctreeBase<OutofcoreOctreeCompressedDiskContainer<PointT>, PointT>;
+
 using octree_ram = OutofcoreOctreeBase<OutofcoreOctreeRamContainer< PointT> , PointT>;
 using octree_ram_node = OutofcoreOctreeBaseNode<OutofcoreOctreeRamContainer<PointT> , PointT>;
 
@@ -237,8 +245,8 @@ TEST(PCL, Outofcore_Bounding_Box)
   }
 }
 
-void 
-point_test (octree_disk& t)
+template <typename OctreeT> void
+point_test (OctreeT& t)
 {
   std::mt19937 rng (rngseed);
   std::uniform_real_distribution<float> dist(0.0, 1.0);
@@ -309,6 +317,372 @@ TEST (PCL, Outofcore_Point_Query)
   point_test(treeB);
 }
 
+TEST (PCL, Outofcore_Buffered_Disk_Container)
+{
+  const boost::filesystem::path container_path = "buffered_container_test.pcd";
+  const boost::filesystem::path compressed_path = "buffered_container_compressed_test.pcd";
+  boost::filesystem::remove (container_path);
+
+  constexpr std::size_t nr_buffered = 10;
+  {
+    OutofcoreOctreeBufferedDiskContainer<PointT> container (container_path);
+
+    // append in blocks, the number of points in the header grows by several digits
+    for (std::size_t i = 0; i < points.size (); i += 1000)
+      container.insertRange (&points[i], std::min<std::size_t> (1000, points.size () - i));
+
+    // these points stay in the write buffer until the container is destroyed
+    for (std::size_t i = 0; i < nr_buffered; i++)
+      container.push_back (points[i]);
+
+    EXPECT_EQ (points.size () + nr_buffered, container.size ());
+  }
+
+  OutofcoreOctreeBufferedDiskContainer<PointT> container (container_path);
+  ASSERT_EQ (points.size () + nr_buffered, container.size ());
+
+  AlignedPointTVector all_points;
+  container.readRange (0, container.size (), all_points);
+  ASSERT_EQ (container.size (), all_points.size ());
+  for (std::size_t i = 0; i < all_points.size (); i++)
+    EXPECT_TRUE (compPt (points[i % points.size ()], all_points[i]));
+
+  AlignedPointTVector window;
+  container.readRange (4321, 100, window);
+  ASSERT_EQ (100, window.size ());
+  for (std::size_t i = 0; i < window.size (); i++)
+    EXPECT_TRUE (compPt (points[4321 + i], window[i]));
+  EXPECT_TRUE (compPt (points[4321], container[4321]));
+
+  // the sampled points are read in ascending order
+  AlignedPointTVector sample;
+  container.readRangeSubSample (0, points.size (), 0.1, sample);
+  EXPECT_EQ (points.size () / 10, sample.size ());
+  for (const auto &p : sample)
+    EXPECT_NE (std::find_if (points.begin (), points.end (), [&p] (const PointT &q) { return compPt (p, q); }), points.end ());
+
+  container.readRangeSubSample_bernoulli (1000, 2000, 0.5, sample);
+  EXPECT_GT (sample.size (), 0);
+  EXPECT_LT (sample.size (), 2000);
+
+  // files written by the compressing disk container are converted
+  pcl::PointCloud<PointT> cloud;
+  cloud.insert (cloud.end (), points.begin (), points.end ());
+  pcl::PCDWriter ().writeBinaryCompressed (compressed_path.string (), cloud);
+
+  OutofcoreOctreeBufferedDiskContainer<PointT> converted (compressed_path);
+  ASSERT_EQ (points.size (), converted.size ());
+  AlignedPointTVector converted_points;
+  converted.readRange (0, converted.size (), converted_points);
+  for (std::size_t i = 0; i < points.size (); i++)
+    EXPECT_TRUE (compPt (points[i], converted_points[i]));
+
+  container.clear ();
+  converted.clear ();
+  EXPECT_FALSE (boost::filesystem::exists (container_path));
+  EXPECT_FALSE (boost::filesystem::exists (compressed_path));
+}
+
+TEST (PCL, Outofcore_Buffered_Disk_Tree)
+{
+  boost::filesystem::remove_all (filename_otreeC.parent_path ());
+
+  Eigen::Vector3d min (0.0, 0.0, 0.0);
+  Eigen::Vector3d max (1.0, 1.0, 1.0);
+
+  {
+    octree_buffered treeC (4, min, max, filename_otreeC, "ECEF");
+    treeC.addDataToLeaf (points);
+    point_test (treeC);
+  }
+
+  // load the tree from disk
+  octree_buffered treeC (filename_otreeC, true);
+  point_test (treeC);
+
+  AlignedPointTVector sample;
+  treeC.queryBBIncludes_subsample (min, max, treeC.getDepth (), 1.0, sample);
+  EXPECT_EQ (points.size (), sample.size ());
+
+  boost::filesystem::remove_all (filename_otreeC.parent_path ());
+}
+
+TEST (PCL, Outofcore_Write_Buffers)
+{
+  const boost::filesystem::path filename_otreeD = "treeD/tree_test.oct_idx";
+  boost::filesystem::remove_all (filename_otreeC.parent_path ());
+  boost::filesystem::remove_all (filename_otreeD.parent_path ());
+
+  Eigen::Vector3d min (0.0, 0.0, 0.0);
+  Eigen::Vector3d max (1.0, 1.0, 1.0);
+
+  octree_buffered treeC (4, min, max, filename_otreeC, "ECEF");
+  octree_buffered treeD (4, min, max, filename_otreeD, "ECEF");
+  treeD.setNumberOfThreads (4);
+  treeD.setWriteBufferSize (sizeof (PointT) * points.size ());
+
+  // insert the points in batches, which are collected in the write buffers of treeD
+  constexpr std::size_t nr_batches = 4;
+  const std::size_t batch_size = points.size () / nr_batches;
+  for (std::size_t i = 0; i < nr_batches; i++)
+  {
+    const std::size_t end = (i == nr_batches - 1) ? points.size () : (i + 1) * batch_size;
+    AlignedPointTVector batch (points.begin () + i * batch_size, points.begin () + end);
+    EXPECT_EQ (batch.size (), treeC.addDataToLeaf (batch));
+    EXPECT_EQ (batch.size (), treeD.addDataToLeaf (batch));
+  }
+
+  AlignedPointTVector pointsC, pointsD;
+  treeD.queryBBIncludes (min, max, treeD.getDepth (), pointsD);
+  EXPECT_TRUE (pointsD.empty ()) << "Buffered points were written before the budget was exceeded\n";
+
+  treeD.flushWriteBuffers ();
+
+  // the nodes have the same points in the same order
+  for (std::uint64_t depth = 0; depth <= treeC.getDepth (); depth++)
+  {
+    EXPECT_EQ (treeC.getNumPointsAtDepth (depth), treeD.getNumPointsAtDepth (depth));
+  }
+
+  treeC.queryBBIncludes (min, max, treeC.getDepth (), pointsC);
+  treeD.queryBBIncludes (min, max, treeD.getDepth (), pointsD);
+  ASSERT_EQ (points.size (), pointsC.size ());
+  ASSERT_EQ (pointsC.size (), pointsD.size ());
+  for (std::size_t i = 0; i < pointsC.size (); i++)
+  {
+    EXPECT_EQ (pointsC[i].x, pointsD[i].x);
+    EXPECT_EQ (pointsC[i].y, pointsD[i].y);
+    EXPECT_EQ (pointsC[i].z, pointsD[i].z);
+  }
+
+  // a budget of 0 writes the points of every insertion
+  treeD.setWriteBufferSize (0);
+  EXPECT_EQ (points.size (), treeD.addDataToLeaf_and_genLOD (points));
+  treeD.queryBBIncludes (min, max, treeD.getDepth (), pointsD);
+  EXPECT_EQ (2 * points.size (), pointsD.size ());
+  EXPECT_GT (treeD.getNumPointsAtDepth (0), 0);
+
+  boost::filesystem::remove_all (filename_otreeC.parent_path ());
+  boost::filesystem::remove_all (filename_otreeD.parent_path ());
+}
+
+TEST (PCL, Outofcore_Compressed_Disk_Container)
+{
+  const boost::filesystem::path container_path = "compressed_container_test.pcd";
+  const boost::filesystem::path pcd_path = "compressed_container_pcd_test.pcd";
+  boost::filesystem::remove (container_path);
+
+  constexpr std::size_t nr_buffered = 10;
+  double step;
+  {
+    OutofcoreOctreeCompressedDiskContainer<PointT> container (container_path);
+    step = container.getQuantizationStep ();
+    ASSERT_GT (step, 0.0);
+
+    for (std::size_t i = 0; i < points.size (); i += 1000)
+      container.insertRange (&points[i], std::min<std::size_t> (1000, points.size () - i));
+
+    for (std::size_t i = 0; i < nr_buffered; i++)
+      container.push_back (points[i]);
+
+    EXPECT_EQ (points.size () + nr_buffered, container.size ());
+  }
+
+  OutofcoreOctreeCompressedDiskContainer<PointT> container (container_path);
+  ASSERT_EQ (points.size () + nr_buffered, container.size ());
+
+  // the quantized coordinates take less than half of the size of the floats
+  EXPECT_LT (container.getFileSize (), container.size () * 3 * sizeof (float) / 2);
+
+  // the number of points of the first block follows the magic in little endian byte order
+  {
+    std::ifstream file (container_path.string (), std::ios::binary);
+    unsigned char bytes[12];
+    ASSERT_TRUE (file.read (reinterpret_cast<char*> (bytes), sizeof (bytes)));
+    const std::uint32_t nr_points = bytes[8] | (bytes[9] << 8) | (bytes[10] << 16) | (static_cast<std::uint32_t> (bytes[11]) << 24);
+    EXPECT_EQ (points.size () + nr_buffered, nr_points);
+  }
+
+  const float tolerance = static_cast<float> (step / 2) + 1e-6f;
+  AlignedPointTVector all_points;
+  container.readRange (0, container.size (), all_points);
+  ASSERT_EQ (container.size (), all_points.size ());
+  for (std::size_t i = 0; i < all_points.size (); i++)
+  {
+    const PointT& p = points[i % points.size ()];
+    EXPECT_NEAR (p.x, all_points[i].x, tolerance);
+    EXPECT_NEAR (p.y, all_points[i].y, tolerance);
+    EXPECT_NEAR (p.z, all_points[i].z, tolerance);
+  }
+
+  AlignedPointTVector window;
+  container.readRange (4321, 100, window);
+  ASSERT_EQ (100, window.size ());
+  for (std::size_t i = 0; i < window.size (); i++)
+    EXPECT_TRUE (compPt (all_points[4321 + i], window[i]));
+  EXPECT_TRUE (compPt (all_points[4321], container[4321]));
+
+  AlignedPointTVector sample;
+  container.readRangeSubSample (0, container.size (), 0.1, sample);
+  EXPECT_EQ (container.size () / 10, sample.size ());
+  for (const auto &p : sample)
+    EXPECT_NE (std::find_if (all_points.begin (), all_points.end (), [&p] (const PointT &q) { return compPt (p, q); }), all_points.end ());
+
+  // a step of 0 keeps the coordinates, the step of other containers does not change
+  const boost::filesystem::path lossless_path = "compressed_container_lossless_test.pcd";
+  boost::filesystem::remove (lossless_path);
+  OutofcoreOctreeCompressedDiskContainer<PointT> lossless (lossless_path);
+  lossless.setQuantizationStep (0.0);
+  EXPECT_EQ (step, container.getQuantizationStep ());
+  lossless.insertRange (points);
+  lossless.flush (true);
+  AlignedPointTVector lossless_points;
+  lossless.readRange (0, lossless.size (), lossless_points);
+  ASSERT_EQ (points.size (), lossless_points.size ());
+  for (std::size_t i = 0; i < points.size (); i++)
+    EXPECT_TRUE (compPt (points[i], lossless_points[i]));
+
+  // PCD files are converted when they are opened
+  pcl::PointCloud<PointT> cloud;
+  cloud.insert (cloud.end (), points.begin (), points.end ());
+  pcl::PCDWriter ().writeBinaryCompressed (pcd_path.string (), cloud);
+
+  OutofcoreOctreeCompressedDiskContainer<PointT> converted (pcd_path);
+  ASSERT_EQ (points.size (), converted.size ());
+  AlignedPointTVector converted_points;
+  converted.readRange (0, converted.size (), converted_points);
+  for (std::size_t i = 0; i < points.size (); i++)
+  {
+    EXPECT_NEAR (points[i].x, converted_points[i].x, tolerance);
+    EXPECT_NEAR (points[i].y, converted_points[i].y, tolerance);
+    EXPECT_NEAR (points[i].z, converted_points[i].z, tolerance);
+  }
+
+  container.clear ();
+  lossless.clear ();
+  converted.clear ();
+  EXPECT_FALSE (boost::filesystem::exists (container_path));
+  EXPECT_FALSE (boost::filesystem::exists (lossless_path));
+  EXPECT_FALSE (boost::filesystem::exists (pcd_path));
+}
+
+TEST (PCL, Outofcore_Compressed_Disk_Tree)
+{
+  boost::filesystem::remove_all (filename_otreeC.parent_path ());
+
+  Eigen::Vector3d min (0.0, 0.0, 0.0);
+  Eigen::Vector3d max (1.0, 1.0, 1.0);
+
+  // store the coordinates losslessly to compare the query results with the points
+  const auto lossless = [] (OutofcoreOctreeCompressedDiskContainer<PointT> &container) { container.setQuantizationStep (0.0); };
+  {
+    octree_compressed treeC (4, min, max, filename_otreeC, "ECEF");
+    treeC.setContainerInitializer (lossless);
+    treeC.addDataToLeaf (points);
+    point_test (treeC);
+  }
+
+  // load the tree from disk
+  octree_compressed treeC (filename_otreeC, true);
+  point_test (treeC);
+
+  AlignedPointTVector sample;
+  treeC.queryBBIncludes_subsample (min, max, treeC.getDepth (), 1.0, sample);
+  EXPECT_EQ (points.size (), sample.size ());
+
+  boost::filesystem::remove_all (filename_otreeC.parent_path ());
+}
+
+TEST (PCL, Outofcore_Async_Query)
+{
+  boost::filesystem::remove_all (filename_otreeC.parent_path ());
+
+  Eigen::Vector3d min (0.0, 0.0, 0.0);
+  Eigen::Vector3d max (1.0, 1.0, 1.0);
+
+  octree_buffered treeC (4, min, max, filename_otreeC, "ECEF");
+  treeC.addDataToLeaf (points);
+  treeC.setNumberOfThreads (2);
+
+  const Eigen::Vector3d query_min (0.2, 0.3, 0.1);
+  const Eigen::Vector3d query_max (0.7, 0.6, 0.9);
+
+  // warm the cache around the query box
+  treeC.prefetch ((query_min + query_max) / 2, Eigen::Vector3d (0.1, 0.0, 0.0), 0.3, treeC.getDepth () - 1).wait ();
+
+  for (std::uint64_t depth = 0; depth <= treeC.getDepth (); depth++)
+  {
+    AlignedPointTVector expected;
+    treeC.queryBBIncludes (query_min, query_max, depth, expected);
+
+    std::future<AlignedPointTVector> result = treeC.queryBBIncludesAsync (query_min, query_max, depth);
+
+    std::promise<AlignedPointTVector> callback_result;
+    treeC.queryBBIncludesAsync (query_min, query_max, depth, [&callback_result] (const AlignedPointTVector &dst)
+    {
+      callback_result.set_value (dst);
+    });
+
+    const AlignedPointTVector async_points = result.get ();
+    const AlignedPointTVector callback_points = callback_result.get_future ().get ();
+    ASSERT_EQ (expected.size (), async_points.size ());
+    ASSERT_EQ (expected.size (), callback_points.size ());
+    for (std::size_t i = 0; i < expected.size (); i++)
+    {
+      EXPECT_TRUE (compPt (expected[i], async_points[i]));
+      EXPECT_TRUE (compPt (expected[i], callback_points[i]));
+    }
+  }
+
+  // the planes of the unit cube enlarged by 0.5, facing inwards
+  const double planes[24] = { 1, 0, 0, 0.5,  -1, 0, 0, 1.5,
+                              0, 1, 0, 0.5,   0, -1, 0, 1.5,
+                              0, 0, 1, 0.5,   0, 0, -1, 1.5 };
+  std::list<std::string> file_names;
+  treeC.queryFrustum (planes, file_names, 2);
+  EXPECT_EQ (file_names, treeC.queryFrustumAsync (planes, 2).get ());
+
+  // an exception of the callback is passed to the caller
+  std::future<void> failed = treeC.queryBBIncludesAsync (query_min, query_max, 0, [] (const AlignedPointTVector &)
+  {
+    throw std::runtime_error ("callback failed");
+  });
+  EXPECT_THROW (failed.get (), std::runtime_error);
+
+  boost::filesystem::remove_all (filename_otreeC.parent_path ());
+}
+
+TEST (PCL, Outofcore_Node_Cache)
+{
+  // a budget of 1000 bytes in 10 shards of 100 bytes
+  ShardedLRUCache<int, int> cache (1000, 10);
+  const auto value = std::make_shared<const int> (0);
+
+  // values larger than a shard are cached while they fit into the budget
+  EXPECT_TRUE (cache.insert (0, value, 600));
+  EXPECT_TRUE (cache.get (0) != nullptr);
+  EXPECT_FALSE (cache.insert (1, value, 1001));
+  EXPECT_TRUE (cache.get (1) == nullptr);
+
+  for (int key = 2; key < 200; key++)
+  {
+    EXPECT_TRUE (cache.insert (key, value, 30));
+    EXPECT_LE (cache.size (), 1000u);
+  }
+
+  // another large value makes room by evicting values of the other shards
+  EXPECT_TRUE (cache.insert (1000, value, 900));
+  EXPECT_TRUE (cache.get (1000) != nullptr);
+  EXPECT_LE (cache.size (), 1000u);
+
+  cache.setCapacity (500);
+  EXPECT_TRUE (cache.get (1000) == nullptr);
+  EXPECT_LE (cache.size (), 500u);
+
+  cache.clear ();
+  EXPECT_EQ (0u, cache.size ());
+}
+
 #if 0 //this class will be deprecated soon.
 TEST (PCL, Outofcore_Ram_Tree)
 {
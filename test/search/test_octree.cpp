@@ -166,6 +166,45 @@ TEST (PCL, Octree_Pointcloud_Nearest_K_Neighbour_Search)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Batch_Search)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (std::size_t i = 0; i < 1000; i++)
+    cloudIn->emplace_back (static_cast<float> (5.0  * (rand () / static_cast<double> (RAND_MAX))),
+                           static_cast<float> (10.0 * (rand () / static_cast<double> (RAND_MAX))),
+                           static_cast<float> (10.0 * (rand () / static_cast<double> (RAND_MAX))));
+
+  pcl::search::Octree<PointXYZ> octree (0.1);
+  octree.setInputCloud (cloudIn);
+
+  const pcl::search::Search<PointXYZ>& search = octree;
+  std::vector<pcl::Indices> k_indices;
+  std::vector<std::vector<float> > k_sqr_distances;
+
+  // queries through the pcl::search::Search interface match the single queries
+  search.nearestKSearch (*cloudIn, pcl::Indices (), 5, k_indices, k_sqr_distances);
+  ASSERT_EQ (cloudIn->size (), k_indices.size ());
+  for (std::size_t i = 0; i < cloudIn->size (); i++)
+  {
+    pcl::Indices indices;
+    std::vector<float> sqr_distances;
+    octree.nearestKSearch ((*cloudIn)[i], 5, indices, sqr_distances);
+    EXPECT_EQ (indices, k_indices[i]);
+    EXPECT_EQ (sqr_distances, k_sqr_distances[i]);
+  }
+
+  search.radiusSearch (*cloudIn, pcl::Indices (), 0.5, k_indices, k_sqr_distances);
+  ASSERT_EQ (cloudIn->size (), k_indices.size ());
+  for (std::size_t i = 0; i < cloudIn->size (); i++)
+  {
+    pcl::Indices indices;
+    std::vector<float> sqr_distances;
+    octree.radiusSearch ((*cloudIn)[i], 0.5, indices, sqr_distances);
+    EXPECT_EQ (indices, k_indices[i]);
+    EXPECT_EQ (sqr_distances, k_sqr_distances[i]);
+  }
+}
+
 #if 0
 TEST (PCL, Octree_Pointcloud_Approx_Nearest_Neighbour_Search)
 {
@@ -0,0 +1,163 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/surface/bilateral_upsampling.h>
+
+#include <random>
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, BilateralUpsampling)
+{
+  // Two planes of different colors, with noise and missing depth
+  PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB> (64, 48));
+  std::mt19937 rng (12345);
+  std::normal_distribution<float> noise (0.0f, 0.01f);
+  std::uniform_int_distribution<int> color_noise (-5, 5);
+  for (int y = 0; y < static_cast<int> (cloud->height); ++y)
+  {
+    for (int x = 0; x < static_cast<int> (cloud->width); ++x)
+    {
+      PointXYZRGB &p = cloud->at (x, y);
+      const bool left = x < 30;
+      p.z = (left ? 1.0f : 2.0f) + noise (rng);
+      p.x = p.y = 0.0f;
+      p.r = static_cast<std::uint8_t> ((left ? 50 : 200) + color_noise (rng));
+      p.g = static_cast<std::uint8_t> ((left ? 100 : 150) + color_noise (rng));
+      p.b = static_cast<std::uint8_t> ((left ? 200 : 20) + color_noise (rng));
+      if ((x * 7 + y * 3) % 11 == 0)
+        p.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+
+  BilateralUpsampling<PointXYZRGB, PointXYZRGB> bu;
+  bu.setInputCloud (cloud);
+  bu.setWindowSize (4);
+  bu.setSigmaColor (15.0f);
+  bu.setSigmaDepth (2.0f);
+  bu.setProjectionMatrix (bu.KinectVGAProjectionMatrix);
+
+  PointCloud<PointXYZRGB> output;
+  bu.process (output);
+  ASSERT_EQ (output.width, cloud->width);
+  ASSERT_EQ (output.height, cloud->height);
+
+  // Compare with the weighted average of the window, computed directly
+  const Eigen::Matrix3f unprojection = bu.KinectVGAProjectionMatrix.inverse ();
+  const int window_size = bu.getWindowSize ();
+  for (int y = 0; y < static_cast<int> (cloud->height); y += 5)
+  {
+    for (int x = 0; x < static_cast<int> (cloud->width); x += 3)
+    {
+      const PointXYZRGB &p = cloud->at (x, y);
+      double sum = 0.0, norm_sum = 0.0;
+      for (int y_w = std::max (y - window_size, 0); y_w < std::min (y + window_size, static_cast<int> (cloud->height)); ++y_w)
+        for (int x_w = std::max (x - window_size, 0); x_w < std::min (x + window_size, static_cast<int> (cloud->width)); ++x_w)
+        {
+          const PointXYZRGB &q = cloud->at (x_w, y_w);
+          if (!std::isfinite (q.z))
+            continue;
+          const int d_color = std::abs (q.r - p.r) + std::abs (q.g - p.g) + std::abs (q.b - p.b);
+          const double weight = std::exp (-((x - x_w) * (x - x_w) + (y - y_w) * (y - y_w)) / (2.0 * 2.0 * 2.0)) *
+                                std::exp (-d_color * d_color / (2.0 * 15.0 * 15.0));
+          sum += weight * q.z;
+          norm_sum += weight;
+        }
+      ASSERT_GT (norm_sum, 0.0);
+      const float depth = static_cast<float> (sum / norm_sum);
+      const Eigen::Vector3f expected = unprojection * Eigen::Vector3f (static_cast<float> (x) * depth, static_cast<float> (y) * depth, depth);
+      EXPECT_NEAR (output.at (x, y).x, expected[0], 1e-4);
+      EXPECT_NEAR (output.at (x, y).y, expected[1], 1e-4);
+      EXPECT_NEAR (output.at (x, y).z, expected[2], 1e-4);
+      EXPECT_EQ (output.at (x, y).rgba, p.rgba);
+    }
+  }
+
+  // The rows processed in parallel give the same result
+  bu.setNumberOfThreads (4);
+  PointCloud<PointXYZRGB> output_mt;
+  bu.process (output_mt);
+  ASSERT_EQ (output_mt.size (), output.size ());
+  for (std::size_t i = 0; i < output.size (); ++i)
+  {
+    EXPECT_EQ (output_mt[i].x, output[i].x);
+    EXPECT_EQ (output_mt[i].y, output[i].y);
+    EXPECT_EQ (output_mt[i].z, output[i].z);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, BilateralUpsamplingSmallWeights)
+{
+  // A missing depth whose neighbors all differ much in color is filled from their tiny weights
+  PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB> (9, 9));
+  for (auto &p : *cloud)
+  {
+    p.x = p.y = 0.0f;
+    p.z = 1.5f;
+    p.r = p.g = p.b = 100;
+  }
+  PointXYZRGB &center = cloud->at (4, 4);
+  center.z = std::numeric_limits<float>::quiet_NaN ();
+  center.r = center.g = center.b = 150;
+
+  BilateralUpsampling<PointXYZRGB, PointXYZRGB> bu;
+  bu.setInputCloud (cloud);
+  bu.setWindowSize (2);
+  bu.setSigmaColor (15.0f);
+  bu.setSigmaDepth (2.0f);
+  bu.setProjectionMatrix (bu.KinectVGAProjectionMatrix);
+
+  PointCloud<PointXYZRGB> output;
+  bu.process (output);
+  ASSERT_EQ (output.size (), cloud->size ());
+  EXPECT_NEAR (output.at (4, 4).z, 1.5f, 1e-5);
+  EXPECT_NEAR (output.at (0, 0).z, 1.5f, 1e-5);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
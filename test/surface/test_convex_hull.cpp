@@ -39,6 +39,8 @@
 
 #include <pcl/test/gtest.h>
 
+#include <algorithm>
+#include <array>
 #include <random>
 
 #include <pcl/point_types.h>
@@ -483,6 +485,105 @@ TEST (PCL, ConvexHull_4points)
   EXPECT_NEAR (convex_hull.getTotalArea (), 1.0f, 1e-6);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ConvexHull_incremental)
+{
+  std::mt19937 gen (12345u);
+  std::uniform_real_distribution<float> rd (-1.0f, 1.0f);
+  std::normal_distribution<float> nd (0.0f, 1.0f);
+
+  // Points on the unit sphere and inside of it, the hull has no nearly coplanar points whose
+  // classification could depend on the order of the points
+  pcl::PointCloud<pcl::PointXYZ>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZ> ());
+  for (int i = 0; i < 20000; ++i)
+  {
+    Eigen::Vector3f point = Eigen::Vector3f (nd (gen), nd (gen), nd (gen)).normalized ();
+    if (i % 4 != 0)
+      point *= 0.9f * std::abs (rd (gen));
+    input_cloud->emplace_back (point.x (), point.y (), point.z ());
+  }
+
+  // Hull of all points at once
+  pcl::PointCloud<pcl::PointXYZ> hull;
+  std::vector<pcl::Vertices> polygons;
+  pcl::ConvexHull<pcl::PointXYZ> chull;
+  chull.setInputCloud (input_cloud);
+  chull.reconstruct (hull, polygons);
+
+  // Hull updated with two batches
+  pcl::PointCloud<pcl::PointXYZ>::Ptr batch_1 (new pcl::PointCloud<pcl::PointXYZ> ());
+  pcl::PointCloud<pcl::PointXYZ>::Ptr batch_2 (new pcl::PointCloud<pcl::PointXYZ> ());
+  batch_1->insert (batch_1->end (), input_cloud->begin (), input_cloud->begin () + 10000);
+  batch_2->insert (batch_2->end (), input_cloud->begin () + 10000, input_cloud->end ());
+
+  pcl::PointCloud<pcl::PointXYZ> incremental_hull;
+  std::vector<pcl::Vertices> incremental_polygons;
+  pcl::ConvexHull<pcl::PointXYZ> incremental_chull;
+  incremental_chull.setIncremental (true);
+  incremental_chull.setInputCloud (batch_1);
+  incremental_chull.reconstruct (incremental_hull, incremental_polygons);
+  incremental_chull.setInputCloud (batch_2);
+  incremental_chull.reconstruct (incremental_hull, incremental_polygons);
+
+  // The updated hull contains all points and its vertices are input points
+  Eigen::Vector4f centroid;
+  pcl::compute3DCentroid (incremental_hull, centroid);
+  for (const auto &polygon : incremental_polygons)
+  {
+    ASSERT_EQ (polygon.vertices.size (), 3);
+    const Eigen::Vector3f a = incremental_hull[polygon.vertices[0]].getVector3fMap ();
+    Eigen::Vector3f normal = (incremental_hull[polygon.vertices[1]].getVector3fMap () - a).cross (
+                              incremental_hull[polygon.vertices[2]].getVector3fMap () - a).normalized ();
+    if (normal.dot (centroid.head<3> () - a) > 0.0f)
+      normal = -normal;
+    for (const auto &point : input_cloud->points)
+      EXPECT_LT (normal.dot (point.getVector3fMap () - a), 1e-5f);
+  }
+  for (const auto &hull_point : incremental_hull.points)
+  {
+    const auto is_input_point = [&] (const pcl::PointXYZ &point) { return (point.getVector3fMap () == hull_point.getVector3fMap ()); };
+    EXPECT_NE (std::find_if (input_cloud->begin (), input_cloud->end (), is_input_point), input_cloud->end ());
+  }
+
+  // The updated hull has the same vertices as the hull of all points at once
+  const auto sorted_vertices = [] (const pcl::PointCloud<pcl::PointXYZ> &points)
+  {
+    std::vector<std::array<float, 3> > vertices;
+    for (const auto &point : points)
+      vertices.push_back ({{point.x, point.y, point.z}});
+    std::sort (vertices.begin (), vertices.end ());
+    return (vertices);
+  };
+  EXPECT_EQ (sorted_vertices (incremental_hull), sorted_vertices (hull));
+  EXPECT_EQ (incremental_polygons.size (), polygons.size ());
+
+  // The indices of the hull points refer to the last batch
+  pcl::PointIndices hull_indices;
+  incremental_chull.getHullPointIndices (hull_indices);
+  EXPECT_FALSE (hull_indices.indices.empty ());
+  for (const auto &index : hull_indices.indices)
+  {
+    ASSERT_LT (index, batch_2->size ());
+    const auto is_hull_point = [&] (const pcl::PointXYZ &point) { return (point.getVector3fMap () == (*batch_2)[index].getVector3fMap ()); };
+    EXPECT_NE (std::find_if (incremental_hull.begin (), incremental_hull.end (), is_hull_point), incremental_hull.end ());
+  }
+
+  // Points inside of the hull do not change it
+  pcl::PointCloud<pcl::PointXYZ>::Ptr inner_batch (new pcl::PointCloud<pcl::PointXYZ> ());
+  for (int i = 0; i < 1000; ++i)
+    inner_batch->emplace_back (0.5f * rd (gen), 0.5f * rd (gen), 0.5f * rd (gen));
+  pcl::PointCloud<pcl::PointXYZ> unchanged_hull;
+  std::vector<pcl::Vertices> unchanged_polygons;
+  incremental_chull.setInputCloud (inner_batch);
+  incremental_chull.reconstruct (unchanged_hull, unchanged_polygons);
+  ASSERT_EQ (unchanged_hull.size (), incremental_hull.size ());
+  for (std::size_t i = 0; i < unchanged_hull.size (); ++i)
+    EXPECT_EQ (unchanged_hull[i].getVector3fMap (), incremental_hull[i].getVector3fMap ());
+  EXPECT_EQ (unchanged_polygons.size (), incremental_polygons.size ());
+  incremental_chull.getHullPointIndices (hull_indices);
+  EXPECT_TRUE (hull_indices.indices.empty ());
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
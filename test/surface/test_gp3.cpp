@@ -110,6 +110,104 @@ TEST (PCL, GreedyProjectionTriangulation)
   EXPECT_EQ (states[393], gp3.BOUNDARY);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GreedyProjectionTriangulation_Tiles)
+{
+  GreedyProjectionTriangulation<PointNormal> gp3;
+  gp3.setInputCloud (cloud_with_normals);
+  gp3.setSearchMethod (tree2);
+  gp3.setSearchRadius (0.025);
+  gp3.setMu (2.5);
+  gp3.setMaximumNearestNeighbors (100);
+  gp3.setMaximumSurfaceAngle(M_PI/4); // 45 degrees
+  gp3.setMinimumAngle(M_PI/18); // 10 degrees
+  gp3.setMaximumAngle(2*M_PI/3); // 120 degrees
+  gp3.setNormalConsistency(false);
+
+  std::vector<Vertices> polygons;
+  gp3.reconstruct (polygons);
+  const std::vector<int> states = gp3.getPointStates ();
+
+  // A single tile gives the same triangles as the sequential reconstruction
+  std::vector<Vertices> single_tile_polygons;
+  gp3.setTileSize (10.0);
+  gp3.reconstruct (single_tile_polygons);
+  ASSERT_EQ (single_tile_polygons.size (), polygons.size ());
+  for (std::size_t i = 0; i < polygons.size (); ++i)
+    EXPECT_EQ (single_tile_polygons[i].vertices, polygons[i].vertices);
+  EXPECT_EQ (gp3.getPointStates (), states);
+
+  // Smaller tiles give the same result for any number of threads
+  std::vector<Vertices> tile_polygons, tile_polygons_mt;
+  gp3.setTileSize (0.05);
+  gp3.setNumberOfThreads (1);
+  gp3.reconstruct (tile_polygons);
+  const std::vector<int> tile_parts = gp3.getPartIDs ();
+  gp3.setNumberOfThreads (4);
+  gp3.reconstruct (tile_polygons_mt);
+  EXPECT_EQ (gp3.getPartIDs (), tile_parts);
+  ASSERT_EQ (tile_polygons_mt.size (), tile_polygons.size ());
+  for (std::size_t i = 0; i < tile_polygons.size (); ++i)
+    EXPECT_EQ (tile_polygons_mt[i].vertices, tile_polygons[i].vertices);
+
+  EXPECT_NEAR (double (tile_polygons.size ()), double (polygons.size ()), 0.1 * polygons.size ());
+  for (const auto &polygon : tile_polygons)
+  {
+    ASSERT_EQ (polygon.vertices.size (), 3);
+    for (const auto &vertex : polygon.vertices)
+      EXPECT_LT (vertex, cloud_with_normals->size ());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GreedyProjectionTriangulation_TileWithFewNeighbors)
+{
+  // A grid of 6x5 points and invalid points, which the search does not return: the tile has fewer points than
+  // the maximum number of neighbors
+  PointCloud<PointNormal>::Ptr grid (new PointCloud<PointNormal>);
+  for (int i = 0; i < 6; ++i)
+    for (int j = 0; j < 5; ++j)
+    {
+      PointNormal p;
+      p.x = 0.01f * static_cast<float> (i) + 0.001f * static_cast<float> (j);
+      p.y = 0.01f * static_cast<float> (j);
+      p.z = 0.0f;
+      p.normal_x = p.normal_y = 0.0f;
+      p.normal_z = 1.0f;
+      grid->push_back (p);
+    }
+  for (int i = 0; i < 20; ++i)
+  {
+    PointNormal p;
+    p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN ();
+    p.normal_x = p.normal_y = 0.0f;
+    p.normal_z = 1.0f;
+    grid->push_back (p);
+  }
+  grid->is_dense = false;
+  search::KdTree<PointNormal>::Ptr grid_tree (new search::KdTree<PointNormal>);
+  grid_tree->setInputCloud (grid);
+
+  GreedyProjectionTriangulation<PointNormal> gp3;
+  gp3.setInputCloud (grid);
+  gp3.setSearchMethod (grid_tree);
+  gp3.setSearchRadius (0.05);
+  gp3.setMu (2.5);
+  gp3.setMaximumNearestNeighbors (40);
+  gp3.setTileSize (1.0);
+
+  // Every cell of the grid is split into two triangles
+  std::vector<Vertices> polygons;
+  gp3.reconstruct (polygons);
+  EXPECT_EQ (polygons.size (), 2 * 5 * 4);
+  for (const auto &polygon : polygons)
+  {
+    ASSERT_EQ (polygon.vertices.size (), 3);
+    for (const auto &vertex : polygon.vertices)
+      EXPECT_LT (vertex, 30);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, GreedyProjectionTriangulation_Merge2Meshes)
 {
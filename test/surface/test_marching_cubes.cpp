@@ -49,6 +49,9 @@
 #include <pcl/surface/marching_cubes_rbf.h>
 #include <pcl/common/common.h>
 
+#include <algorithm>
+#include <array>
+
 using namespace pcl;
 using namespace pcl::io;
 
@@ -100,6 +103,105 @@ TEST (PCL, MarchingCubesTest)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MarchingCubesNarrowBand)
+{
+  // the triangles of a mesh as sorted vertex coordinates, independent of their order
+  const auto sorted_triangles = [] (const PointCloud<PointNormal> &points)
+  {
+    std::vector<std::array<float, 9> > triangles (points.size () / 3);
+    for (std::size_t i = 0; i < triangles.size (); ++i)
+      for (std::size_t j = 0; j < 3; ++j)
+        for (std::size_t k = 0; k < 3; ++k)
+          triangles[i][3 * j + k] = points[3 * i + j].data[k];
+    std::sort (triangles.begin (), triangles.end ());
+    return (triangles);
+  };
+
+  MarchingCubesHoppe<PointNormal> hoppe;
+  hoppe.setIsoLevel (0);
+  hoppe.setGridResolution (30, 30, 30);
+  hoppe.setPercentageExtendGrid (0.3f);
+  hoppe.setInputCloud (cloud_with_normals);
+  PointCloud<PointNormal> points;
+  std::vector<Vertices> vertices;
+  hoppe.reconstruct (points, vertices);
+  const auto dense_triangles = sorted_triangles (points);
+
+  // a narrow band covering the whole grid gives the same surface as the dense grid
+  hoppe.setNarrowBand (30);
+  hoppe.setNumberOfThreads (4);
+  PointCloud<PointNormal> band_points;
+  hoppe.reconstruct (band_points, vertices);
+  ASSERT_EQ (band_points.size (), vertices.size () * 3);
+  EXPECT_EQ (dense_triangles, sorted_triangles (band_points));
+
+  // a thin narrow band only keeps the surface close to the points
+  hoppe.setNarrowBand (2);
+  hoppe.reconstruct (band_points, vertices);
+  ASSERT_EQ (band_points.size (), vertices.size () * 3);
+  const auto band_triangles = sorted_triangles (band_points);
+  EXPECT_FALSE (band_triangles.empty ());
+  EXPECT_TRUE (std::includes (dense_triangles.begin (), dense_triangles.end (),
+                              band_triangles.begin (), band_triangles.end ()));
+
+  MarchingCubesRBF<PointNormal> rbf;
+  rbf.setIsoLevel (0);
+  rbf.setGridResolution (20, 20, 20);
+  rbf.setPercentageExtendGrid (0.1f);
+  rbf.setInputCloud (cloud_with_normals);
+  rbf.setOffSurfaceDisplacement (0.02f);
+  rbf.reconstruct (points, vertices);
+
+  rbf.setNarrowBand (20);
+  rbf.reconstruct (band_points, vertices);
+  EXPECT_EQ (sorted_triangles (points), sorted_triangles (band_points));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MarchingCubesMergeVertices)
+{
+  MarchingCubesHoppe<PointNormal> hoppe;
+  hoppe.setIsoLevel (0);
+  hoppe.setGridResolution (30, 30, 30);
+  hoppe.setPercentageExtendGrid (0.3f);
+  hoppe.setInputCloud (cloud_with_normals);
+  PointCloud<PointNormal> points;
+  std::vector<Vertices> vertices;
+  hoppe.reconstruct (points, vertices);
+
+  hoppe.setMergeVertices (true);
+  PointCloud<PointNormal> merged_points;
+  std::vector<Vertices> merged_vertices;
+  hoppe.reconstruct (merged_points, merged_vertices);
+
+  // the same triangles, with the vertices shared between neighboring triangles
+  ASSERT_EQ (vertices.size (), merged_vertices.size ());
+  EXPECT_LT (merged_points.size () * 5, points.size ());
+  for (std::size_t i = 0; i < merged_vertices.size (); ++i)
+  {
+    ASSERT_EQ (merged_vertices[i].vertices.size (), 3);
+    for (std::size_t j = 0; j < 3; ++j)
+    {
+      const auto index = merged_vertices[i].vertices[j];
+      ASSERT_LT (index, merged_points.size ());
+      EXPECT_LT ((merged_points[index].getVector3fMap () - points[3 * i + j].getVector3fMap ()).norm (), 1e-6);
+    }
+  }
+
+  // the result does not depend on the number of threads
+  hoppe.setNumberOfThreads (4);
+  PointCloud<PointNormal> parallel_points;
+  std::vector<Vertices> parallel_vertices;
+  hoppe.reconstruct (parallel_points, parallel_vertices);
+  ASSERT_EQ (merged_points.size (), parallel_points.size ());
+  for (std::size_t i = 0; i < merged_points.size (); ++i)
+    EXPECT_EQ (merged_points[i].getVector3fMap (), parallel_points[i].getVector3fMap ());
+  ASSERT_EQ (merged_vertices.size (), parallel_vertices.size ());
+  for (std::size_t i = 0; i < merged_vertices.size (); ++i)
+    EXPECT_EQ (merged_vertices[i].vertices, parallel_vertices[i].vertices);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -182,6 +182,58 @@ TEST (PCL, MovingLeastSquaresOMP)
 }
 #endif
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MovingLeastSquaresUpsamplingReuse)
+{
+  const auto expect_equal_clouds = [] (const PointCloud<PointNormal> &a, const PointCloud<PointNormal> &b)
+  {
+    ASSERT_EQ (a.size (), b.size ());
+    for (std::size_t i = 0; i < a.size (); ++i)
+    {
+      EXPECT_EQ (a[i].getVector3fMap (), b[i].getVector3fMap ());
+      EXPECT_EQ (a[i].getNormalVector3fMap (), b[i].getNormalVector3fMap ());
+    }
+  };
+
+  MovingLeastSquares<PointXYZ, PointNormal> mls;
+  mls.setInputCloud (cloud);
+  mls.setComputeNormals (true);
+  mls.setPolynomialOrder (2);
+  mls.setSearchMethod (tree);
+  mls.setSearchRadius (0.03);
+  mls.setUpsamplingMethod (MovingLeastSquares<PointXYZ, PointNormal>::VOXEL_GRID_DILATION);
+  mls.setDilationIterations (2);
+  mls.setDilationVoxelSize (0.005f);
+
+  // The upsampled cloud does not depend on the number of threads
+  PointCloud<PointNormal> serial_points, parallel_points;
+  mls.process (serial_points);
+  const pcl::Indices serial_indices = mls.getCorrespondingIndices ()->indices;
+  mls.setNumberOfThreads (4);
+  mls.process (parallel_points);
+  expect_equal_clouds (serial_points, parallel_points);
+  EXPECT_EQ (serial_indices, mls.getCorrespondingIndices ()->indices);
+
+  // Projecting a distinct cloud with the cached mls results gives the same result as fitting the surfaces again
+  PointCloud<PointXYZ>::Ptr distinct_cloud (new PointCloud<PointXYZ> (*cloud));
+  for (auto &point : *distinct_cloud)
+    point.x += 0.001f;
+  mls.setUpsamplingMethod (MovingLeastSquares<PointXYZ, PointNormal>::DISTINCT_CLOUD);
+  mls.setDistinctCloud (distinct_cloud);
+  PointCloud<PointNormal> fitted_points, reused_points;
+  mls.process (fitted_points);
+  mls.setReuseMLSResults (true);
+  mls.process (reused_points);
+  EXPECT_EQ (fitted_points.size (), distinct_cloud->size ());
+  expect_equal_clouds (fitted_points, reused_points);
+
+  mls.setUpsamplingMethod (MovingLeastSquares<PointXYZ, PointNormal>::NONE);
+  mls.process (reused_points);
+  mls.setReuseMLSResults (false);
+  mls.process (fitted_points);
+  expect_equal_clouds (fitted_points, reused_points);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -0,0 +1,155 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <pcl/test/gtest.h>
+
+#include <pcl/surface/on_nurbs/fitting_surface_pdm.h>
+
+#include <cmath>
+#include <random>
+
+using namespace pcl::on_nurbs;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NurbsSolve)
+{
+  // Over-determined system with the exact solution x = (1, 2, 3)
+  NurbsSolve solver;
+  solver.assign (4, 3, 1);
+  solver.K (0, 0, 1.0);
+  solver.K (1, 1, 1.0);
+  solver.K (2, 2, 5.0);
+  solver.K (2, 2, 1.0); // overwrites the previous value
+  solver.K (3, 0, 1.0);
+  solver.K (3, 2, 1.0);
+  solver.f (0, 0, 1.0);
+  solver.f (1, 0, 2.0);
+  solver.f (2, 0, 3.0);
+  solver.f (3, 0, 4.0);
+
+  EXPECT_EQ (solver.K (2, 2), 1.0);
+  EXPECT_EQ (solver.K (2, 0), 0.0);
+
+  ASSERT_TRUE (solver.solve ());
+  EXPECT_NEAR (solver.x (0, 0), 1.0, 1e-10);
+  EXPECT_NEAR (solver.x (1, 0), 2.0, 1e-10);
+  EXPECT_NEAR (solver.x (2, 0), 3.0, 1e-10);
+  EXPECT_NEAR (solver.diff ().norm (), 0.0, 1e-10);
+
+  // The second unknown is not constrained, the minimum norm solution sets it to zero
+  solver.assign (2, 2, 1);
+  solver.K (0, 0, 2.0);
+  solver.K (1, 0, 2.0);
+  solver.f (0, 0, 2.0);
+  solver.f (1, 0, 2.0);
+
+  ASSERT_TRUE (solver.solve ());
+  EXPECT_NEAR (solver.x (0, 0), 1.0, 1e-10);
+  EXPECT_NEAR (solver.x (1, 0), 0.0, 1e-10);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FittingSurface)
+{
+  // Points of a curved patch z = 0.2 sin (2x) cos (y)
+  NurbsDataSurface data;
+  std::mt19937 rng (12345);
+  std::uniform_real_distribution<double> uniform (-1.0, 1.0);
+  for (int i = 0; i < 1000; i++)
+  {
+    double x = uniform (rng);
+    double y = uniform (rng);
+    data.interior.emplace_back (x, y, 0.2 * std::sin (2.0 * x) * std::cos (y));
+  }
+
+  FittingSurface::Parameter params;
+  params.interior_smoothness = 0.01;
+  params.interior_weight = 1.0;
+  params.boundary_smoothness = 0.01;
+  params.boundary_weight = 0.0;
+
+  ON_NurbsSurface nurbs = FittingSurface::initNurbsPCABoundingBox (3, &data);
+  FittingSurface fit (&data, nurbs);
+  fit.refine (0);
+  fit.refine (1);
+  fit.refine (0);
+  fit.refine (1);
+
+  for (int i = 0; i < 5; i++)
+  {
+    fit.assemble (params);
+    fit.solve ();
+  }
+  fit.assemble (params);
+  ASSERT_EQ (data.interior_error.size (), data.interior.size ());
+  ASSERT_EQ (data.interior_param.size (), data.interior.size ());
+  double max_error (0.0);
+  for (const double &error : data.interior_error)
+    max_error = std::max (max_error, error);
+  EXPECT_LT (max_error, 0.01);
+
+  // The parallel inverse mapping matches the sequential one
+  NurbsDataSurface data_mt;
+  data_mt.interior = data.interior;
+  data_mt.interior_param = data.interior_param;
+  data_mt.interior_param.resize (data.interior.size () / 2); // the rest starts at the element midpoints
+  FittingSurface fit_mt (&data_mt, fit.m_nurbs);
+  fit_mt.setNumberOfThreads (4);
+  fit_mt.assemble (params);
+
+  NurbsDataSurface data_st;
+  data_st.interior = data_mt.interior;
+  data_st.interior_param = data.interior_param;
+  data_st.interior_param.resize (data.interior.size () / 2);
+  FittingSurface fit_st (&data_st, fit.m_nurbs);
+  fit_st.assemble (params);
+
+  ASSERT_EQ (data_mt.interior_param.size (), data_st.interior_param.size ());
+  for (std::size_t i = 0; i < data_st.interior_param.size (); i++)
+  {
+    EXPECT_EQ (data_mt.interior_param[i], data_st.interior_param[i]);
+    EXPECT_EQ (data_mt.interior_error[i], data_st.interior_error[i]);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -108,6 +108,71 @@ TEST (PCL, Organized)
   EXPECT_EQ (int (triangles.polygons.at (0).vertices.at (2)), 1);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, OrganizedIndexBuffer)
+{
+  // Wavy surface with a hole, so that the polygons of the rows differ
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_organized (new pcl::PointCloud<pcl::PointXYZ> (40, 30));
+  for (std::size_t i = 0; i < cloud_organized->height; i++)
+  {
+    for (std::size_t j = 0; j < cloud_organized->width; j++)
+    {
+      pcl::PointXYZ &p = cloud_organized->at (j, i);
+      p.x = 0.01f * static_cast<float> (j);
+      p.y = 0.01f * static_cast<float> (i);
+      p.z = 1.0f + 0.005f * std::sin (0.5f * static_cast<float> (i * j));
+      if (i > 10 && i < 15 && j > 5 && j < 12)
+        p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+
+  const OrganizedFastMesh<PointXYZ>::TriangulationType types[] = {
+    OrganizedFastMesh<PointXYZ>::TRIANGLE_RIGHT_CUT, OrganizedFastMesh<PointXYZ>::TRIANGLE_LEFT_CUT,
+    OrganizedFastMesh<PointXYZ>::TRIANGLE_ADAPTIVE_CUT, OrganizedFastMesh<PointXYZ>::QUAD_MESH};
+  for (const auto type : types)
+  {
+    for (const int pixel_size : {1, 3})
+    {
+      OrganizedFastMesh<PointXYZ> ofm;
+      ofm.setInputCloud (cloud_organized);
+      ofm.setMaxEdgeLength (0.05);
+      ofm.setTrianglePixelSize (pixel_size);
+      ofm.setTriangulationType (type);
+
+      std::vector<pcl::Vertices> polygons;
+      ofm.reconstruct (polygons);
+      ASSERT_FALSE (polygons.empty ());
+
+      // The flat index buffer holds the same polygons in the same order
+      const std::size_t polygon_size = (type == OrganizedFastMesh<PointXYZ>::QUAD_MESH) ? 4 : 3;
+      std::vector<std::uint32_t> indices;
+      ofm.reconstruct (indices);
+      ASSERT_EQ (indices.size (), polygons.size () * polygon_size);
+      for (std::size_t i = 0; i < polygons.size (); ++i)
+      {
+        ASSERT_EQ (polygons[i].vertices.size (), polygon_size);
+        for (std::size_t k = 0; k < polygon_size; ++k)
+          EXPECT_EQ (indices[i * polygon_size + k], polygons[i].vertices[k]);
+      }
+
+      // Bands of rows processed in parallel give the same result, also when the buffers are reused
+      ofm.setNumberOfThreads (4);
+      for (int frame = 0; frame < 2; ++frame)
+      {
+        std::vector<pcl::Vertices> polygons_mt;
+        ofm.reconstruct (polygons_mt);
+        ASSERT_EQ (polygons_mt.size (), polygons.size ());
+        for (std::size_t i = 0; i < polygons.size (); ++i)
+          EXPECT_EQ (polygons_mt[i].vertices, polygons[i].vertices);
+
+        std::vector<std::uint32_t> indices_mt;
+        ofm.reconstruct (indices_mt);
+        EXPECT_EQ (indices_mt, indices);
+      }
+    }
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
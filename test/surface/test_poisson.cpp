@@ -91,6 +91,91 @@ TEST (PCL, Poisson)
   EXPECT_EQ (mesh.polygons[1000].vertices[2], 715);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PoissonSlabs)
+{
+  Poisson<PointNormal> poisson;
+  poisson.setInputCloud (cloud_with_normals);
+  poisson.setMinDepth (2);
+  PolygonMesh mesh;
+  poisson.reconstruct (mesh);
+
+  Poisson<PointNormal>::Statistics statistics = poisson.getStatistics ();
+  EXPECT_EQ (statistics.nr_slabs, 1);
+  EXPECT_EQ (statistics.nr_samples, cloud_with_normals->size ());
+  EXPECT_GT (statistics.max_tree_nodes, 0);
+  EXPECT_GT (statistics.max_memory, statistics.max_tree_nodes);
+  EXPECT_GE (statistics.solver_time, 0.0);
+  const std::size_t max_tree_nodes = statistics.max_tree_nodes;
+
+  // Reconstructing the input in slabs bounds the size of the octrees
+  poisson.setMaxSlabPoints (cloud_with_normals->size () / 3 + 1);
+  PointCloud<PointNormal> points;
+  std::vector<Vertices> polygons;
+  poisson.reconstruct (points, polygons);
+
+  statistics = poisson.getStatistics ();
+  EXPECT_EQ (statistics.nr_slabs, 3);
+  EXPECT_GT (statistics.nr_samples, cloud_with_normals->size ());
+  EXPECT_LT (statistics.max_tree_nodes, max_tree_nodes);
+  EXPECT_GT (polygons.size (), mesh.polygons.size () / 2);
+  EXPECT_LT (polygons.size (), mesh.polygons.size () * 2);
+
+  std::vector<bool> used (points.size (), false);
+  for (const auto &polygon : polygons)
+  {
+    ASSERT_EQ (polygon.vertices.size (), 3);
+    for (const auto &vertex : polygon.vertices)
+    {
+      ASSERT_LT (vertex, points.size ());
+      used[vertex] = true;
+    }
+  }
+  EXPECT_EQ (std::count (used.begin (), used.end (), false), 0);
+
+  // The slabs cover the surface of the single reconstruction where the points determine it: every
+  // vertex of either surface close to the input is close to a vertex of the other surface. Away from
+  // the input both surfaces are closed by the solver and may differ.
+  const auto max_distance = [] (const PointCloud<PointXYZ> &from, const PointCloud<PointXYZ> &to)
+  {
+    float max_sqr_distance = 0.0f;
+    for (const auto &p : from)
+    {
+      float min_sqr_distance = std::numeric_limits<float>::max ();
+      for (const auto &q : to)
+        min_sqr_distance = std::min (min_sqr_distance, (p.getVector3fMap () - q.getVector3fMap ()).squaredNorm ());
+      max_sqr_distance = std::max (max_sqr_distance, min_sqr_distance);
+    }
+    return (std::sqrt (max_sqr_distance));
+  };
+
+  PointCloud<PointXYZ> input_points, single_points, slab_points;
+  copyPointCloud (*cloud_with_normals, input_points);
+  Eigen::Vector4f min_pt, max_pt;
+  getMinMax3D (input_points, min_pt, max_pt);
+  const float size = (max_pt - min_pt).norm ();
+
+  const auto near_input = [&] (const PointCloud<PointXYZ> &vertices, PointCloud<PointXYZ> &near)
+  {
+    for (const auto &p : vertices)
+    {
+      PointCloud<PointXYZ> vertex;
+      vertex.push_back (p);
+      if (max_distance (vertex, input_points) < 0.02f * size)
+        near.push_back (p);
+    }
+  };
+  PointCloud<PointXYZ> single_vertices, slab_vertices;
+  fromPCLPointCloud2 (mesh.cloud, single_vertices);
+  copyPointCloud (points, slab_vertices);
+  near_input (single_vertices, single_points);
+  near_input (slab_vertices, slab_points);
+  ASSERT_GT (single_points.size (), single_vertices.size () / 2);
+  ASSERT_GT (slab_points.size (), slab_vertices.size () / 2);
+  EXPECT_LT (max_distance (single_points, slab_points), 0.05f * size);
+  EXPECT_LT (max_distance (slab_points, single_points), 0.05f * size);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
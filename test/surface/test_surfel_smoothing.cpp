@@ -0,0 +1,108 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/surface/surfel_smoothing.h>
+
+#include <random>
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SurfelSmoothing)
+{
+  // Noisy plane z = 0, with the normals of the plane
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  std::mt19937 rng (12345);
+  std::normal_distribution<float> noise (0.0f, 0.002f);
+  for (int y = 0; y < 20; ++y)
+  {
+    for (int x = 0; x < 20; ++x)
+    {
+      cloud->push_back (PointXYZ (0.01f * static_cast<float> (x), 0.01f * static_cast<float> (y), noise (rng)));
+      normals->push_back (Normal (0.0f, 0.0f, 1.0f));
+    }
+  }
+
+  PointCloud<PointXYZ>::Ptr smoothed (new PointCloud<PointXYZ>), smoothed_mt (new PointCloud<PointXYZ>);
+  PointCloud<Normal>::Ptr smoothed_normals (new PointCloud<Normal>), smoothed_normals_mt (new PointCloud<Normal>);
+  float residual = 0.0f, residual_mt = 0.0f;
+  for (const unsigned int nr_threads : {1u, 4u})
+  {
+    SurfelSmoothing<PointXYZ, Normal> surfel_smoothing (0.01f);
+    surfel_smoothing.setInputCloud (cloud);
+    surfel_smoothing.setInputNormals (normals);
+    surfel_smoothing.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ>));
+    surfel_smoothing.setNumberOfThreads (nr_threads);
+    if (nr_threads == 1)
+      surfel_smoothing.computeSmoothedCloud (smoothed, smoothed_normals);
+    else
+      surfel_smoothing.computeSmoothedCloud (smoothed_mt, smoothed_normals_mt);
+
+    PointCloud<PointXYZ>::Ptr iteration_positions;
+    PointCloud<Normal>::Ptr iteration_normals;
+    (nr_threads == 1 ? residual : residual_mt) = surfel_smoothing.smoothCloudIteration (iteration_positions, iteration_normals);
+    ASSERT_EQ (iteration_positions->size (), cloud->size ());
+  }
+
+  // The smoothed points are closer to the plane, and do not depend on the number of threads
+  ASSERT_EQ (smoothed->size (), cloud->size ());
+  ASSERT_EQ (smoothed_mt->size (), cloud->size ());
+  double noise_before = 0.0, noise_after = 0.0;
+  for (std::size_t i = 0; i < cloud->size (); ++i)
+  {
+    EXPECT_EQ ((*smoothed)[i].getVector3fMap (), (*smoothed_mt)[i].getVector3fMap ());
+    EXPECT_EQ ((*smoothed_normals)[i].getNormalVector3fMap (), (*smoothed_normals_mt)[i].getNormalVector3fMap ());
+    noise_before += std::abs ((*cloud)[i].z);
+    noise_after += std::abs ((*smoothed)[i].z);
+  }
+  EXPECT_LT (noise_after, noise_before);
+  EXPECT_NEAR (residual_mt, residual, 1e-5f);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
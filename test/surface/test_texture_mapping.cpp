@@ -0,0 +1,174 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/conversions.h>
+#include <pcl/surface/texture_mapping.h>
+
+#include <random>
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FaceBVH)
+{
+  // Random triangles, the hierarchy has to agree with testing all of them
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> coordinate (-1.0f, 1.0f);
+  std::vector<Eigen::Vector3f> vertices (600);
+  for (auto &vertex : vertices)
+    vertex = Eigen::Vector3f (coordinate (rng), coordinate (rng), coordinate (rng));
+  std::vector<Vertices> faces (vertices.size () / 3);
+  for (std::size_t i = 0; i < faces.size (); ++i)
+  {
+    const auto a = static_cast<int> (3 * i);
+    // Shrink the triangles, so that the segments are not occluded all the time
+    vertices[a + 1] = vertices[a] + 0.2f * (vertices[a + 1] - vertices[a]);
+    vertices[a + 2] = vertices[a] + 0.2f * (vertices[a + 2] - vertices[a]);
+    faces[i].vertices = {a, a + 1, a + 2};
+  }
+
+  texture_mapping::FaceBVH bvh;
+  bvh.build (vertices, faces);
+  EXPECT_EQ (bvh.size (), faces.size ());
+
+  texture_mapping::FaceBVH all_faces;
+  int nr_occluded = 0;
+  for (int i = 0; i < 200; ++i)
+  {
+    const Eigen::Vector3f start (coordinate (rng), coordinate (rng), coordinate (rng));
+    const Eigen::Vector3f end (coordinate (rng), coordinate (rng), coordinate (rng));
+    bool expected = false;
+    for (const auto &face : faces)
+    {
+      all_faces.build (vertices, std::vector<Vertices> (1, face));
+      expected = expected || all_faces.intersectsSegment (start, end);
+    }
+    EXPECT_EQ (bvh.intersectsSegment (start, end), expected);
+    nr_occluded += expected;
+  }
+  EXPECT_GT (nr_occluded, 0);
+  EXPECT_LT (nr_occluded, 200);
+
+  // Faces containing the ignored vertex do not occlude it
+  const Eigen::Vector3f centroid = (vertices[0] + vertices[1] + vertices[2]) / 3.0f;
+  const Eigen::Vector3f normal = (vertices[1] - vertices[0]).cross (vertices[2] - vertices[0]).normalized ();
+  EXPECT_TRUE (bvh.intersectsSegment (centroid - normal, centroid + normal));
+  EXPECT_FALSE (bvh.intersectsSegment (centroid - 1e-3f * normal, centroid + 1e-3f * normal, 0));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TextureMeshRaycast)
+{
+  // A square at z = 1, and behind it a triangle with a vertex that the square hides from the origin
+  PointCloud<PointXYZ> cloud;
+  cloud.push_back (PointXYZ (-0.5f, -0.5f, 1.0f));
+  cloud.push_back (PointXYZ (0.5f, -0.5f, 1.0f));
+  cloud.push_back (PointXYZ (0.5f, 0.5f, 1.0f));
+  cloud.push_back (PointXYZ (-0.5f, 0.5f, 1.0f));
+  cloud.push_back (PointXYZ (0.0f, 0.0f, 2.0f));
+  cloud.push_back (PointXYZ (1.5f, 0.0f, 2.0f));
+  cloud.push_back (PointXYZ (1.5f, 0.5f, 2.0f));
+
+  std::vector<Vertices> faces (3);
+  faces[0].vertices = {0, 1, 2};
+  faces[1].vertices = {0, 2, 3};
+  faces[2].vertices = {4, 5, 6};
+
+  // The first camera is at the origin, the second one sees the triangle from the side
+  texture_mapping::CameraVector cameras (2);
+  for (auto &camera : cameras)
+  {
+    camera.focal_length = 100.0;
+    camera.width = 500.0;
+    camera.height = 500.0;
+  }
+  cameras[0].pose = Eigen::Affine3f::Identity ();
+  cameras[1].pose = Eigen::Translation3f (3.0f, 0.0f, 0.0f) * Eigen::Affine3f::Identity ();
+
+  for (const unsigned int nr_threads : {1u, 4u})
+  {
+    TextureMesh mesh;
+    toPCLPointCloud2 (cloud, mesh.cloud);
+    mesh.tex_polygons.push_back (faces);
+
+    TextureMapping<PointXYZ> tm;
+    tm.setNumberOfThreads (nr_threads);
+    tm.textureMeshwithMultipleCamerasRaycast (mesh, cameras);
+
+    ASSERT_EQ (mesh.tex_polygons.size (), 3u);
+    ASSERT_EQ (mesh.tex_coordinates.size (), 3u);
+    ASSERT_EQ (mesh.tex_polygons[0].size (), 2u);
+    ASSERT_EQ (mesh.tex_polygons[1].size (), 1u);
+    EXPECT_TRUE (mesh.tex_polygons[2].empty ());
+    EXPECT_EQ (mesh.tex_polygons[0][0].vertices, faces[0].vertices);
+    EXPECT_EQ (mesh.tex_polygons[0][1].vertices, faces[1].vertices);
+    EXPECT_EQ (mesh.tex_polygons[1][0].vertices, faces[2].vertices);
+    ASSERT_EQ (mesh.tex_coordinates[0].size (), 6u);
+    ASSERT_EQ (mesh.tex_coordinates[1].size (), 3u);
+    EXPECT_TRUE (mesh.tex_coordinates[2].empty ());
+
+    // (-0.5, -0.5, 1) in the first camera, and (-3, 0, 2) in the second one
+    EXPECT_NEAR (mesh.tex_coordinates[0][0][0], 0.4f, 1e-5);
+    EXPECT_NEAR (mesh.tex_coordinates[0][0][1], 0.6f, 1e-5);
+    EXPECT_NEAR (mesh.tex_coordinates[1][0][0], 0.2f, 1e-5);
+    EXPECT_NEAR (mesh.tex_coordinates[1][0][1], 0.5f, 1e-5);
+  }
+
+  // Without the second camera, the triangle is not textured
+  TextureMesh mesh;
+  toPCLPointCloud2 (cloud, mesh.cloud);
+  mesh.tex_polygons.push_back (faces);
+  TextureMapping<PointXYZ> tm;
+  tm.textureMeshwithMultipleCamerasRaycast (mesh, texture_mapping::CameraVector (1, cameras[0]));
+  ASSERT_EQ (mesh.tex_polygons.size (), 2u);
+  EXPECT_EQ (mesh.tex_polygons[0].size (), 2u);
+  ASSERT_EQ (mesh.tex_polygons[1].size (), 1u);
+  ASSERT_EQ (mesh.tex_coordinates[1].size (), 3u);
+  EXPECT_EQ (mesh.tex_coordinates[1][0][0], -1.0f);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */